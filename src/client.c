@@ -0,0 +1,625 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	client.c
+ * @brief	変換サーバー(ilc --server)に変換を依頼する(ilc-client)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+
+/*-
+ * ilc-client は ilc と同じように入力ファイルを指定し、変換を ilc --server に依頼する。
+ * 変換の指定(-f、-i、-n、-r、-C)はサーバーの起動時に指定したものを使用する。
+ * ilc と同じ -f、-i、-n、-r を指定した場合は、最初に MODE 要求でサーバーの指定と
+ * 同じか確認し、異なれば変換を依頼せずにエラーにする(ilc のコマンドラインを
+ * そのまま ilc-client に置き換えても、別の指定で変換されないようにするため)。
+ * 1回の起動で1つの接続を使い、入力ファイルごとに CONV 要求を送る。
+ * サーバーは送受信のない接続を切断するため、-p の標準入力は接続する前に読み込む。
+ * 入力ファイル名は作業ディレクトリとともに送るため、ilc と同じ計測ポイントの名前になる。
+ */
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-client [options] file ...\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -S socket    server socket (default: $" SERVER_ENV ")\n", stdout);
+  fputs("  -f datafile  check that the server uses this coverage data file\n", stdout);
+  fputs("  -i, -n, -r   check that the server was started with the same -i, -n, -r\n", stdout);
+  fputs("  -o outfile   output file (only with a single input file)\n", stdout);
+  fputs("  -p name      convert standard input as file name to standard output\n", stdout);
+  fputs("  -F           make the server write its datafile now\n", stdout);
+  fputs("  -Q           stop the server (it writes its datafile)\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  @listfile    read input file names from listfile, one per line\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+/**
+ * 変換サーバーに接続する
+ * @param const char* ソケットのパス
+ * @return 接続のディスクリプタ
+ *         -1:接続できない
+ */
+int client_connect (
+	const char* path
+)
+{
+	/**/
+	struct sockaddr_un addr;
+	int fd;
+	/**/
+	/* ILC: client_connect開始 */
+
+	if ( strlen( path ) >= sizeof(addr.sun_path) ) {
+		/* ILC: パスが長すぎる */
+		return -1;
+	}
+
+	memset( &addr, 0, sizeof(addr) );
+	addr.sun_family = AF_UNIX;
+	strcpy( addr.sun_path, path );
+
+	fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if ( fd >= 0 && connect( fd, (struct sockaddr*)&addr, sizeof(addr) ) != 0 ) {
+		/* ILC: 接続できない */
+		close( fd );
+		fd = -1;
+	}
+
+	/* ILC: client_connect終了 */
+	return fd;
+}
+
+
+/**
+ * 変換サーバーの応答を受け取る
+ * @param FILE*          接続(読み込み)
+ * @param unsigned long* 応答に続く内容のバイト数の格納先(NULL:内容なし)
+ * @return  0:成功
+ *         -1:接続が切れた、または不正な応答
+ *         それ以外:サーバーが返したエラーコード
+ */
+int client_reply (
+	FILE* in,
+	unsigned long* len
+)
+{
+	/**/
+	char line[64];
+	char* tab;
+	int ret = -1;
+	/**/
+	/* ILC: client_reply開始 */
+
+	if ( fgets( line, sizeof(line), in ) != NULL ) {
+		/* ILC: 応答の1行を受け取った */
+		line[strcspn( line, "\r\n" )] = '\0';
+		tab = strchr( line, '\t' );
+		if ( tab != NULL ) {
+			/* ILC: 応答の種類と値を分ける */
+			*tab++ = '\0';
+		}
+
+		if ( strcmp( line, SERVER_NG ) == 0 && tab != NULL ) {
+			/* ILC: 失敗 */
+			ret = atoi( tab );
+			ret = ( ret != 0 ) ? ret : -1;
+		}
+		else if ( strcmp( line, SERVER_OK ) == 0 && ( len == NULL ) == ( tab == NULL ) ) {
+			/* ILC: 成功 */
+			if ( len != NULL ) {
+				/* ILC: 内容のバイト数 */
+				*len = strtoul( tab, NULL, 10 );
+			}
+			ret = 0;
+		}
+	}
+
+	/* ILC: client_reply終了 */
+	return ret;
+}
+
+
+/**
+ * 変換に失敗したことを報告する
+ * @param const char* 変換元入力ファイル名
+ * @param int         client_reply の戻り値
+ */
+void client_report (
+	const char* in_file,
+	int code
+)
+{
+	/**/
+	/**/
+	/* ILC: client_report開始 */
+
+	switch ( code ) {
+	case 1:
+		/* ILC: 構文エラー */
+		fprintf( stderr, "%s: 構文解析に失敗したので中断します。\n", in_file );
+		break;
+	case 2:
+		/* ILC: メモリエラー */
+		fprintf( stderr, "%s: メモリ確保に失敗したので中断します。\n", in_file );
+		break;
+	case 3:
+		/* ILC: ファイルのオープンエラー */
+		fprintf( stderr, "%s: ファイルを開けないので中断します。\n", in_file );
+		break;
+	case 4:
+		/* ILC: ファイルの書き込みエラー */
+		fprintf( stderr, "%s: ファイルの書き込みに失敗したので中断します。\n", in_file );
+		break;
+	case SERVER_EFLUSH:
+		/* ILC: カバレッジデータの書き出しエラー */
+		fprintf( stderr, "カバレッジデータの書き出しに失敗しました。\n" );
+		break;
+	case SERVER_EMODE:
+		/* ILC: 変換の指定がサーバーと異なる */
+		fprintf( stderr, "%s: -f、-i、-n、-r の指定がサーバーの起動時の指定と異なるので中断します。\n", in_file );
+		break;
+	case -1:
+		/* ILC: 接続が切れた */
+		fprintf( stderr, "%s: サーバーとの接続が切れたので中断します。\n", in_file );
+		break;
+	default:
+		/* ILC: 不正な要求、ありえないエラー */
+		fprintf( stderr, "%s: サーバーがエラーを返したので中断します。エラーコード=%d\n", in_file, code );
+		break;
+	}
+
+	/* ILC: client_report終了 */
+}
+
+
+/**
+ * 変換の指定がサーバーの起動時の指定と同じか確認する(MODE 要求)
+ * @param FILE*       接続(読み込み)
+ * @param FILE*       接続(書き込み)
+ * @param const char* 作業ディレクトリ
+ * @param const char* カバレッジデータファイル名(NULL:確認しない)
+ * @param const char* 変換の指定(i、n、r を並べた文字列)
+ * @param const char* ソケットのパス(エラーの表示に使用する)
+ * @return 0:同じ
+ *         それ以外:client_reply の戻り値
+ */
+int client_mode (
+	FILE* in,
+	FILE* out,
+	const char* cwd,
+	const char* ilc_file,
+	const char* flags,
+	const char* path
+)
+{
+	/**/
+	int ret = -1;
+	/**/
+	/* ILC: client_mode開始 */
+
+	if ( ilc_file != NULL && strpbrk( ilc_file, "\t\n" ) != NULL ) {
+		/* ILC: タブ、改行を含むファイル名は送れない */
+		ret = SERVER_EREQUEST;
+	}
+	else if ( fprintf( out, "%s\t%s\t%s\t%s\n", SERVER_MODE, cwd, ( ilc_file != NULL ) ? ilc_file : "", flags ) >= 0
+			  && fflush( out ) == 0 ) {
+		/* ILC: 要求を送ったので応答を待つ */
+		ret = client_reply( in, NULL );
+	}
+
+	if ( ret != 0 ) {
+		/* ILC: 失敗 */
+		client_report( path, ret );
+	}
+
+	/* ILC: client_mode終了 */
+	return ret;
+}
+
+
+/**
+ * ファイルの変換を依頼する(CONV 要求)
+ * @param FILE*       接続(読み込み)
+ * @param FILE*       接続(書き込み)
+ * @param const char* 作業ディレクトリ
+ * @param const char* 変換元入力ファイル名
+ * @param const char* 変換後出力ファイル名(NULL:自動設定)
+ * @return 0:成功
+ *         それ以外:client_reply の戻り値
+ */
+int client_conv (
+	FILE* in,
+	FILE* out,
+	const char* cwd,
+	const char* in_file,
+	const char* out_file
+)
+{
+	/**/
+	int ret = -1;
+	/**/
+	/* ILC: client_conv開始 */
+
+	if ( strpbrk( in_file, "\t\n" ) != NULL || ( out_file != NULL && strpbrk( out_file, "\t\n" ) != NULL ) ) {
+		/* ILC: タブ、改行を含むファイル名は送れない */
+		ret = SERVER_EREQUEST;
+	}
+	else if ( fprintf( out, "%s\t%s\t%s\t%s\n", SERVER_CONV, cwd, in_file, ( out_file != NULL ) ? out_file : "" ) >= 0
+		 && fflush( out ) == 0 ) {
+		/* ILC: 要求を送ったので応答を待つ */
+		ret = client_reply( in, NULL );
+	}
+
+	if ( ret != 0 ) {
+		/* ILC: 失敗 */
+		client_report( in_file, ret );
+	}
+
+	/* ILC: client_conv終了 */
+	return ret;
+}
+
+
+/**
+ * 標準入力をすべて読み込む
+ * 読み込む間にサーバーが接続を切断しないよう、接続する前に呼び出す。
+ * @param char**  読み込んだ内容の格納先(呼び出し側で free する)
+ * @param size_t* 読み込んだバイト数の格納先
+ * @param size_t* 確保した領域のバイト数の格納先
+ * @return 0:成功
+ *         2:メモリ確保エラー
+ *         3:読み込みエラー
+ */
+int client_stdin (
+	char** data,
+	size_t* data_len,
+	size_t* data_capacity
+)
+{
+	/**/
+	char* buf = NULL;
+	size_t len = 0;
+	size_t capacity = 0;
+	size_t n;
+	int ret = 0;
+	/**/
+	/* ILC: client_stdin開始 */
+
+	for ( ;; ) {
+		/* ILC: 標準入力をすべて読み込む */
+		if ( len == capacity ) {
+			/**/
+			char* tmp;
+			/**/
+			/* ILC: 領域を倍々で拡張する */
+			capacity = ( capacity == 0 ) ? 64 * 1024 : capacity * 2;
+			tmp = (char*)realloc( buf, capacity );
+			if ( tmp == NULL ) {
+				/* ILC: メモリ確保エラー */
+				ret = 2;
+				break;
+			}
+			buf = tmp;
+		}
+		n = fread( buf + len, 1, capacity - len, stdin );
+		len += n;
+		if ( n == 0 ) {
+			/* ILC: EOF */
+			break;
+		}
+	}
+
+	if ( ret == 0 && ferror( stdin ) ) {
+		/* ILC: 読み込めない */
+		ret = 3;
+	}
+
+	*data = buf;
+	*data_len = len;
+	*data_capacity = capacity;
+
+	/* ILC: client_stdin終了 */
+	return ret;
+}
+
+
+/**
+ * 標準入力の変換を依頼し、変換後を標準出力に書き出す(BUF 要求)
+ * @param FILE*       接続(読み込み)
+ * @param FILE*       接続(書き込み)
+ * @param const char* 変換元入力ファイル名(計測ポイントの名前に使用する)
+ * @param char*       client_stdin で読み込んだ内容(変換後の複写にも使用する)
+ * @param size_t      読み込んだバイト数
+ * @param size_t      確保した領域のバイト数
+ * @return 0:成功
+ *         それ以外:client_reply の戻り値
+ */
+int client_pipe (
+	FILE* in,
+	FILE* out,
+	const char* name,
+	char* buf,
+	size_t len,
+	size_t capacity
+)
+{
+	/**/
+	size_t n;
+	unsigned long out_len;
+	int ret = -1;
+	/**/
+	/* ILC: client_pipe開始 */
+
+	if ( strpbrk( name, "\t\n" ) != NULL ) {
+		/* ILC: タブ、改行を含むファイル名は送れない */
+		ret = SERVER_EREQUEST;
+	}
+	else if ( fprintf( out, "%s\t%s\t%lu\n", SERVER_BUF, name, (unsigned long)len ) >= 0
+			  && fwrite( buf, 1, len, out ) == len && fflush( out ) == 0 ) {
+		/* ILC: 要求を送ったので応答を待つ */
+		ret = client_reply( in, &out_len );
+		while ( ret == 0 && out_len > 0 ) {
+			/* ILC: 変換後を標準出力に複写する */
+			n = fread( buf, 1, ( out_len < capacity ) ? (size_t)out_len : capacity, in );
+			if ( n == 0 || fwrite( buf, 1, n, stdout ) != n ) {
+				/* ILC: 接続が切れた、または書き込めない */
+				ret = ( n == 0 ) ? -1 : 4;
+			}
+			out_len -= n;
+		}
+	}
+
+	if ( ret != 0 ) {
+		/* ILC: 失敗 */
+		client_report( name, ret );
+	}
+
+	/* ILC: client_pipe終了 */
+	return ret;
+}
+
+
+/**
+ * 入力ファイル名の一覧の変換を依頼する
+ * @param FILE*       接続(読み込み)
+ * @param FILE*       接続(書き込み)
+ * @param const char* 作業ディレクトリ
+ * @param const char* ファイル名の一覧(1行1ファイル)
+ * @return  0:成功
+ *         -1:一覧を読み込めない
+ *         それ以外:client_reply の戻り値
+ */
+int client_list (
+	FILE* in,
+	FILE* out,
+	const char* cwd,
+	const char* list
+)
+{
+	/**/
+	FILE* fp;
+	char* line = NULL;
+	size_t size = 0;
+	ssize_t len;
+	int ret = 0;
+	/**/
+	/* ILC: client_list開始 */
+
+	fp = fopen( list, "r" );
+	if ( fp == NULL ) {
+		/* ILC: ファイルオープンエラー */
+		fprintf( stderr, "%s: ファイル一覧を開けません。\n", list );
+		return -1;
+	}
+
+	while ( ret == 0 && (len = getline( &line, &size, fp )) > 0 ) {
+		/* ILC: 1行ずつ変換を依頼する */
+		while ( len > 0 && strchr( " \t\r\n", line[len - 1] ) != NULL ) {
+			/* ILC: 行末の空白と改行を取り除く */
+			line[--len] = '\0';
+		}
+		if ( len > 0 ) {
+			/* ILC: 空行以外 */
+			ret = client_conv( in, out, cwd, line, NULL );
+		}
+	}
+
+	free( line );
+	fclose( fp );
+
+	/* ILC: client_list終了 */
+	return ret;
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	FILE* in = NULL;
+	FILE* out = NULL;
+	const char* path = getenv( SERVER_ENV );
+	const char* out_file = NULL;
+	const char* pipe_name = NULL;
+	const char* command = NULL;
+	const char* ilc_file = NULL;
+	char* buf = NULL;				/* -p の標準入力 */
+	size_t len = 0;
+	size_t capacity = 0;
+	char flags[4] = "";				/* -i、-n、-r の指定 */
+	int check = 0;					/* 変換の指定をサーバーに確認する */
+	char cwd[FILENAME_MAX];
+	int fd = -1;
+	int ret = 0;
+	int ch;
+	int ix;
+	/**/
+	/* ILC: main開始 */
+
+	while ( (ch = getopt( argc, argv, "FQS:f:hino:p:r" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'f':
+			/* ILC: カバレッジデータファイル(サーバーと同じか確認する) */
+			ilc_file = optarg;
+			check = 1;
+			break;
+		case 'i':
+		case 'n':
+		case 'r':
+			/* ILC: 変換の指定(サーバーと同じか確認する) */
+			if ( strchr( flags, ch ) == NULL ) {
+				/* ILC: 初めての指定 */
+				flags[strlen( flags )] = (char)ch;
+			}
+			check = 1;
+			break;
+		case 'F':
+			/* ILC: カバレッジデータファイルの書き出し */
+			command = SERVER_FLUSH;
+			break;
+		case 'Q':
+			/* ILC: サーバーの終了 */
+			command = SERVER_QUIT;
+			break;
+		case 'S':
+			/* ILC: ソケットのパス */
+			path = optarg;
+			break;
+		case 'o':
+			/* ILC: 出力ファイル */
+			out_file = optarg;
+			break;
+		case 'p':
+			/* ILC: 標準入力を変換する */
+			pipe_name = optarg;
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 1;
+		}
+	}
+	if ( path == NULL || ( optind >= argc && pipe_name == NULL && command == NULL ) ) {
+		/* ILC: ソケット、または依頼する内容の指定なし */
+		usage();
+		return 1;
+	}
+	if ( out_file != NULL && ( argc - optind != 1 || argv[optind][0] == '@' ) ) {
+		/* ILC: 複数ファイルの出力先を1つには指定できない */
+		fprintf( stderr, "-o は入力ファイルが1つの場合のみ指定できます。\n" );
+		return 1;
+	}
+	if ( getcwd( cwd, sizeof(cwd) ) == NULL || strpbrk( cwd, "\t\n" ) != NULL ) {
+		/* ILC: 作業ディレクトリを送れない */
+		fprintf( stderr, "作業ディレクトリを取得できません。\n" );
+		return 1;
+	}
+
+	if ( pipe_name != NULL && (ret = client_stdin( &buf, &len, &capacity )) != 0 ) {
+		/* ILC: 標準入力を読み込めない */
+		client_report( pipe_name, ret );
+	}
+	else if ( (fd = client_connect( path )) >= 0 ) {
+		/* ILC: 読み込み用と書き込み用のストリームを作成する */
+		in = fdopen( fd, "r" );
+		fd = ( in != NULL ) ? dup( fd ) : fd;
+		out = ( fd >= 0 ) ? fdopen( fd, "w" ) : NULL;
+	}
+	if ( ret == 0 && ( in == NULL || out == NULL ) ) {
+		/* ILC: 接続できない */
+		fprintf( stderr, "%s: サーバーに接続できません。\n", path );
+		ret = -1;
+	}
+
+	if ( ret == 0 && check != 0 ) {
+		/* ILC: 変換の指定がサーバーと同じか確認する */
+		ret = client_mode( in, out, cwd, ilc_file, flags, path );
+	}
+
+	if ( ret == 0 && pipe_name != NULL ) {
+		/* ILC: 標準入力を変換する */
+		ret = client_pipe( in, out, pipe_name, buf, len, capacity );
+	}
+
+	for ( ix = optind; ret == 0 && ix < argc; ix++ ) {
+		/* ILC: 入力ファイルごとに変換を依頼する */
+		if ( argv[ix][0] == '@' ) {
+			/* ILC: ファイル一覧 */
+			ret = client_list( in, out, cwd, argv[ix] + 1 );
+		}
+		else {
+			/* ILC: 通常のファイル名 */
+			ret = client_conv( in, out, cwd, argv[ix], out_file );
+		}
+	}
+
+	if ( ret == 0 && command != NULL ) {
+		/* ILC: 書き出し、終了の要求 */
+		if ( fprintf( out, "%s\n", command ) < 0 || fflush( out ) != 0 || (ret = client_reply( in, NULL )) != 0 ) {
+			/* ILC: 失敗 */
+			ret = ( ret != 0 ) ? ret : -1;
+			client_report( command, ret );
+		}
+	}
+
+	if ( in != NULL ) {
+		/* ILC: 接続のクローズ */
+		fclose( in );
+	}
+	if ( out != NULL ) {
+		/* ILC: 接続のクローズ */
+		fclose( out );
+	}
+	else if ( fd >= 0 ) {
+		/* ILC: 複製したディスクリプタのクローズ */
+		close( fd );
+	}
+	free( buf );
+
+	/* ILC: main終了 */
+	return ( ret == 0 ) ? 0 : 1;
+}
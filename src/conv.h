@@ -0,0 +1,79 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	conv.h
+ * @brief	ファイルの変換(ilc、ilc --server で共用する)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#ifndef _CONV_H_
+#define _CONV_H_
+
+#include <stdio.h>
+#include "options.h"
+
+/**
+ * 1ファイルを変換し、カバレッジデータに登録する
+ * @param const struct opt* 引数の解析結果(out_file:変換後出力ファイル名 NULL:自動設定)
+ * @param char*             変換元入力ファイル名
+ * @return 0:正常
+ *         1:構文エラー
+ *         2:メモリエラー
+ *         3:ファイルのオープンエラー
+ *         4:ファイルの書き込みエラー
+ */
+int conv_file ( const struct opt*, char* );
+
+/**
+ * メモリ上の変換元を変換し、カバレッジデータに登録する
+ * @param const struct opt* 引数の解析結果
+ * @param char*             変換元入力ファイル名(計測ポイントの名前に使用する)
+ * @param char*             変換元
+ * @param size_t            変換元のバイト数
+ * @param char**            変換後の格納先(正常時は呼び出し側で free する)
+ * @param size_t*           変換後のバイト数の格納先
+ * @return 0:正常
+ *         1:構文エラー
+ *         2:メモリエラー
+ *         4:書き込みエラー
+ */
+int conv_buffer ( const struct opt*, char*, char*, size_t, char**, size_t* );
+
+/**
+ * 変換結果を報告する
+ * @param const char* 変換元入力ファイル名
+ * @param int         conv_file、conv_buffer の戻り値
+ * @return  0:正常
+ *         -1:異常
+ */
+int conv_report ( const char*, int );
+
+#endif /* _CONV_H_ */
@@ -0,0 +1,134 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	datconv.c
+ * @brief	ILCカバレッジデータファイルのテキスト形式、バイナリ形式を相互に変換する(ilc-datconv)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ilc_dat.h"
+
+/*-
+ * 入力の形式は先頭の識別子で判定する(ILC_DatLoad)。
+ * 計測ポイントの並びは変えないため、ilc -i で埋め込んだIDは
+ * 変換後のファイルでもそのまま使える。
+ */
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-datconv [options] datafile\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -b           write the binary format\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  -o outfile   output file (default: standard output)\n", stdout);
+  fputs("  -t           write the text format (default)\n", stdout);
+  fputs("  datafile     text or binary coverage data file (\"-\" for standard input)\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	ILC_DAT_TABLE table;
+	const char* out_file = "-";
+	int format = ILC_DAT_TEXT;
+	int ret = 1;
+	int ch;
+	/**/
+	/* ILC: main開始 */
+
+	while ( (ch = getopt( argc, argv, "bho:t" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'b':
+			/* ILC: バイナリ形式で出力 */
+			format = ILC_DAT_BINARY;
+			break;
+		case 't':
+			/* ILC: テキスト形式で出力 */
+			format = ILC_DAT_TEXT;
+			break;
+		case 'o':
+			/* ILC: 出力ファイル */
+			out_file = optarg;
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 1;
+		}
+	}
+	if ( argc - optind != 1 ) {
+		/* ILC: データファイルは1つ */
+		usage();
+		return 1;
+	}
+	if ( format == ILC_DAT_BINARY && strcmp( out_file, "-" ) == 0 && isatty( fileno( stdout ) ) ) {
+		/* ILC: 端末にバイナリは出力しない */
+		fprintf( stderr, "バイナリ形式は -o で出力ファイルを指定してください。\n" );
+		return 1;
+	}
+
+	memset( &table, 0, sizeof(ILC_DAT_TABLE) );
+	if ( ILC_DatLoad( argv[optind], &table ) != 0 ) {
+		/* ILC: 読み込みエラー */
+		fprintf( stderr, "%s: ファイルを読み込めません。\n", argv[optind] );
+	}
+	else if ( table.invalid > 0 ) {
+		/* ILC: 変換すると失われる行がある */
+		fprintf( stderr, "%s: 形式が正しくない行が%ld行あるため変換しません。\n", argv[optind], table.invalid );
+	}
+	else if ( ILC_DatSave( out_file, table.point, table.num, format ) != 0 ) {
+		/* ILC: 書き込みエラー */
+		fprintf( stderr, "%s: 書き込みに失敗しました。\n", out_file );
+	}
+	else {
+		/* ILC: 変換成功 */
+		ret = 0;
+	}
+
+	ILC_DatFree( &table );
+
+	/* ILC: main終了 */
+	return ret;
+}
@@ -0,0 +1,818 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	diff.c
+ * @brief	2つのILCカバレッジデータファイルの差分を表示する(ilc-diff)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ilc_dat.h"
+
+/*-
+ * 旧・新のILCカバレッジデータファイルを「ファイル名:関数名:行数」の順に
+ * 先頭から同時に読み進めて突き合わせる。
+ * すでにこの順に並んでいる(同じ計測ポイントが複数ない)ファイルは、
+ * 並びを確認した後、ILC_DatOpen / ILC_DatRead で読み進めるため、
+ * ファイル全体をメモリに展開しない(並びの確認と突き合わせで2回読み込む)。
+ * 並んでいないファイルと標準入力は、従来どおり ILC_DatLoad で展開して
+ * ILC_DatSort で並べ替えるため、ファイルの大きさ分のメモリを使う。
+ *
+ *   gained    : 新で通過済み、旧で未通過(または旧にない)
+ *   lost      : 旧で通過済み、新で未通過(または新にない)
+ *   unchanged : それ以外
+ *
+ * 通過済みかは ILC_DAT_COVERED で判定する(通過回数の増減は差分としない)。
+ * 並べ替えた列ではファイル・関数が連続するため、ファイルごと・関数ごとの
+ * 集計は、ファイル名・関数名が変わるところで区切るだけで求まる。
+ */
+
+/* 出力ファイルのバッファサイズ */
+#define DIFF_BUFSIZ (256 * 1024)
+
+/**
+ * 入力(旧または新)
+ * reader で読み込んだ計測ポイントは、次に読み込むまで有効なため、
+ * 突き合わせに使った計測ポイントは、次の突き合わせの時に読み進める。
+ */
+typedef struct _diff_input {
+	const char*				filename;	/**< ファイル名 */
+	ILC_DAT_READER*			reader;		/**< 並べ替え済みのファイル(NULL:table を使う) */
+	ILC_DAT_TABLE			table;		/**< 展開して並べ替えた計測ポイント */
+	long					ix;			/**< table の次の添字 */
+	ILC_DAT_POINT			point;		/**< reader で読み込んだ計測ポイント */
+	const ILC_DAT_POINT*	cur;		/**< 現在の計測ポイント(NULL:終わり) */
+	int						used;		/**< 現在の計測ポイントを突き合わせに使ったか */
+}
+DIFF_INPUT;
+
+/**
+ * 突き合わせの状態
+ */
+typedef struct _diff_cursor {
+	DIFF_INPUT*	old_data;	/**< 旧 */
+	DIFF_INPUT*	new_data;	/**< 新 */
+}
+DIFF_CURSOR;
+
+/**
+ * 突き合わせた計測ポイント
+ */
+typedef struct _diff_pair {
+	const ILC_DAT_POINT*	key;		/**< 計測ポイント(旧または新) */
+	const ILC_DAT_POINT*	old_point;	/**< 旧(ない場合はNULL) */
+	const ILC_DAT_POINT*	new_point;	/**< 新(ない場合はNULL) */
+	int						old_covered;/**< 旧で通過済みか */
+	int						new_covered;/**< 新で通過済みか */
+}
+DIFF_PAIR;
+
+/**
+ * ファイルごと、関数ごとの集計
+ */
+typedef struct _diff_count {
+	long	old_covered;	/**< 旧の通過済みの計測ポイント数 */
+	long	old_total;		/**< 旧の計測ポイント数 */
+	long	new_covered;	/**< 新の通過済みの計測ポイント数 */
+	long	new_total;		/**< 新の計測ポイント数 */
+	long	gained;			/**< 新しく通過した計測ポイント数 */
+	long	lost;			/**< 通過しなくなった計測ポイント数 */
+	long	unchanged;		/**< 変化のない計測ポイント数 */
+}
+DIFF_COUNT;
+
+/** 同じ文字列か(同じ領域を指していれば比較しない) */
+#define DIFF_SAME(a, b)	((a) == (b) || strcmp( (a), (b) ) == 0)
+
+/** 表示する内容 */
+#define DIFF_SHOW_POINT		(0x01)	/**< gained / lost の計測ポイント */
+#define DIFF_SHOW_SUMMARY	(0x02)	/**< ファイルごと、関数ごとの集計 */
+#define DIFF_SHOW_ALL		(0x04)	/**< unchanged の計測ポイント、変化のないファイル・関数も表示 */
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-diff [options] old.dat new.dat\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -a           also show unchanged points, files and functions\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  -o outfile   output file (default: standard output)\n", stdout);
+  fputs("  -s           show the per-file and per-function summary only\n", stdout);
+  fputs("  exit status is 0 if no point is gained or lost, 1 if some are, 2 on error\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+/**
+ * 文字列を領域に複写する(足りなければ拡張する)
+ * @param char**      複写先の領域
+ * @param size_t*     複写先の領域のサイズ
+ * @param const char* 複写する文字列
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー
+ */
+int diff_copy (
+	char** buf,
+	size_t* size,
+	const char* str
+)
+{
+	/**/
+	size_t len = strlen( str ) + 1;
+	/**/
+	/* ILC: diff_copy開始 */
+
+	if ( len > *size ) {
+		/**/
+		char* ptr = (char*)realloc( *buf, len );
+		/**/
+		/* ILC: 領域を拡張する */
+		if ( ptr == NULL ) {
+			/* ILC: メモリ確保エラー */
+			return -1;
+		}
+		*buf = ptr;
+		*size = len;
+	}
+	memcpy( *buf, str, len );
+
+	/* ILC: diff_copy終了 */
+	return 0;
+}
+
+
+/**
+ * ILCカバレッジデータファイルが並べ替え済みかを、メモリに展開せずに確認する
+ * 計測ポイントが「ファイル名:関数名:行数」の順に並び、同じ計測ポイントが
+ * 複数ない場合を並べ替え済みとする。
+ * @param const char* ファイル名
+ * @param long*       形式が正しくない行数の格納先
+ * @return  1:並べ替え済み
+ *          0:並べ替えが必要
+ *         -1:読み込みエラー
+ */
+int diff_sorted (
+	const char* filename,
+	long* invalid
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT point;
+	ILC_DAT_POINT prev;
+	char* file = NULL;		/* 直前の計測ポイントのファイル名(次の読み込みで上書きされるため複製する) */
+	size_t file_size = 0;
+	char* func = NULL;		/* 直前の計測ポイントの関数名(同上) */
+	size_t func_size = 0;
+	int first = 1;
+	int ret = 1;
+	int rc;
+	/**/
+	/* ILC: diff_sorted開始 */
+
+	*invalid = 0;
+	reader = ILC_DatOpen( filename );
+	if ( reader == NULL ) {
+		/* ILC: ファイルオープンエラー */
+		return -1;
+	}
+
+	while ( ret == 1 && (rc = ILC_DatRead( reader, &point )) != 0 ) {
+		/* ILC: 計測ポイントごとに直前と比べる */
+		if ( rc < 0 ) {
+			/* ILC: 形式が正しくない行(読み込みエラーは最後に判定する) */
+			*invalid += ( reader->error == 0 );
+			continue;
+		}
+		if ( first == 0 && ILC_DatCompare( &prev, &point ) >= 0 ) {
+			/* ILC: 並びが逆、または同じ計測ポイントが続く */
+			ret = 0;
+		}
+		else if ( diff_copy( &file, &file_size, point.file ) != 0 || diff_copy( &func, &func_size, point.func ) != 0 ) {
+			/* ILC: 複製できないので、展開して並べ替える */
+			ret = 0;
+		}
+		else {
+			/* ILC: 次の比較のために残す */
+			prev = point;
+			prev.file = file;
+			prev.func = func;
+			first = 0;
+		}
+	}
+
+	if ( reader->error != 0 ) {
+		/* ILC: 読み込みエラー */
+		ret = -1;
+	}
+	ILC_DatClose( reader );
+	free( file );
+	free( func );
+
+	/* ILC: diff_sorted終了 */
+	return ret;
+}
+
+
+/**
+ * 入力を開く
+ * 並べ替え済みのファイルは先頭から読み進め、そうでなければ展開して並べ替える。
+ * @param DIFF_INPUT* 入力
+ * @param const char* ファイル名("-"の場合は標準入力)
+ * @return  0:正常終了
+ *         -1:読み込みエラー
+ */
+int diff_open (
+	DIFF_INPUT* input,
+	const char* filename
+)
+{
+	/**/
+	long invalid = 0;
+	int sorted = 0;
+	/**/
+	/* ILC: diff_open開始 */
+
+	memset( input, 0, sizeof(DIFF_INPUT) );
+	input->filename = filename;
+	input->used = 1;
+
+	if ( strcmp( filename, "-" ) != 0 ) {
+		/* ILC: 標準入力は2回読み込めないため、ファイルの場合だけ並びを確認する */
+		sorted = diff_sorted( filename, &invalid );
+	}
+
+	if ( sorted == 1 ) {
+		/* ILC: 並べ替え済みなので、先頭から読み進める */
+		input->reader = ILC_DatOpen( filename );
+		sorted = ( input->reader != NULL ) ? 1 : -1;
+	}
+	else if ( sorted == 0 ) {
+		/* ILC: 展開して並べ替える */
+		sorted = ( ILC_DatLoad( filename, &(input->table) ) == 0 ) ? 0 : -1;
+		invalid = input->table.invalid;
+		ILC_DatSort( &(input->table) );
+	}
+
+	if ( sorted < 0 ) {
+		/* ILC: 読み込みエラー */
+		fprintf( stderr, "%s: ファイルを読み込めません。\n", filename );
+		return -1;
+	}
+	if ( invalid > 0 ) {
+		/* ILC: 形式が正しくない行があった */
+		fprintf( stderr, "%s: 形式が正しくない%ld行を読み飛ばしました。\n", filename, invalid );
+	}
+
+	/* ILC: diff_open終了 */
+	return 0;
+}
+
+
+/**
+ * 入力を閉じる
+ * @param DIFF_INPUT* 入力
+ * @return  0:正常終了
+ *         -1:読み進める途中で読み込みエラーが発生した
+ */
+int diff_close (
+	DIFF_INPUT* input
+)
+{
+	/**/
+	int ret = 0;
+	/**/
+	/* ILC: diff_close開始 */
+
+	if ( input->reader != NULL && input->reader->error != 0 ) {
+		/* ILC: 読み込みエラー */
+		fprintf( stderr, "%s: ファイルを読み込めません。\n", input->filename );
+		ret = -1;
+	}
+	ILC_DatClose( input->reader );
+	input->reader = NULL;
+	ILC_DatFree( &(input->table) );
+
+	/* ILC: diff_close終了 */
+	return ret;
+}
+
+
+/**
+ * 入力の現在の計測ポイントを得る
+ * 前回の突き合わせに使った場合は、次の計測ポイントに読み進める。
+ * @param DIFF_INPUT* 入力
+ * @return 現在の計測ポイント(NULL:終わり)
+ */
+const ILC_DAT_POINT* diff_input_point (
+	DIFF_INPUT* input
+)
+{
+	/**/
+	int rc;
+	/**/
+	/* ILC: diff_input_point開始 */
+
+	if ( input->used != 0 ) {
+		/* ILC: 次の計測ポイントに読み進める */
+		input->used = 0;
+		if ( input->reader == NULL ) {
+			/* ILC: 展開した計測ポイント */
+			input->cur = ( input->ix < input->table.num ) ? &(input->table.point)[input->ix++] : NULL;
+		}
+		else {
+			/* ILC: 形式が正しくない行は読み飛ばす(diff_open で報告済み) */
+			while ( (rc = ILC_DatRead( input->reader, &(input->point) )) < 0 ) {
+				/* ILC: 次の行 */
+			}
+			input->cur = ( rc > 0 ) ? &(input->point) : NULL;
+		}
+	}
+
+	/* ILC: diff_input_point終了 */
+	return input->cur;
+}
+
+
+/**
+ * 次の計測ポイントを突き合わせる
+ * 突き合わせた計測ポイントは、次に diff_next を呼ぶまで有効。
+ * @param DIFF_CURSOR* 突き合わせの状態
+ * @param DIFF_PAIR*   突き合わせた計測ポイントの格納先
+ * @return 1:突き合わせた 0:旧・新とも終わり
+ */
+int diff_next (
+	DIFF_CURSOR* cur,
+	DIFF_PAIR* pair
+)
+{
+	/**/
+	int cmp;
+	/**/
+	/* ILC: diff_next開始 */
+
+	pair->old_point = diff_input_point( cur->old_data );
+	pair->new_point = diff_input_point( cur->new_data );
+	if ( pair->old_point == NULL && pair->new_point == NULL ) {
+		/* ILC: 旧・新とも終わり */
+		return 0;
+	}
+
+	if ( pair->old_point == NULL ) {
+		/* ILC: 旧が終わり */
+		cmp = 1;
+	}
+	else if ( pair->new_point == NULL ) {
+		/* ILC: 新が終わり */
+		cmp = -1;
+	}
+	else {
+		/* ILC: 小さい方を取り出す */
+		cmp = ILC_DatCompare( pair->old_point, pair->new_point );
+	}
+
+	if ( cmp < 0 ) {
+		/* ILC: 旧にのみある */
+		pair->new_point = NULL;
+		cur->old_data->used = 1;
+	}
+	else if ( cmp > 0 ) {
+		/* ILC: 新にのみある */
+		pair->old_point = NULL;
+		cur->new_data->used = 1;
+	}
+	else {
+		/* ILC: 旧・新にある */
+		cur->old_data->used = 1;
+		cur->new_data->used = 1;
+	}
+
+	pair->key = ( pair->old_point != NULL ) ? pair->old_point : pair->new_point;
+	pair->old_covered = ( pair->old_point != NULL && ILC_DAT_COVERED( pair->old_point ) );
+	pair->new_covered = ( pair->new_point != NULL && ILC_DAT_COVERED( pair->new_point ) );
+
+	/* ILC: diff_next終了 */
+	return 1;
+}
+
+
+/**
+ * 突き合わせた計測ポイントを集計に加える
+ * @param DIFF_COUNT*      集計
+ * @param const DIFF_PAIR* 突き合わせた計測ポイント
+ */
+void diff_count (
+	DIFF_COUNT* count,
+	const DIFF_PAIR* pair
+)
+{
+	/**/
+	/**/
+	/* ILC: diff_count開始 */
+
+	count->old_total += ( pair->old_point != NULL );
+	count->new_total += ( pair->new_point != NULL );
+	count->old_covered += pair->old_covered;
+	count->new_covered += pair->new_covered;
+	if ( pair->new_covered && !pair->old_covered ) {
+		/* ILC: gained */
+		count->gained++;
+	}
+	else if ( pair->old_covered && !pair->new_covered ) {
+		/* ILC: lost */
+		count->lost++;
+	}
+	else {
+		/* ILC: unchanged */
+		count->unchanged++;
+	}
+
+	/* ILC: diff_count終了 */
+}
+
+
+/**
+ * 集計を1行出力する
+ * 旧・新の計測ポイント数が同じで、gained / lost がない場合は、
+ * DIFF_SHOW_ALL の指定がなければ出力しない。
+ * @param FILE*             出力先
+ * @param const char*       行頭の字下げ
+ * @param const char*       ファイル名、または関数名
+ * @param const DIFF_COUNT* 集計
+ * @param int               DIFF_SHOW_xxx の論理和
+ */
+void diff_count_out (
+	FILE* fp,
+	const char* indent,
+	const char* name,
+	const DIFF_COUNT* count,
+	int show
+)
+{
+	/**/
+	char old_rate[64];
+	char new_rate[64];
+	char lost[64];
+	/**/
+	/* ILC: diff_count_out開始 */
+
+	if ( !( show & DIFF_SHOW_ALL ) && count->gained == 0 && count->lost == 0
+	     && count->old_total == count->new_total ) {
+		/* ILC: 変化なし */
+		return;
+	}
+
+	sprintf( old_rate, "%ld/%ld", count->old_covered, count->old_total );
+	sprintf( new_rate, "%ld/%ld", count->new_covered, count->new_total );
+	sprintf( lost, "-%ld", count->lost );
+	fprintf( fp, "%s%-*s %15s %15s %+9ld %9s %9ld\n",
+	         indent, (int)( 40 - strlen( indent ) ), name,
+	         old_rate, new_rate, count->gained, lost, count->unchanged );
+
+	/* ILC: diff_count_out終了 */
+}
+
+
+/**
+ * gained / lost の計測ポイントを出力する
+ * 行頭の記号は '+':gained '-':lost ' ':unchanged(DIFF_SHOW_ALL)
+ * @param FILE*            出力先
+ * @param const DIFF_PAIR* 突き合わせた計測ポイント
+ * @param int              DIFF_SHOW_xxx の論理和
+ */
+void diff_point_out (
+	FILE* fp,
+	const DIFF_PAIR* pair,
+	int show
+)
+{
+	/**/
+	char mark;
+	/**/
+	/* ILC: diff_point_out開始 */
+
+	if ( pair->new_covered && !pair->old_covered ) {
+		/* ILC: gained */
+		mark = '+';
+	}
+	else if ( pair->old_covered && !pair->new_covered ) {
+		/* ILC: lost */
+		mark = '-';
+	}
+	else if ( show & DIFF_SHOW_ALL ) {
+		/* ILC: unchanged */
+		mark = ' ';
+	}
+	else {
+		/* ILC: unchangedは表示しない */
+		return;
+	}
+	fprintf( fp, "%c %s:%s:%ld\n", mark, pair->key->file, pair->key->func, pair->key->line );
+
+	/* ILC: diff_point_out終了 */
+}
+
+
+/**
+ * 旧・新を1回だけ読み進めて、計測ポイントと、ファイルごと・関数ごとの集計を出力する
+ * 集計は計測ポイントの後に表示するため、別の出力先に書き出しておく。
+ * @param FILE*        計測ポイントの出力先
+ * @param FILE*        集計の出力先
+ * @param DIFF_CURSOR* 突き合わせの状態
+ * @param int          DIFF_SHOW_xxx の論理和
+ * @param DIFF_COUNT*  全体の集計の格納先
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー
+ */
+int diff_walk (
+	FILE* fp,
+	FILE* sum_fp,
+	DIFF_CURSOR* cur,
+	int show,
+	DIFF_COUNT* total
+)
+{
+	/**/
+	DIFF_PAIR pair;
+	DIFF_COUNT file_count;
+	DIFF_COUNT func_count;
+	DIFF_COUNT* funcs = NULL;	/* ファイル内の関数の集計(ファイルの行の後に出力する) */
+	char** names = NULL;		/* funcsの関数名(複製) */
+	long func_num = 0;
+	long capacity = 0;
+	char* file = NULL;			/* 集計中のファイル名(入力を読み進めると上書きされるため複製する) */
+	size_t file_size = 0;
+	char* func = NULL;			/* 集計中の関数名(同上) */
+	size_t func_size = 0;
+	int in_file = 0;			/* ファイルを集計中か */
+	int in_func = 0;			/* 関数を集計中か */
+	int more;
+	int ret = 0;
+	long ix;
+	/**/
+	/* ILC: diff_walk開始 */
+
+	memset( total, 0, sizeof(DIFF_COUNT) );
+	memset( &file_count, 0, sizeof(DIFF_COUNT) );
+	memset( &func_count, 0, sizeof(DIFF_COUNT) );
+
+	if ( show & DIFF_SHOW_SUMMARY ) {
+		/* ILC: 見出し */
+		fprintf( sum_fp, "%-40s %15s %15s %9s %9s %9s\n", "File / Function", "Old", "New", "Gained", "Lost", "Unchanged" );
+	}
+
+	do {
+		/* ILC: 計測ポイントごと(終わりの後にもう1回、最後の区切りを処理する) */
+		more = diff_next( cur, &pair );
+
+		if ( in_func && ( !more || !DIFF_SAME( pair.key->file, file ) || !DIFF_SAME( pair.key->func, func ) ) ) {
+			/* ILC: 関数の区切り */
+			if ( func_num == capacity ) {
+				/**/
+				DIFF_COUNT* ptr1;
+				char** ptr2;
+				/**/
+				/* ILC: 関数の集計の領域を倍々で拡張する */
+				capacity = ( capacity == 0 ) ? 64 : capacity * 2;
+				ptr1 = (DIFF_COUNT*)realloc( funcs, sizeof(DIFF_COUNT) * (size_t)capacity );
+				if ( ptr1 != NULL ) {
+					/* ILC: 拡張成功 */
+					funcs = ptr1;
+				}
+				ptr2 = (char**)realloc( names, sizeof(char*) * (size_t)capacity );
+				if ( ptr2 != NULL ) {
+					/* ILC: 拡張成功 */
+					names = ptr2;
+				}
+				if ( ptr1 == NULL || ptr2 == NULL ) {
+					/* ILC: 拡張失敗(関数ごとの集計は出力しない) */
+					capacity = func_num;
+				}
+			}
+			if ( func_num < capacity ) {
+				/**/
+				size_t size = 0;
+				/**/
+				/* ILC: 関数の集計を保存(関数名を複製できなければ出力しない) */
+				names[func_num] = NULL;
+				if ( diff_copy( &names[func_num], &size, func ) == 0 ) {
+					/* ILC: 複製成功 */
+					funcs[func_num++] = func_count;
+				}
+			}
+			memset( &func_count, 0, sizeof(DIFF_COUNT) );
+			in_func = 0;
+		}
+
+		if ( in_file && ( !more || !DIFF_SAME( pair.key->file, file ) ) ) {
+			/* ILC: ファイルの区切り */
+			if ( show & DIFF_SHOW_SUMMARY ) {
+				/* ILC: ファイルの集計、続けて関数の集計を出力 */
+				diff_count_out( sum_fp, "", file, &file_count, show );
+				for ( ix = 0; ix < func_num; ix++ ) {
+					/* ILC: 関数ごと */
+					diff_count_out( sum_fp, "  ", names[ix], &funcs[ix], show );
+				}
+			}
+			for ( ix = 0; ix < func_num; ix++ ) {
+				/* ILC: 関数名の複製を解放 */
+				free( names[ix] );
+			}
+			memset( &file_count, 0, sizeof(DIFF_COUNT) );
+			func_num = 0;
+			in_file = 0;
+		}
+
+		if ( more ) {
+			/* ILC: 計測ポイントを出力し、集計に加える */
+			if ( show & DIFF_SHOW_POINT ) {
+				/* ILC: 計測ポイント */
+				diff_point_out( fp, &pair, show );
+			}
+			if ( ( !in_file && diff_copy( &file, &file_size, pair.key->file ) != 0 )
+				 || ( !in_func && diff_copy( &func, &func_size, pair.key->func ) != 0 ) ) {
+				/* ILC: メモリ確保エラー */
+				ret = -1;
+				break;
+			}
+			in_file = 1;
+			in_func = 1;
+			diff_count( &func_count, &pair );
+			diff_count( &file_count, &pair );
+			diff_count( total, &pair );
+		}
+	} while ( more );
+
+	if ( ret == 0 && ( show & DIFF_SHOW_SUMMARY ) ) {
+		/* ILC: 全体の集計 */
+		diff_count_out( sum_fp, "", "Total", total, show | DIFF_SHOW_ALL );
+	}
+
+	for ( ix = 0; ix < func_num; ix++ ) {
+		/* ILC: 出力しなかった関数名の複製を解放 */
+		free( names[ix] );
+	}
+	free( funcs );
+	free( names );
+	free( file );
+	free( func );
+
+	/* ILC: diff_walk終了 */
+	return ret;
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	DIFF_INPUT old_data;
+	DIFF_INPUT new_data;
+	DIFF_CURSOR cur = { &old_data, &new_data };
+	DIFF_COUNT total;
+	const char* out_file = NULL;
+	FILE* out = NULL;
+	FILE* sum = NULL;		/* 集計の出力先(計測ポイントも出力する場合は一時ファイル) */
+	int show = DIFF_SHOW_POINT | DIFF_SHOW_SUMMARY;
+	int ret = 2;
+	int ch;
+	/**/
+	/* ILC: main開始 */
+
+	while ( (ch = getopt( argc, argv, "aho:s" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'a':
+			/* ILC: 変化のないものも表示 */
+			show |= DIFF_SHOW_ALL;
+			break;
+		case 'o':
+			/* ILC: 出力ファイル */
+			out_file = optarg;
+			break;
+		case 's':
+			/* ILC: 集計のみ */
+			show &= ~DIFF_SHOW_POINT;
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 2;
+		}
+	}
+	if ( argc - optind != 2 ) {
+		/* ILC: データファイルは2つ */
+		usage();
+		return 2;
+	}
+
+	memset( &old_data, 0, sizeof(DIFF_INPUT) );
+	memset( &new_data, 0, sizeof(DIFF_INPUT) );
+	if ( diff_open( &old_data, argv[optind] ) == 0 && diff_open( &new_data, argv[optind + 1] ) == 0 ) {
+		/* ILC: 開けたので突き合わせる */
+		out = ( out_file != NULL ) ? fopen( out_file, "w" ) : stdout;
+		if ( out == NULL ) {
+			/* ILC: ファイルオープンエラー */
+			fprintf( stderr, "%s: ファイルを開けません。\n", out_file );
+		}
+		else {
+			/* ILC: 計測ポイントを出力する場合、集計は後でまとめて出力する */
+			sum = ( show & DIFF_SHOW_POINT ) ? tmpfile() : out;
+			if ( sum == NULL ) {
+				/* ILC: 一時ファイルを作成できない */
+				fprintf( stderr, "一時ファイルを作成できません。\n" );
+			}
+		}
+	}
+
+	if ( sum != NULL ) {
+		/* ILC: 計測ポイント、集計の順に出力 */
+		setvbuf( out, NULL, _IOFBF, DIFF_BUFSIZ );
+		if ( diff_walk( out, sum, &cur, show, &total ) == 0 ) {
+			/* ILC: 差分があれば1 */
+			ret = ( total.gained == 0 && total.lost == 0 ) ? 0 : 1;
+		}
+		else {
+			/* ILC: メモリ確保エラー */
+			fprintf( stderr, "メモリ確保に失敗しました。\n" );
+		}
+
+		if ( sum != out ) {
+			/**/
+			char buf[BUFSIZ];
+			size_t n;
+			/**/
+			/* ILC: 集計との区切り、続けて集計を複写する */
+			fputs( "\n", out );
+			rewind( sum );
+			while ( (n = fread( buf, 1, sizeof(buf), sum )) > 0 ) {
+				/* ILC: 一時ファイルの終わりまで */
+				fwrite( buf, 1, n, out );
+			}
+			if ( ferror( sum ) ) {
+				/* ILC: 一時ファイルの読み込みエラー */
+				fprintf( stderr, "一時ファイルを読み込めません。\n" );
+				ret = 2;
+			}
+			fclose( sum );
+		}
+
+		if ( fflush( out ) != 0 || ferror( out ) ) {
+			/* ILC: 書き込みエラー */
+			fprintf( stderr, "%s: 書き込みに失敗しました。\n", ( out_file != NULL ) ? out_file : "stdout" );
+			ret = 2;
+		}
+	}
+	if ( out != NULL && out != stdout ) {
+		/* ILC: 出力ファイルを閉じる */
+		fclose( out );
+	}
+
+	if ( diff_close( &old_data ) != 0 ) {
+		/* ILC: 旧を読み進める途中で読み込みエラー */
+		ret = 2;
+	}
+	if ( diff_close( &new_data ) != 0 ) {
+		/* ILC: 新を読み進める途中で読み込みエラー */
+		ret = 2;
+	}
+
+	/* ILC: main終了 */
+	return ret;
+}
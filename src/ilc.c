@@ -37,8 +37,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <limits.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "ilc.h"
+#include "ilc_local.h"
+#include "ilc_inline.h"
 
 /** RCSID */
 static const char rcsid[] = "@(#) $Id: ilc.c,v 1.2 2008/05/25 13:22:49 shingo Exp $";
@@ -46,13 +57,128 @@ static const char rcsid[] = "@(#) $Id: ilc.c,v 1.2 2008/05/25 13:22:49 shingo Ex
 /* ILCカバレッジデータ */
 static ILC_DATA __ilc_data;
 
-/* デフォルトのファイル名 */
-#define ILC_FILE_DEFAULT "ilc.dat"
+/* スレッド別の記録領域(ILC_MODE_THREAD) */
+static __thread ILC_SHARD* __ilc_shard;
+
+/* 計測ポイント(ilc -n)を記録済みとする世代。0は未記録の site と区別するため使わない */
+unsigned long __ilc_epoch = 1;
+
+/* 通過回数の標本化: 次に数えるまでの残り回数(スレッドごと) */
+static __thread long __ilc_sample_left;
+
+/* 通過回数の標本化: 間隔の乱数の状態(スレッドごと、0は未初期化) */
+static __thread unsigned long __ilc_sample_seed;
+
+/* 作成済みのスレッド別記録領域のリスト */
+static ILC_SHARD* __ilc_shard_list;
+
+/* 通過回数を数えている計測ポイント(ilc -n)のリスト */
+static ILC_SITE* __ilc_site_list;
+
+/* __ilc_shard_list・__ilc_site_list の排他 */
+static pthread_mutex_t __ilc_shard_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* スレッド終了時にスレッド別記録領域を集計・解放するためのキー */
+static pthread_key_t __ilc_shard_key;
+
+/* __ilc_shard_key の作成(1回だけ行う) */
+static pthread_once_t __ilc_shard_once = PTHREAD_ONCE_INIT;
+
+/* __ilc_shard_key を作成できたか */
+static int __ilc_shard_keyed;
+
+/* 前回異常終了時の通過回数ファイルを読み込んだか(ILC_Finalizeでの書き直しが必要) */
+static int __ilc_recovered;
+
+/* __ilc_data の書き出し・クリアの排他(ILC_Snapshot、ILC_Reset、ILC_Finalize) */
+static pthread_mutex_t __ilc_data_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* ILC_MODE_SIGNAL: シグナルハンドラからスナップショット書き出しスレッドへの通知 */
+static sem_t __ilc_writer_sem;
+
+/* ILC_MODE_SIGNAL: スナップショット書き出しスレッド */
+static pthread_t __ilc_writer;
+
+/* ILC_MODE_SIGNAL: 書き出しスレッドが動作中か */
+static int __ilc_writer_running;
+
+/* ILC_MODE_SIGNAL: 書き出しスレッドの終了要求(__atomic_xxxで読み書きする) */
+static int __ilc_writer_stop;
+
+/* ILC_MODE_SIGNAL: 変更前のシグナルハンドラ */
+static struct sigaction __ilc_writer_oldact;
+
+/* 自動初期化(コンストラクタ)で初期化したか */
+static int __ilc_auto;
+
+/* 終了時の書き出し(atexit)を登録済みか */
+static int __ilc_atexit_registered;
+
+/* 異常終了時に書き出すシグナル(0で終わり) */
+static const int __ilc_crash_signals[] = {
+	SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM, SIGINT, SIGHUP, SIGQUIT, 0
+};
+
+/* 異常終了時の書き出し用ハンドラを設定したか(__ilc_crash_signalsと同じ添字) */
+static int __ilc_crash_installed[ sizeof(__ilc_crash_signals) / sizeof(int) ];
+
+/* 異常終了時の書き出し中か(__atomic_xxxで読み書きする) */
+static int __ilc_crash_running;
+
+/* 異常終了時の一時ファイル名(シグナルハンドラで確保しないよう、事前に作成する) */
+static char* __ilc_crash_tmp;
+
+/* 異常終了時の書き出しバッファ */
+static char __ilc_crash_buf[ILC_CRASH_BUFSIZ];
+
+/* __ilc_crash_buf に溜まっているバイト数 */
+static size_t __ilc_crash_len;
+
+/* fork 時の処理(pthread_atfork)を登録済みか */
+static int __ilc_fork_registered;
+
+/* fork で作成された子プロセスか(子プロセスのファイルを集計しない) */
+static int __ilc_fork_child;
+
+/* 子プロセスが親と共有するマップに記録しているか(ファイルは書き出さない) */
+static int __ilc_fork_shared;
+
+/* 子プロセスのファイル名の接頭辞(ファイル名.識別子)。識別子は ILC_Initialize ごとに作成する */
+static char* __ilc_fork_prefix;
+
+/* 子プロセスのファイル名(ファイル名.識別子.プロセスID) */
+static char* __ilc_fork_file;
+
+/* fork の直前に確保する、子プロセスのファイル名の領域(子プロセスのハンドラで確保しないため) */
+static char* __ilc_fork_next;
+
+/* fork の直前に確保する、子プロセスの異常終了時の一時ファイル名の領域 */
+static char* __ilc_fork_next_tmp;
+
+/* 子プロセスのハンドラで置き換えた領域(ハンドラでは解放せず、ILC_Finalize で解放する) */
+static char* __ilc_fork_stale[2];
+
+/* ILC_MODE_SHM: 作成した共有メモリの名前 */
+static char* __ilc_shm_name;
+
+/* ilc -r で変換したソースの計測ポイント(リンカが作成する。セクションがなければNULL) */
+extern ILC_POINT __start_ilc_points[] __attribute__((weak));
+extern ILC_POINT __stop_ilc_points[] __attribute__((weak));
+
+/* 変換ツールなど、自動初期化しないプログラムが定義する(未定義ならNULL) */
+extern const int __ilc_no_auto __attribute__((weak));
 
 /* ILCカバレッジデータファイルの構造 */
 /* フラグ:ファイル名:関数名:行数     */
 #define ILC_COVERAGE_DATA "%d:%s:%s:%d\n"
 
+/* 通過回数を持つ場合は5番目の項目 */
+/* フラグ:ファイル名:関数名:行数:回数 */
+#define ILC_COVERAGE_COUNT "%d:%s:%s:%d:%llu\n"
+
+/* ハッシュ表の最小サイズ(2のべき乗であること) */
+#define ILC_INDEX_MIN (64)
+
 /*
  *
  * static functions
@@ -69,36 +195,485 @@ static ILC_DATA __ilc_data;
 static ILC_ERROR ilc_fopen ( const char*, ILC_DATA* );
 
 /**
- * 1行読み込み、ILCカバレッジデータをメモリに展開する
- * @param FILE*     ファイルポインタ
+ * ファイルの内容をすべて読み込む
+ * @param FILE*   ファイルポインタ
+ * @param size_t* 読み込んだバイト数
+ * @return 読み込んだ内容(NULL終端)。mallocで確保するため、不要になったらfreeすること。
+ *         NULL:メモリ確保エラー、または読み込みエラー
+ */
+static char* ilc_fread ( FILE*, size_t* );
+
+/**
+ * 読み込んだファイルの内容を行に分割し、ILCカバレッジデータに展開する
+ * 改行文字(CR/LF/CRLF)を'\0'に置き換え、各行を計測ポイントとして登録する。
+ * 通過回数の項目は count に、ILC_MODE_MMAP の場合はフラグの位置を offset に設定する。
+ * 内容のバッファは展開後に解放する。
+ * @param char*     ファイルの内容(NULL終端)
+ * @param size_t    ファイルの内容のバイト数
  * @param ILC_DATA* ILCカバレッジデータ
  * @return ILC_SUCCESS:正常終了
  *         ILC_FAILURE:メモリ展開失敗
  */
-static ILC_ERROR ilc_deploy ( FILE*, ILC_DATA* );
+static ILC_ERROR ilc_deploy ( char*, size_t, ILC_DATA* );
 
 /**
- * ファイルより１行(最大LONG_MAX文字)読み込む
- * mallocでメモリを確保するため、文字列を使用しなくなった場合はfreeをすること。
- * @param FILE* ファイルポインタ
- * @param size_t* 読み込んだ文字列の長さ
- * @return 読み込んだ文字列。改行文字(CR/LF)を含まないNULL終端文字列。
+ * 計測ポイントの各配列を指定した数以上に拡張する
+ * 拡張した部分の通過フラグは0で初期化する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      必要なデータ数
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
  */
-static char* __fgetln ( FILE*, size_t* );
+static ILC_ERROR ilc_reserve ( ILC_DATA*, long );
 
 /**
  * ファイルに１行書き出す
- * @param FILE*       ファイルポインタ
- * @param const char* 書き出す文字列
+ * @param FILE*           ファイルポインタ
+ * @param const ILC_DATA* ILCカバレッジデータ
+ * @param long            書き出す計測ポイントのID
+ * @param int             通過フラグ(0:未通過 1:通過)
+ * @param const unsigned long long* 通過回数(NULLの場合は書き出さない)
+ */
+static void ilc_fout( FILE*, const ILC_DATA*, long, int, const unsigned long long* );
+
+/**
+ * すべての計測ポイントをファイルに書き出す
+ * 通過回数が1以上の計測ポイントは通過済みとして書き出す。
+ * @param FILE*                     ファイルポインタ
+ * @param const ILC_DATA*           ILCカバレッジデータ
+ * @param const char*               通過フラグ(num個)
+ * @param const unsigned long long* 通過回数(flag_num個)
+ */
+static void ilc_write( FILE*, const ILC_DATA*, const char*, const unsigned long long* );
+
+/**
+ * すべての計測ポイントを一時ファイルに書き出し、指定したファイル名に置き換える
+ * 書き出しに失敗した場合、指定したファイルは変更しない。
+ * @param const ILC_DATA*           ILCカバレッジデータ
+ * @param const char*               ILCカバレッジデータファイル名
+ * @param const char*               通過フラグ(num個)
+ * @param const unsigned long long* 通過回数(flag_num個)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :ファイル書き出し失敗
+ */
+static ILC_ERROR ilc_save( const ILC_DATA*, const char*, const char*, const unsigned long long* );
+
+/**
+ * ILCカバレッジデータの領域をすべて解放する
+ * 動作モード、ファイル名、世代はそのまま残す。
+ * @param ILC_DATA* ILCカバレッジデータ
+ */
+static void ilc_free( ILC_DATA* );
+
+/**
+ * 「ファイル名:関数名:行数」を分解する
+ * @param const char* ファイル名:関数名:行数(後ろに ":回数" があってもよい)
+ * @param ILC_KEY*    分解結果
+ * @return  0:正常終了
+ *         -1:行数が数字でない
+ */
+static int ilc_key_parse( const char*, ILC_KEY* );
+
+/**
+ * 「フラグ:ファイル名:関数名:行数」を分解し、計測ポイントとして末尾に追加する
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* フラグ:ファイル名:関数名:行数
+ * @param ILC_KEY*    分解結果(行数の後ろの通過回数を取り出すために使用する)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_point_add( ILC_DATA*, const char*, ILC_KEY* );
+
+/**
+ * ファイル名・関数名のIDと行数を、計測ポイントとして末尾に追加する
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      ファイル名のID
+ * @param long      関数名のID
+ * @param int       行数
+ * @param int       通過フラグ(0:未通過 1:通過)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_point_insert( ILC_DATA*, long, long, int, int );
+
+/**
+ * 実行ファイルの ilc_points セクション(ilc -r)の計測ポイントを登録する
+ * 未登録の計測ポイントは末尾に追加し、各計測ポイントの記録状態にIDを設定する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_registry_add( ILC_DATA* );
+
+/**
+ * 計測ポイントをファイル名・関数名のIDと行数で検索する
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      ファイル名のID
+ * @param long      関数名のID
+ * @param int       行数
+ * @return 計測ポイントのID
+ *         -1:見つからない
+ */
+static long ilc_point_search( ILC_DATA*, long, long, int );
+
+/**
+ * 文字列表からファイル名・関数名を検索する
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 検索する文字列(NULL終端していなくてよい)
+ * @param size_t      検索する文字列の長さ
+ * @return 文字列のID(nameの添字)
+ *         -1:見つからない
+ */
+static long ilc_name_search( ILC_DATA*, const char*, size_t );
+
+/**
+ * 文字列表にファイル名・関数名を登録する
+ * 登録済みの場合は、そのIDを返す。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 登録する文字列(NULL終端していなくてよい)
+ * @param size_t      登録する文字列の長さ
+ * @return 文字列のID(nameの添字)
+ *         -1:メモリ確保エラー
+ */
+static long ilc_name_intern( ILC_DATA*, const char*, size_t );
+
+/**
+ * 文字列表の検索用ハッシュ表を作り直す
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      登録予定の文字列の数(この倍以上のサイズで作成する)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー(元のハッシュ表はそのまま残る)
+ */
+static ILC_ERROR ilc_name_index_build( ILC_DATA*, long );
+
+/**
+ * 呼び出したスレッドの記録領域を作成し、リストに登録する
+ * @return ILC_SHARD* 作成した記録領域
+ *                    NULL: 作成に失敗
+ */
+static ILC_SHARD* ilc_shard_create( );
+
+/**
+ * スレッド終了時にスレッド別の記録領域を集計・解放するキーを作成する(pthread_once)
+ */
+static void ilc_shard_key_create( );
+
+/**
+ * スレッド終了時に、スレッド別の記録領域をILCカバレッジデータに集計して解放する
+ * @param void* スレッド別の記録領域(ILC_SHARD*)
+ */
+static void ilc_shard_destroy( void* );
+
+/**
+ * スレッド別の記録領域をリストから外す(__ilc_shard_lock を取得して呼び出すこと)
+ * @param ILC_SHARD* 外す記録領域
+ */
+static void ilc_shard_unlink( ILC_SHARD* );
+
+/**
+ * 1つのスレッド別記録領域の未集計分をILCカバレッジデータに集計する
+ * (__ilc_shard_lock を取得して呼び出すこと)
+ * @param ILC_DATA*  ILCカバレッジデータ
+ * @param ILC_SHARD* スレッド別の記録領域
+ */
+static void ilc_shard_fold( ILC_DATA*, ILC_SHARD* );
+
+/**
+ * スレッド別の記録領域をILCカバレッジデータに集計する
+ * 集計した通過回数は集計済み(base)にする。
+ * @param ILC_DATA* ILCカバレッジデータ
+ */
+static void ilc_shard_merge( ILC_DATA* );
+
+/**
+ * スレッド別の記録領域を、指定した通過フラグと通過回数に加える
+ * ilc_shard_mergeと異なり、記録領域はそのまま残す(計測を止めずに集計できる)。
+ * @param ILC_DATA*           ILCカバレッジデータ
+ * @param char*               通過フラグ(flag_num個以上)
+ * @param unsigned long long* 通過回数(flag_num個以上)
+ */
+static void ilc_shard_collect( ILC_DATA*, char*, unsigned long long* );
+
+/**
+ * スレッド別の記録領域の通過フラグ・通過回数をクリアする
+ * 通過回数は集計済み(base)にすることでクリアする。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param int       ILC_RESET_xxx の論理和
+ */
+static void ilc_shard_reset( ILC_DATA*, int );
+
+/**
+ * 計測ポイント(ilc -n)ごとに数えた通過回数を集計する
+ * @param ILC_DATA*           ILCカバレッジデータ
+ * @param unsigned long long* 集計先の通過回数
+ * @param int                 0以外:集計した通過回数を0にする
+ */
+static void ilc_site_collect( ILC_DATA*, unsigned long long*, int );
+
+/**
+ * 計測ポイント(ilc -n)の記録済みの状態・通過回数をクリアする
+ * @param int ILC_RESET_xxx の論理和
+ */
+static void ilc_site_reset( int );
+
+/**
+ * 通過回数の標本化(ILC_SetSampling)で、今回の通過で加算する回数を求める
+ * スレッドごとのカウントダウンが0になったときだけ間隔分を加算し、
+ * 次の間隔を 1〜2N-1 の乱数で決める(平均 N)。
+ * @param int 0以外:初回通過(標本化せずに1を加算する)
+ * @return 加算する回数(0:今回は数えない)
  */
-static void ilc_fout( FILE*, const char* );
+static unsigned long long ilc_sample( int );
 
 /**
- * ilc_foutの何もしない版
- * @param FILE*
- * @param const char*
+ * スナップショットを要求するシグナルのハンドラ(ILC_MODE_SIGNAL)
+ * 書き出しスレッドに通知するだけで、ファイルの書き出しは行わない。
+ * @param int シグナル番号
  */
-static void ilc_fout_null( FILE*, const char* );
+static void ilc_writer_signal( int );
+
+/**
+ * 環境変数 ILC_MODE の値を動作モードに変換する
+ * 数値、または "count,thread" のように名前をカンマ区切りで指定する。
+ * @param const char* 環境変数の値(NULL可)
+ * @return ILC_MODE_xxx の論理和
+ */
+static int ilc_mode_parse( const char* );
+
+/**
+ * プログラム開始時に、環境変数の設定でILCカバレッジデータを展開する
+ * __ilc_no_auto が定義されている場合は何もしない。
+ */
+static void ilc_auto_init( ) __attribute__((constructor));
+
+/**
+ * プログラム終了時(exit、mainからのreturn)に、ILCカバレッジデータを書き出す
+ * ILC_Finalize が呼ばれていれば何もしない。
+ */
+static void ilc_atexit( );
+
+/**
+ * ILCカバレッジデータを書き出さずに終了する(プログラム終了時のみ)
+ * 書き出しスレッドと異常終了時のハンドラも元に戻す。
+ * 他のスレッドが計測を続けている可能性があるため、メモリは解放しない。
+ */
+static void ilc_discard( );
+
+/**
+ * メモリのILCカバレッジデータをファイルに書き込む(ILC_Finalize の本体)
+ * @param int 0以外:メモリを解放し、マップを解除する
+ *            0    :書き出すだけで、メモリとマップはそのまま残す(atexit から呼ぶ場合)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :ファイル書き出し失敗
+ */
+static ILC_ERROR ilc_finalize( int );
+
+/**
+ * ILCカバレッジデータのメモリを解放し、マップを解除する
+ */
+static void ilc_release( );
+
+/**
+ * 異常終了時の書き出し用ハンドラを設定する
+ * ハンドラが設定されていない(SIG_DFL)シグナルのみ対象とする。
+ */
+static void ilc_crash_install( );
+
+/**
+ * 異常終了時の書き出し用ハンドラを元に戻す
+ */
+static void ilc_crash_uninstall( );
+
+/**
+ * 異常終了時のシグナルハンドラ
+ * 計測結果を書き出してから、シグナル本来の動作(SIG_DFL)で終了する。
+ * @param int シグナル番号
+ */
+static void ilc_crash_signal( int );
+
+/**
+ * 異常終了時に計測結果を書き出す
+ * シグナルハンドラから呼ぶため、メモリ確保・stdio・ロックは使用せず、
+ * 事前に確保した一時ファイル名とバッファだけで書き出す。
+ */
+static void ilc_crash_flush( );
+
+/**
+ * 異常終了時の書き出しバッファに文字列を追加する
+ * バッファが一杯になったら書き出す。
+ * @param int         ファイルディスクリプタ
+ * @param const char* 文字列
+ * @param size_t      文字列の長さ
+ */
+static void ilc_crash_put( int, const char*, size_t );
+
+/**
+ * 異常終了時の書き出しバッファを書き出す
+ * @param int ファイルディスクリプタ
+ * @param int 0以外:すべて書き出す 0:バッファが一杯の場合のみ書き出す
+ * @return 0:成功 -1:書き出しエラー
+ */
+static int ilc_crash_drain( int, int );
+
+/**
+ * 異常終了時の書き出しバッファに数値を追加する
+ * @param int                ファイルディスクリプタ
+ * @param unsigned long long 数値(の絶対値)
+ * @param int                0以外:負数として '-' をつける
+ */
+static void ilc_crash_putnum( int, unsigned long long, int );
+
+/**
+ * 子プロセスのファイル名の接頭辞(ファイル名.識別子)を作成する
+ * 識別子は「プロセスID-時刻-世代」とし、以前の実行や同じファイルを使う
+ * 他のプロセスが残したファイルと区別する。
+ * @param const char* ILCカバレッジデータファイル名
+ * @return 接頭辞。mallocで確保するため、不要になったらfreeすること。
+ *         NULL:メモリ確保エラー
+ */
+static char* ilc_fork_prefix( const char* );
+
+/**
+ * 文字列・プロセスID・接尾辞をつなげた名前を作成する
+ * fork 直後の子プロセスで使用するため、メモリの確保や stdio は使わない。
+ * @param char*       作成先(十分な大きさを確保しておくこと)
+ * @param const char* 先頭の文字列
+ * @param long        プロセスID("." の後ろにつける)
+ * @param const char* 接尾辞
+ */
+static void ilc_fork_name( char*, const char*, long, const char* );
+
+/**
+ * fork の直前(親プロセス)に、ILCカバレッジデータの排他を取得する
+ * 子プロセスに書き出し途中・集計途中の状態を引き継がないようにする。
+ * 子プロセスで使うファイル名の領域もここで確保する。
+ */
+static void ilc_fork_prepare( );
+
+/**
+ * fork の直後(親プロセス)に、ILCカバレッジデータの排他を解放する
+ */
+static void ilc_fork_parent( );
+
+/**
+ * fork の直後(子プロセス)に、子プロセス用の計測に切り替える
+ * ILC_MODE_MMAP でマップ済みの場合は、親と同じマップに記録を続ける。
+ * それ以外は、fork 以降の通過だけを「ファイル名.識別子.プロセスID」に書き出すよう、
+ * 親から引き継いだ計測結果をクリアする。
+ */
+static void ilc_fork_child( );
+
+/**
+ * 子プロセスが書き出したファイル(ファイル名.識別子.プロセスID)を集計する
+ * 識別子が今回の ILC_Initialize のものと一致するファイルだけを対象とする。
+ * 通過フラグは論理和、通過回数は加算する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return 集計したファイル名のリスト(NULL終端)。書き出し後に削除し、freeすること。
+ *         NULL:子プロセスのファイルがない、またはメモリ確保エラー
+ */
+static char** ilc_fork_collect( ILC_DATA* );
+
+/**
+ * スナップショットの書き出しスレッド(ILC_MODE_SIGNAL)
+ * シグナルハンドラから通知されるたびに ILC_Snapshot を呼び出す。
+ * @param void* 未使用
+ * @return NULL
+ */
+static void* ilc_writer_main( void* );
+
+/**
+ * スナップショットの書き出しスレッドを開始し、シグナルハンドラを設定する
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :開始できなかった(シグナルでのスナップショットは行わない)
+ */
+static ILC_ERROR ilc_writer_start( );
+
+/**
+ * スナップショットの書き出しスレッドを終了し、シグナルハンドラを元に戻す
+ */
+static void ilc_writer_stop( );
+
+/**
+ * 文字列のハッシュ値を求める(FNV-1a)
+ * @param const char* 文字列
+ * @param size_t      文字列の長さ
+ * @return ハッシュ値
+ */
+static unsigned long ilc_hash( const char*, size_t );
+
+/**
+ * 計測ポイントのハッシュ値を求める
+ * @param int ファイル名のID
+ * @param int 関数名のID
+ * @param int 行数
+ * @return ハッシュ値
+ */
+static unsigned long ilc_hash_point( int, int, int );
+
+/**
+ * ILCカバレッジデータの検索用ハッシュ表を作り直す
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      登録予定のデータ数(この倍以上のサイズで作成する)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー(ハッシュ表は作成されない)
+ */
+static ILC_ERROR ilc_index_build( ILC_DATA*, long );
+
+/**
+ * ハッシュ表に計測ポイントを登録する
+ * ハッシュ表には十分な空きがあること。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      登録する計測ポイントのID
+ */
+static void ilc_index_insert( ILC_DATA*, long );
+
+/**
+ * 通過回数ファイル名を作成する
+ * @param const char* ILCカバレッジデータファイル名
+ * @return 通過回数ファイル名。mallocで確保するため、不要になったらfreeすること。
+ *         NULL:メモリ確保エラー
+ */
+static char* ilc_count_path( const char* );
+
+/**
+ * 前回の実行で残った通過回数ファイル(ILC_MODE_MMAP)を読み込む
+ * 計測ポイントの数が一致する場合のみ、countに反映する。
+ * @param ILC_DATA* ILCカバレッジデータ(countは作成済みであること)
+ * @return 1:読み込んだ 0:ファイルなし、または対象外
+ */
+static int ilc_count_recover( ILC_DATA* );
+
+/**
+ * ILCカバレッジデータファイル(と通過回数ファイル)をマップする
+ * @param ILC_DATA* ILCカバレッジデータ(ILC_Initializeで展開済みであること)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :マップできなかった(通常の動作で続行可能)
+ */
+static ILC_ERROR ilc_map( ILC_DATA* );
+
+/**
+ * マップしたファイル・共有メモリ上の通過フラグを、指定した通過フラグに加える
+ * fork した子プロセスは、親と共有するマップにのみ通過フラグを書き込むため。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param char*     通過フラグ(flag_num個以上)
+ */
+static void ilc_map_collect( ILC_DATA*, char* );
+
+/**
+ * 計測ポイントを名前つきの共有メモリに置く(ILC_MODE_SHM)
+ * バイナリ形式のILCカバレッジデータファイルと同じ列の並びで作成し、
+ * 以後は __ilc_check が共有メモリ上のフラグ・通過回数を更新する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return ILC_SUCCESS:作成成功
+ *         ILC_WARN   :作成できない(共有メモリなしで計測を続ける)
+ */
+static ILC_ERROR ilc_shm_open( ILC_DATA* );
+
+/**
+ * 共有メモリ(ILC_MODE_SHM)の名前を削除する
+ * マップは ilc_free で解除する。fork した子プロセスは削除しない。
+ */
+static void ilc_shm_unlink( );
 
 
 
@@ -118,6 +693,8 @@ static ILC_ERROR ilc_fopen (
 	/**/
 	ILC_ERROR ret = ILC_FAILURE;
 	FILE* fp;
+	char* buf;
+	size_t len;
 	/**/
 	/* ILC: ilc_fopen開始 */
 
@@ -125,9 +702,13 @@ static ILC_ERROR ilc_fopen (
 		/* ILC: ファイル指定あり */
 		fp = fopen( ilc_file, "r" );
 		if ( fp != NULL ) {
-			/* ILC: ファイルの中身をメモリに展開する */
-			ret = ilc_deploy( fp, ilc_data );
+			/* ILC: ファイルの中身を一括で読み込み、メモリに展開する */
+			buf = ilc_fread( fp, &len );
 			fclose( fp );
+			if ( buf != NULL ) {
+				/* ILC: 読み込み成功 */
+				ret = ilc_deploy( buf, len, ilc_data );
+			}
 		}
 		else {
 			/* ILC: ファイルオープンエラー */
@@ -141,268 +722,3117 @@ static ILC_ERROR ilc_fopen (
 
 
 /**
- * 1行読み込み、ILCカバレッジデータをメモリに展開する
- * @param FILE*     ファイルポインタ
- * @param ILC_DATA* ILCカバレッジデータ
- * @return ILC_SUCCESS:正常終了
- *         ILC_FAILURE:メモリ展開失敗
+ * ファイルの内容をすべて読み込む
+ * @param FILE*   ファイルポインタ
+ * @param size_t* 読み込んだバイト数
+ * @return 読み込んだ内容(NULL終端)。mallocで確保するため、不要になったらfreeすること。
+ *         NULL:メモリ確保エラー、または読み込みエラー
  */
-static ILC_ERROR ilc_deploy (
+static char* ilc_fread (
 	FILE* fp,
-	ILC_DATA* ilc_data
+	size_t* len		/* OUT */
 )
 {
 	/**/
-	char* str;						/* ファイルより取得した1行 */
-	size_t len;						/* 1行の長さ(未使用) */
-	ILC_ERROR ret = ILC_SUCCESS;
+	struct stat st;
+	size_t size = 64 * 1024;	/* バッファの初期値:64KB */
+	size_t cnt = 0;
+	char* buf;
 	/**/
-	/* ILC: ilc_deploy開始 */
+	/* ILC: ilc_fread開始 */
+
+	if ( fstat( fileno( fp ), &st ) == 0 && S_ISREG( st.st_mode ) ) {
+		/* ILC: 通常ファイルはサイズがわかるので、1回で読み込めるように確保 */
+		/* (EOFを短い読み込みで検出できるよう、NULL終端分+1バイト多く確保する) */
+		size = (size_t)st.st_size + 2;
+	}
+
+	buf = (char*)malloc( size );
+	while ( buf != NULL ) {
+		/* ILC: EOFまで大きなブロック単位で読み込む */
+		cnt += fread( buf + cnt, 1, size - cnt - 1, fp );
+		if ( cnt < size - 1 ) {
+			/* ILC: EOF、または読み込みエラー */
+			if ( ferror( fp ) ) {
+				/* ILC: 読み込みエラー */
+				free( buf );
+				buf = NULL;
+			}
+			break;
+		}
+		else {
+			/**/
+			char* ptr;
+			/**/
+			/* ILC: バッファが一杯なので拡大して読み込みを続ける */
+			size *= 2;
+			ptr = (char*)realloc( buf, size );
+			if ( ptr == NULL ) {
+				/* ILC: メモリが確保できない場合はNULLを返す */
+				free( buf );
+			}
+			buf = ptr;
+		}
+	}
+
+	if ( buf != NULL ) {
+		/* ILC: NULL終端して、長さを設定して終了 */
+		buf[cnt] = '\0';
+		*len = cnt;
+	}
+
+	/* ILC: ilc_fread終了 */
+	return buf;
+}
+
+
+/**
+ * 読み込んだファイルの内容を行に分割し、ILCカバレッジデータに展開する
+ * 改行文字(CR/LF/CRLF)を'\0'に置き換え、各行を計測ポイントとして登録する。
+ * 通過回数の項目は count に、ILC_MODE_MMAP の場合はフラグの位置を offset に設定する。
+ * 内容のバッファは展開後に解放する。
+ * @param char*     ファイルの内容(NULL終端)
+ * @param size_t    ファイルの内容のバイト数
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ展開失敗
+ */
+static ILC_ERROR ilc_deploy (
+	char* buf,
+	size_t len,
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	char* end = buf + len;
+	char* str;						/* 1行の先頭 */
+	char* ptr;
+	long lines = 0;					/* 行数(領域の事前確保用) */
+	unsigned long long* count;
+	ILC_KEY key;
+	ILC_ERROR ret = ILC_SUCCESS;
+	/**/
+	/* ILC: ilc_deploy開始 */
+
+	for ( ptr = buf; (ptr = memchr( ptr, '\n', (size_t)(end - ptr) )) != NULL; ptr++ ) {
+		/* ILC: 行数を数える */
+		lines++;
+	}
+
+	/* 通過回数とフラグの位置はファイルの行と同じ数だけあればよい */
+	/* 展開済みの計測ポイントがある場合は、その通過回数を残して拡張する */
+	count = (unsigned long long*)realloc( ilc_data->count, sizeof(unsigned long long) * (size_t)(ilc_data->num + lines + 1) );
+	if ( count != NULL ) {
+		/* ILC: 拡張した部分の通過回数は0 */
+		memset( count + ilc_data->num, 0, sizeof(unsigned long long) * (size_t)(lines + 1) );
+		ilc_data->count = count;
+	}
+	if ( (ilc_data->mode & ILC_MODE_MMAP) != 0 && ilc_data->num == 0 ) {
+		/* ILC: マップしたファイルに書き込むため、フラグの位置を記録する */
+		/* 確保できなくてもマップしないだけなので、エラーにはしない */
+		/* (展開済みの計測ポイントがある場合は、ファイルの位置と一致しないためマップしない) */
+		free( ilc_data->offset );
+		ilc_data->offset = (size_t*)malloc( sizeof(size_t) * (size_t)(ilc_data->num + lines + 1) );
+	}
+	else {
+		/* ILC: マップしない */
+		free( ilc_data->offset );
+		ilc_data->offset = NULL;
+	}
+
+	if ( count == NULL || ilc_reserve( ilc_data, ilc_data->num + lines + 1 ) == ILC_FAILURE ) {
+		/* ILC: 領域の確保に失敗 */
+		ret = ILC_FAILURE;
+	}
+
+	for ( str = buf; ret == ILC_SUCCESS && str < end; str = ptr + 1 ) {
+		/* ILC: 1行ずつ切り出して登録する */
+		for ( ptr = str; ptr < end && *ptr != '\n' && *ptr != '\r'; ptr++ ) {
+			/* 改行文字まで進める */
+		}
+		if ( ptr + 1 < end && ptr[0] == '\r' && ptr[1] == '\n' ) {
+			/* ILC: CRLFは2文字で1つの改行 */
+			*ptr++ = '\0';
+		}
+		*ptr = '\0';
+
+		if ( ptr != str ) {
+			/* ILC: ILCカバレッジデータへの追加 */
+			/* len == 0 は改行のみの行（e.g. 行末）なので読み飛ばす */
+			ret = ilc_point_add( ilc_data, str, &key );
+			if ( ret == ILC_SUCCESS && key.rest[0] == ':' ) {
+				/* ILC: 通過回数の項目あり */
+				(ilc_data->count)[ilc_data->num - 1] = strtoull( key.rest + 1, NULL, 10 );
+			}
+			if ( ret == ILC_SUCCESS && ilc_data->offset != NULL ) {
+				/* ILC: 行の先頭がフラグなので、バッファ内の位置がファイル上の位置になる */
+				(ilc_data->offset)[ilc_data->num - 1] = (size_t)(str - buf);
+			}
+		}
+	}
+
+	/* 行の内容は展開済みなので、バッファは不要 */
+	free( buf );
+
+	if ( ret == ILC_SUCCESS ) {
+		/* ILC: ILC_MODE_MMAPでファイルが変更されていないかの確認用 */
+		ilc_data->file_size = len;
+	}
+	else {
+		/* ILC: ILCカバレッジデータへのデータ追加に失敗 */
+		ilc_free( ilc_data );
+	}
+
+	/* ILC: ilc_deploy終了 */
+	return ret;
+}
+
+
+/**
+ * 計測ポイントの各配列を指定した数以上に拡張する
+ * 拡張した部分の通過フラグは0で初期化する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      必要なデータ数
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_reserve (
+	ILC_DATA* ilc_data,
+	long num
+)
+{
+	/**/
+	long capacity = ilc_data->capacity;
+	int* file_id;
+	int* func_id;
+	int* line;
+	char* flag;
+	ILC_ERROR ret = ILC_SUCCESS;
+	/**/
+	/* ILC: ilc_reserve開始 */
+
+	if ( capacity < num ) {
+		/* ILC: 領域が足りないので倍々で拡張する */
+		if ( capacity < 16 ) {
+			capacity = 16;
+		}
+		while ( capacity < num ) {
+			capacity *= 2;
+		}
+
+		/* 失敗しても拡張できた配列はそのまま使い、次回に再度拡張する */
+		file_id = (int*)realloc( ilc_data->file_id, sizeof(int) * (size_t)capacity );
+		if ( file_id != NULL ) {
+			/* ILC: ファイル名のIDの拡張成功 */
+			ilc_data->file_id = file_id;
+		}
+		func_id = (int*)realloc( ilc_data->func_id, sizeof(int) * (size_t)capacity );
+		if ( func_id != NULL ) {
+			/* ILC: 関数名のIDの拡張成功 */
+			ilc_data->func_id = func_id;
+		}
+		line = (int*)realloc( ilc_data->line, sizeof(int) * (size_t)capacity );
+		if ( line != NULL ) {
+			/* ILC: 行数の拡張成功 */
+			ilc_data->line = line;
+		}
+		flag = (char*)realloc( ilc_data->flag, (size_t)capacity );
+		if ( flag != NULL ) {
+			/* ILC: 通過フラグの拡張成功 */
+			memset( flag + ilc_data->capacity, 0, (size_t)(capacity - ilc_data->capacity) );
+			ilc_data->flag = flag;
+		}
+
+		if ( file_id != NULL && func_id != NULL && line != NULL && flag != NULL ) {
+			/* ILC: すべて拡張成功 */
+			ilc_data->capacity = capacity;
+		}
+		else {
+			/* ILC: 拡張失敗 */
+			ret = ILC_FAILURE;
+		}
+	}
+
+	/* ILC: ilc_reserve終了 */
+	return ret;
+}
+
+
+/**
+ * ファイルに１行書き出す
+ * @param FILE*           ファイルポインタ
+ * @param const ILC_DATA* ILCカバレッジデータ
+ * @param long            書き出す計測ポイントのID
+ * @param int             通過フラグ(0:未通過 1:通過)
+ * @param const unsigned long long* 通過回数(NULLの場合は書き出さない)
+ */
+static void ilc_fout (
+	FILE* fp,
+	const ILC_DATA* ilc_data,
+	long ix,
+	int flag,
+	const unsigned long long* count
+)
+{
+	/**/
+	const char* file = (ilc_data->name)[ (ilc_data->file_id)[ix] ];
+	const char* func = (ilc_data->name)[ (ilc_data->func_id)[ix] ];
+	/**/
+	/* ILC: ilc_fout開始 */
+
+	if ( count != NULL ) {
+		/* ILC: 通過回数つき */
+		fprintf( fp, ILC_COVERAGE_COUNT, flag, file, func, (ilc_data->line)[ix], *count );
+	}
+	else {
+		/* ILC: フラグのみ */
+		fprintf( fp, ILC_COVERAGE_DATA, flag, file, func, (ilc_data->line)[ix] );
+	}
+
+	/* ILC: ilc_fout終了 */
+	return ;
+}
+
+
+/**
+ * すべての計測ポイントをファイルに書き出す
+ * 通過回数が1以上の計測ポイントは通過済みとして書き出す。
+ * @param FILE*                     ファイルポインタ
+ * @param const ILC_DATA*           ILCカバレッジデータ
+ * @param const char*               通過フラグ(num個)
+ * @param const unsigned long long* 通過回数(flag_num個)
+ */
+static void ilc_write (
+	FILE* fp,
+	const ILC_DATA* ilc_data,
+	const char* flag,
+	const unsigned long long* count
+)
+{
+	/**/
+	long ix;							/* ループカウンタ */
+	/**/
+	/* ILC: ilc_write開始 */
+
+	for ( ix = 0; ix < ilc_data->num; ix++ ) {
+		/**/
+		int covered = flag[ix] != 0 ? 1 : 0;	/* 書き出す通過フラグ */
+		const unsigned long long* cnt = NULL;	/* 書き出す通過回数 */
+		/**/
+		/* ILC: 各配列を先頭から順に読みながら1行ずつ書き出す */
+		if ( ix < ilc_data->flag_num ) {
+			/* ILC: ILC_Initialize時点の計測ポイントは通過回数を持つ */
+			if ( count[ix] != 0 ) {
+				/* ILC: 通過回数があれば通過済み */
+				covered = 1;
+			}
+			if ( (ilc_data->mode & ILC_MODE_COUNT) != 0 || count[ix] != 0 ) {
+				/* ILC: 回数モード、またはファイルに回数があった場合は回数も書き出す */
+				cnt = &count[ix];
+			}
+		}
+		ilc_fout( fp, ilc_data, ix, covered, cnt );
+	}
+
+	/* ILC: ilc_write終了 */
+}
+
+
+/**
+ * すべての計測ポイントを一時ファイルに書き出し、指定したファイル名に置き換える
+ * 書き出しに失敗した場合、指定したファイルは変更しない。
+ * @param const ILC_DATA*           ILCカバレッジデータ
+ * @param const char*               ILCカバレッジデータファイル名
+ * @param const char*               通過フラグ(num個)
+ * @param const unsigned long long* 通過回数(flag_num個)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :ファイル書き出し失敗
+ */
+static ILC_ERROR ilc_save (
+	const ILC_DATA* ilc_data,
+	const char* path,
+	const char* flag,
+	const unsigned long long* count
+)
+{
+	/**/
+	char* tmp;
+	FILE* fp = NULL;
+	int err;
+	ILC_ERROR ret = ILC_WARN;
+	/**/
+	/* ILC: ilc_save開始 */
+
+	/* 一時ファイル名: ファイル名 + "." + プロセスID + ".tmp" */
+	tmp = (char*)malloc( strlen( path ) + 1 + 20 + sizeof(ILC_TMP_SUFFIX) );
+	if ( tmp != NULL ) {
+		/* ILC: 同じディレクトリに作成するため、renameで置き換えられる */
+		sprintf( tmp, "%s.%ld" ILC_TMP_SUFFIX, path, (long)getpid() );
+		fp = fopen( tmp, "w" );
+	}
+
+	if ( fp != NULL ) {
+		/* ILC: 一時ファイルに書き出す */
+		ilc_write( fp, ilc_data, flag, count );
+		err = ferror( fp );
+		if ( fclose( fp ) == 0 && err == 0 && rename( tmp, path ) == 0 ) {
+			/* ILC: 書き出しが完了したファイルで置き換える */
+			ret = ILC_SUCCESS;
+		}
+		else {
+			/* ILC: 書き出し失敗。指定したファイルは変更しない */
+			unlink( tmp );
+		}
+	}
+
+	free( tmp );
+
+	/* ILC: ilc_save終了 */
+	return ret;
+}
+
+
+/**
+ * ILCカバレッジデータの領域をすべて解放する
+ * 動作モード、ファイル名、世代はそのまま残す。
+ * @param ILC_DATA* ILCカバレッジデータ
+ */
+static void ilc_free (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	long ix;
+	/**/
+	/* ILC: ilc_free開始 */
+
+	for ( ix = 0; ix < ilc_data->name_num; ix++ ) {
+		/* ILC: ファイル名・関数名は1つずつ確保している */
+		free( (ilc_data->name)[ix] );
+	}
+	free( ilc_data->name );
+	free( ilc_data->name_index );
+	free( ilc_data->file_id );
+	free( ilc_data->func_id );
+	free( ilc_data->line );
+	free( ilc_data->flag );
+	free( ilc_data->index );
+	free( ilc_data->offset );
+	if ( ilc_data->count_map != NULL ) {
+		/* ILC: 通過回数はマップしたファイル上にある */
+		munmap( ilc_data->count_map, ilc_data->count_map_size );
+		ilc_data->count_map = NULL;
+		ilc_data->count_map_size = 0;
+	}
+	else if ( ilc_data->shm == NULL || (((ILC_SHM_HEADER*)ilc_data->shm)->flags & ILC_DAT_HAS_COUNT) == 0 ) {
+		/* ILC: 通常の通過回数(共有メモリ上にある場合は解放しない) */
+		free( ilc_data->count );
+	}
+	if ( ilc_data->shm != NULL ) {
+		/* ILC: 共有メモリのマップを解除する(名前は ilc_shm_unlink で削除する) */
+		munmap( ilc_data->shm, ilc_data->shm_size );
+		ilc_data->shm = NULL;
+		ilc_data->shm_size = 0;
+		ilc_data->shm_flag = NULL;
+	}
+
+	ilc_data->num = 0;
+	ilc_data->capacity = 0;
+	ilc_data->file_id = NULL;
+	ilc_data->func_id = NULL;
+	ilc_data->line = NULL;
+	ilc_data->flag = NULL;
+	ilc_data->name = NULL;
+	ilc_data->name_num = 0;
+	ilc_data->name_capacity = 0;
+	ilc_data->name_index = NULL;
+	ilc_data->name_index_size = 0;
+	ilc_data->index = NULL;
+	ilc_data->index_size = 0;
+	ilc_data->flag_num = 0;
+	ilc_data->count = NULL;
+	ilc_data->offset = NULL;
+	ilc_data->file_size = 0;
+
+	/* ILC: ilc_free終了 */
+}
+
+
+/**
+ * 「ファイル名:関数名:行数」を分解する
+ * @param const char* ファイル名:関数名:行数(後ろに ":回数" があってもよい)
+ * @param ILC_KEY*    分解結果
+ * @return  0:正常終了
+ *         -1:行数が数字でない
+ */
+static int ilc_key_parse (
+	const char* str,
+	ILC_KEY* key		/* OUT */
+)
+{
+	/**/
+	const char* ptr;
+	char* end;
+	/**/
+	/* ILC: ilc_key_parse開始 */
+
+	key->file = str;
+	for ( ptr = str; *ptr != '\0' && *ptr != ':'; ptr++ ) {
+		/* ファイル名の終わりまで進める */
+	}
+	key->file_len = (size_t)(ptr - str);
+	if ( *ptr == ':' ) {
+		/* ILC: 区切りを飛ばす */
+		ptr++;
+	}
+
+	key->func = ptr;
+	for ( ; *ptr != '\0' && *ptr != ':'; ptr++ ) {
+		/* 関数名の終わりまで進める */
+	}
+	key->func_len = (size_t)(ptr - key->func);
+	if ( *ptr == ':' ) {
+		/* ILC: 区切りを飛ばす */
+		ptr++;
+	}
+
+	key->line = (int)strtol( ptr, &end, 10 );
+	key->rest = end;
+
+	/* ILC: ilc_key_parse終了 */
+	return ( end != ptr ) ? 0 : -1;
+}
+
+
+/**
+ * 「フラグ:ファイル名:関数名:行数」を分解し、計測ポイントとして末尾に追加する
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* フラグ:ファイル名:関数名:行数
+ * @param ILC_KEY*    分解結果(行数の後ろの通過回数を取り出すために使用する)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_point_add (
+	ILC_DATA* ilc_data,
+	const char* str,
+	ILC_KEY* key		/* OUT */
+)
+{
+	/**/
+	long file = -1;
+	long func = -1;
+	ILC_ERROR ret = ILC_FAILURE;
+	/**/
+	/* ILC: ilc_point_add開始 */
+
+	/* フラグ + ':' を飛ばしたものがキー */
+	ilc_key_parse( ( str[0] != '\0' && str[1] == ':' ) ? str + 2 : str, key );
+
+	file = ilc_name_intern( ilc_data, key->file, key->file_len );
+	if ( file >= 0 ) {
+		/* ILC: ファイル名の登録成功 */
+		func = ilc_name_intern( ilc_data, key->func, key->func_len );
+	}
+
+	if ( func >= 0 ) {
+		/* ILC: ファイル名・関数名の登録成功 */
+		ret = ilc_point_insert( ilc_data, file, func, key->line, ( str[0] == '1' ) ? 1 : 0 );
+	}
+
+	/* ILC: ilc_point_add終了 */
+	return ret;
+}
+
+
+/**
+ * ファイル名・関数名のIDと行数を、計測ポイントとして末尾に追加する
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      ファイル名のID
+ * @param long      関数名のID
+ * @param int       行数
+ * @param int       通過フラグ(0:未通過 1:通過)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_point_insert (
+	ILC_DATA* ilc_data,
+	long file,
+	long func,
+	int line,
+	int flag
+)
+{
+	/**/
+	long ix;
+	ILC_ERROR ret = ILC_FAILURE;
+	/**/
+	/* ILC: ilc_point_insert開始 */
+
+	/* 領域は倍々で拡張するため、追加は償却O(1) */
+	if ( ilc_reserve( ilc_data, ilc_data->num + 1 ) == ILC_SUCCESS ) {
+		/* ILC: 拡張成功(または空きあり) */
+		ix = ilc_data->num;
+		(ilc_data->file_id)[ix] = (int)file;
+		(ilc_data->func_id)[ix] = (int)func;
+		(ilc_data->line)[ix] = line;
+		(ilc_data->flag)[ix] = (char)flag;
+		ilc_data->num++;
+
+		if ( ilc_data->index != NULL ) {
+			/* ILC: ハッシュ表にも登録する */
+			if ( ilc_data->num * 2 > ilc_data->index_size ) {
+				/* ILC: 負荷率が1/2を超えたのでハッシュ表を拡大して作り直す */
+				ilc_index_build( ilc_data, ilc_data->num );
+			}
+			else {
+				/* ILC: 空きがあるのでそのまま登録 */
+				ilc_index_insert( ilc_data, ix );
+			}
+		}
+		ret = ILC_SUCCESS;
+	}
+
+	/* ILC: ilc_point_insert終了 */
+	return ret;
+}
+
+
+/**
+ * 実行ファイルの ilc_points セクション(ilc -r)の計測ポイントを登録する
+ * 未登録の計測ポイントは末尾に追加し、各計測ポイントの記録状態にIDを設定する。
+ * ILCカバレッジデータファイルがなくても、すべての計測ポイントが揃う。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+static ILC_ERROR ilc_registry_add (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	ILC_POINT* point;
+	long num = ilc_data->num;		/* 追加前の計測ポイントの数 */
+	long file;
+	long func;
+	long id;
+	unsigned long long* count;
+	ILC_ERROR ret = ILC_SUCCESS;
+	/**/
+	/* ILC: ilc_registry_add開始 */
+
+	for ( point = __start_ilc_points; point != NULL && point < __stop_ilc_points && ret == ILC_SUCCESS; point++ ) {
+		/* ILC: セクションの計測ポイントごとに登録 */
+		file = ilc_name_intern( ilc_data, point->file, strlen( point->file ) );
+		func = ( file >= 0 ) ? ilc_name_intern( ilc_data, point->func, strlen( point->func ) ) : -1;
+		id = ( func >= 0 ) ? ilc_point_search( ilc_data, file, func, point->line ) : -1;
+		if ( func >= 0 && id < 0 ) {
+			/* ILC: ILCカバレッジデータファイルにない計測ポイントを追加 */
+			id = ilc_data->num;
+			ret = ilc_point_insert( ilc_data, file, func, point->line, 0 );
+		}
+		else if ( func < 0 ) {
+			/* ILC: 名前の登録に失敗 */
+			ret = ILC_FAILURE;
+		}
+		if ( ret == ILC_SUCCESS && point->site != NULL ) {
+			/* ILC: 以後の通過では検索せずにIDで記録する(ilc-link -c の一覧は記録状態なし) */
+			point->site->id = id;
+		}
+	}
+
+	if ( ret == ILC_SUCCESS && ilc_data->num > num && ilc_data->count != NULL ) {
+		/* ILC: ファイルから読み込んだ際の通過回数は、ファイルの行の分しかない */
+		count = (unsigned long long*)realloc( ilc_data->count, sizeof(unsigned long long) * (size_t)(ilc_data->num + 1) );
+		if ( count != NULL ) {
+			/* ILC: 追加した計測ポイントの通過回数は0 */
+			memset( count + num, 0, sizeof(unsigned long long) * (size_t)(ilc_data->num + 1 - num) );
+			ilc_data->count = count;
+		}
+		else {
+			/* ILC: 拡張失敗 */
+			ret = ILC_FAILURE;
+		}
+	}
+	if ( ilc_data->num > num && ilc_data->offset != NULL ) {
+		/* ILC: ファイルにない計測ポイントはフラグの位置がないので、今回はマップしない */
+		free( ilc_data->offset );
+		ilc_data->offset = NULL;
+	}
+
+	/* ILC: ilc_registry_add終了 */
+	return ret;
+}
+
+
+/**
+ * 計測ポイントをファイル名・関数名のIDと行数で検索する
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      ファイル名のID
+ * @param long      関数名のID
+ * @param int       行数
+ * @return 計測ポイントのID
+ *         -1:見つからない
+ */
+static long ilc_point_search (
+	ILC_DATA* ilc_data,
+	long file,
+	long func,
+	int line
+)
+{
+	/**/
+	long ix;
+	long ret = -1;
+	/**/
+	/* ILC: ilc_point_search開始 */
+
+	if ( ilc_data->index != NULL ) {
+		/**/
+		unsigned long mask = (unsigned long)ilc_data->index_size - 1;
+		unsigned long pos;
+		/**/
+		/* ILC: ハッシュ表で検索 */
+		for ( pos = ilc_hash_point( (int)file, (int)func, line ) & mask;
+			  (ix = (ilc_data->index)[pos]) != 0;
+			  pos = (pos + 1) & mask ) {
+			/* ILC: 空きを検出するまで線形探査 */
+			if ( (ilc_data->line)[ix - 1] == line &&
+				 (ilc_data->file_id)[ix - 1] == file &&
+				 (ilc_data->func_id)[ix - 1] == func ) {
+				/* ILC: ハッシュ表で一致 */
+				ret = ix - 1;
+				break;
+			}
+		}
+	}
+	else {
+		/* ILC: ハッシュ表がない場合は線形検索 */
+		for ( ix = 0; ix < ilc_data->num; ix++ ) {
+			/* ILC: 行数から比較する */
+			if ( (ilc_data->line)[ix] == line &&
+				 (ilc_data->file_id)[ix] == file &&
+				 (ilc_data->func_id)[ix] == func ) {
+				/* ILC: 一致 */
+				ret = ix;
+				break;
+			}
+		}
+	}
+
+	/* ILC: ilc_point_search終了 */
+	return ret;
+}
+
+
+/**
+ * 文字列表からファイル名・関数名を検索する
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 検索する文字列(NULL終端していなくてよい)
+ * @param size_t      検索する文字列の長さ
+ * @return 文字列のID(nameの添字)
+ *         -1:見つからない
+ */
+static long ilc_name_search (
+	ILC_DATA* ilc_data,
+	const char* str,
+	size_t len
+)
+{
+	/**/
+	long ix;
+	long ret = -1;
+	/**/
+	/* ILC: ilc_name_search開始 */
+
+	if ( ilc_data->name_index != NULL ) {
+		/**/
+		unsigned long mask = (unsigned long)ilc_data->name_index_size - 1;
+		unsigned long pos;
+		/**/
+		/* ILC: ハッシュ表で検索 */
+		for ( pos = ilc_hash( str, len ) & mask;
+			  (ix = (ilc_data->name_index)[pos]) != 0;
+			  pos = (pos + 1) & mask ) {
+			/* ILC: 空きを検出するまで線形探査 */
+			if ( strncmp( (ilc_data->name)[ix - 1], str, len ) == 0 && (ilc_data->name)[ix - 1][len] == '\0' ) {
+				/* ILC: 一致 */
+				ret = ix - 1;
+				break;
+			}
+		}
+	}
+
+	/* ILC: ilc_name_search終了 */
+	return ret;
+}
+
+
+/**
+ * 文字列表にファイル名・関数名を登録する
+ * 登録済みの場合は、そのIDを返す。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 登録する文字列(NULL終端していなくてよい)
+ * @param size_t      登録する文字列の長さ
+ * @return 文字列のID(nameの添字)
+ *         -1:メモリ確保エラー
+ */
+static long ilc_name_intern (
+	ILC_DATA* ilc_data,
+	const char* str,
+	size_t len
+)
+{
+	/**/
+	char** name;
+	char* copy;
+	long ret;
+	/**/
+	/* ILC: ilc_name_intern開始 */
+
+	ret = ilc_name_search( ilc_data, str, len );
+
+	if ( ret < 0 && ilc_data->name_num >= ilc_data->name_capacity ) {
+		/* ILC: 文字列表が一杯なので倍々で拡張する */
+		name = (char**)realloc( ilc_data->name, sizeof(char*) * (size_t)(ilc_data->name_capacity * 2 + 16) );
+		if ( name != NULL ) {
+			/* ILC: 拡張成功 */
+			ilc_data->name = name;
+			ilc_data->name_capacity = ilc_data->name_capacity * 2 + 16;
+		}
+	}
+
+	if ( ret < 0 && ilc_data->name_num < ilc_data->name_capacity &&
+		 ( (ilc_data->name_num + 1) * 2 <= ilc_data->name_index_size ||
+		   ilc_name_index_build( ilc_data, ilc_data->name_num + 1 ) == ILC_SUCCESS ) ) {
+		/**/
+		unsigned long mask = (unsigned long)ilc_data->name_index_size - 1;
+		unsigned long pos;
+		/**/
+		/* ILC: 未登録なので複製して登録する(ハッシュ表には空きがある) */
+		copy = (char*)malloc( len + 1 );
+		if ( copy != NULL ) {
+			/* ILC: 複製成功 */
+			memcpy( copy, str, len );
+			copy[len] = '\0';
+
+			pos = ilc_hash( copy, len ) & mask;
+			while ( (ilc_data->name_index)[pos] != 0 ) {
+				/* ILC: 線形探査で空きを探す */
+				pos = (pos + 1) & mask;
+			}
+			ret = ilc_data->name_num++;
+			(ilc_data->name)[ret] = copy;
+			(ilc_data->name_index)[pos] = ret + 1;
+		}
+	}
+
+	/* ILC: ilc_name_intern終了 */
+	return ret;
+}
+
+
+/**
+ * 文字列表の検索用ハッシュ表を作り直す
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      登録予定の文字列の数(この倍以上のサイズで作成する)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー(元のハッシュ表はそのまま残る)
+ */
+static ILC_ERROR ilc_name_index_build (
+	ILC_DATA* ilc_data,
+	long num
+)
+{
+	/**/
+	long size = ILC_INDEX_MIN;
+	long* index;
+	long ix;
+	ILC_ERROR ret = ILC_FAILURE;
+	/**/
+	/* ILC: ilc_name_index_build開始 */
+
+	while ( size < num * 2 ) {
+		/* ILC: 負荷率が1/2以下になるまでサイズを拡大 */
+		size *= 2;
+	}
+
+	index = (long*)calloc( (size_t)size, sizeof(long) );
+	if ( index != NULL ) {
+		/**/
+		unsigned long mask = (unsigned long)size - 1;
+		unsigned long pos;
+		/**/
+		/* ILC: 登録済みの文字列をすべて登録しなおす */
+		for ( ix = 0; ix < ilc_data->name_num; ix++ ) {
+			pos = ilc_hash( (ilc_data->name)[ix], strlen( (ilc_data->name)[ix] ) ) & mask;
+			while ( index[pos] != 0 ) {
+				/* ILC: 線形探査で空きを探す */
+				pos = (pos + 1) & mask;
+			}
+			index[pos] = ix + 1;
+		}
+		free( ilc_data->name_index );
+		ilc_data->name_index = index;
+		ilc_data->name_index_size = size;
+		ret = ILC_SUCCESS;
+	}
+
+	/* ILC: ilc_name_index_build終了 */
+	return ret;
+}
+
+
+/**
+ * 呼び出したスレッドの記録領域を作成し、リストに登録する
+ * 以前の ILC_Initialize で作成した自スレッドの領域は解放する。
+ * @return ILC_SHARD* 作成した記録領域
+ *                    NULL: 作成に失敗
+ */
+static ILC_SHARD* ilc_shard_create (
+)
+{
+	/**/
+#define ILC_ALIGN(x) (((x) + ILC_CACHE_LINE - 1) / ILC_CACHE_LINE * ILC_CACHE_LINE)
+	size_t head = ILC_ALIGN( sizeof(ILC_SHARD) );
+	size_t flag_size = ILC_ALIGN( (size_t)__ilc_data.flag_num );
+	size_t count_size = 0;
+	void* ptr;
+	ILC_SHARD* old = __ilc_shard;
+	ILC_SHARD* shard = NULL;
+	/**/
+	/* ILC: ilc_shard_create開始 */
+
+	pthread_once( &__ilc_shard_once, ilc_shard_key_create );
+
+	if ( (__ilc_data.mode & ILC_MODE_COUNT) != 0 ) {
+		/* ILC: 回数モードの場合は通過回数(と集計済みの通過回数)の領域も確保する */
+		count_size = ILC_ALIGN( sizeof(unsigned long long) * (size_t)__ilc_data.flag_num );
+	}
+
+	/* ヘッダ、通過回数、通過フラグ、集計済みの通過回数をそれぞれキャッシュライン境界に配置する */
+	if ( posix_memalign( &ptr, ILC_CACHE_LINE, head + count_size + flag_size + count_size ) == 0 ) {
+		/* ILC: 確保成功 */
+		memset( ptr, 0, head + count_size + flag_size + count_size );
+		shard = (ILC_SHARD*)ptr;
+		shard->num = __ilc_data.flag_num;
+		shard->count = count_size != 0 ? (unsigned long long*)((char*)ptr + head) : NULL;
+		shard->flag = (char*)ptr + head + count_size;
+		shard->base = count_size != 0 ? (unsigned long long*)((char*)ptr + head + count_size + flag_size) : NULL;
+
+		pthread_mutex_lock( &__ilc_shard_lock );
+		if ( old != NULL ) {
+			/* ILC: 以前の世代の領域は集計されないため、リストから外して解放する */
+			ilc_shard_unlink( old );
+		}
+		shard->generation = __ilc_data.generation;
+		shard->next = __ilc_shard_list;
+		__ilc_shard_list = shard;
+		pthread_mutex_unlock( &__ilc_shard_lock );
+
+		free( old );
+		__ilc_shard = shard;
+		if ( __ilc_shard_keyed != 0 ) {
+			/* ILC: スレッド終了時に集計・解放する */
+			pthread_setspecific( __ilc_shard_key, shard );
+		}
+	}
+
+	/* ILC: ilc_shard_create終了 */
+	return shard;
+}
+
+
+/**
+ * スレッド終了時にスレッド別の記録領域を集計・解放するキーを作成する(pthread_once)
+ */
+static void ilc_shard_key_create (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_shard_key_create開始 */
+
+	/* 作成できない場合は、領域をスレッド終了後も残して ILC_Finalize で集計する */
+	__ilc_shard_keyed = ( pthread_key_create( &__ilc_shard_key, ilc_shard_destroy ) == 0 );
+
+	/* ILC: ilc_shard_key_create終了 */
+}
+
+
+/**
+ * スレッド終了時に、スレッド別の記録領域をILCカバレッジデータに集計して解放する
+ * スレッドごとのリソースが増え続けないよう、終了したスレッドの領域は残さない。
+ * @param void* スレッド別の記録領域(ILC_SHARD*)
+ */
+static void ilc_shard_destroy (
+	void* ptr
+)
+{
+	/**/
+	ILC_SHARD* shard = (ILC_SHARD*)ptr;
+	/**/
+	/* ILC: ilc_shard_destroy開始 */
+
+	/* ILC_Finalize と同じ順序で取得する */
+	pthread_mutex_lock( &__ilc_data_lock );
+	pthread_mutex_lock( &__ilc_shard_lock );
+
+	ilc_shard_unlink( shard );
+	if ( __ilc_data.flag != NULL && shard->generation == __ilc_data.generation && shard->num == __ilc_data.flag_num ) {
+		/* ILC: 現在のILCカバレッジデータの領域のみ集計する */
+		ilc_shard_fold( &__ilc_data, shard );
+	}
+
+	pthread_mutex_unlock( &__ilc_shard_lock );
+	pthread_mutex_unlock( &__ilc_data_lock );
+
+	if ( __ilc_shard == shard ) {
+		/* ILC: 後続のデストラクタから __ilc_check が呼ばれた場合は、領域を作り直させる */
+		__ilc_shard = NULL;
+	}
+	free( shard );
+
+	/* ILC: ilc_shard_destroy終了 */
+}
+
+
+/**
+ * スレッド別の記録領域をリストから外す(__ilc_shard_lock を取得して呼び出すこと)
+ * @param ILC_SHARD* 外す記録領域
+ */
+static void ilc_shard_unlink (
+	ILC_SHARD* shard
+)
+{
+	/**/
+	ILC_SHARD** link;
+	/**/
+	/* ILC: ilc_shard_unlink開始 */
+
+	for ( link = &__ilc_shard_list; *link != NULL; link = &((*link)->next) ) {
+		/* ILC: 指す側を付け替える */
+		if ( *link == shard ) {
+			/* ILC: 見つかった */
+			*link = shard->next;
+			break;
+		}
+	}
+
+	/* ILC: ilc_shard_unlink終了 */
+}
+
+
+/**
+ * 1つのスレッド別記録領域の未集計分をILCカバレッジデータに集計する
+ * (__ilc_shard_lock を取得して呼び出すこと)
+ * 記録中のスレッドは count にのみ書き込むため、集計済みの値を base に
+ * 記録し、count 自体はクリアしない(書き込み途中の加算を失わない)。
+ * @param ILC_DATA*  ILCカバレッジデータ
+ * @param ILC_SHARD* スレッド別の記録領域
+ */
+static void ilc_shard_fold (
+	ILC_DATA* ilc_data,
+	ILC_SHARD* shard
+)
+{
+	/**/
+	unsigned long long count;
+	long ix;
+	/**/
+	/* ILC: ilc_shard_fold開始 */
+
+	for ( ix = 0; ix < shard->num; ix++ ) {
+		/* ILC: 通過フラグは論理和 */
+		(ilc_data->flag)[ix] |= __atomic_load_n( &(shard->flag)[ix], __ATOMIC_RELAXED );
+	}
+	for ( ix = 0; shard->count != NULL && ix < shard->num; ix++ ) {
+		/* ILC: 通過回数は未集計分を加算 */
+		/* (マップした通過回数は fork した他のプロセスも加算するため、不可分に加算する) */
+		count = __atomic_load_n( &(shard->count)[ix], __ATOMIC_RELAXED );
+		if ( count != (shard->base)[ix] ) {
+			/* ILC: 未集計の通過あり */
+			__atomic_fetch_add( &(ilc_data->count)[ix], count - (shard->base)[ix], __ATOMIC_RELAXED );
+			(shard->base)[ix] = count;
+		}
+	}
+
+	/* ILC: ilc_shard_fold終了 */
+}
+
+
+/**
+ * スレッド別の記録領域をILCカバレッジデータに集計する
+ * 集計した通過回数は集計済み(base)にする。
+ * @param ILC_DATA* ILCカバレッジデータ
+ */
+static void ilc_shard_merge (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	ILC_SHARD* shard;
+	/**/
+	/* ILC: ilc_shard_merge開始 */
+
+	pthread_mutex_lock( &__ilc_shard_lock );
+	for ( shard = __ilc_shard_list; shard != NULL; shard = shard->next ) {
+		/* ILC: 記録領域ごとに集計 */
+		if ( shard->generation != ilc_data->generation || shard->num != ilc_data->flag_num ) {
+			/* ILC: 以前の ILC_Initialize で作成した領域は対象外 */
+			continue;
+		}
+		ilc_shard_fold( ilc_data, shard );
+	}
+	pthread_mutex_unlock( &__ilc_shard_lock );
+
+	/* ILC: ilc_shard_merge終了 */
+}
+
+
+/**
+ * スレッド別の記録領域を、指定した通過フラグと通過回数に加える
+ * ilc_shard_mergeと異なり、集計済みにはしない(計測を止めずに集計できる)。
+ * @param ILC_DATA*           ILCカバレッジデータ
+ * @param char*               通過フラグ(flag_num個以上)
+ * @param unsigned long long* 通過回数(flag_num個以上)
+ */
+static void ilc_shard_collect (
+	ILC_DATA* ilc_data,
+	char* flag,
+	unsigned long long* count
+)
+{
+	/**/
+	ILC_SHARD* shard;
+	long ix;
+	/**/
+	/* ILC: ilc_shard_collect開始 */
+
+	pthread_mutex_lock( &__ilc_shard_lock );
+	for ( shard = __ilc_shard_list; shard != NULL; shard = shard->next ) {
+		/* ILC: 記録領域ごとに集計 */
+		if ( shard->generation != ilc_data->generation || shard->num != ilc_data->flag_num ) {
+			/* ILC: 以前の ILC_Initialize で作成した領域は対象外 */
+			continue;
+		}
+		for ( ix = 0; ix < shard->num; ix++ ) {
+			/* ILC: 通過フラグは論理和 */
+			flag[ix] |= __atomic_load_n( &(shard->flag)[ix], __ATOMIC_RELAXED );
+		}
+		for ( ix = 0; shard->count != NULL && ix < shard->num; ix++ ) {
+			/* ILC: 通過回数は未集計分を加算 */
+			count[ix] += __atomic_load_n( &(shard->count)[ix], __ATOMIC_RELAXED ) - (shard->base)[ix];
+		}
+	}
+	pthread_mutex_unlock( &__ilc_shard_lock );
+
+	/* ILC: ilc_shard_collect終了 */
+}
+
+
+/**
+ * スレッド別の記録領域の通過フラグ・通過回数をクリアする
+ * 通過回数は集計済み(base)にすることでクリアする。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param int       ILC_RESET_xxx の論理和
+ */
+static void ilc_shard_reset (
+	ILC_DATA* ilc_data,
+	int what
+)
+{
+	/**/
+	ILC_SHARD* shard;
+	long ix;
+	/**/
+	/* ILC: ilc_shard_reset開始 */
+
+	pthread_mutex_lock( &__ilc_shard_lock );
+	for ( shard = __ilc_shard_list; shard != NULL; shard = shard->next ) {
+		/* ILC: 記録領域ごとにクリア(以前の世代の領域は集計されないため対象外) */
+		if ( shard->generation != ilc_data->generation || shard->num != ilc_data->flag_num ) {
+			/* ILC: 以前の ILC_Initialize で作成した領域 */
+			continue;
+		}
+		for ( ix = 0; (what & ILC_RESET_FLAG) != 0 && ix < shard->num; ix++ ) {
+			/* ILC: 通過フラグのクリア(記録中のスレッドが同時に立てた場合は、クリア後の通過とする) */
+			__atomic_store_n( &(shard->flag)[ix], 0, __ATOMIC_RELAXED );
+		}
+		for ( ix = 0; (what & ILC_RESET_COUNT) != 0 && shard->count != NULL && ix < shard->num; ix++ ) {
+			/* ILC: 通過回数のクリア(ここまでの通過回数を集計済みにする) */
+			(shard->base)[ix] = __atomic_load_n( &(shard->count)[ix], __ATOMIC_RELAXED );
+		}
+	}
+	pthread_mutex_unlock( &__ilc_shard_lock );
+
+	/* ILC: ilc_shard_reset終了 */
+}
+
+
+/**
+ * 計測ポイント(ilc -n)ごとに数えた通過回数を集計する
+ * @param ILC_DATA*           ILCカバレッジデータ
+ * @param unsigned long long* 集計先の通過回数
+ * @param int                 0以外:集計した通過回数を0にする
+ */
+static void ilc_site_collect (
+	ILC_DATA* ilc_data,
+	unsigned long long* count,
+	int take
+)
+{
+	/**/
+	ILC_SITE* site;
+	/**/
+	/* ILC: ilc_site_collect開始 */
+
+	pthread_mutex_lock( &__ilc_shard_lock );
+	for ( site = __ilc_site_list; site != NULL; site = site->next ) {
+		/* ILC: 計測ポイントごとに加算 */
+		if ( (unsigned long)site->id >= (unsigned long)ilc_data->flag_num ) {
+			/* ILC: 現在のILCカバレッジデータにない計測ポイント */
+			continue;
+		}
+		if ( take != 0 ) {
+			/* ILC: 集計した分を0に戻す */
+			count[ site->id ] += __atomic_exchange_n( &(site->count), 0, __ATOMIC_RELAXED );
+		}
+		else {
+			/* ILC: 計測を続けたまま読むだけ */
+			count[ site->id ] += __atomic_load_n( &(site->count), __ATOMIC_RELAXED );
+		}
+	}
+	pthread_mutex_unlock( &__ilc_shard_lock );
+
+	/* ILC: ilc_site_collect終了 */
+}
+
+
+/**
+ * 計測ポイント(ilc -n)の記録済みの状態・通過回数をクリアする
+ * 記録済みの状態は世代を進めてクリアし、次の通過で改めて記録させる。
+ * @param int ILC_RESET_xxx の論理和
+ */
+static void ilc_site_reset (
+	int what
+)
+{
+	/**/
+	ILC_SITE* site;
+	/**/
+	/* ILC: ilc_site_reset開始 */
+
+	if ( (what & ILC_RESET_FLAG) != 0 ) {
+		/* ILC: 記録済みの状態のクリア */
+		__atomic_add_fetch( &__ilc_epoch, 1, __ATOMIC_RELEASE );
+	}
+
+	if ( (what & ILC_RESET_COUNT) != 0 ) {
+		/* ILC: 通過回数のクリア */
+		pthread_mutex_lock( &__ilc_shard_lock );
+		for ( site = __ilc_site_list; site != NULL; site = site->next ) {
+			/* ILC: 計測ポイントごとにクリア */
+			__atomic_store_n( &(site->count), 0, __ATOMIC_RELAXED );
+		}
+		pthread_mutex_unlock( &__ilc_shard_lock );
+	}
+
+	/* ILC: ilc_site_reset終了 */
+}
+
+
+/**
+ * 通過回数の標本化(ILC_SetSampling)で、今回の通過で加算する回数を求める
+ * スレッドごとのカウントダウンが0になったときだけ間隔分を加算し、
+ * 次の間隔を 1〜2N-1 の乱数で決める(平均 N)。
+ * @param int 0以外:初回通過(標本化せずに1を加算する)
+ * @return 加算する回数(0:今回は数えない)
+ */
+static unsigned long long ilc_sample (
+	int first
+)
+{
+	/**/
+	unsigned long x;
+	long interval = __ilc_data.sampling;
+	unsigned long long ret = (unsigned long long)interval;
+	/**/
+	/* ILC: ilc_sample開始 */
+
+	if ( first != 0 || interval <= 1 ) {
+		/* ILC: 初回通過、または標本化しない */
+		return 1;
+	}
+
+	x = __ilc_sample_seed;
+	if ( x == 0 ) {
+		/* ILC: スレッドで初めて標本化する。最初のカウントダウンも乱数で決め、今回は数えない */
+		/* (カウントダウンの初期値0のまま数えると、どのスレッドも2回目の通過で必ず N を加算してしまう) */
+		x = (unsigned long)&__ilc_sample_seed * 2654435761UL | 1;
+		ret = 0;
+	}
+	else if ( --__ilc_sample_left > 0 ) {
+		/* ILC: 今回は数えない */
+		return 0;
+	}
+
+	/* xorshift */
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	__ilc_sample_seed = x;
+	__ilc_sample_left = 1 + (long)(x % (unsigned long)(interval * 2 - 1));
+
+	/* ILC: ilc_sample終了 */
+	return ret;
+}
+
+
+/**
+ * 文字列のハッシュ値を求める(FNV-1a)
+ * @param const char* 文字列
+ * @param size_t      文字列の長さ
+ * @return ハッシュ値
+ */
+static unsigned long ilc_hash (
+	const char* str,
+	size_t len
+)
+{
+	/**/
+	unsigned long hash = 2166136261UL;
+	const char* end = str + len;
+	/**/
+	/* ILC: ilc_hash開始 */
+
+	while ( str < end ) {
+		/* ILC: 1文字ずつ混ぜ込む */
+		hash ^= (unsigned char)*str++;
+		hash *= 16777619UL;
+	}
+
+	/* ILC: ilc_hash終了 */
+	return hash;
+}
+
+
+/**
+ * 計測ポイントのハッシュ値を求める
+ * @param int ファイル名のID
+ * @param int 関数名のID
+ * @param int 行数
+ * @return ハッシュ値
+ */
+static unsigned long ilc_hash_point (
+	int file,
+	int func,
+	int line
+)
+{
+	/**/
+	unsigned long hash = 2166136261UL;
+	/**/
+	/* ILC: ilc_hash_point開始 */
+
+	/* FNV-1aを1バイトずつではなく値ごとに適用し、上位ビットを下位に折り返す */
+	hash = (hash ^ (unsigned int)file) * 16777619UL;
+	hash = (hash ^ (unsigned int)func) * 16777619UL;
+	hash = (hash ^ (unsigned int)line) * 16777619UL;
+
+	/* ILC: ilc_hash_point終了 */
+	return hash ^ (hash >> 15);
+}
+
+
+/**
+ * ILCカバレッジデータの検索用ハッシュ表を作り直す
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      登録予定のデータ数(この倍以上のサイズで作成する)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー(ハッシュ表は作成されない)
+ */
+static ILC_ERROR ilc_index_build (
+	ILC_DATA* ilc_data,
+	long num
+)
+{
+	/**/
+	long size = ILC_INDEX_MIN;
+	long* index;
+	long ix;
+	ILC_ERROR ret;
+	/**/
+	/* ILC: ilc_index_build開始 */
+
+	while ( size < num * 2 ) {
+		/* ILC: 負荷率が1/2以下になるまでサイズを拡大 */
+		size *= 2;
+	}
+
+	index = (long*)calloc( (size_t)size, sizeof(long) );
+
+	/* 古いハッシュ表は作成の成否によらず破棄する(線形検索で代替できる) */
+	free( ilc_data->index );
+	ilc_data->index = index;
+	ilc_data->index_size = 0;
+
+	if ( index != NULL ) {
+		/* ILC: 登録済みのデータをすべて登録しなおす */
+		ilc_data->index_size = size;
+		for ( ix = 0; ix < ilc_data->num; ix++ ) {
+			ilc_index_insert( ilc_data, ix );
+		}
+		ret = ILC_SUCCESS;
+	}
+	else {
+		/* ILC: メモリ確保エラー */
+		ret = ILC_FAILURE;
+	}
+
+	/* ILC: ilc_index_build終了 */
+	return ret;
+}
+
+
+/**
+ * ハッシュ表に計測ポイントを登録する
+ * ハッシュ表には十分な空きがあること。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param long      登録する計測ポイントのID
+ */
+static void ilc_index_insert (
+	ILC_DATA* ilc_data,
+	long ix
+)
+{
+	/**/
+	unsigned long mask = (unsigned long)ilc_data->index_size - 1;
+	unsigned long pos;
+	/**/
+	/* ILC: ilc_index_insert開始 */
+
+	pos = ilc_hash_point( (ilc_data->file_id)[ix], (ilc_data->func_id)[ix], (ilc_data->line)[ix] ) & mask;
+	while ( (ilc_data->index)[pos] != 0 ) {
+		/* ILC: 線形探査で空きを探す */
+		pos = (pos + 1) & mask;
+	}
+	(ilc_data->index)[pos] = ix + 1;
+
+	/* ILC: ilc_index_insert終了 */
+}
+
+
+/**
+ * 通過回数ファイル名を作成する
+ * @param const char* ILCカバレッジデータファイル名
+ * @return 通過回数ファイル名。mallocで確保するため、不要になったらfreeすること。
+ *         NULL:メモリ確保エラー
+ */
+static char* ilc_count_path (
+	const char* filename
+)
+{
+	/**/
+	char* path;
+	/**/
+	/* ILC: ilc_count_path開始 */
+
+	path = (char*)malloc( strlen( filename ) + sizeof(ILC_COUNT_SUFFIX) );
+	if ( path != NULL ) {
+		/* ILC: ファイル名 + 拡張子 */
+		strcpy( path, filename );
+		strcat( path, ILC_COUNT_SUFFIX );
+	}
+
+	/* ILC: ilc_count_path終了 */
+	return path;
+}
+
+
+/**
+ * 前回の実行で残った通過回数ファイル(ILC_MODE_MMAP)を読み込む
+ * 計測ポイントの数が一致する場合のみ、countに反映する。
+ * @param ILC_DATA* ILCカバレッジデータ(countは作成済みであること)
+ * @return 1:読み込んだ 0:ファイルなし、または対象外
+ */
+static int ilc_count_recover (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	char* path;
+	FILE* fp = NULL;
+	ILC_COUNT_HEADER header;
+	unsigned long long count;
+	long ix;
+	int ret = 0;
+	/**/
+	/* ILC: ilc_count_recover開始 */
+
+	path = ilc_count_path( ilc_data->filename );
+	if ( path != NULL ) {
+		/* ILC: 通過回数ファイルを開く */
+		fp = fopen( path, "rb" );
+		free( path );
+	}
+
+	if ( fp != NULL ) {
+		/* ILC: 通過回数ファイルあり */
+		if ( fread( &header, sizeof(header), 1, fp ) == 1 &&
+			 memcmp( header.magic, ILC_COUNT_MAGIC, sizeof(header.magic) ) == 0 &&
+			 header.num == (long long)ilc_data->flag_num ) {
+			/* ILC: 同じILCカバレッジデータの通過回数 */
+			for ( ix = 0; ix < ilc_data->flag_num && fread( &count, sizeof(count), 1, fp ) == 1; ix++ ) {
+				/* ILC: 通過回数ファイルは累計なので、大きい方を採用する */
+				if ( (ilc_data->count)[ix] < count ) {
+					/* ILC: ファイルに反映されていない通過回数あり */
+					(ilc_data->count)[ix] = count;
+				}
+			}
+			ret = 1;
+		}
+		fclose( fp );
+	}
+
+	/* ILC: ilc_count_recover終了 */
+	return ret;
+}
+
+
+/**
+ * ILCカバレッジデータファイル(と通過回数ファイル)をマップする
+ * @param ILC_DATA* ILCカバレッジデータ(ILC_Initializeで展開済みであること)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :マップできなかった(通常の動作で続行可能)
+ */
+static ILC_ERROR ilc_map (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	struct stat st;
+	char* path;
+	void* ptr;
+	size_t size;
+	int fd;
+	ILC_ERROR ret = ILC_WARN;
+	/**/
+	/* ILC: ilc_map開始 */
+
+	fd = ( ilc_data->flag_num > 0 && ilc_data->offset != NULL ) ? open( ilc_data->filename, O_RDWR ) : -1;
+	if ( fd >= 0 ) {
+		/* ILC: ILCカバレッジデータファイルをマップする */
+		/* フラグの位置は読み込み時に offset に記録してある */
+		if ( fstat( fd, &st ) == 0 && (size_t)st.st_size == ilc_data->file_size ) {
+			/* ILC: 読み込んだときから変更されていない */
+			ptr = mmap( NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+			if ( ptr != MAP_FAILED ) {
+				/* ILC: マップ成功 */
+				ilc_data->map = (char*)ptr;
+				ilc_data->map_size = (size_t)st.st_size;
+				ret = ILC_SUCCESS;
+			}
+		}
+		close( fd );
+	}
+
+	if ( ret == ILC_SUCCESS && (ilc_data->mode & ILC_MODE_COUNT) != 0 ) {
+		/* ILC: 回数モードは通過回数ファイルもマップする */
+		ret = ILC_WARN;
+		size = sizeof(ILC_COUNT_HEADER) + sizeof(unsigned long long) * (size_t)ilc_data->flag_num;
+		path = ilc_count_path( ilc_data->filename );
+		fd = ( path != NULL ) ? open( path, O_RDWR | O_CREAT, 0666 ) : -1;
+		free( path );
+		if ( fd >= 0 ) {
+			/* ILC: 通過回数ファイルを作成 */
+			if ( ftruncate( fd, (off_t)size ) == 0 ) {
+				/* ILC: サイズを確定してからマップする */
+				ptr = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+				if ( ptr != MAP_FAILED ) {
+					/**/
+					ILC_COUNT_HEADER* header = (ILC_COUNT_HEADER*)ptr;
+					unsigned long long* count = (unsigned long long*)(header + 1);
+					/**/
+					/* ILC: マップ成功。現在の累計を書き込み、以後はファイル上で加算する */
+					memcpy( count, ilc_data->count, sizeof(unsigned long long) * (size_t)ilc_data->flag_num );
+					memcpy( header->magic, ILC_COUNT_MAGIC, sizeof(header->magic) );
+					header->num = (long long)ilc_data->flag_num;
+					free( ilc_data->count );
+					ilc_data->count = count;
+					ilc_data->count_map = (char*)ptr;
+					ilc_data->count_map_size = size;
+					ret = ILC_SUCCESS;
+				}
+			}
+			close( fd );
+		}
+	}
+
+	/* ILC: ilc_map終了 */
+	return ret;
+}
+
+
+/**
+ * マップしたファイル・共有メモリ上の通過フラグを、指定した通過フラグに加える
+ * fork した子プロセスは、親と共有するマップにのみ通過フラグを書き込むため。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @param char*     通過フラグ(flag_num個以上)
+ */
+static void ilc_map_collect (
+	ILC_DATA* ilc_data,
+	char* flag
+)
+{
+	/**/
+	long ix;
+	/**/
+	/* ILC: ilc_map_collect開始 */
+
+	for ( ix = 0; ilc_data->map != NULL && ix < ilc_data->flag_num; ix++ ) {
+		/* ILC: ファイル上で '1' になっている計測ポイント */
+		if ( (ilc_data->map)[ (ilc_data->offset)[ix] ] == '1' ) {
+			/* ILC: 通過済み */
+			flag[ix] = 1;
+		}
+	}
+	for ( ix = 0; ilc_data->shm_flag != NULL && ix < ilc_data->flag_num; ix++ ) {
+		/* ILC: 共有メモリ上でフラグが立っている計測ポイント */
+		if ( (ilc_data->shm_flag)[ix] != 0 ) {
+			/* ILC: 通過済み */
+			flag[ix] = 1;
+		}
+	}
+
+	/* ILC: ilc_map_collect終了 */
+}
+
+
+/**
+ * 計測ポイントを名前つきの共有メモリに置く(ILC_MODE_SHM)
+ * バイナリ形式のILCカバレッジデータファイルと同じ列の並びで作成し、
+ * 以後は __ilc_check が共有メモリ上のフラグ・通過回数を更新する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return ILC_SUCCESS:作成成功
+ *         ILC_WARN   :作成できない(共有メモリなしで計測を続ける)
+ */
+static ILC_ERROR ilc_shm_open (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	ILC_SHM_HEADER* header;
+	const char* name;
+	char* ptr;
+	size_t str_size = 0;
+	size_t size;
+	long num = ilc_data->flag_num;
+	long ix;
+	int fd = -1;
+	unsigned int flags = 0;
+	ILC_ERROR ret = ILC_WARN;
+	/**/
+	/* ILC: ilc_shm_open開始 */
+
+	name = getenv( ILC_ENV_SHM );
+	__ilc_shm_name = (char*)malloc( ( name != NULL ? strlen( name ) : sizeof(ILC_SHM_PREFIX) + 20 ) + 2 );
+	if ( __ilc_shm_name != NULL && name != NULL ) {
+		/* ILC: 指定された名前(先頭の '/' は省略できる) */
+		sprintf( __ilc_shm_name, "%s%s", ( name[0] == '/' ) ? "" : "/", name );
+	}
+	else if ( __ilc_shm_name != NULL ) {
+		/* ILC: "/ilc.プロセスID" */
+		sprintf( __ilc_shm_name, ILC_SHM_PREFIX "%ld", (long)getpid() );
+	}
+
+	if ( (ilc_data->mode & ILC_MODE_COUNT) != 0 && ilc_data->count_map == NULL ) {
+		/* ILC: 通過回数も共有メモリに置く(通過回数ファイルにマップ済みの場合はそちらを使う) */
+		flags |= ILC_DAT_HAS_COUNT;
+	}
+	for ( ix = 0; ix < ilc_data->name_num; ix++ ) {
+		/* ILC: 文字列表のサイズ */
+		str_size += strlen( (ilc_data->name)[ix] ) + 1;
+	}
+	str_size = (str_size + 7) & ~(size_t)7;
+	size = sizeof(ILC_SHM_HEADER) + str_size
+		 + ( (flags & ILC_DAT_HAS_COUNT) != 0 ? sizeof(unsigned long long) * (size_t)num : 0 )
+		 + (sizeof(unsigned int) * 2 + sizeof(int) + 1) * (size_t)num;
+
+	if ( __ilc_shm_name != NULL && num > 0 ) {
+		/* ILC: 前回異常終了した同じ名前の共有メモリは作り直す */
+		shm_unlink( __ilc_shm_name );
+		fd = shm_open( __ilc_shm_name, O_RDWR | O_CREAT | O_EXCL, 0644 );
+	}
+	if ( fd >= 0 ) {
+		/* ILC: サイズを確定してからマップする */
+		ptr = ( ftruncate( fd, (off_t)size ) == 0 ) ? (char*)mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) : (char*)MAP_FAILED;
+		close( fd );
+		if ( ptr != (char*)MAP_FAILED ) {
+			/* ILC: マップ成功 */
+			ilc_data->shm = ptr;
+			ilc_data->shm_size = size;
+			ret = ILC_SUCCESS;
+		}
+		else {
+			/* ILC: 作成した共有メモリは使わないので削除する */
+			shm_unlink( __ilc_shm_name );
+		}
+	}
+
+	if ( ret == ILC_SUCCESS ) {
+		/* ILC: ヘッダの後ろに各列を並べる */
+		header = (ILC_SHM_HEADER*)ptr;
+		ptr += sizeof(ILC_SHM_HEADER);
+		for ( ix = 0; ix < ilc_data->name_num; ix++ ) {
+			/* ILC: 文字列表(IDの順) */
+			strcpy( ptr, (ilc_data->name)[ix] );
+			ptr += strlen( (ilc_data->name)[ix] ) + 1;
+		}
+		ptr = ilc_data->shm + sizeof(ILC_SHM_HEADER) + str_size;
+		if ( (flags & ILC_DAT_HAS_COUNT) != 0 ) {
+			/* ILC: 現在の累計を書き込み、以後は共有メモリ上で加算する */
+			memcpy( ptr, ilc_data->count, sizeof(unsigned long long) * (size_t)num );
+			free( ilc_data->count );
+			ilc_data->count = (unsigned long long*)ptr;
+			ptr += sizeof(unsigned long long) * (size_t)num;
+		}
+		for ( ix = 0; ix < num; ix++ ) {
+			/* ILC: ファイル名のID */
+			((unsigned int*)ptr)[ix] = (unsigned int)(ilc_data->file_id)[ix];
+		}
+		ptr += sizeof(unsigned int) * (size_t)num;
+		for ( ix = 0; ix < num; ix++ ) {
+			/* ILC: 関数名のID */
+			((unsigned int*)ptr)[ix] = (unsigned int)(ilc_data->func_id)[ix];
+		}
+		ptr += sizeof(unsigned int) * (size_t)num;
+		memcpy( ptr, ilc_data->line, sizeof(int) * (size_t)num );
+		ptr += sizeof(int) * (size_t)num;
+		for ( ix = 0; ix < num; ix++ ) {
+			/* ILC: フラグ */
+			ptr[ix] = ( (ilc_data->flag)[ix] != 0 ) ? ILC_DAT_FLAG_COVERED : 0;
+		}
+		ilc_data->shm_flag = (unsigned char*)ptr;
+
+		header->endian = ILC_DAT_ENDIAN;
+		header->flags = flags;
+		header->num = (long long)num;
+		header->str_num = (long long)ilc_data->name_num;
+		header->str_size = (long long)str_size;
+		header->pid = (long long)getpid();
+		header->size = (long long)size;
+		header->sampling = (long long)ilc_data->sampling;
+
+		/* 内容が揃ってから識別子を書き込む */
+		__atomic_thread_fence( __ATOMIC_RELEASE );
+		memcpy( header->magic, ILC_SHM_MAGIC, sizeof(header->magic) );
+	}
+	else {
+		/* ILC: 共有メモリなしで計測を続ける */
+		free( __ilc_shm_name );
+		__ilc_shm_name = NULL;
+	}
+
+	/* ILC: ilc_shm_open終了 */
+	return ret;
+}
+
+
+/**
+ * 共有メモリ(ILC_MODE_SHM)の名前を削除する
+ * マップは ilc_free で解除する。fork した子プロセスは削除しない。
+ */
+static void ilc_shm_unlink (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_shm_unlink開始 */
+
+	if ( __ilc_shm_name != NULL ) {
+		/* ILC: 作成したプロセスだけが削除する */
+		if ( __ilc_fork_child == 0 ) {
+			/* ILC: 以後、ilc-top からは参照できない */
+			shm_unlink( __ilc_shm_name );
+		}
+		free( __ilc_shm_name );
+		__ilc_shm_name = NULL;
+	}
+
+	/* ILC: ilc_shm_unlink終了 */
+}
+
+
+/**
+ * スナップショットを要求するシグナルのハンドラ(ILC_MODE_SIGNAL)
+ * 書き出しスレッドに通知するだけで、ファイルの書き出しは行わない。
+ * @param int シグナル番号
+ */
+static void ilc_writer_signal (
+	int signo
+)
+{
+	/**/
+	int err = errno;
+	/**/
+	/* ILC: ilc_writer_signal開始 */
+
+	/* sem_postはシグナルハンドラから呼び出せる */
+	sem_post( &__ilc_writer_sem );
+	errno = err;
+
+	/* ILC: ilc_writer_signal終了 */
+}
+
+
+/**
+ * スナップショットの書き出しスレッド(ILC_MODE_SIGNAL)
+ * シグナルハンドラから通知されるたびに ILC_Snapshot を呼び出す。
+ * @param void* 未使用
+ * @return NULL
+ */
+static void* ilc_writer_main (
+	void* arg
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_writer_main開始 */
+
+	while ( __atomic_load_n( &__ilc_writer_stop, __ATOMIC_ACQUIRE ) == 0 ) {
+		/* ILC: 通知を待つ */
+		if ( sem_wait( &__ilc_writer_sem ) != 0 ) {
+			/* ILC: シグナルによる中断(EINTR)は待ち直す */
+			continue;
+		}
+		if ( __atomic_load_n( &__ilc_writer_stop, __ATOMIC_ACQUIRE ) == 0 ) {
+			/* ILC: スナップショット要求 */
+			ILC_Snapshot( NULL );
+		}
+	}
+
+	/* ILC: ilc_writer_main終了 */
+	return NULL;
+}
+
+
+/**
+ * スナップショットの書き出しスレッドを開始し、シグナルハンドラを設定する
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :開始できなかった(シグナルでのスナップショットは行わない)
+ */
+static ILC_ERROR ilc_writer_start (
+)
+{
+	/**/
+	struct sigaction act;
+	sigset_t mask;
+	sigset_t oldmask;
+	ILC_ERROR ret = ILC_WARN;
+	/**/
+	/* ILC: ilc_writer_start開始 */
+
+	__atomic_store_n( &__ilc_writer_stop, 0, __ATOMIC_RELEASE );
+	if ( __ilc_writer_running == 0 && sem_init( &__ilc_writer_sem, 0, 0 ) == 0 ) {
+		/* ILC: 書き出しスレッドはシグナルを受け取らないよう、すべてブロックして作成する */
+		sigfillset( &mask );
+		pthread_sigmask( SIG_SETMASK, &mask, &oldmask );
+		if ( pthread_create( &__ilc_writer, NULL, ilc_writer_main, NULL ) == 0 ) {
+			/* ILC: スレッド作成成功 */
+			__ilc_writer_running = 1;
+			ret = ILC_SUCCESS;
+		}
+		else {
+			/* ILC: スレッド作成失敗 */
+			sem_destroy( &__ilc_writer_sem );
+		}
+		pthread_sigmask( SIG_SETMASK, &oldmask, NULL );
+	}
+
+	if ( ret == ILC_SUCCESS ) {
+		/* ILC: シグナルハンドラを設定する */
+		memset( &act, 0, sizeof(act) );
+		act.sa_handler = ilc_writer_signal;
+		act.sa_flags = SA_RESTART;
+		sigemptyset( &act.sa_mask );
+		sigaction( ILC_SNAPSHOT_SIGNAL, &act, &__ilc_writer_oldact );
+	}
+
+	/* ILC: ilc_writer_start終了 */
+	return ret;
+}
+
+
+/**
+ * スナップショットの書き出しスレッドを終了し、シグナルハンドラを元に戻す
+ */
+static void ilc_writer_stop (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_writer_stop開始 */
+
+	if ( __ilc_writer_running != 0 ) {
+		/* ILC: シグナルハンドラを戻してから、スレッドに終了を通知する */
+		sigaction( ILC_SNAPSHOT_SIGNAL, &__ilc_writer_oldact, NULL );
+		__atomic_store_n( &__ilc_writer_stop, 1, __ATOMIC_RELEASE );
+		sem_post( &__ilc_writer_sem );
+		pthread_join( __ilc_writer, NULL );
+		sem_destroy( &__ilc_writer_sem );
+		__ilc_writer_running = 0;
+	}
+
+	/* ILC: ilc_writer_stop終了 */
+}
+
+
+/**
+ * 環境変数 ILC_MODE の値を動作モードに変換する
+ * 数値、または "count,thread" のように名前をカンマ区切りで指定する。
+ * @param const char* 環境変数の値(NULL可)
+ * @return ILC_MODE_xxx の論理和
+ */
+static int ilc_mode_parse (
+	const char* str
+)
+{
+	/**/
+	static const struct _modes {	/* 名前と動作モードの対応 */
+		const char* name;
+		int         mode;
+	}
+	modes[] = {
+		{ "flag",   ILC_MODE_FLAG   },
+		{ "count",  ILC_MODE_COUNT  },
+		{ "thread", ILC_MODE_THREAD },
+		{ "mmap",   ILC_MODE_MMAP   },
+		{ "signal", ILC_MODE_SIGNAL },
+		{ "shm",    ILC_MODE_SHM    },
+		{ NULL,     0               }
+	};
+	const struct _modes* ptr;
+	char* end;
+	size_t len;
+	int mode = 0;
+	/**/
+	/* ILC: ilc_mode_parse開始 */
+
+	if ( str != NULL ) {
+		/* ILC: 数値ならそのまま使用する */
+		mode = (int)strtol( str, &end, 0 );
+		if ( end != str && *end == '\0' ) {
+			/* ILC: 数値の指定 */
+			str = NULL;
+		}
+		else {
+			/* ILC: 名前の指定 */
+			mode = 0;
+		}
+	}
+
+	while ( str != NULL && *str != '\0' ) {
+		/* ILC: カンマ区切りの名前を1つずつ調べる */
+		len = strcspn( str, ",|" );
+		for ( ptr = &modes[0]; ptr->name != NULL; ptr++ ) {
+			/* ILC: 名前が一致した動作モードを加える(未知の名前は無視する) */
+			if ( strlen( ptr->name ) == len && strncmp( ptr->name, str, len ) == 0 ) {
+				/* ILC: 一致 */
+				mode |= ptr->mode;
+			}
+		}
+		str += len;
+		if ( *str != '\0' ) {
+			/* ILC: 区切りを飛ばす */
+			str++;
+		}
+	}
+
+	/* ILC: ilc_mode_parse終了 */
+	return mode;
+}
+
+
+/**
+ * プログラム開始時に、環境変数の設定でILCカバレッジデータを展開する
+ * __ilc_no_auto が定義されている場合は何もしない。
+ */
+static void ilc_auto_init (
+)
+{
+	/**/
+	const char* sample;
+	/**/
+	/* ILC: ilc_auto_init開始 */
+
+	if ( &__ilc_no_auto == NULL && __ilc_data.flag == NULL ) {
+		/* ILC: 自動初期化する */
+		/* ILC_FILE がなければ ilc.dat を使用する */
+		ILC_SetMode( ilc_mode_parse( getenv( ILC_ENV_MODE ) ) );
+		if ( (sample = getenv( ILC_ENV_SAMPLE )) != NULL ) {
+			/* ILC: 通過回数の標本化 */
+			ILC_SetSampling( atol( sample ) );
+		}
+		if ( ILC_Initialize( getenv( ILC_ENV_FILE ) ) != ILC_FAILURE ) {
+			/* ILC: プログラムが ILC_Initialize を呼んだ場合は、こちらを破棄する */
+			__ilc_auto = 1;
+		}
+	}
+
+	/* ILC: ilc_auto_init終了 */
+}
+
+
+/**
+ * プログラム終了時(exit、mainからのreturn)に、ILCカバレッジデータを書き出す
+ * ILC_Finalize が呼ばれていれば何もしない。
+ */
+static void ilc_atexit (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_atexit開始 */
+
+	if ( __ilc_data.flag != NULL ) {
+		/* ILC: ILC_Finalize されていない */
+		if ( __ilc_auto != 0 && __ilc_data.num == 0 ) {
+			/* ILC: 自動初期化で計測ポイントがない(計測対象のプログラムでない)場合は、ファイルを作らない */
+			ilc_discard();
+		}
+		else {
+			/* ILC: 一時ファイルに書き出してから置き換える */
+			/* exit は他のスレッドを止めないため、__ilc_check_id が参照するメモリは解放しない */
+			ilc_finalize( 0 );
+		}
+	}
+
+	/* ILC: ilc_atexit終了 */
+}
+
+
+/**
+ * ILCカバレッジデータを書き出さずに終了する(プログラム終了時のみ)
+ * 書き出しスレッドと異常終了時のハンドラも元に戻す。
+ * 他のスレッドが計測を続けている可能性があるため、メモリは解放しない。
+ */
+static void ilc_discard (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_discard開始 */
+
+	ilc_writer_stop();
+
+	pthread_mutex_lock( &__ilc_data_lock );
+
+	/* マップしたファイルはそのまま残す(解除はプロセスの終了時に行われる) */
+	ilc_crash_uninstall();
+	ilc_shm_unlink();
+	__ilc_recovered = 0;
+	__ilc_auto = 0;
+
+	pthread_mutex_unlock( &__ilc_data_lock );
+
+	/* ILC: ilc_discard終了 */
+}
+
+
+/**
+ * 異常終了時の書き出し用ハンドラを設定する
+ * ハンドラが設定されていない(SIG_DFL)シグナルのみ対象とする。
+ */
+static void ilc_crash_install (
+)
+{
+	/**/
+	struct sigaction act;
+	struct sigaction old;
+	int ix;
+	/**/
+	/* ILC: ilc_crash_install開始 */
+
+	/* 一時ファイル名: ファイル名 + "." + プロセスID + ".tmp" */
+	free( __ilc_crash_tmp );
+	__ilc_crash_tmp = (char*)malloc( strlen( __ilc_data.filename ) + 1 + 20 + sizeof(ILC_TMP_SUFFIX) );
+	if ( __ilc_crash_tmp != NULL ) {
+		/* ILC: 一時ファイル名を作成できた場合のみ、ハンドラを設定する */
+		sprintf( __ilc_crash_tmp, "%s.%ld" ILC_TMP_SUFFIX, __ilc_data.filename, (long)getpid() );
+
+		memset( &act, 0, sizeof(act) );
+		act.sa_handler = ilc_crash_signal;
+		act.sa_flags = SA_RESETHAND;	/* ハンドラに入った時点で SIG_DFL に戻す */
+		sigemptyset( &act.sa_mask );
+
+		for ( ix = 0; __ilc_crash_signals[ix] != 0; ix++ ) {
+			/* ILC: プログラムがハンドラを設定していないシグナルのみ */
+			if ( __ilc_crash_installed[ix] == 0 &&
+				 sigaction( __ilc_crash_signals[ix], NULL, &old ) == 0 &&
+				 (old.sa_flags & SA_SIGINFO) == 0 && old.sa_handler == SIG_DFL ) {
+				/* ILC: ハンドラを設定する */
+				__ilc_crash_installed[ix] = ( sigaction( __ilc_crash_signals[ix], &act, NULL ) == 0 );
+			}
+		}
+	}
+
+	/* ILC: ilc_crash_install終了 */
+}
+
+
+/**
+ * 異常終了時の書き出し用ハンドラを元に戻す
+ */
+static void ilc_crash_uninstall (
+)
+{
+	/**/
+	struct sigaction act;
+	struct sigaction old;
+	int ix;
+	/**/
+	/* ILC: ilc_crash_uninstall開始 */
+
+	memset( &act, 0, sizeof(act) );
+	act.sa_handler = SIG_DFL;
+	sigemptyset( &act.sa_mask );
+
+	for ( ix = 0; __ilc_crash_signals[ix] != 0; ix++ ) {
+		/* ILC: 設定したハンドラのみ */
+		if ( __ilc_crash_installed[ix] != 0 &&
+			 sigaction( __ilc_crash_signals[ix], NULL, &old ) == 0 &&
+			 old.sa_handler == ilc_crash_signal ) {
+			/* ILC: プログラムが変更していなければ SIG_DFL に戻す */
+			sigaction( __ilc_crash_signals[ix], &act, NULL );
+		}
+		__ilc_crash_installed[ix] = 0;
+	}
+
+	free( __ilc_crash_tmp );
+	__ilc_crash_tmp = NULL;
+
+	/* ILC: ilc_crash_uninstall終了 */
+}
+
+
+/**
+ * 異常終了時のシグナルハンドラ
+ * 計測結果を書き出してから、シグナル本来の動作(SIG_DFL)で終了する。
+ * @param int シグナル番号
+ */
+static void ilc_crash_signal (
+	int signo
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_crash_signal開始 */
+
+	if ( __atomic_exchange_n( &__ilc_crash_running, 1, __ATOMIC_ACQ_REL ) == 0 ) {
+		/* ILC: 最初に異常終了したスレッドだけが書き出す */
+		ilc_crash_flush();
+	}
+
+	/* SA_RESETHAND で SIG_DFL に戻っているので、ハンドラから戻ると本来の動作で終了する */
+	/* (SIGSEGVなどは同じ命令で再発生し、SIGTERMなどはここで送りなおしたものが届く) */
+	raise( signo );
+
+	/* ILC: ilc_crash_signal終了 */
+}
+
+
+/**
+ * 異常終了時に計測結果を書き出す
+ * シグナルハンドラから呼ぶため、メモリ確保・stdio・ロックは使用せず、
+ * 事前に確保した一時ファイル名とバッファだけで書き出す。
+ */
+static void ilc_crash_flush (
+)
+{
+	/**/
+	ILC_SHARD* shard;
+	ILC_SITE* site;
+	long ix;
+	int fd;
+	int err;
+	/**/
+	/* ILC: ilc_crash_flush開始 */
+
+	if ( __ilc_data.flag == NULL || __ilc_crash_tmp == NULL ) {
+		/* ILC: 書き出すものがない(ILC_Finalize済み) */
+		return ;
+	}
+	if ( __ilc_auto != 0 && __ilc_data.num == 0 ) {
+		/* ILC: 自動初期化で計測ポイントがない場合は、ファイルを作らない(ilc_atexitと同じ判定) */
+		return ;
+	}
+
+	/* 異常終了するので、スレッド別・計測ポイント別の記録はロックせずに集計してよい */
+	for ( shard = __ilc_shard_list; shard != NULL; shard = shard->next ) {
+		/* ILC: 記録領域ごとに集計 */
+		if ( shard->generation != __ilc_data.generation || shard->num != __ilc_data.flag_num ) {
+			/* ILC: 以前の ILC_Initialize で作成した領域は対象外 */
+			continue;
+		}
+		for ( ix = 0; ix < shard->num; ix++ ) {
+			/* ILC: 通過フラグは論理和 */
+			(__ilc_data.flag)[ix] |= (shard->flag)[ix];
+		}
+		for ( ix = 0; shard->count != NULL && ix < shard->num; ix++ ) {
+			/* ILC: 通過回数は未集計分を加算 */
+			(__ilc_data.count)[ix] += (shard->count)[ix] - (shard->base)[ix];
+		}
+	}
+	for ( site = __ilc_site_list; site != NULL; site = site->next ) {
+		/* ILC: 計測ポイント(ilc -n)ごとに数えた通過回数も加算 */
+		if ( (unsigned long)site->id < (unsigned long)__ilc_data.flag_num ) {
+			/* ILC: 現在のILCカバレッジデータにある計測ポイント */
+			(__ilc_data.count)[ site->id ] += site->count;
+		}
+	}
+
+	if ( __ilc_fork_shared != 0 || (__ilc_data.map != NULL && __ilc_data.count_map == NULL &&
+		 __ilc_data.num == __ilc_data.flag_num && __ilc_recovered == 0) ) {
+		/* ILC: マップしたファイルに反映済みなので書き出さない(ILC_Finalizeと同じ判定) */
+		return ;
+	}
+
+	fd = open( __ilc_crash_tmp, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+	if ( fd >= 0 ) {
+		/* ILC: 1行ずつバッファに組み立てて書き出す */
+		__ilc_crash_len = 0;
+		for ( ix = 0; ix < __ilc_data.num; ix++ ) {
+			/**/
+			const char* file = (__ilc_data.name)[ (__ilc_data.file_id)[ix] ];
+			const char* func = (__ilc_data.name)[ (__ilc_data.func_id)[ix] ];
+			int line = (__ilc_data.line)[ix];
+			int covered = (__ilc_data.flag)[ix] != 0;
+			int with_count = 0;
+			/**/
+			/* ILC: ilc_writeと同じ形式で書き出す */
+			if ( ix < __ilc_data.flag_num ) {
+				/* ILC: ILC_Initialize時点の計測ポイントは通過回数を持つ */
+				covered |= ( (__ilc_data.count)[ix] != 0 );
+				with_count = (__ilc_data.mode & ILC_MODE_COUNT) != 0 || (__ilc_data.count)[ix] != 0;
+			}
+			ilc_crash_put( fd, covered ? "1:" : "0:", 2 );
+			ilc_crash_put( fd, file, strlen( file ) );
+			ilc_crash_put( fd, ":", 1 );
+			ilc_crash_put( fd, func, strlen( func ) );
+			ilc_crash_put( fd, ":", 1 );
+			ilc_crash_putnum( fd, line < 0 ? 0ULL - (unsigned long long)line : (unsigned long long)line, line < 0 );
+			if ( with_count != 0 ) {
+				/* ILC: 通過回数も書き出す */
+				ilc_crash_put( fd, ":", 1 );
+				ilc_crash_putnum( fd, (__ilc_data.count)[ix], 0 );
+			}
+			ilc_crash_put( fd, "\n", 1 );
+		}
+
+		/* 書き出しが完了したファイルで置き換える */
+		err = ilc_crash_drain( fd, 1 );
+		if ( close( fd ) == 0 && err == 0 ) {
+			/* ILC: 書き出し成功 */
+			rename( __ilc_crash_tmp, __ilc_data.filename );
+		}
+		else {
+			/* ILC: 書き出し失敗。元のファイルは変更しない */
+			unlink( __ilc_crash_tmp );
+		}
+	}
+
+	/* ILC: ilc_crash_flush終了 */
+}
+
+
+/**
+ * 異常終了時の書き出しバッファに文字列を追加する
+ * バッファが一杯になったら書き出す。
+ * @param int         ファイルディスクリプタ
+ * @param const char* 文字列
+ * @param size_t      文字列の長さ
+ */
+static void ilc_crash_put (
+	int fd,
+	const char* str,
+	size_t len
+)
+{
+	/**/
+	size_t size;
+	/**/
+	/* ILC: ilc_crash_put開始 */
+
+	while ( len > 0 && ilc_crash_drain( fd, 0 ) == 0 ) {
+		/* ILC: バッファに入る分だけコピーする(一杯なら先に書き出す) */
+		size = sizeof(__ilc_crash_buf) - __ilc_crash_len;
+		if ( size > len ) {
+			/* ILC: 残りがすべて入る */
+			size = len;
+		}
+		memcpy( __ilc_crash_buf + __ilc_crash_len, str, size );
+		__ilc_crash_len += size;
+		str += size;
+		len -= size;
+	}
+
+	/* ILC: ilc_crash_put終了 */
+}
+
+
+/**
+ * 異常終了時の書き出しバッファを書き出す
+ * @param int ファイルディスクリプタ
+ * @param int 0以外:すべて書き出す 0:バッファが一杯の場合のみ書き出す
+ * @return 0:成功 -1:書き出しエラー
+ */
+static int ilc_crash_drain (
+	int fd,
+	int all
+)
+{
+	/**/
+	ssize_t cnt;
+	/**/
+	/* ILC: ilc_crash_drain開始 */
+
+	while ( __ilc_crash_len > 0 && (all != 0 || __ilc_crash_len == sizeof(__ilc_crash_buf)) ) {
+		/* ILC: 書き出せた分だけバッファを詰める */
+		cnt = write( fd, __ilc_crash_buf, __ilc_crash_len );
+		if ( cnt <= 0 ) {
+			/* ILC: 書き出しエラー */
+			return -1;
+		}
+		memmove( __ilc_crash_buf, __ilc_crash_buf + cnt, __ilc_crash_len - (size_t)cnt );
+		__ilc_crash_len -= (size_t)cnt;
+	}
+
+	/* ILC: ilc_crash_drain終了 */
+	return 0;
+}
+
+
+/**
+ * 異常終了時の書き出しバッファに数値を追加する
+ * @param int                ファイルディスクリプタ
+ * @param unsigned long long 数値(の絶対値)
+ * @param int                0以外:負数として '-' をつける
+ */
+static void ilc_crash_putnum (
+	int fd,
+	unsigned long long num,
+	int minus
+)
+{
+	/**/
+	char buf[24];						/* 20桁 + '-' */
+	char* ptr = buf + sizeof(buf);
+	/**/
+	/* ILC: ilc_crash_putnum開始 */
+
+	do {
+		/* ILC: 下の桁から組み立てる */
+		*--ptr = (char)('0' + num % 10);
+		num /= 10;
+	} while ( num != 0 );
+	if ( minus != 0 ) {
+		/* ILC: 負数 */
+		*--ptr = '-';
+	}
+	ilc_crash_put( fd, ptr, (size_t)(buf + sizeof(buf) - ptr) );
+
+	/* ILC: ilc_crash_putnum終了 */
+}
+
+
+/**
+ * 子プロセスのファイル名の接頭辞(ファイル名.識別子)を作成する
+ * 識別子は「プロセスID-時刻-世代」とし、以前の実行や同じファイルを使う
+ * 他のプロセスが残したファイルと区別する。
+ * @param const char* ILCカバレッジデータファイル名
+ * @return 接頭辞。mallocで確保するため、不要になったらfreeすること。
+ *         NULL:メモリ確保エラー
+ */
+static char* ilc_fork_prefix (
+	const char* filename
+)
+{
+	/**/
+	char* prefix;
+	/**/
+	/* ILC: ilc_fork_prefix開始 */
+
+	/* ファイル名 + "." + プロセスID + "-" + 時刻 + "-" + 世代 */
+	prefix = (char*)malloc( strlen( filename ) + 1 + 20 + 1 + 20 + 1 + 20 + 1 );
+	if ( prefix != NULL ) {
+		/* ILC: 識別子をつける */
+		sprintf( prefix, "%s.%ld-%ld-%lu", filename, (long)getpid(), (long)time( NULL ), __ilc_data.generation );
+	}
+
+	/* ILC: ilc_fork_prefix終了 */
+	return prefix;
+}
+
+
+/**
+ * 文字列・プロセスID・接尾辞をつなげた名前を作成する
+ * fork 直後の子プロセスで使用するため、メモリの確保や stdio は使わない。
+ * @param char*       作成先(十分な大きさを確保しておくこと)
+ * @param const char* 先頭の文字列
+ * @param long        プロセスID("." の後ろにつける)
+ * @param const char* 接尾辞
+ */
+static void ilc_fork_name (
+	char* buf,
+	const char* str,
+	long pid,
+	const char* suffix
+)
+{
+	/**/
+	char num[24];
+	char* ptr = num + sizeof(num);
+	size_t len = strlen( str );
+	/**/
+	/* ILC: ilc_fork_name開始 */
+
+	do {
+		/* ILC: 下の桁から数字にする */
+		*--ptr = (char)('0' + pid % 10);
+		pid /= 10;
+	} while ( pid > 0 );
+
+	memcpy( buf, str, len );
+	buf[len++] = '.';
+	memcpy( buf + len, ptr, (size_t)(num + sizeof(num) - ptr) );
+	len += (size_t)(num + sizeof(num) - ptr);
+	strcpy( buf + len, suffix );
+
+	/* ILC: ilc_fork_name終了 */
+}
+
+
+/**
+ * fork の直前(親プロセス)に、ILCカバレッジデータの排他を取得する
+ * 子プロセスに書き出し途中・集計途中の状態を引き継がないようにする。
+ * 子プロセスで使うファイル名の領域もここで確保する。
+ */
+static void ilc_fork_prepare (
+)
+{
+	/**/
+	size_t len;
+	/**/
+	/* ILC: ilc_fork_prepare開始 */
+
+	/* ILC_Finalize と同じ順序で取得する */
+	pthread_mutex_lock( &__ilc_data_lock );
+	pthread_mutex_lock( &__ilc_shard_lock );
+
+	if ( __ilc_data.flag != NULL && __ilc_fork_prefix != NULL ) {
+		/* ILC: 子プロセスのファイル名(接頭辞 + "." + プロセスID) */
+		len = strlen( __ilc_fork_prefix ) + 1 + 20;
+		__ilc_fork_next = (char*)malloc( len + 1 );
+		if ( len < strlen( __ilc_data.filename ) ) {
+			/* ILC: 親とマップを共有する場合は、親のファイル名のまま */
+			len = strlen( __ilc_data.filename );
+		}
+		/* 異常終了時の一時ファイル名(ファイル名 + "." + プロセスID + ".tmp") */
+		__ilc_fork_next_tmp = (char*)malloc( len + 1 + 20 + sizeof(ILC_TMP_SUFFIX) );
+	}
+
+	/* ILC: ilc_fork_prepare終了 */
+}
+
+
+/**
+ * fork の直後(親プロセス)に、ILCカバレッジデータの排他を解放する
+ */
+static void ilc_fork_parent (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_fork_parent開始 */
+
+	/* 子プロセス用の領域は親では使わない */
+	free( __ilc_fork_next );
+	free( __ilc_fork_next_tmp );
+	__ilc_fork_next = NULL;
+	__ilc_fork_next_tmp = NULL;
+
+	pthread_mutex_unlock( &__ilc_shard_lock );
+	pthread_mutex_unlock( &__ilc_data_lock );
+
+	/* ILC: ilc_fork_parent終了 */
+}
+
+
+/**
+ * fork の直後(子プロセス)に、子プロセス用の計測に切り替える
+ * ILC_MODE_MMAP でマップ済みの場合は、親と同じマップに記録を続ける。
+ * それ以外は、fork 以降の通過だけを「ファイル名.識別子.プロセスID」に書き出すよう、
+ * 親から引き継いだ計測結果をクリアする。
+ * 親が複数のスレッドを持つ場合に備え、メモリは確保・解放しない
+ * (ファイル名は ilc_fork_prepare で確保した領域に作成する)。
+ */
+static void ilc_fork_child (
+)
+{
+	/**/
+	struct sigaction oldact;
+	/**/
+	/* ILC: ilc_fork_child開始 */
+
+	pthread_mutex_unlock( &__ilc_shard_lock );
+	pthread_mutex_unlock( &__ilc_data_lock );
+
+	if ( __ilc_data.flag != NULL ) {
+		/* ILC: 初期化済み */
+		__ilc_fork_child = 1;
+		__ilc_recovered = 0;
+
+		/* 他のスレッドの記録領域には、親プロセスで未集計の通過が残っている */
+		ilc_shard_reset( &__ilc_data, ILC_RESET_FLAG | ILC_RESET_COUNT );
+		ilc_site_reset( ILC_RESET_FLAG | ILC_RESET_COUNT );
+
+		if ( __ilc_data.map != NULL || __ilc_data.shm != NULL ) {
+			/* ILC: 親と共有するマップに記録を続ける。ファイルは書き出さない */
+			__ilc_fork_shared = 1;
+		}
+		else {
+			/* ILC: fork 以降の通過だけを、子プロセス用のファイルに書き出す */
+			memset( __ilc_data.flag, 0, (size_t)__ilc_data.num );
+			memset( __ilc_data.count, 0, sizeof(unsigned long long) * (size_t)__ilc_data.flag_num );
+
+			if ( __ilc_fork_next != NULL ) {
+				/* ILC: 子プロセス用のファイル名: ファイル名 + "." + 識別子 + "." + プロセスID */
+				ilc_fork_name( __ilc_fork_next, __ilc_fork_prefix, (long)getpid(), "" );
+				__ilc_fork_stale[0] = __ilc_fork_file;
+				__ilc_fork_file = __ilc_fork_next;
+				__ilc_fork_next = NULL;
+				__ilc_data.filename = __ilc_fork_file;
+			}
+			else {
+				/* ILC: ファイル名が作れない場合は、親のファイルを壊さないよう書き出さない */
+				__ilc_fork_shared = 1;
+			}
+		}
+
+		if ( __ilc_crash_tmp != NULL && __ilc_fork_next_tmp != NULL ) {
+			/* ILC: 異常終了時の一時ファイル名をこのプロセスのものに作り直す */
+			/* (ハンドラは親から引き継いでいる) */
+			ilc_fork_name( __ilc_fork_next_tmp, __ilc_data.filename, (long)getpid(), ILC_TMP_SUFFIX );
+			__ilc_fork_stale[1] = __ilc_crash_tmp;
+			__ilc_crash_tmp = __ilc_fork_next_tmp;
+			__ilc_fork_next_tmp = NULL;
+			__atomic_store_n( &__ilc_crash_running, 0, __ATOMIC_RELEASE );
+		}
+		else if ( __ilc_crash_tmp != NULL ) {
+			/* ILC: 一時ファイル名が作れない場合は、親の一時ファイル名で書き出さないよう、異常終了時は書き出さない */
+			__ilc_fork_stale[1] = __ilc_crash_tmp;
+			__ilc_crash_tmp = NULL;
+		}
+
+		if ( __ilc_writer_running != 0 ) {
+			/* ILC: 書き出しスレッドは子プロセスに引き継がれないので作り直す */
+			oldact = __ilc_writer_oldact;
+			__ilc_writer_running = 0;
+			if ( ilc_writer_start() == ILC_SUCCESS ) {
+				/* ILC: ハンドラは ILC_Finalize で親と同じものに戻す */
+				__ilc_writer_oldact = oldact;
+			}
+			else {
+				/* ILC: 開始できない場合はハンドラを戻す */
+				sigaction( ILC_SNAPSHOT_SIGNAL, &oldact, NULL );
+			}
+		}
+	}
+
+	/* ILC: ilc_fork_child終了 */
+}
+
+
+/**
+ * 子プロセスが書き出したファイル(ファイル名.識別子.プロセスID)を集計する
+ * 識別子が今回の ILC_Initialize のものと一致するファイルだけを対象とする。
+ * 通過フラグは論理和、通過回数は加算する。
+ * @param ILC_DATA* ILCカバレッジデータ
+ * @return 集計したファイル名のリスト(NULL終端)。書き出し後に削除し、freeすること。
+ *         NULL:子プロセスのファイルがない、またはメモリ確保エラー
+ */
+static char** ilc_fork_collect (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	const char* prefix = __ilc_fork_prefix;
+	const char* base;
+	size_t dir_len;
+	size_t base_len;
+	DIR* dir;
+	struct dirent* ent;
+	char* path;
+	char** list = NULL;
+	long num = 0;
+	ILC_DATA shard;
+	ILC_KEY key;
+	/**/
+	/* ILC: ilc_fork_collect開始 */
+
+	if ( prefix == NULL ) {
+		/* ILC: 子プロセスのファイル名が作れないため、子プロセスもファイルを書き出していない */
+		return NULL;
+	}
+
+	/* 子プロセスのファイルは同じディレクトリにある */
+	base = strrchr( prefix, '/' );
+	base = ( base != NULL ) ? base + 1 : prefix;
+	dir_len = (size_t)(base - prefix);
+	base_len = strlen( base );
+
+	path = (char*)malloc( dir_len + 2 );
+	if ( path != NULL ) {
+		/* ILC: ディレクトリ名を取り出す */
+		memcpy( path, prefix, dir_len );
+		strcpy( path + dir_len, ( dir_len > 0 ) ? "" : "." );
+	}
+	dir = ( path != NULL ) ? opendir( path ) : NULL;
+	free( path );
+
+	while ( dir != NULL && (ent = readdir( dir )) != NULL ) {
+		/**/
+		const char* ptr = ent->d_name + base_len + 1;
+		char** tmp;
+		long ix;
+		/**/
+		/* ILC: 「ファイル名.識別子.数字」のみ対象(識別子の違うファイルは他の実行のもの) */
+		if ( strncmp( ent->d_name, base, base_len ) != 0 || ent->d_name[base_len] != '.' ||
+			 *ptr == '\0' || strspn( ptr, "0123456789" ) != strlen( ptr ) ) {
+			/* ILC: 対象外 */
+			continue;
+		}
+
+		tmp = (char**)realloc( list, sizeof(char*) * (size_t)(num + 2) );
+		if ( tmp != NULL ) {
+			/* ILC: リストの拡張成功 */
+			list = tmp;
+			list[num] = NULL;
+		}
+		path = ( tmp != NULL ) ? (char*)malloc( dir_len + strlen( ent->d_name ) + 1 ) : NULL;
+		if ( path == NULL ) {
+			/* ILC: メモリ確保エラー。残りは次回の ILC_Finalize で集計する */
+			break;
+		}
+		memcpy( path, prefix, dir_len );
+		strcpy( path + dir_len, ent->d_name );
+
+		memset( &shard, 0, sizeof(shard) );
+		if ( ilc_fopen( path, &shard ) != ILC_SUCCESS ) {
+			/* ILC: 読み込めないファイルは削除しない */
+			free( path );
+			continue;
+		}
+
+		for ( ix = 0; ix < shard.num; ix++ ) {
+			/**/
+			const char* file = (shard.name)[ (shard.file_id)[ix] ];
+			const char* func = (shard.name)[ (shard.func_id)[ix] ];
+			long file_id = ilc_name_search( ilc_data, file, strlen( file ) );
+			long func_id = ilc_name_search( ilc_data, func, strlen( func ) );
+			long id = -1;
+			/**/
+			/* ILC: 同じ計測ポイントに集計する */
+			if ( file_id >= 0 && func_id >= 0 ) {
+				/* ILC: ファイル名・関数名が登録済み */
+				id = ilc_point_search( ilc_data, file_id, func_id, (shard.line)[ix] );
+			}
+			if ( id < 0 ) {
+				/**/
+				char* str = (char*)malloc( strlen( file ) + strlen( func ) + 32 );
+				/**/
+				/* ILC: 子プロセスで追加された計測ポイント */
+				if ( str != NULL ) {
+					/* ILC: 末尾に追加する */
+					sprintf( str, "0:%s:%s:%d", file, func, (shard.line)[ix] );
+					if ( ilc_point_add( ilc_data, str, &key ) == ILC_SUCCESS ) {
+						/* ILC: 追加成功 */
+						id = ilc_data->num - 1;
+					}
+					free( str );
+				}
+			}
+			if ( id >= 0 ) {
+				/* ILC: 通過回数は ILC_Initialize 時点の計測ポイントのみ持つ */
+				(ilc_data->flag)[id] |= (shard.flag)[ix] | ( (shard.count)[ix] != 0 );
+				if ( id < ilc_data->flag_num ) {
+					/* ILC: 通過回数の加算 */
+					(ilc_data->count)[id] += (shard.count)[ix];
+				}
+			}
+		}
+		ilc_free( &shard );
+
+		list[num++] = path;
+		list[num] = NULL;
+	}
+
+	if ( dir != NULL ) {
+		/* ILC: ディレクトリの読み込み終了 */
+		closedir( dir );
+	}
+
+	/* ILC: ilc_fork_collect終了 */
+	return list;
+}
+
+
+
+/**
+ * ファイルのILCカバレッジデータをメモリに展開する
+ * @param const char* ILCカバレッジデータファイル名
+ *                    NULLの場合、またはファイルが存在しない場合は ilc.dat を読み込む
+ * @return ILC_ERROR  ILC_SUCCESS: 成功
+ *                    ILC_WARN   : 指定したファイルがないため、 ilc.dat を使用（続行可能）
+ *                    ILC_FAILURE: メモリ展開に失敗（続行不可）
+ */
+ILC_ERROR ILC_Initialize (
+	const char* ilc_file
+)
+{
+	/**/
+	ILC_ERROR ret = ILC_FAILURE;
+	struct _files {				/* 読み込みファイルとその戻り値のリスト */
+		const char* filename;	/*   ILCカバレッジデータファイル名 */
+		ILC_ERROR   ret;		/*   ILC_Initializeの戻り値 */
+	}
+	files[] = {
+		{ ilc_file,         ILC_SUCCESS },	/* 指定されたファイル名 */
+		{ ILC_FILE_DEFAULT, ILC_WARN    },	/* デフォルトのファイル名 */
+		{ NULL,             ILC_FAILURE }	/* エラー */
+	};
+	struct _files* ptr;
+	/**/
+	/* ILC: ILC_Initialize開始 */
+
+	if ( __ilc_auto != 0 ) {
+		/* ILC: プログラムが自分で初期化する場合、自動初期化した内容は書き出さずに破棄する */
+		/* 読み込んだ計測ポイントに新しいファイルを追加して展開しないよう、メモリも解放する */
+		ilc_discard();
+		pthread_mutex_lock( &__ilc_data_lock );
+		ilc_release();
+		pthread_mutex_unlock( &__ilc_data_lock );
+	}
+
+	/* 新たに初期化したプロセスは、子プロセスのファイルを集計する側になる */
+	__ilc_fork_child = 0;
+	__ilc_fork_shared = 0;
+	free( __ilc_fork_file );
+	__ilc_fork_file = NULL;
+
+	/* 以前のスレッド別記録領域を使用しないよう、世代を進める */
+	pthread_mutex_lock( &__ilc_shard_lock );
+	__ilc_data.generation++;
+	pthread_mutex_unlock( &__ilc_shard_lock );
+	ilc_site_reset( ILC_RESET_FLAG | ILC_RESET_COUNT );
+
+	/* ファイルがまったく存在しないときのため、デフォルト値を設定しておく */
+	__ilc_data.filename = ILC_FILE_DEFAULT;
+
+	for ( ptr = &files[0]; ptr->ret != ILC_FAILURE; ptr++ ) {
+		/* ILC: ループ終了条件：ILC_FAILUREを検出 */
+		if ( ilc_fopen( ptr->filename, &__ilc_data ) != ILC_FAILURE ) {
+			/* ILC: open成功、もしくは新規ファイル */
+			ret = ptr->ret;
+			__ilc_data.filename = (char*)ptr->filename;
+			break;
+		}
+	}
+
+	if ( ret != ILC_FAILURE && ilc_registry_add( &__ilc_data ) != ILC_SUCCESS ) {
+		/* ILC: 実行ファイルに埋め込まれた計測ポイントが登録できないため続行不可 */
+		ret = ILC_FAILURE;
+	}
+
+	if ( ret != ILC_FAILURE ) {
+		/* ILC: 通過フラグ(1計測ポイント1バイト)と通過回数の作成 */
+		/* ファイルから読み込んだ場合は、展開時に作成済み */
+		if ( __ilc_data.count == NULL ) {
+			/* ILC: 新規ファイル */
+			__ilc_data.count = (unsigned long long*)calloc( (size_t)__ilc_data.num + 1, sizeof(unsigned long long) );
+		}
+		if ( __ilc_data.count != NULL && ilc_reserve( &__ilc_data, __ilc_data.num + 1 ) == ILC_SUCCESS ) {
+			/* ILC: 通過フラグの作成に成功 */
+			__ilc_data.flag_num = __ilc_data.num;
+
+			/* 前回異常終了した場合の通過回数を反映する */
+			__ilc_recovered = ilc_count_recover( &__ilc_data );
+
+			/* __ilc_checkで使用する検索用ハッシュ表を作成 */
+			/* 作成に失敗しても線形検索で動作するため、エラーにはしない */
+			ilc_index_build( &__ilc_data, __ilc_data.num );
+
+			if ( (__ilc_data.mode & ILC_MODE_MMAP) != 0 ) {
+				/* ILC: ファイルをマップする */
+				/* マップできなくても、ILC_Finalizeで書き出すためエラーにはしない */
+				ilc_map( &__ilc_data );
+			}
+
+			if ( (__ilc_data.mode & ILC_MODE_SHM) != 0 ) {
+				/* ILC: 共有メモリに置き、外部から参照できるようにする */
+				/* 作成できなくても計測はできるため、エラーにはしない */
+				ilc_shm_open( &__ilc_data );
+			}
 
-	while ( feof( fp ) == 0 ) {
-		/* ILC: feofは正常終了。それ以外は異常終了 */
+			if ( (__ilc_data.mode & ILC_MODE_SIGNAL) != 0 ) {
+				/* ILC: シグナルでスナップショットを書き出す */
+				/* 開始できなくても、ILC_Finalizeで書き出すためエラーにはしない */
+				ilc_writer_start();
+			}
 
-		str = __fgetln( fp, &len );
-		if ( str != NULL && len != 0 ) {
-			/* ILC: ILCカバレッジデータへの追加 */
-			
-			if ( ILC_Append( ilc_data, str ) == ILC_FAILURE ) {
-				/**/
-				long ix;
-				/**/
-				/* ILC: ILCカバレッジデータへのデータ追加に失敗 */
-				for ( ix = 0; ix < ilc_data->num; ix++ ) {
-					/* ILC: メモリ解放中 */
-					free( (ilc_data->coverage)[ix] );
+			/* fork した子プロセスは「ファイル名.識別子.プロセスID」に書き出し、親の ILC_Finalize で集計する */
+			/* 作成できない場合、子プロセスはファイルを書き出さない */
+			free( __ilc_fork_prefix );
+			__ilc_fork_prefix = ilc_fork_prefix( __ilc_data.filename );
+			if ( __ilc_fork_registered == 0 ) {
+				/* ILC: fork 時の処理は1回だけ登録する */
+				__ilc_fork_registered = ( pthread_atfork( ilc_fork_prepare, ilc_fork_parent, ilc_fork_child ) == 0 );
+			}
+
+			if ( &__ilc_no_auto == NULL ) {
+				/* ILC: ILC_Finalize が呼ばれずに終了した場合も書き出す */
+				/* 設定できなくても、ILC_Finalizeで書き出すためエラーにはしない */
+				ilc_crash_install();
+				if ( __ilc_atexit_registered == 0 ) {
+					/* ILC: 終了時の書き出しは1回だけ登録する */
+					__ilc_atexit_registered = ( atexit( ilc_atexit ) == 0 );
 				}
-				ret = ILC_FAILURE;
-				break;
 			}
-			
 		}
-		else if ( len != 0 ) {
-			/**/
-			long ix;
-			/**/
-			/* ILC: ファイルからの読み込みに失敗 */
-			for ( ix = 0; ix < ilc_data->num; ix++ ) {
-				/* ILC: メモリ解放中 */
-				free( (ilc_data->coverage)[ix] );
-			}
+		else {
+			/* ILC: 通過フラグが作成できないため続行不可 */
 			ret = ILC_FAILURE;
-			break;
 		}
-		/* len == 0 は改行のみの行（e.g. 行末） */
 	}
 
-	/* ILC: ilc_deploy終了 */
+	/* ILC: ILC_Initialize終了 */
 	return ret;
 }
 
 
+
 /**
- * ファイルより1行(最大LONG_MAX文字)読み込む
- * mallocでメモリを確保するため、文字列を使用しなくなった場合はfreeをすること。
- * @param FILE* ファイルポインタ
- * @param size_t* 読み込んだ文字列の長さ
- * @return 読み込んだ文字列。改行文字(CR/LF)を含まないNULL終端文字列。
- *         NULLの場合は、何らかのエラー。
+ * 動作モードを設定する
+ * ILC_Initialize の前に呼び出すこと。
+ * @param int ILC_MODE_xxx の論理和
+ * @return ILC_SUCCESS
  */
-static char* __fgetln (
-	FILE* fp,
-	size_t* len	/* OUT */
+ILC_ERROR ILC_SetMode (
+	int mode
 )
 {
 	/**/
-#ifndef LONG_MAX
-#define LONG_MAX (2147483647)
-#endif /* LONG_MAX */
-	char *str;
-	unsigned int size = 32;		/* バッファの初期値:32 */
-	unsigned int cnt;
-	int ch;
 	/**/
-	/* ILC: __fgetln開始 */
+	/* ILC: ILC_SetMode開始 */
 
-	str = (char*) malloc( size );
- 
-	if ( str != NULL ) {
-		/* ILC: 初期バッファ確保成功 */
-
-		for ( cnt = 0; (ch = fgetc( fp )) != EOF ; cnt++ ) {
-			/* ILC: EOFでループ終了。または\r/\nでbreak */
-
-			if ( cnt == size ) {
-				/* ILC: バッファサイズの拡大 */
-				size *= 2;
-				if ( size > LONG_MAX ) {
-					/* ILC: 最大読み込み文字数を超えたのでエラー(NULLを返す) */
-					free( str );
-					str = NULL;
-				}
-				str = realloc( str, size );
-				if ( str == NULL ) {
-					/* ILC: メモリが確保できない場合はNULLを返す */
-					break;
-				}
-			}
-			if ( ch == '\r' ) {
-				/* \rを検出した場合は、もう一文字読み込み改行コードを調べる */
-				ch = fgetc( fp );
-				if ( ch == EOF || ch == '\n' ) {
-					/* EOFなら改行はCRなので、そのままbreak。\nなら改行をCRLFとみなしてbreak */
-					break;
-				}
-				else {
-					/* ILC: \n以外は改行はCRなので、読み込んだ文字を戻してbreak */
-					ungetc( ch, fp );
-					break;
-				}
-			}
-			else if ( ch == '\n' ) {
-				/* ILC: LFは無条件にbreak */
-				break;
-			}
-			else {
-				/* ILC: 改行文字以外なら、バッファに格納 */
-				str[cnt] = (char)ch;
-			}
-		}
-		if ( str != NULL ) {
-			/* ILC: NULL終端して、長さを設定して終了 */
-			str[cnt] = '\0';
-			*len = (size_t)cnt;
-		}
-	}
+	__ilc_data.mode = mode;
 
-	/* ILC: __fgetln終了 */
-	return str;
+	/* ILC: ILC_SetMode終了 */
+	return ILC_SUCCESS;
 }
 
+
 /**
- * ファイルに１行書き出す
- * @param FILE*       ファイルポインタ
- * @param const char* 書き出す文字列
+ * 通過回数の標本化の間隔を設定する
+ * ILC_Initialize の前に呼び出すこと。
+ * @param long 平均 N 回に1回だけ数え、N を加算する(1以下:すべて数える)
+ * @return ILC_SUCCESS
  */
-static void ilc_fout (
-	FILE* fp,
-	const char* str
+ILC_ERROR ILC_SetSampling (
+	long sampling
 )
 {
 	/**/
 	/**/
-	/* ILC: ilc_fout開始 */
+	/* ILC: ILC_SetSampling開始 */
 
-	fprintf( fp, "%s\n", str );
+	__ilc_data.sampling = sampling;
 
-	/* ILC: ilc_fout終了 */
-	return ;
+	/* ILC: ILC_SetSampling終了 */
+	return ILC_SUCCESS;
 }
 
 
 /**
- * ilc_foutの何もしない版
- * @param FILE*
- * @param const char*
+ * メモリのILCカバレッジデータをファイルに書き込む
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :ファイル書き出し失敗
+ *
  */
-static void ilc_fout_null (
-	FILE* fp,
-	const char* str
+ILC_ERROR ILC_Finalize (
 )
 {
 	/**/
 	/**/
-	/* ILC: ilc_fout_null開始 */
-	/* ILC: ilc_fout_null終了 */
-	return ;
-}
+	/* ILC: ILC_Finalize開始 */
 
+	/* ILC: ILC_Finalize終了 */
+	return ilc_finalize( 1 );
+}
 
 
 /**
- * ファイルのILCカバレッジデータをメモリに展開する
- * @param const char* ILCカバレッジデータファイル名
- *                    NULLの場合、またはファイルが存在しない場合は ilc.dat を読み込む
- * @return ILC_ERROR  ILC_SUCCESS: 成功
- *                    ILC_WARN   : 指定したファイルがないため、 ilc.dat を使用（続行可能）
- *                    ILC_FAILURE: メモリ展開に失敗（続行不可）
+ * メモリのILCカバレッジデータをファイルに書き込む(ILC_Finalize の本体)
+ * release が0の場合は、書き出した後も他のスレッドの __ilc_check_id が
+ * 参照できるよう、メモリとマップを残す(以後の通過は書き出されない)。
+ * @param int 0以外:メモリを解放し、マップを解除する
+ *            0    :書き出すだけで、メモリとマップはそのまま残す(atexit から呼ぶ場合)
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :ファイル書き出し失敗
  */
-ILC_ERROR ILC_Initialize (
-	const char* ilc_file
+static ILC_ERROR ilc_finalize (
+	int release
 )
 {
 	/**/
-	ILC_ERROR ret = ILC_FAILURE;
-	struct _files {				/* 読み込みファイルとその戻り値のリスト */
-		const char* filename;	/*   ILCカバレッジデータファイル名 */
-		ILC_ERROR   ret;		/*   ILC_Initializeの戻り値 */
-	}
-	files[] = {
-		{ ilc_file,         ILC_SUCCESS },	/* 指定されたファイル名 */
-		{ ILC_FILE_DEFAULT, ILC_WARN    },	/* デフォルトのファイル名 */
-		{ NULL,             ILC_FAILURE }	/* エラー */
-	};
-	struct _files* ptr;
+	char* path;
+	char** forks = NULL;				/* 集計した子プロセスのファイル */
+	long ix;
+	int rewrite = 1;					/* ファイルを書き直すか */
+	ILC_ERROR ret;
 	/**/
-	/* ILC: ILC_Initialize開始 */
+	/* ILC: ilc_finalize開始 */
 
-	/* ファイルがまったく存在しないときのため、デフォルト値を設定しておく */
-	__ilc_data.filename = ILC_FILE_DEFAULT;
+	/* 書き出しスレッドは ILC_Snapshot で __ilc_data_lock を使うため、ロックの前に止める */
+	ilc_writer_stop();
 
-	for ( ptr = &files[0]; ptr->ret != ILC_FAILURE; ptr++ ) {
-		/* ILC: ループ終了条件：ILC_FAILUREを検出 */
-		if ( ilc_fopen( ptr->filename, &__ilc_data ) != ILC_FAILURE ) {
-			/* ILC: open成功、もしくは新規ファイル */
-			ret = ptr->ret;
-			__ilc_data.filename = (char*)ptr->filename;
-			break;
+	pthread_mutex_lock( &__ilc_data_lock );
+
+	if ( __ilc_data.flag != NULL ) {
+		/* ILC: スレッド別の記録と、子プロセスの記録を集計する */
+		ilc_shard_merge( &__ilc_data );
+		ilc_site_reset( ILC_RESET_FLAG );
+		ilc_site_collect( &__ilc_data, __ilc_data.count, 1 );
+		ilc_map_collect( &__ilc_data, __ilc_data.flag );
+		if ( __ilc_fork_child == 0 ) {
+			/* ILC: 子プロセスのファイルは親だけが集計する */
+			forks = ilc_fork_collect( &__ilc_data );
 		}
 	}
 
-	/* ILC: ILC_Initialize終了 */
+	if ( __ilc_data.map != NULL ) {
+		/* ILC: マップしたファイルには通過フラグが反映済み */
+		if ( release != 0 ) {
+			/* ILC: マップを解除する */
+			munmap( __ilc_data.map, __ilc_data.map_size );
+			__ilc_data.map = NULL;
+			__ilc_data.map_size = 0;
+		}
+		if ( __ilc_data.count_map == NULL && __ilc_data.num == __ilc_data.flag_num && __ilc_recovered == 0 && forks == NULL ) {
+			/* ILC: 計測ポイントの追加も通過回数の変更もないので、書き直さない */
+			rewrite = 0;
+		}
+	}
+	if ( __ilc_fork_shared != 0 ) {
+		/* ILC: 親とマップを共有する子プロセスは、親のファイルを書き直さない */
+		rewrite = 0;
+	}
+
+	if ( rewrite != 0 ) {
+		/* ILC: 一時ファイルに書き出してから置き換える */
+		/* 書き出し途中で終了しても、元のファイルは壊れない */
+		ret = ilc_save( &__ilc_data, __ilc_data.filename, __ilc_data.flag, __ilc_data.count );
+		if ( ret == ILC_SUCCESS && (path = ilc_count_path( __ilc_data.filename )) != NULL ) {
+			/* ILC: 通過回数はファイルに反映したので、通過回数ファイルを削除(存在しなくてもよい) */
+			unlink( path );
+			free( path );
+		}
+	}
+	else {
+		/* ILC: 書き直し不要の場合は、メモリ解放のみ行う */
+		ret = ILC_SUCCESS;
+	}
+	ilc_shm_unlink();
+	ilc_crash_uninstall();
+	__ilc_recovered = 0;
+	__ilc_auto = 0;
+	if ( release != 0 ) {
+		/* ILC: メモリを解放する */
+		ilc_release();
+	}
+
+	for ( ix = 0; forks != NULL && forks[ix] != NULL; ix++ ) {
+		/* ILC: 集計した子プロセスのファイルは、書き出しに成功した場合のみ削除する */
+		if ( ret == ILC_SUCCESS ) {
+			/* ILC: 集計結果は書き出し済み */
+			unlink( forks[ix] );
+		}
+		free( forks[ix] );
+	}
+	free( forks );
+
+	pthread_mutex_unlock( &__ilc_data_lock );
+
+	/* ILC: ilc_finalize終了 */
 	return ret;
 }
 
 
+/**
+ * ILCカバレッジデータのメモリを解放し、マップを解除する
+ * fork のハンドラが使う識別子も解放する。__ilc_data_lock を取得してから呼ぶこと。
+ */
+static void ilc_release (
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_release開始 */
+
+	if ( __ilc_data.map != NULL ) {
+		/* ILC: マップを解除する */
+		munmap( __ilc_data.map, __ilc_data.map_size );
+		__ilc_data.map = NULL;
+		__ilc_data.map_size = 0;
+	}
+	ilc_free( &__ilc_data );
+	__ilc_fork_shared = 0;
+	free( __ilc_fork_prefix );
+	free( __ilc_fork_stale[0] );
+	free( __ilc_fork_stale[1] );
+	__ilc_fork_prefix = NULL;
+	__ilc_fork_stale[0] = NULL;
+	__ilc_fork_stale[1] = NULL;
+
+	/* ILC: ilc_release終了 */
+}
+
 
 /**
- * メモリのILCカバレッジデータをファイルに書き込む
+ * 現在の計測結果を、計測を止めずにファイルに書き出す
+ * 一時ファイルに書き出してから置き換えるため、書き出し途中の内容が
+ * 読まれることはない。計測結果はクリアしない。
+ * ILC_MODE_MMAP でマップしているファイルは置き換えずに msync で反映する。
+ * @param const char* 書き出すファイル名
+ *                    NULLの場合は ILC_Initialize で読み込んだファイル
  * @return ILC_SUCCESS:正常終了
  *         ILC_WARN   :ファイル書き出し失敗
- *
+ *         ILC_FAILURE:ILC_Initialize されていない、またはメモリ確保エラー
  */
-ILC_ERROR ILC_Finalize (
+ILC_ERROR ILC_Snapshot (
+	const char* path
 )
 {
 	/**/
-	FILE* fp;
-	void (*p_func)(FILE*, const char*);	/* ファイル書き出し用関数 */
-	long ix;							/* ループカウンタ */
-	ILC_ERROR ret;
+	char* flag = NULL;
+	unsigned long long* count = NULL;
+	ILC_ERROR ret = ILC_FAILURE;
 	/**/
-	/* ILC: ILC_Finalize開始 */
+	/* ILC: ILC_Snapshot開始 */
 
-	fp = fopen( __ilc_data.filename, "w" );
-	if ( fp != NULL ) {
-		/* ILC: ファイルに書き出す関数。通常はこちら。 */
-		p_func = ilc_fout;
+	pthread_mutex_lock( &__ilc_data_lock );
+
+	if ( __ilc_data.flag != NULL ) {
+		/* ILC: 初期化済み。スレッド別の記録を残したまま集計するため複製する */
+		flag = (char*)malloc( (size_t)__ilc_data.num + 1 );
+		count = (unsigned long long*)malloc( sizeof(unsigned long long) * ((size_t)__ilc_data.flag_num + 1) );
+	}
+
+	if ( flag != NULL && count != NULL && path == NULL && __ilc_fork_shared != 0 ) {
+		/* ILC: 親と共有するマップに記録している子プロセスは、マップに集計するだけ */
+		/* (親のファイルを置き換えると、他のプロセスの記録が失われる) */
+		ilc_shard_merge( &__ilc_data );
 		ret = ILC_SUCCESS;
 	}
-	else {
-		/* ILC: NULL OBJECTパターン */
-		p_func = ilc_fout_null;
-		ret = ILC_WARN;
+	else if ( flag != NULL && count != NULL && __ilc_data.map != NULL &&
+			  (path == NULL || strcmp( path, __ilc_data.filename ) == 0) ) {
+		/* ILC: マップしているファイルは置き換えずに、マップの内容をファイルに反映する */
+		/* (置き換えると、以後の通過が古いマップにしか記録されず、異常終了時に残らない) */
+		/* 通過フラグはマップ上、通過回数は通過回数ファイル上にあるため、 */
+		/* スレッド別の記録をそこへ集計してから書き出す */
+		ilc_shard_merge( &__ilc_data );
+		ret = ILC_SUCCESS;
+		if ( msync( __ilc_data.map, __ilc_data.map_size, MS_SYNC ) != 0 ) {
+			/* ILC: 書き出し失敗 */
+			ret = ILC_WARN;
+		}
+		if ( __ilc_data.count_map != NULL && msync( __ilc_data.count_map, __ilc_data.count_map_size, MS_SYNC ) != 0 ) {
+			/* ILC: 書き出し失敗 */
+			ret = ILC_WARN;
+		}
 	}
+	else if ( flag != NULL && count != NULL ) {
+		/* ILC: 複製に集計して書き出す */
+		memcpy( flag, __ilc_data.flag, (size_t)__ilc_data.num );
+		memcpy( count, __ilc_data.count, sizeof(unsigned long long) * (size_t)__ilc_data.flag_num );
+		ilc_shard_collect( &__ilc_data, flag, count );
+		ilc_site_collect( &__ilc_data, count, 0 );
+		ilc_map_collect( &__ilc_data, flag );
 
-	for ( ix = 0; ix < __ilc_data.num; ix++ ) {
-		/* ILC: ファイルに1行ずつ書き出しながら、メモリ解放 */
-		(*p_func)( fp, __ilc_data.coverage[ix] );
-		free( __ilc_data.coverage[ix] );
+		if ( path == NULL ) {
+			/* ILC: 読み込んだファイルに書き出す */
+			path = __ilc_data.filename;
+		}
+		ret = ilc_save( &__ilc_data, path, flag, count );
 	}
-	free( __ilc_data.coverage );
 
+	pthread_mutex_unlock( &__ilc_data_lock );
 
-	/* ILC: ILC_Finalize終了 */
+	free( flag );
+	free( count );
+
+	/* ILC: ILC_Snapshot終了 */
+	return ret;
+}
+
+
+/**
+ * 現在の計測結果をクリアする
+ * ファイルから読み込んだ結果もクリアするため、以後の ILC_Snapshot や
+ * ILC_Finalize では、クリア後に通過した計測ポイントだけが通過済みとなる。
+ * @param int ILC_RESET_xxx の論理和
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:ILC_Initialize されていない
+ */
+ILC_ERROR ILC_Reset (
+	int what
+)
+{
+	/**/
+	long ix;
+	ILC_ERROR ret = ILC_FAILURE;
+	/**/
+	/* ILC: ILC_Reset開始 */
+
+	pthread_mutex_lock( &__ilc_data_lock );
+
+	if ( __ilc_data.flag != NULL ) {
+		/* ILC: 初期化済み */
+		ilc_shard_reset( &__ilc_data, what );
+		ilc_site_reset( what );
+
+		if ( (what & ILC_RESET_FLAG) != 0 ) {
+			/* ILC: 通過フラグのクリア */
+			memset( __ilc_data.flag, 0, (size_t)__ilc_data.num );
+			for ( ix = 0; __ilc_data.map != NULL && ix < __ilc_data.flag_num; ix++ ) {
+				/* ILC: マップしたファイルのフラグも戻す */
+				__ilc_data.map[ (__ilc_data.offset)[ix] ] = '0';
+			}
+			if ( __ilc_data.shm_flag != NULL ) {
+				/* ILC: 共有メモリのフラグも戻す */
+				memset( __ilc_data.shm_flag, 0, (size_t)__ilc_data.flag_num );
+			}
+		}
+		if ( (what & ILC_RESET_COUNT) != 0 ) {
+			/* ILC: 通過回数のクリア(マップした通過回数ファイル・共有メモリも含む) */
+			memset( __ilc_data.count, 0, sizeof(unsigned long long) * (size_t)__ilc_data.flag_num );
+		}
+		ret = ILC_SUCCESS;
+	}
+
+	pthread_mutex_unlock( &__ilc_data_lock );
+
+	/* ILC: ILC_Reset終了 */
 	return ret;
 }
 
@@ -417,29 +3847,161 @@ void __ilc_check (
 )
 {
 	/**/
-	char* flag;
 	/**/
 	/* ILC: __ilc_check開始 */
 
-	flag = ILC_Search( &__ilc_data, check_str );
-	if ( flag != NULL ) {
-		/* ILC: NULLはありえないが... */
-		*flag = '1';
-	}
+	__ilc_check_id( ILC_SearchId( &__ilc_data, check_str ) );
 
 	/* ILC: __ilc_check終了 */
 }
 
 
+/**
+ * カバレッジ検出ポイント通過のフラグをたてる(ID指定版)
+ * @param long 計測ポイントのID(ILCカバレッジデータファイルの行番号-1)
+ */
+void __ilc_check_id (
+	long id
+)
+{
+	/**/
+	/**/
+	/* ILC: __ilc_check_id開始 */
+
+	/* 負数(見つからない)も範囲外として1回の比較で弾く */
+	if ( (unsigned long)id < (unsigned long)__ilc_data.flag_num ) {
+		/**/
+		ILC_SHARD* shard = NULL;
+		int first = 0;					/* 初回通過か(標本化せずに数える) */
+		unsigned long long add;			/* 加算する通過回数 */
+		/**/
+		/* ILC: 範囲内のIDのみ */
+		if ( (__ilc_data.mode & ILC_MODE_THREAD) != 0 ) {
+			/* ILC: スレッドモードは自スレッドの記録領域に書き込む */
+			shard = __ilc_shard;
+			if ( shard == NULL || shard->generation != __ilc_data.generation ) {
+				/* ILC: 初回(または再初期化後)のみ記録領域を作成する */
+				shard = ilc_shard_create();
+			}
+		}
+
+		if ( shard != NULL ) {
+			/* ILC: 書き込むのは自スレッドだけなので排他は不要 */
+			/* (集計・クリアする側も読むため、relaxed の不可分な読み書きにする) */
+			if ( __atomic_load_n( &(shard->flag)[id], __ATOMIC_RELAXED ) == 0 ) {
+				/* ILC: 自スレッドでの初回通過 */
+				__atomic_store_n( &(shard->flag)[id], 1, __ATOMIC_RELAXED );
+				first = 1;
+				if ( __ilc_data.map != NULL ) {
+					/* ILC: マップしたファイルのフラグを直接書き換える */
+					__ilc_data.map[ (__ilc_data.offset)[id] ] = '1';
+				}
+				if ( __ilc_data.shm_flag != NULL ) {
+					/* ILC: 共有メモリのフラグも立てる */
+					__ilc_data.shm_flag[id] = ILC_DAT_FLAG_COVERED;
+				}
+			}
+			if ( shard->count != NULL && (add = ilc_sample( first )) != 0 ) {
+				/* ILC: 回数モード(標本化する場合は数える回だけ加算) */
+				/* 集計・クリアする側は count に書き込まないため、読んでから書いても加算は失われない */
+				__atomic_store_n( &(shard->count)[id],
+								  __atomic_load_n( &(shard->count)[id], __ATOMIC_RELAXED ) + add, __ATOMIC_RELAXED );
+			}
+		}
+		else {
+			/* ILC: 共有データに直接書き込む(記録領域が作成できなかった場合も含む) */
+			if ( __ilc_data.flag[id] == 0 ) {
+				/* ILC: 初回通過 */
+				__ilc_data.flag[id] = 1;
+				first = 1;
+				if ( __ilc_data.map != NULL ) {
+					/* ILC: マップしたファイルのフラグを直接書き換える */
+					__ilc_data.map[ (__ilc_data.offset)[id] ] = '1';
+				}
+				if ( __ilc_data.shm_flag != NULL ) {
+					/* ILC: 共有メモリのフラグも立てる */
+					__ilc_data.shm_flag[id] = ILC_DAT_FLAG_COVERED;
+				}
+			}
+			if ( (__ilc_data.mode & ILC_MODE_COUNT) != 0 && (add = ilc_sample( first )) != 0 ) {
+				/* ILC: 回数モード。順序保証は不要なのでrelaxedで加算する */
+				__atomic_fetch_add( &(__ilc_data.count[id]), add, __ATOMIC_RELAXED );
+			}
+		}
+	}
+
+	/* ILC: __ilc_check_id終了 */
+}
+
+
+/**
+ * 計測ポイント(ilc -n)の通過を記録し、可能なら記録済みにする
+ * 記録済みにした計測ポイントは、世代(__ilc_epoch)が変わるまで呼ばれない。
+ * 回数モードでは、以後の通過回数を site の count に数えさせる。
+ * @param ILC_SITE* 計測ポイントの記録状態
+ */
+void __ilc_site_hit (
+	ILC_SITE* site
+)
+{
+	/**/
+	unsigned long epoch;
+	long id = site->id;
+	int local = (__ilc_data.mode & ILC_MODE_COUNT) != 0;
+	/**/
+	/* ILC: __ilc_site_hit開始 */
+
+	/* 記録中に世代が進んだ場合は、古い世代で記録済みにして次の通過で記録しなおす */
+	epoch = __atomic_load_n( &__ilc_epoch, __ATOMIC_ACQUIRE );
+
+	if ( site->key != NULL ) {
+		/* ILC: 文字列で指定した計測ポイントは、世代ごとにIDを検索する */
+		id = ILC_SearchId( &__ilc_data, site->key );
+	}
+	__ilc_check_id( id );
+
+	if ( __ilc_data.flag == NULL || (unsigned long)id >= (unsigned long)__ilc_data.flag_num ) {
+		/* ILC: 初期化前、または未登録の計測ポイントは記録済みにしない */
+	}
+	else if ( local != 0 && ((__ilc_data.mode & (ILC_MODE_THREAD | ILC_MODE_MMAP | ILC_MODE_SHM)) != 0 || __ilc_data.sampling > 1) ) {
+		/* ILC: 通過回数をスレッド別・ファイル・共有メモリに記録する場合や標本化する場合は、 */
+		/*      通過のたびに __ilc_check_id で数える */
+	}
+	else {
+		/* ILC: 記録済みにする */
+		if ( local != 0 ) {
+			/* ILC: 通過回数を集計できるようリストに登録する */
+			pthread_mutex_lock( &__ilc_shard_lock );
+			site->id = id;
+			if ( site->listed == 0 ) {
+				/* ILC: 初めて数える計測ポイント */
+				site->next = __ilc_site_list;
+				__ilc_site_list = site;
+				site->listed = 1;
+			}
+			pthread_mutex_unlock( &__ilc_shard_lock );
+		}
+		site->local = local;
+		__atomic_store_n( &(site->seen), epoch, __ATOMIC_RELEASE );
+	}
+
+	/* ILC: __ilc_site_hit終了 */
+}
+
+
 
 /**
  * ILCカバレッジデータで保持している文字列を検索する
  * 「フラグ:ファイル名:関数名:行数」を保持している中の、
  * 「ファイル名:関数名:行数」を検索対象とする。
  * 検索結果はフラグの位置を返す。
+ * (ILC_Append で計測ポイントの配列が拡張されると無効になる)
+ * 以前の「フラグ:ファイル名:関数名:行数」の文字列ではなく、flag[ID] の
+ * 1バイト(数値の 0 / 1)を指す。
  * @param ILC_DATA*   ILCカバレッジデータ
  * @param const char* 検索対象の文字列(ファイル名:関数名:行数)
  * @return            検索結果(フラグ)
+ *                    NULL:見つからない
  */
 char* ILC_Search(
 	ILC_DATA* ilc_data,
@@ -448,19 +4010,14 @@ char* ILC_Search(
 {
 	/**/
 	long ix;
-	char* ilc_id;		/* ILCカバレッジデータに登録してある文字列 */
 	char* ret = NULL;
 	/**/
 	/* ILC: ILC_Search開始 */
 
-	for ( ix = 0; ix < ilc_data->num; ix++ ) {
-		/* ILC: 検索開始 */
-		ilc_id = (ilc_data->coverage)[ix];
-		if ( strcmp( str, ilc_id + 2 ) == 0 ) {
-			/* ILC: フラグ + ':' を飛ばし、ファイル名から検索させるため +2 で比較する */
-			ret = ilc_id;
-			break;
-		}
+	ix = ILC_SearchId( ilc_data, str );
+	if ( ix >= 0 ) {
+		/* ILC: 見つかった */
+		ret = &(ilc_data->flag)[ix];
 	}
 
 	/* ILC: ILC_Search終了 */
@@ -468,10 +4025,54 @@ char* ILC_Search(
 }
 
 
+/**
+ * ILCカバレッジデータで保持している文字列を検索する
+ * ILC_Searchと同じ検索を行い、見つかったデータの添字(計測ポイントのID)を返す。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 検索対象の文字列(ファイル名:関数名:行数)
+ * @return            検索結果(計測ポイントのID)
+ *                    -1:見つからない
+ */
+long ILC_SearchId(
+	ILC_DATA* ilc_data,
+	const char* str
+)
+{
+	/**/
+	ILC_KEY key;
+	long file = -1;
+	long func = -1;
+	long ret = -1;
+	/**/
+	/* ILC: ILC_SearchId開始 */
+
+	if ( ilc_key_parse( str, &key ) == 0 && key.rest[0] == '\0' ) {
+		/* ILC: ファイル名と関数名を文字列表のIDに置き換える */
+		file = ilc_name_search( ilc_data, key.file, key.file_len );
+		if ( file >= 0 ) {
+			/* ILC: 登録済みのファイル名 */
+			func = ilc_name_search( ilc_data, key.func, key.func_len );
+		}
+	}
+
+	if ( func >= 0 ) {
+		/* ILC: ファイル名・関数名・行数で検索 */
+		ret = ilc_point_search( ilc_data, file, func, key.line );
+	}
+
+	/* ILC: ILC_SearchId終了 */
+	return ret;
+}
+
+
 /**
  * ILCカバレッジデータに、指定したデータを追加する
+ * 追加したデータのIDは、追加前の計測ポイントの数となる。
+ * 以前と同じく、成功した場合は渡した文字列を引き取る(内容を展開した後に
+ * free で解放するため、malloc で確保した文字列を渡すこと)。
+ * 失敗した場合は呼び出し元で解放すること。
  * @param ILC_DATA* ILCカバレッジデータ
- * @param char*     追加するデータ
+ * @param char*     追加するデータ(フラグ:ファイル名:関数名:行数)
  * @return ILC_SUCCESS:正常終了
  *         ILC_FAILURE:メモリ確保エラー
  */
@@ -481,28 +4082,14 @@ ILC_ERROR ILC_Append (
 )
 {
 	/**/
-	char** ptr;
 	ILC_ERROR ret;
 	/**/
 	/* ILC: ILC_Append開始 */
 
-	/* ilc_data->coverage を realloc する */
-	ptr = (char**)malloc( sizeof(char*) * (ilc_data->num + 1) );
-	if ( ptr != NULL ) {
-		/* ILC: realloc成功 */
-		if ( ilc_data->coverage != NULL ) {
-			/* ILC: realloc実施 */
-			memcpy( ptr, ilc_data->coverage, sizeof(char*) * ilc_data->num );
-			free( ilc_data->coverage );
-		}
-		ptr[ilc_data->num] = data;
-		ilc_data->num++;
-		ilc_data->coverage = ptr;
-		ret = ILC_SUCCESS;
-	}
-	else {
-		/* ILC: realloc失敗 */
-		ret = ILC_FAILURE;
+	ret = ILC_AppendCopy( ilc_data, data );
+	if ( ret == ILC_SUCCESS ) {
+		/* ILC: 内容は展開済みなので、引き取った文字列は不要 */
+		free( data );
 	}
 
 	/* ILC: ILC_Append終了 */
@@ -510,6 +4097,33 @@ ILC_ERROR ILC_Append (
 }
 
 
+/**
+ * ILCカバレッジデータに、指定したデータを追加する(文字列を引き取らない版)
+ * 追加したデータのIDは、追加前の計測ポイントの数となる。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 追加するデータ(フラグ:ファイル名:関数名:行数)
+ *                    内容は展開して保持するため、呼び出し後に解放してよい。
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+ILC_ERROR ILC_AppendCopy (
+	ILC_DATA* ilc_data,
+	const char* data
+)
+{
+	/**/
+	ILC_KEY key;
+	ILC_ERROR ret;
+	/**/
+	/* ILC: ILC_AppendCopy開始 */
+
+	ret = ilc_point_add( ilc_data, data, &key );
+
+	/* ILC: ILC_AppendCopy終了 */
+	return ret;
+}
+
+
 /**
  * staticで保持しているILCカバレッジデータのアドレスを得る
  * @return ILC_DATA*
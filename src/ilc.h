@@ -37,17 +37,62 @@
 #ifndef _ILC_H_
 #define _ILC_H_
 
+#include <stddef.h>
+
 /**
  * ILCカバレッジデータ
  *
  */
 typedef struct _ilc_data {
 	char*		filename;		/**< ファイル名 */
-	char**		coverage;		/**< カバレッジデータ */
-	long		num;			/**< カバレッジデータの数 */
+	long		num;			/**< 計測ポイントの数 */
+	long		capacity;		/**< 計測ポイントの各配列の確保済みの数 */
+	int*		file_id;		/**< ファイル名のID(nameの添字) */
+	int*		func_id;		/**< 関数名のID(nameの添字) */
+	int*		line;			/**< 行数 */
+	char*		flag;			/**< 通過フラグ(0:未通過 1:通過) */
+	char**		name;			/**< ファイル名・関数名の文字列表 */
+	long		name_num;		/**< nameの数 */
+	long		name_capacity;	/**< nameの確保済みの数 */
+	long*		name_index;		/**< nameの検索用ハッシュ表(nameの添字+1、0は空き) */
+	long		name_index_size;	/**< nameのハッシュ表のサイズ(2のべき乗) */
+	long*		index;			/**< 検索用ハッシュ表(計測ポイントのID+1、0は空き) */
+	long		index_size;		/**< ハッシュ表のサイズ(2のべき乗) */
+	long		flag_num;		/**< ILC_Initializeで確定した計測ポイントの数 */
+	unsigned long long*	count;	/**< 通過回数(flag_num個) */
+	size_t*		offset;			/**< ILC_MODE_MMAP: ファイル上のフラグの位置(flag_num個) */
+	size_t		file_size;		/**< ILC_Initializeで読み込んだファイルのサイズ */
+	int			mode;			/**< 動作モード(ILC_MODE_xxxの論理和) */
+	unsigned long	generation;	/**< ILC_Initializeの世代(スレッド別領域の判定用) */
+	char*		map;			/**< ILC_MODE_MMAP: マップしたILCカバレッジデータファイル */
+	size_t		map_size;		/**< mapのサイズ */
+	char*		count_map;		/**< ILC_MODE_MMAP: マップした通過回数ファイル(countはこの中を指す) */
+	size_t		count_map_size;	/**< count_mapのサイズ */
+	char*		shm;			/**< ILC_MODE_SHM: マップした共有メモリ(countはこの中を指すことがある) */
+	size_t		shm_size;		/**< shmのサイズ */
+	unsigned char*	shm_flag;	/**< ILC_MODE_SHM: 共有メモリ上の通過フラグの列(flag_num個) */
+	long		sampling;		/**< 通過回数の標本化の間隔(1以下:すべて数える) */
 }
 ILC_DATA;
 
+/** 動作モード：通過フラグのみ記録する(デフォルト) */
+#define ILC_MODE_FLAG	(0x00)
+/** 動作モード：通過回数も記録する */
+#define ILC_MODE_COUNT	(0x01)
+/** 動作モード：スレッドごとの領域に記録し、ILC_Finalizeで集計する */
+#define ILC_MODE_THREAD	(0x02)
+/** 動作モード：ファイルをマップし、通過時に直接書き込む(異常終了しても記録が残る) */
+#define ILC_MODE_MMAP	(0x04)
+/** 動作モード：SIGUSR1を受けたら、ILCカバレッジデータファイルにスナップショットを書き出す */
+#define ILC_MODE_SIGNAL	(0x08)
+/** 動作モード：通過フラグ・通過回数を名前つきの共有メモリに置き、ilc-top で外部から参照できるようにする */
+#define ILC_MODE_SHM	(0x10)
+
+/** ILC_Reset：通過フラグをクリアする */
+#define ILC_RESET_FLAG	(0x01)
+/** ILC_Reset：通過回数をクリアする */
+#define ILC_RESET_COUNT	(0x02)
+
 /**
  *
  *
@@ -61,13 +106,111 @@ ILC_ERROR;
 
 /*-
  * カバレッジデータの構造
- * char* coverage[0 ... n]
+ * ILCカバレッジデータファイルの行
+ *
+ *   0:test.c:test:10
+ *   0:test.c:test:20
+ *   1:test2.c:main:5
+ *
+ * を、計測ポイントごとの配列(添字が計測ポイントのID)に分けて持つ。
+ *
+ *   name    = { "test.c", "test", "test2.c", "main" }
+ *   file_id = { 0,  0,  2 }
+ *   func_id = { 1,  1,  3 }
+ *   line    = { 10, 20, 5 }
+ *   flag    = { 0,  0,  1 }
+ *
+ * ファイル名と関数名は name に1回だけ登録し、計測ポイントからは
+ * name の添字で参照する。読み込んだファイルの内容は展開後に解放する。
+ * (以前の coverage[ID] = "フラグ:ファイル名:関数名:行数" の配列は廃止した。
+ *  行の文字列が必要な場合は、name[file_id[ID]] などから組み立てること)
+ * 計測ポイントの各配列は倍々で拡張するため、capacity 分の領域を確保している。
+ *
+ * index は (ファイル名, 関数名, 行数) をキーとしたオープンアドレス法の
+ * ハッシュ表で、ILC_Initialize で作成し ILC_Append で追加する。
+ * ILC_DATA を自前で用意する場合は、0 で初期化しておくこと。
+ *
+ * flag は通過フラグで、ファイルから読み込んだ値に実行時の通過を加えていく。
+ * __ilc_check_id は flag[ID] に1を立てるだけで済み、ILC_Finalize は
+ * 各配列を先頭から順に読みながら行を組み立てて書き出す。
+ *
+ * ILC_MODE_COUNT の場合は count[ID] も加算する。
+ * 通過回数はファイルの5番目の項目として「フラグ:ファイル名:関数名:行数:回数」
+ * の形式で保存し、次回の ILC_Initialize で読み込んだ値に加算していく。
+ * count は ILC_Initialize 時点の計測ポイント(flag_num個)の分だけ作成する。
+ *
+ * ILC_SetSampling( N ) を指定すると、各計測ポイントの初回通過は正確に数え、
+ * 2回目以降はスレッドごとのカウントダウンで平均 N 回に1回だけ N を加算する。
+ * count は通過回数の推定値となり、ループ内の計測ポイントでも加算の負荷は
+ * 約 1/N になる。間隔は 1〜2N-1 の乱数とし、ループの周期と揃わないようにする。
+ *
+ * ILC_MODE_THREAD の場合は、スレッドごとに確保した領域に記録するため、
+ * __ilc_check で共有データへの書き込みが発生しない。
+ * 各スレッドの記録は ILC_Finalize で flag / count に集計する。
+ * 終了したスレッドの記録は、スレッド終了時に集計して領域を解放する。
+ * ILC_Initialize 後の ILC_DATA は読み取り専用として扱うこと
+ * (スレッド動作中に ILC_Append しないこと)。
  *
- * coverage[0] = "0:test.c:test:10"
- * coverage[1] = "0:test.c:test:20"
- * coverage[n] = "......."
+ * ILC_MODE_MMAP の場合は、ILCカバレッジデータファイルを MAP_SHARED で
+ * マップし、初回通過時にファイル上のフラグを直接 '1' に書き換える。
+ * プロセスが SIGKILL などで終了しても、通過フラグはファイルに残る。
+ * 回数モードを併用する場合は、通過回数を固定長の別ファイル
+ * (ILCカバレッジデータファイル名 + ".cnt")にマップして加算する。
+ * このファイルは ILC_Finalize でテキストに反映した後に削除し、
+ * 残っていた場合(異常終了時)は次回の ILC_Initialize で読み込む。
+ * 計測ポイントの追加も回数モードもなければ、ILC_Finalize でファイルを
+ * 書き直さない。
  *
- * フラグ、ファイル名、関数名、行数を文字列で持つ。
+ * ILC_Snapshot は計測を止めずに、その時点の結果をファイルに書き出す。
+ * スレッド別の記録はクリアせずに複製へ集計し、「ファイル名.プロセスID.tmp」
+ * に書き出してから rename で置き換える。ILC_MODE_MMAP でマップしている
+ * ファイルへのスナップショットは、ファイルを置き換えずに msync で反映する
+ * (通過回数は通過回数ファイルに反映し、追加した計測ポイントは ILC_Finalize で
+ * 書き出す)。マップは ILC_Finalize まで有効なため、以後の通過も記録が残る。
+ * ILC_Reset は計測結果をクリアし、
+ * 負荷試験のフェーズごとなど、区間を区切った計測に使用する。
+ *
+ * ILC_MODE_SIGNAL の場合は、ILC_Initialize で書き出し用のスレッドを作成し、
+ * SIGUSR1 のハンドラを設定する。ハンドラは sem_post で通知するだけで、
+ * ファイルへの書き出しはスレッドが ILC_Snapshot で行う。
+ * ハンドラは ILC_Finalize で元に戻す。
+ *
+ * libilc をリンクしたプログラムは、main の前にコンストラクタで
+ * 環境変数 ILC_FILE(ファイル名)・ILC_MODE(動作モード)に従って
+ * ILC_Initialize する。プログラムが自分で ILC_Initialize した場合は、
+ * 自動初期化した内容を書き出さずに破棄する。
+ * ILC_Initialize 後は atexit で ILC_Finalize を登録し、ハンドラ未設定の
+ * 異常終了シグナル(SIGSEGV, SIGABRT, SIGTERM など)にも書き出し用の
+ * ハンドラを設定する。シグナルハンドラでは事前に作成した一時ファイル名と
+ * 固定長のバッファだけを使い、write で書き出してから rename で置き換える。
+ * exit は他のスレッドを止めないため、atexit での書き出しではメモリの解放と
+ * マップの解除を行わない(書き出した後の他のスレッドの通過は記録されない)。
+ * 自動初期化を行わないプログラムは、const int __ilc_no_auto を定義すること。
+ *
+ * ILC_MODE_SHM の場合は、ILC_Initialize で POSIX 共有メモリ
+ * (環境変数 ILC_SHM、なければ "/ilc.プロセスID")を作成し、バイナリ形式の
+ * ILCカバレッジデータファイルと同じ列の並びで計測ポイントを置く。
+ * 初回通過時に共有メモリ上のフラグも立て、回数モードでは count を共有メモリ上に
+ * 置いて直接加算するため、ilc-top はプロセスに通知せずに読み取るだけでよい。
+ * (ILC_MODE_THREAD の通過回数は集計時、ILC_MODE_MMAP と回数モードを
+ * 併用する場合の通過回数は通過回数ファイルにのみ記録する)
+ * 共有メモリは ILC_Finalize で削除する。
+ *
+ * ILC_Initialize 後に fork した子プロセスは、pthread_atfork で登録した
+ * ハンドラで計測結果をクリアし、fork 以降の通過だけを
+ * 「ILCカバレッジデータファイル名.識別子.プロセスID」に書き出す。
+ * 識別子は ILC_Initialize ごとに「プロセスID-時刻-世代」で作成する。
+ * ILC_MODE_MMAP でマップ済み、または ILC_MODE_SHM の場合は、親と同じマップに記録を続け、
+ * ファイルは書き出さない。ILC_Initialize したプロセスの ILC_Finalize は、
+ * 同じ識別子を持つ子プロセスのファイルだけを集計してから書き出し、
+ * 集計したファイルを削除する。以前の実行や他のプロセスのファイルには触れない。
+ *
+ * ilc -r で変換したソースは、計測ポイントごとの ILC_POINT を実行ファイルの
+ * ilc_points セクションに持つ。ILC_Initialize はファイルを読み込んだ後、
+ * リンカが作成する __start_ilc_points 〜 __stop_ilc_points を順に見て、
+ * ファイルにない計測ポイントを末尾に追加し、各計測ポイントにIDを設定する。
+ * ファイルがなくてもすべての計測ポイントが揃うため、ファイルは結果の出力先と
+ * 前回までの結果の読み込みにのみ使う(libilc.a を静的にリンクすること)。
  *
  */
 
@@ -83,12 +226,47 @@ ILC_ERROR;
  */
 ILC_ERROR ILC_Initialize ( const char* );
 
+/**
+ * 動作モードを設定する
+ * ILC_Initialize の前に呼び出すこと。
+ * @param int ILC_MODE_xxx の論理和
+ * @return ILC_SUCCESS
+ */
+ILC_ERROR ILC_SetMode ( int );
+
+/**
+ * 通過回数の標本化の間隔を設定する
+ * ILC_Initialize の前に呼び出すこと。
+ * @param long 平均 N 回に1回だけ数え、N を加算する(1以下:すべて数える)
+ * @return ILC_SUCCESS
+ */
+ILC_ERROR ILC_SetSampling ( long );
+
 /**
  * メモリのILCカバレッジデータをファイルに書き込む
  *
  */
 ILC_ERROR ILC_Finalize ( );
 
+/**
+ * 現在の計測結果を、計測を止めずにファイルに書き出す
+ * @param const char* 書き出すファイル名
+ *                    NULLの場合は ILC_Initialize で読み込んだファイル
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_WARN   :ファイル書き出し失敗
+ *         ILC_FAILURE:ILC_Initialize されていない、またはメモリ確保エラー
+ */
+ILC_ERROR ILC_Snapshot ( const char* );
+
+/**
+ * 現在の計測結果をクリアする
+ * ファイルから読み込んだ結果もクリアする。
+ * @param int ILC_RESET_xxx の論理和
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:ILC_Initialize されていない
+ */
+ILC_ERROR ILC_Reset ( int );
+
 /**
  * カバレッジ検出ポイント通過のフラグをたてる
  * @param const char* チェックポイントに設定してある文字列
@@ -96,28 +274,68 @@ ILC_ERROR ILC_Finalize ( );
  */
 void __ilc_check ( const char* );
 
+/**
+ * カバレッジ検出ポイント通過のフラグをたてる(ID指定版)
+ * ilc -i で変換したソースから呼ばれる。
+ * @param long 計測ポイントのID(ILCカバレッジデータファイルの行番号-1)
+ */
+void __ilc_check_id ( long );
+
 
 /**
  * ILCカバレッジデータで保持している文字列を検索する
  * 「フラグ:ファイル名:関数名:行数」を保持している中の、
  * 「ファイル名:関数名:行数」を検索対象とする。
  * 検索結果はフラグの位置を返す。
+ * (ILC_Append で計測ポイントの配列が拡張されると無効になる)
+ *
+ * 【互換性】計測ポイントを展開して保持するようになったため、検索結果は
+ * 「フラグ:ファイル名:関数名:行数」の文字列ではなく、flag[ID] の
+ * 1バイト(値は文字の '0' / '1' ではなく数値の 0 / 1)を指す。
+ * 文字列として参照していた場合は、ILC_SearchId で得たIDから
+ * name / file_id / func_id / line を参照すること。
  * @param ILC_DATA*   ILCカバレッジデータ
  * @param const char* 検索対象の文字列(ファイル名:関数名:行数)
  * @return            検索結果(フラグ)
+ *                    NULL:見つからない
  */
 char* ILC_Search( ILC_DATA*, const char* );
 
+/**
+ * ILCカバレッジデータで保持している文字列を検索する
+ * ILC_Searchと同じ検索を行い、見つかったデータの添字(計測ポイントのID)を返す。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 検索対象の文字列(ファイル名:関数名:行数)
+ * @return            検索結果(計測ポイントのID)
+ *                    -1:見つからない
+ */
+long ILC_SearchId( ILC_DATA*, const char* );
+
 
 /**
  * ILCカバレッジデータに、指定したデータを追加する
+ * 追加したデータのIDは、追加前の計測ポイントの数となる。
+ * 以前と同じく、成功した場合は渡した文字列を引き取る(内容を展開した後に
+ * free で解放するため、malloc で確保した文字列を渡すこと)。
+ * 失敗した場合は呼び出し元で解放すること。
  * @param ILC_DATA* ILCカバレッジデータ
- * @param char*     追加するデータ
+ * @param char*     追加するデータ(フラグ:ファイル名:関数名:行数)
  * @return ILC_SUCCESS:正常終了
  *         ILC_FAILURE:メモリ確保エラー
  */
 ILC_ERROR ILC_Append ( 	ILC_DATA*, 	char* );
 
+/**
+ * ILCカバレッジデータに、指定したデータを追加する(文字列を引き取らない版)
+ * 追加したデータのIDは、追加前の計測ポイントの数となる。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* 追加するデータ(フラグ:ファイル名:関数名:行数)
+ *                    内容は展開して保持するため、呼び出し後に解放してよい。
+ * @return ILC_SUCCESS:正常終了
+ *         ILC_FAILURE:メモリ確保エラー
+ */
+ILC_ERROR ILC_AppendCopy ( 	ILC_DATA*, 	const char* );
+
 
 /**
  * staticで保持しているILCカバレッジデータのアドレスを得る
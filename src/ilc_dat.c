@@ -0,0 +1,1105 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	ilc_dat.c
+ * @brief	ILCカバレッジデータファイルの読み込み
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "ilc_dat.h"
+#include "ilc_local.h"
+
+/* 読み込み用バッファの初期サイズ */
+#define ILC_DAT_BUFSIZ (256 * 1024)
+
+/* 1行の項目数(フラグ:ファイル名:関数名:行数[:回数]) */
+#define ILC_DAT_FIELDS (5)
+
+/* 文字列の格納領域の大きさ */
+#define ILC_DAT_CHUNK_SIZE (1024 * 1024)
+
+/* バイナリ形式の各部分の境界 */
+#define ILC_DAT_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+/**
+ * 文字列表(ILC_DAT_BINARYの書き込み用)
+ * 文字列をIDに対応付けるオープンアドレス法のハッシュ表を持つ。
+ */
+typedef struct _ilc_dat_intern {
+	const char**	str;		/**< 登録した文字列(IDの順) */
+	long			num;		/**< 登録した文字列の数 */
+	long			capacity;	/**< strの確保済みの数 */
+	size_t			size;		/**< 登録した文字列のバイト数(NULL終端を含む) */
+	long*			index;		/**< ハッシュ表(ID+1、0は空き) */
+	long			index_size;	/**< indexのサイズ(2のべき乗) */
+}
+ILC_DAT_INTERN;
+
+/*
+ *
+ * static functions
+ *
+ */
+/**
+ * 1行を項目に分割し、計測ポイントに設定する
+ * 区切り文字の':'は'\0'に置き換える。
+ * @param char*          1行(NULL終端、改行を含まない)
+ * @param ILC_DAT_POINT* 計測ポイントの格納先
+ * @return  0:正常終了
+ *         -1:形式が正しくない
+ */
+static int ilc_dat_parse ( char*, ILC_DAT_POINT* );
+
+/**
+ * バッファの未処理部分を先頭に詰め、ファイルの続きを読み込む
+ * バッファが一杯の場合は倍に拡張する。
+ * @param ILC_DAT_READER* 読み込み状態
+ * @return  0:正常終了(ファイルの終わりに達した場合はeofを設定する)
+ *         -1:読み込みエラー、またはメモリ確保エラー
+ */
+static int ilc_dat_fill ( ILC_DAT_READER* );
+
+/**
+ * 文字列を格納領域に複製する
+ * @param ILC_DAT_TABLE* 格納先
+ * @param const char*    複製する文字列
+ * @return 複製した文字列
+ *         NULL:メモリ確保エラー
+ */
+static char* ilc_dat_strdup ( ILC_DAT_TABLE*, const char* );
+
+/**
+ * qsort用の ILC_DatCompare
+ * @param const void* ILC_DAT_POINT*
+ * @param const void* ILC_DAT_POINT*
+ * @return 比較結果
+ */
+static int ilc_dat_qsort_cmp ( const void*, const void* );
+
+/**
+ * バイナリ形式のファイルを最後まで読み込み、各列の位置を設定する
+ * @param ILC_DAT_READER* 読み込み状態(先頭の識別子を読み込み済みであること)
+ * @return  0:正常終了
+ *         -1:読み込みエラー、メモリ確保エラー、または形式が正しくない
+ */
+static int ilc_dat_bin_open ( ILC_DAT_READER* );
+
+/**
+ * 文字列表に文字列を登録し、IDを得る(登録済みならそのIDを返す)
+ * @param ILC_DAT_INTERN* 文字列表
+ * @param const char*     文字列
+ * @return ID
+ *         -1:メモリ確保エラー
+ */
+static long ilc_dat_intern ( ILC_DAT_INTERN*, const char* );
+
+/**
+ * 計測ポイントをバイナリ形式で書き込む
+ * @param FILE*                出力先
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param long                 計測ポイントの数
+ * @return  0:正常終了
+ *         -1:書き込みエラー、メモリ確保エラー、またはintで表せない行数
+ */
+static int ilc_dat_save_binary ( FILE*, const ILC_DAT_POINT*, long );
+
+
+
+/**
+ * 1行を項目に分割し、計測ポイントに設定する
+ * 区切り文字の':'は'\0'に置き換える。
+ * @param char*          1行(NULL終端、改行を含まない)
+ * @param ILC_DAT_POINT* 計測ポイントの格納先
+ * @return  0:正常終了
+ *         -1:形式が正しくない
+ */
+static int ilc_dat_parse (
+	char* line,
+	ILC_DAT_POINT* point
+)
+{
+	/**/
+	char* field[ILC_DAT_FIELDS];
+	char* ptr = line;
+	char* end;
+	int num = 0;
+	/**/
+	/* ILC: ilc_dat_parse開始 */
+
+	field[num++] = ptr;
+	while ( num < ILC_DAT_FIELDS && (ptr = strchr( ptr, ':' )) != NULL ) {
+		/* ILC: 区切り文字で分割 */
+		*ptr++ = '\0';
+		field[num++] = ptr;
+	}
+	if ( num < ILC_DAT_FIELDS - 1 ) {
+		/* ILC: 項目が足りない */
+		return -1;
+	}
+
+	point->flag = ( strtol( field[0], &end, 10 ) != 0 );
+	if ( end == field[0] || *end != '\0' ) {
+		/* ILC: フラグが数値でない */
+		return -1;
+	}
+	point->file = field[1];
+	point->func = field[2];
+	point->line = strtol( field[3], &end, 10 );
+	if ( end == field[3] || *end != '\0' ) {
+		/* ILC: 行数が数値でない */
+		return -1;
+	}
+
+	point->count = 0;
+	point->has_count = ( num == ILC_DAT_FIELDS );
+	if ( point->has_count ) {
+		/* ILC: 通過回数の項目あり */
+		point->count = strtoull( field[4], &end, 10 );
+		if ( end == field[4] || *end != '\0' ) {
+			/* ILC: 通過回数が数値でない */
+			return -1;
+		}
+	}
+
+	/* ILC: ilc_dat_parse終了 */
+	return 0;
+}
+
+
+/**
+ * バッファの未処理部分を先頭に詰め、ファイルの続きを読み込む
+ * バッファが一杯の場合は倍に拡張する。
+ * @param ILC_DAT_READER* 読み込み状態
+ * @return  0:正常終了(ファイルの終わりに達した場合はeofを設定する)
+ *         -1:読み込みエラー、またはメモリ確保エラー
+ */
+static int ilc_dat_fill (
+	ILC_DAT_READER* reader
+)
+{
+	/**/
+	size_t cnt;
+	/**/
+	/* ILC: ilc_dat_fill開始 */
+
+	if ( reader->pos > 0 ) {
+		/* ILC: 未処理部分を先頭に詰める */
+		memmove( reader->buf, reader->buf + reader->pos, reader->len - reader->pos );
+		reader->len -= reader->pos;
+		reader->pos = 0;
+	}
+
+	/* NULL終端分の1バイトは常に空けておく */
+	if ( reader->len + 1 >= reader->size ) {
+		/**/
+		char* ptr;
+		/**/
+		/* ILC: 1行がバッファより長いので拡張する */
+		ptr = (char*)realloc( reader->buf, reader->size * 2 );
+		if ( ptr == NULL ) {
+			/* ILC: 拡張失敗 */
+			return -1;
+		}
+		reader->buf = ptr;
+		reader->size *= 2;
+	}
+
+	cnt = fread( reader->buf + reader->len, 1, reader->size - reader->len - 1, reader->fp );
+	reader->len += cnt;
+	if ( cnt == 0 ) {
+		/* ILC: ファイルの終わり、または読み込みエラー */
+		reader->eof = 1;
+		if ( ferror( reader->fp ) ) {
+			/* ILC: 読み込みエラー */
+			return -1;
+		}
+	}
+
+	/* ILC: ilc_dat_fill終了 */
+	return 0;
+}
+
+
+
+/**
+ * 文字列を格納領域に複製する
+ * @param ILC_DAT_TABLE* 格納先
+ * @param const char*    複製する文字列
+ * @return 複製した文字列
+ *         NULL:メモリ確保エラー
+ */
+static char* ilc_dat_strdup (
+	ILC_DAT_TABLE* table,
+	const char* str
+)
+{
+	/**/
+	ILC_DAT_CHUNK* chunk = table->chunk;
+	size_t len = strlen( str ) + 1;
+	char* dst;
+	/**/
+	/* ILC: ilc_dat_strdup開始 */
+
+	if ( chunk == NULL || chunk->size - chunk->used < len ) {
+		/**/
+		size_t size = ( len > ILC_DAT_CHUNK_SIZE ) ? len : ILC_DAT_CHUNK_SIZE;
+		/**/
+		/* ILC: 空きがないので新しい領域を先頭に追加する */
+		chunk = (ILC_DAT_CHUNK*)malloc( sizeof(ILC_DAT_CHUNK) + size );
+		if ( chunk == NULL ) {
+			/* ILC: メモリ確保エラー */
+			return NULL;
+		}
+		chunk->next = table->chunk;
+		chunk->size = size;
+		chunk->used = 0;
+		table->chunk = chunk;
+	}
+
+	dst = chunk->data + chunk->used;
+	memcpy( dst, str, len );
+	chunk->used += len;
+
+	/* ILC: ilc_dat_strdup終了 */
+	return dst;
+}
+
+
+/**
+ * qsort用の ILC_DatCompare
+ * @param const void* ILC_DAT_POINT*
+ * @param const void* ILC_DAT_POINT*
+ * @return 比較結果
+ */
+static int ilc_dat_qsort_cmp (
+	const void* a,
+	const void* b
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_dat_qsort_cmp */
+	return ILC_DatCompare( (const ILC_DAT_POINT*)a, (const ILC_DAT_POINT*)b );
+}
+
+
+
+/**
+ * バイナリ形式のファイルを最後まで読み込み、各列の位置を設定する
+ * @param ILC_DAT_READER* 読み込み状態(先頭の識別子を読み込み済みであること)
+ * @return  0:正常終了
+ *         -1:読み込みエラー、メモリ確保エラー、または形式が正しくない
+ */
+static int ilc_dat_bin_open (
+	ILC_DAT_READER* reader
+)
+{
+	/**/
+	ILC_DAT_HEADER header;
+	size_t offset;
+	size_t need;
+	char* ptr;
+	char* end;
+	long ix;
+	/**/
+	/* ILC: ilc_dat_bin_open開始 */
+
+	while ( !reader->eof ) {
+		/* ILC: ファイル全体を読み込む */
+		if ( ilc_dat_fill( reader ) != 0 ) {
+			/* ILC: 読み込みエラー、またはメモリ確保エラー */
+			return -1;
+		}
+	}
+
+	if ( reader->len < sizeof(ILC_DAT_HEADER) ) {
+		/* ILC: ヘッダがない */
+		return -1;
+	}
+	memcpy( &header, reader->buf, sizeof(ILC_DAT_HEADER) );
+	if ( header.endian != ILC_DAT_ENDIAN || header.num < 0 || header.str_num < 0
+	     || header.str_size < 0 || header.str_size % 8 != 0
+	     || (unsigned long long)header.str_size > reader->len
+	     || (unsigned long long)header.num > reader->len
+	     || (unsigned long long)header.str_num > (unsigned long long)header.str_size ) {
+		/* ILC: バイトオーダーが異なる、または値が正しくない */
+		return -1;
+	}
+
+	/* 各列は8バイト境界から始まる(malloc した buf からの位置) */
+	offset = sizeof(ILC_DAT_HEADER) + (size_t)header.str_size;
+	need = ( header.flags & ILC_DAT_HAS_COUNT ) ? sizeof(unsigned long long) : 0;
+	need += sizeof(unsigned int) * 2 + sizeof(int) + sizeof(unsigned char);
+	if ( reader->len != offset + need * (size_t)header.num ) {
+		/* ILC: ファイルの大きさが合わない(途中で切れている) */
+		return -1;
+	}
+
+	/* 文字列表 */
+	reader->strings = (char**)malloc( sizeof(char*) * (size_t)( header.str_num + 1 ) );
+	if ( reader->strings == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+	ptr = reader->buf + sizeof(ILC_DAT_HEADER);
+	end = ptr + header.str_size;
+	for ( ix = 0; ix < header.str_num; ix++ ) {
+		/* ILC: NULL終端で区切る */
+		(reader->strings)[ix] = ptr;
+		ptr = (char*)memchr( ptr, '\0', (size_t)( end - ptr ) );
+		if ( ptr == NULL ) {
+			/* ILC: 文字列表が正しくない */
+			return -1;
+		}
+		ptr++;
+	}
+	reader->str_num = (long)header.str_num;
+	reader->num = (long)header.num;
+
+	/* 列 */
+	ptr = reader->buf + offset;
+	if ( header.flags & ILC_DAT_HAS_COUNT ) {
+		/* ILC: 通過回数の列あり */
+		reader->count = (const unsigned long long*)ptr;
+		ptr += sizeof(unsigned long long) * (size_t)header.num;
+	}
+	reader->file_id = (const unsigned int*)ptr;
+	ptr += sizeof(unsigned int) * (size_t)header.num;
+	reader->func_id = (const unsigned int*)ptr;
+	ptr += sizeof(unsigned int) * (size_t)header.num;
+	reader->line = (const int*)ptr;
+	ptr += sizeof(int) * (size_t)header.num;
+	reader->flag = (const unsigned char*)ptr;
+
+	reader->format = ILC_DAT_BINARY;
+
+	/* ILC: ilc_dat_bin_open終了 */
+	return 0;
+}
+
+
+/**
+ * 文字列表に文字列を登録し、IDを得る(登録済みならそのIDを返す)
+ * @param ILC_DAT_INTERN* 文字列表
+ * @param const char*     文字列
+ * @return ID
+ *         -1:メモリ確保エラー
+ */
+static long ilc_dat_intern (
+	ILC_DAT_INTERN* intern,
+	const char* str
+)
+{
+	/**/
+	unsigned long hash = 2166136261UL;	/* FNV-1a */
+	const char* ptr;
+	long pos;
+	long id;
+	/**/
+	/* ILC: ilc_dat_intern開始 */
+
+	if ( ( intern->num + 1 ) * 2 > intern->index_size ) {
+		/**/
+		long* index;
+		long size = ( intern->index_size == 0 ) ? 1024 : intern->index_size * 2;
+		long ix;
+		/**/
+		/* ILC: 負荷率が1/2を超えるのでハッシュ表を作り直す */
+		index = (long*)calloc( (size_t)size, sizeof(long) );
+		if ( index == NULL ) {
+			/* ILC: メモリ確保エラー */
+			return -1;
+		}
+		for ( ix = 0; ix < intern->index_size; ix++ ) {
+			/* ILC: 登録済みの文字列を入れ直す */
+			if ( (intern->index)[ix] != 0 ) {
+				/* ILC: 登録済みの位置 */
+				for ( hash = 2166136261UL, ptr = (intern->str)[(intern->index)[ix] - 1]; *ptr != '\0'; ptr++ ) {
+					/* ILC: ハッシュ値の計算 */
+					hash = ( hash ^ (unsigned char)*ptr ) * 16777619UL;
+				}
+				for ( pos = (long)( hash & (unsigned long)( size - 1 ) ); index[pos] != 0; pos = ( pos + 1 ) & ( size - 1 ) ) {
+					/* ILC: 空いている位置を線形探索 */
+				}
+				index[pos] = (intern->index)[ix];
+			}
+		}
+		free( intern->index );
+		intern->index = index;
+		intern->index_size = size;
+		hash = 2166136261UL;
+	}
+
+	for ( ptr = str; *ptr != '\0'; ptr++ ) {
+		/* ILC: ハッシュ値の計算 */
+		hash = ( hash ^ (unsigned char)*ptr ) * 16777619UL;
+	}
+	for ( pos = (long)( hash & (unsigned long)( intern->index_size - 1 ) ); (intern->index)[pos] != 0; pos = ( pos + 1 ) & ( intern->index_size - 1 ) ) {
+		/* ILC: 登録済みの位置 */
+		if ( strcmp( (intern->str)[(intern->index)[pos] - 1], str ) == 0 ) {
+			/* ILC: 登録済み */
+			return (intern->index)[pos] - 1;
+		}
+	}
+
+	if ( intern->num == intern->capacity ) {
+		/**/
+		const char** ptr2;
+		long capacity = ( intern->capacity == 0 ) ? 256 : intern->capacity * 2;
+		/**/
+		/* ILC: 文字列の領域を倍々で拡張する */
+		ptr2 = (const char**)realloc( intern->str, sizeof(char*) * (size_t)capacity );
+		if ( ptr2 == NULL ) {
+			/* ILC: 拡張失敗 */
+			return -1;
+		}
+		intern->str = ptr2;
+		intern->capacity = capacity;
+	}
+
+	id = intern->num++;
+	(intern->str)[id] = str;
+	(intern->index)[pos] = id + 1;
+	intern->size += (size_t)( ptr - str ) + 1;
+
+	/* ILC: ilc_dat_intern終了 */
+	return id;
+}
+
+
+/**
+ * 計測ポイントをバイナリ形式で書き込む
+ * @param FILE*                出力先
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param long                 計測ポイントの数
+ * @return  0:正常終了
+ *         -1:書き込みエラー、メモリ確保エラー、またはintで表せない行数
+ */
+static int ilc_dat_save_binary (
+	FILE* fp,
+	const ILC_DAT_POINT* point,
+	long num
+)
+{
+	/**/
+	ILC_DAT_HEADER header;
+	ILC_DAT_INTERN intern;
+	unsigned int* ids;		/* ファイル名のID[num]、関数名のID[num] */
+	static const char pad[8] = { 0 };
+	const char* file = NULL;	/* 直前の計測ポイントのファイル名 */
+	const char* func = NULL;	/* 直前の計測ポイントの関数名 */
+	long file_id = 0;
+	long func_id = 0;
+	long ix;
+	int ret = 0;
+	/**/
+	/* ILC: ilc_dat_save_binary開始 */
+
+	memset( &intern, 0, sizeof(ILC_DAT_INTERN) );
+	memset( &header, 0, sizeof(ILC_DAT_HEADER) );
+	memcpy( header.magic, ILC_DAT_MAGIC, sizeof(header.magic) );
+	header.endian = ILC_DAT_ENDIAN;
+	header.num = num;
+
+	ids = (unsigned int*)malloc( sizeof(unsigned int) * (size_t)( num * 2 + 1 ) );
+	if ( ids == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+
+	/* ファイル名、関数名をIDに置き換える */
+	for ( ix = 0; ix < num && ret == 0; ix++ ) {
+		/* ILC: 計測ポイントごと */
+		if ( point[ix].line < INT_MIN || point[ix].line > INT_MAX ) {
+			/* ILC: intで表せない行数 */
+			ret = -1;
+			break;
+		}
+		if ( point[ix].has_count ) {
+			/* ILC: 通過回数の列が必要 */
+			header.flags |= ILC_DAT_HAS_COUNT;
+		}
+		/* 直前と同じ領域(ILC_DatLoadで共有した文字列)は検索しない */
+		if ( point[ix].file != file ) {
+			/* ILC: ファイル名のIDを得る */
+			file = point[ix].file;
+			file_id = ilc_dat_intern( &intern, file );
+		}
+		if ( point[ix].func != func ) {
+			/* ILC: 関数名のIDを得る */
+			func = point[ix].func;
+			func_id = ilc_dat_intern( &intern, func );
+		}
+		if ( file_id < 0 || func_id < 0 ) {
+			/* ILC: メモリ確保エラー */
+			ret = -1;
+			break;
+		}
+		ids[ix] = (unsigned int)file_id;
+		ids[num + ix] = (unsigned int)func_id;
+	}
+	header.str_num = intern.num;
+	header.str_size = (long long)ILC_DAT_ALIGN( intern.size );
+
+	if ( ret == 0 ) {
+		/* ILC: ヘッダ、文字列表、列の順に書き込む */
+		fwrite( &header, sizeof(ILC_DAT_HEADER), 1, fp );
+		for ( ix = 0; ix < intern.num; ix++ ) {
+			/* ILC: 文字列表(NULL終端を含む) */
+			fwrite( (intern.str)[ix], 1, strlen( (intern.str)[ix] ) + 1, fp );
+		}
+		fwrite( pad, 1, (size_t)header.str_size - intern.size, fp );
+
+		if ( header.flags & ILC_DAT_HAS_COUNT ) {
+			/* ILC: 通過回数の列 */
+			for ( ix = 0; ix < num; ix++ ) {
+				/* ILC: 通過回数 */
+				fwrite( &point[ix].count, sizeof(unsigned long long), 1, fp );
+			}
+		}
+		fwrite( ids, sizeof(unsigned int), (size_t)num * 2, fp );
+		for ( ix = 0; ix < num; ix++ ) {
+			/**/
+			int line = (int)point[ix].line;
+			/**/
+			/* ILC: 行数の列 */
+			fwrite( &line, sizeof(int), 1, fp );
+		}
+		for ( ix = 0; ix < num; ix++ ) {
+			/**/
+			unsigned char flag = 0;
+			/**/
+			/* ILC: フラグの列 */
+			if ( point[ix].flag ) {
+				/* ILC: 通過済み */
+				flag |= ILC_DAT_FLAG_COVERED;
+			}
+			if ( point[ix].has_count ) {
+				/* ILC: 通過回数の項目あり */
+				flag |= ILC_DAT_FLAG_COUNT;
+			}
+			putc( flag, fp );
+		}
+		if ( ferror( fp ) ) {
+			/* ILC: 書き込みエラー */
+			ret = -1;
+		}
+	}
+
+	free( ids );
+	free( intern.str );
+	free( intern.index );
+
+	/* ILC: ilc_dat_save_binary終了 */
+	return ret;
+}
+
+
+
+/**
+ * ILCカバレッジデータファイルを開く
+ * @param const char* ファイル名("-"の場合は標準入力)
+ * @return ILC_DAT_READER* 読み込み状態
+ *                         NULL:ファイルオープンエラー、またはメモリ確保エラー
+ */
+ILC_DAT_READER* ILC_DatOpen (
+	const char* filename
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	/**/
+	/* ILC: ILC_DatOpen開始 */
+
+	reader = (ILC_DAT_READER*)calloc( 1, sizeof(ILC_DAT_READER) );
+	if ( reader == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return NULL;
+	}
+
+	reader->filename = filename;
+	reader->size = ILC_DAT_BUFSIZ;
+	reader->buf = (char*)malloc( reader->size );
+	if ( strcmp( filename, "-" ) == 0 ) {
+		/* ILC: 標準入力 */
+		reader->fp = stdin;
+	}
+	else {
+		/* ILC: ファイル */
+		reader->fp = fopen( filename, "r" );
+	}
+
+	if ( reader->buf == NULL || reader->fp == NULL || ilc_dat_fill( reader ) != 0 ) {
+		/* ILC: オープンエラー、読み込みエラー、またはメモリ確保エラー */
+		ILC_DatClose( reader );
+		reader = NULL;
+	}
+	else if ( reader->len >= sizeof(ILC_DAT_MAGIC) - 1
+	          && memcmp( reader->buf, ILC_DAT_MAGIC, sizeof(ILC_DAT_MAGIC) - 1 ) == 0 ) {
+		/* ILC: 先頭がバイナリ形式の識別子 */
+		if ( ilc_dat_bin_open( reader ) != 0 ) {
+			/* ILC: 読み込めない */
+			ILC_DatClose( reader );
+			reader = NULL;
+		}
+	}
+
+	/* ILC: ILC_DatOpen終了 */
+	return reader;
+}
+
+
+/**
+ * ILCカバレッジデータファイルから計測ポイントを1つ読み込む
+ * 空行は読み飛ばす。
+ * @param ILC_DAT_READER* 読み込み状態
+ * @param ILC_DAT_POINT*  読み込んだ計測ポイントの格納先
+ * @return  1:読み込んだ
+ *          0:ファイルの終わり
+ *         -1:形式が正しくない行(lineno の行、続けて次の行を読み込める)、
+ *            読み込みエラー、またはメモリ確保エラー(以降は0を返す)
+ */
+int ILC_DatRead (
+	ILC_DAT_READER* reader,
+	ILC_DAT_POINT* point
+)
+{
+	/**/
+	char* line;
+	char* end;
+	/**/
+	/* ILC: ILC_DatRead開始 */
+
+	if ( reader->format == ILC_DAT_BINARY ) {
+		/**/
+		long ix = reader->lineno;
+		/**/
+		/* ILC: バイナリ形式は次の計測ポイントを列から取り出す */
+		if ( ix >= reader->num ) {
+			/* ILC: ファイルの終わり */
+			return 0;
+		}
+		reader->lineno++;
+		if ( (reader->file_id)[ix] >= (unsigned long)reader->str_num
+		     || (reader->func_id)[ix] >= (unsigned long)reader->str_num ) {
+			/* ILC: 文字列表にないID */
+			return -1;
+		}
+		point->flag = ( (reader->flag)[ix] & ILC_DAT_FLAG_COVERED ) != 0;
+		point->file = (reader->strings)[(reader->file_id)[ix]];
+		point->func = (reader->strings)[(reader->func_id)[ix]];
+		point->line = (reader->line)[ix];
+		point->has_count = ( (reader->flag)[ix] & ILC_DAT_FLAG_COUNT ) != 0;
+		point->count = ( reader->count != NULL ) ? (reader->count)[ix] : 0;
+		return 1;
+	}
+
+	for ( ;; ) {
+		/* ILC: 空行以外の行が見つかるまで */
+		line = reader->buf + reader->pos;
+		end = (char*)memchr( line, '\n', reader->len - reader->pos );
+		if ( end != NULL ) {
+			/* ILC: バッファ内に1行ある */
+			reader->pos = (size_t)(end - reader->buf) + 1;
+		}
+		else if ( !reader->eof ) {
+			/* ILC: 行の途中までしかないので続きを読み込む */
+			if ( ilc_dat_fill( reader ) != 0 ) {
+				/* ILC: エラー(以降は読み込まない) */
+				reader->pos = reader->len = 0;
+				reader->eof = 1;
+				reader->error = 1;
+				return -1;
+			}
+			continue;
+		}
+		else if ( reader->pos < reader->len ) {
+			/* ILC: 改行のない最終行 */
+			end = reader->buf + reader->len;
+			reader->pos = reader->len;
+		}
+		else {
+			/* ILC: ファイルの終わり */
+			return 0;
+		}
+
+		*end = '\0';
+		if ( end > line && *(end - 1) == '\r' ) {
+			/* ILC: CRLFの場合はCRも取り除く */
+			*(end - 1) = '\0';
+		}
+		reader->lineno++;
+
+		if ( *line != '\0' ) {
+			/* ILC: 空行でなければ項目に分割する */
+			break;
+		}
+	}
+
+	/* ILC: ILC_DatRead終了 */
+	return ( ilc_dat_parse( line, point ) == 0 ) ? 1 : -1;
+}
+
+
+/**
+ * ILCカバレッジデータファイルを閉じる
+ * @param ILC_DAT_READER* 読み込み状態(NULLの場合は何もしない)
+ */
+void ILC_DatClose (
+	ILC_DAT_READER* reader
+)
+{
+	/**/
+	/**/
+	/* ILC: ILC_DatClose開始 */
+
+	if ( reader != NULL ) {
+		/* ILC: ファイルとバッファを解放 */
+		if ( reader->fp != NULL && reader->fp != stdin ) {
+			/* ILC: 標準入力以外は閉じる */
+			fclose( reader->fp );
+		}
+		free( reader->strings );
+		free( reader->buf );
+		free( reader );
+	}
+
+	/* ILC: ILC_DatClose終了 */
+}
+
+
+/**
+ * ILCカバレッジデータファイルをすべて読み込み、メモリに展開する
+ * 形式が正しくない行は読み飛ばし、invalid に数える。
+ * @param const char*    ファイル名("-"の場合は標準入力)
+ * @param ILC_DAT_TABLE* 展開先(読み込んだ計測ポイントを末尾に追加する)
+ * @return  0:正常終了
+ *         -1:ファイルオープンエラー、読み込みエラー、またはメモリ確保エラー
+ */
+int ILC_DatLoad (
+	const char* filename,
+	ILC_DAT_TABLE* table
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT point;
+	const char* file = NULL;	/* 直前の行のファイル名(格納領域内) */
+	const char* func = NULL;	/* 直前の行の関数名(格納領域内) */
+	int ret = 0;
+	int rc;
+	/**/
+	/* ILC: ILC_DatLoad開始 */
+
+	reader = ILC_DatOpen( filename );
+	if ( reader == NULL ) {
+		/* ILC: ファイルオープンエラー */
+		return -1;
+	}
+
+	while ( ret == 0 && (rc = ILC_DatRead( reader, &point )) != 0 ) {
+		/* ILC: 1行ずつ展開 */
+		if ( rc < 0 ) {
+			/* ILC: 形式が正しくない行(読み込みエラーの場合は次で終わる) */
+			table->invalid += !reader->error;
+			continue;
+		}
+
+		if ( table->num == table->capacity ) {
+			/**/
+			ILC_DAT_POINT* ptr;
+			long capacity = ( table->capacity == 0 ) ? 1024 : table->capacity * 2;
+			/**/
+			/* ILC: 計測ポイントの領域を倍々で拡張する */
+			ptr = (ILC_DAT_POINT*)realloc( table->point, sizeof(ILC_DAT_POINT) * (size_t)capacity );
+			if ( ptr == NULL ) {
+				/* ILC: 拡張失敗 */
+				ret = -1;
+				break;
+			}
+			table->point = ptr;
+			table->capacity = capacity;
+		}
+
+		/* 同じファイル名、関数名が続く場合は直前の行の文字列を共有する */
+		if ( file == NULL || strcmp( file, point.file ) != 0 ) {
+			/* ILC: ファイル名が変わった */
+			file = ilc_dat_strdup( table, point.file );
+			func = NULL;
+		}
+		if ( func == NULL || strcmp( func, point.func ) != 0 ) {
+			/* ILC: 関数名が変わった */
+			func = ilc_dat_strdup( table, point.func );
+		}
+		if ( file == NULL || func == NULL ) {
+			/* ILC: メモリ確保エラー */
+			ret = -1;
+			break;
+		}
+		point.file = (char*)file;
+		point.func = (char*)func;
+		(table->point)[table->num++] = point;
+	}
+
+	if ( reader->error ) {
+		/* ILC: 読み込みエラー、またはメモリ確保エラー */
+		ret = -1;
+	}
+	ILC_DatClose( reader );
+
+	/* ILC: ILC_DatLoad終了 */
+	return ret;
+}
+
+
+/**
+ * 計測ポイントを「ファイル名:関数名:行数」の順に並べ替える
+ * 同じ計測ポイントが複数ある場合は ILC_DatCombine で1つにまとめる。
+ * @param ILC_DAT_TABLE* メモリに展開したILCカバレッジデータファイル
+ */
+void ILC_DatSort (
+	ILC_DAT_TABLE* table
+)
+{
+	/**/
+	long src;
+	long dst = 0;
+	/**/
+	/* ILC: ILC_DatSort開始 */
+
+	for ( src = 1; src < table->num; src++ ) {
+		/* ILC: 並び順を確認(ilc-mergeの出力などは並べ替え済み) */
+		if ( ILC_DatCompare( &(table->point)[src - 1], &(table->point)[src] ) >= 0 ) {
+			/* ILC: 並べ替えが必要 */
+			break;
+		}
+	}
+
+	if ( src < table->num ) {
+		/* ILC: 並べ替えて、隣り合う同じ計測ポイントをまとめる */
+		qsort( table->point, (size_t)table->num, sizeof(ILC_DAT_POINT), ilc_dat_qsort_cmp );
+		for ( src = 1; src < table->num; src++ ) {
+			/* ILC: 直前と比較 */
+			if ( ILC_DatCompare( &(table->point)[dst], &(table->point)[src] ) == 0 ) {
+				/* ILC: 同じ計測ポイント */
+				ILC_DatCombine( &(table->point)[dst], &(table->point)[src] );
+			}
+			else {
+				/* ILC: 次の計測ポイント */
+				(table->point)[++dst] = (table->point)[src];
+			}
+		}
+		table->num = dst + 1;
+	}
+
+	/* ILC: ILC_DatSort終了 */
+}
+
+
+/**
+ * 計測ポイントを「ファイル名:関数名:行数」で比較する
+ * ファイル名、関数名は文字列として、行数は数値として比較する。
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return 負:前 0:同じ計測ポイント 正:後
+ */
+int ILC_DatCompare (
+	const ILC_DAT_POINT* a,
+	const ILC_DAT_POINT* b
+)
+{
+	/**/
+	int ret;
+	/**/
+	/* ILC: ILC_DatCompare開始 */
+
+	if ( a->file != b->file && (ret = strcmp( a->file, b->file )) != 0 ) {
+		/* ILC: ファイル名が異なる */
+		return ret;
+	}
+	if ( a->func != b->func && (ret = strcmp( a->func, b->func )) != 0 ) {
+		/* ILC: 関数名が異なる */
+		return ret;
+	}
+
+	/* ILC: ILC_DatCompare終了 */
+	return ( a->line < b->line ) ? -1 : ( a->line > b->line );
+}
+
+
+/**
+ * 同じ計測ポイントの結果をまとめる
+ * 通過フラグは論理和、通過回数は合計とする。
+ * どちらかに通過回数があれば、まとめた結果も通過回数を持つ。
+ * @param ILC_DAT_POINT*       まとめ先
+ * @param const ILC_DAT_POINT* まとめる計測ポイント
+ */
+void ILC_DatCombine (
+	ILC_DAT_POINT* dst,
+	const ILC_DAT_POINT* src
+)
+{
+	/**/
+	/**/
+	/* ILC: ILC_DatCombine開始 */
+
+	dst->flag = ( dst->flag || src->flag );
+	dst->count += src->count;
+	dst->has_count = ( dst->has_count || src->has_count );
+
+	/* ILC: ILC_DatCombine終了 */
+}
+
+
+/**
+ * 計測ポイントをILCカバレッジデータファイルの形式で1行書き出す
+ * @param FILE*                出力先
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return  0:正常終了
+ *         -1:書き込みエラー
+ */
+int ILC_DatWrite (
+	FILE* fp,
+	const ILC_DAT_POINT* point
+)
+{
+	/**/
+	int ret;
+	/**/
+	/* ILC: ILC_DatWrite開始 */
+
+	if ( point->has_count ) {
+		/* ILC: 通過回数あり */
+		ret = fprintf( fp, "%d:%s:%s:%ld:%llu\n", point->flag, point->file, point->func, point->line, point->count );
+	}
+	else {
+		/* ILC: 通過フラグのみ */
+		ret = fprintf( fp, "%d:%s:%s:%ld\n", point->flag, point->file, point->func, point->line );
+	}
+
+	/* ILC: ILC_DatWrite終了 */
+	return ( ret < 0 ) ? -1 : 0;
+}
+
+
+/**
+ * 計測ポイントをILCカバレッジデータファイルに書き込む
+ * 計測ポイントの並びはそのまま書き込む。
+ * @param const char*          ファイル名("-"の場合は標準出力)
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param long                 計測ポイントの数
+ * @param int                  ファイル形式(ILC_DAT_TEXT / ILC_DAT_BINARY)
+ * @return  0:正常終了
+ *         -1:ファイルオープンエラー、書き込みエラー、メモリ確保エラー、
+ *            またはバイナリ形式で表せない行数
+ */
+int ILC_DatSave (
+	const char* filename,
+	const ILC_DAT_POINT* point,
+	long num,
+	int format
+)
+{
+	/**/
+	FILE* fp;
+	long ix;
+	int ret = 0;
+	/**/
+	/* ILC: ILC_DatSave開始 */
+
+	if ( strcmp( filename, "-" ) == 0 ) {
+		/* ILC: 標準出力 */
+		fp = stdout;
+	}
+	else {
+		/* ILC: ファイル */
+		fp = fopen( filename, ( format == ILC_DAT_BINARY ) ? "wb" : "w" );
+		if ( fp == NULL ) {
+			/* ILC: ファイルオープンエラー */
+			return -1;
+		}
+		setvbuf( fp, NULL, _IOFBF, ILC_DAT_BUFSIZ );
+	}
+
+	if ( format == ILC_DAT_BINARY ) {
+		/* ILC: バイナリ形式 */
+		ret = ilc_dat_save_binary( fp, point, num );
+	}
+	else {
+		/* ILC: テキスト形式 */
+		for ( ix = 0; ix < num && ret == 0; ix++ ) {
+			/* ILC: 1行ずつ */
+			ret = ILC_DatWrite( fp, &point[ix] );
+		}
+	}
+
+	if ( fflush( fp ) != 0 ) {
+		/* ILC: 書き込みエラー */
+		ret = -1;
+	}
+	if ( fp != stdout && fclose( fp ) != 0 ) {
+		/* ILC: 書き込みエラー */
+		ret = -1;
+	}
+
+	/* ILC: ILC_DatSave終了 */
+	return ret;
+}
+
+
+/**
+ * ILC_DatLoad で展開したメモリを解放する
+ * 解放後は0で初期化した状態になる。
+ * @param ILC_DAT_TABLE* メモリに展開したILCカバレッジデータファイル
+ */
+void ILC_DatFree (
+	ILC_DAT_TABLE* table
+)
+{
+	/**/
+	ILC_DAT_CHUNK* chunk;
+	/**/
+	/* ILC: ILC_DatFree開始 */
+
+	while ( (chunk = table->chunk) != NULL ) {
+		/* ILC: 文字列の格納領域を解放 */
+		table->chunk = chunk->next;
+		free( chunk );
+	}
+	free( table->point );
+	memset( table, 0, sizeof(ILC_DAT_TABLE) );
+
+	/* ILC: ILC_DatFree終了 */
+}
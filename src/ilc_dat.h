@@ -0,0 +1,225 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	ilc_dat.h
+ * @brief	ILCカバレッジデータファイルの読み込み
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#ifndef _ILC_DAT_H_
+#define _ILC_DAT_H_
+
+#include <stdio.h>
+
+/**
+ * ILCカバレッジデータファイルの1行(計測ポイント)
+ * file / func は読み込み用バッファ内を指すため、次の ILC_DatRead
+ * (または ILC_DatClose)までの間だけ有効。
+ */
+typedef struct _ilc_dat_point {
+	int					flag;		/**< 通過フラグ(0:未通過 1:通過) */
+	char*				file;		/**< ファイル名 */
+	char*				func;		/**< 関数名 */
+	long				line;		/**< 行数 */
+	unsigned long long	count;		/**< 通過回数(has_countが0の場合は0) */
+	int					has_count;	/**< 通過回数の項目があるか(ILC_MODE_COUNT) */
+}
+ILC_DAT_POINT;
+
+/** 計測ポイントを通過済みか(通過フラグが立っている、または通過回数が1以上) */
+#define ILC_DAT_COVERED(p)	((p)->flag != 0 || (p)->count != 0)
+
+/** ファイル形式：テキスト(フラグ:ファイル名:関数名:行数[:回数]) */
+#define ILC_DAT_TEXT	(0)
+/** ファイル形式：バイナリ(文字列表 + 列ごとの配列) */
+#define ILC_DAT_BINARY	(1)
+
+/**
+ * ILCカバレッジデータファイルの読み込み状態
+ */
+typedef struct _ilc_dat_reader {
+	FILE*		fp;			/**< 読み込み中のファイル */
+	const char*	filename;	/**< ファイル名(エラー表示用) */
+	char*		buf;		/**< 読み込み用バッファ */
+	size_t		size;		/**< bufのサイズ */
+	size_t		pos;		/**< 未処理の先頭位置 */
+	size_t		len;		/**< bufに読み込んだバイト数 */
+	long		lineno;		/**< 最後に読み込んだ行の行番号 */
+	int			eof;		/**< ファイルの終わりに達したか */
+	int			error;		/**< 読み込みエラー、またはメモリ確保エラーが発生したか */
+	int			format;		/**< ファイル形式(ILC_DAT_TEXT / ILC_DAT_BINARY) */
+	long		num;		/**< ILC_DAT_BINARY: 計測ポイントの数 */
+	char**		strings;	/**< ILC_DAT_BINARY: 文字列表(IDの順) */
+	long		str_num;	/**< ILC_DAT_BINARY: 文字列の数 */
+	const unsigned long long*	count;		/**< ILC_DAT_BINARY: 通過回数の列(NULL:なし) */
+	const unsigned int*			file_id;	/**< ILC_DAT_BINARY: ファイル名のIDの列 */
+	const unsigned int*			func_id;	/**< ILC_DAT_BINARY: 関数名のIDの列 */
+	const int*					line;		/**< ILC_DAT_BINARY: 行数の列 */
+	const unsigned char*		flag;		/**< ILC_DAT_BINARY: フラグの列 */
+}
+ILC_DAT_READER;
+
+/*-
+ * ILCカバレッジデータファイルを先頭から1行ずつ読み込む。
+ * ファイル全体はメモリに展開せず、大きなブロック単位で読み込んだ
+ * バッファの中で行を分割するため、巨大なファイルでも使用メモリは
+ * 最も長い行の長さ程度で済む。
+ * バイナリ形式(ILC_DatSave で ILC_DAT_BINARY を指定して作成したもの)は
+ * 先頭の識別子で判定し、ファイル全体を読み込んでから1件ずつ返す。
+ * lineno はテキスト形式では行番号、バイナリ形式では計測ポイントの番号となる。
+ *
+ *   reader = ILC_DatOpen( "ilc.dat" );
+ *   while ( (ret = ILC_DatRead( reader, &point )) != 0 ) {
+ *       if ( ret > 0 ) { ... point を使う ... }
+ *   }
+ *   ILC_DatClose( reader );
+ */
+
+/**
+ * ILCカバレッジデータファイルを開く
+ * @param const char* ファイル名("-"の場合は標準入力)
+ * @return ILC_DAT_READER* 読み込み状態
+ *                         NULL:ファイルオープンエラー、またはメモリ確保エラー
+ */
+ILC_DAT_READER* ILC_DatOpen ( const char* );
+
+/**
+ * ILCカバレッジデータファイルから計測ポイントを1つ読み込む
+ * 空行は読み飛ばす。
+ * @param ILC_DAT_READER* 読み込み状態
+ * @param ILC_DAT_POINT*  読み込んだ計測ポイントの格納先
+ * @return  1:読み込んだ
+ *          0:ファイルの終わり
+ *         -1:形式が正しくない行(lineno の行、続けて次の行を読み込める)、
+ *            読み込みエラー、またはメモリ確保エラー(以降は0を返す)
+ */
+int ILC_DatRead ( ILC_DAT_READER*, ILC_DAT_POINT* );
+
+/**
+ * ILCカバレッジデータファイルを閉じる
+ * @param ILC_DAT_READER* 読み込み状態(NULLの場合は何もしない)
+ */
+void ILC_DatClose ( ILC_DAT_READER* );
+
+
+/**
+ * 文字列の格納領域(ILC_DAT_TABLE)
+ * 一杯になったら新しい領域を先頭に追加する(格納済みの文字列は移動しない)。
+ */
+typedef struct _ilc_dat_chunk {
+	struct _ilc_dat_chunk*	next;	/**< 次の領域 */
+	size_t					size;	/**< dataのサイズ */
+	size_t					used;	/**< 使用済みのバイト数 */
+	char					data[1];/**< 文字列(size分を確保する) */
+}
+ILC_DAT_CHUNK;
+
+/**
+ * メモリに展開したILCカバレッジデータファイル
+ * 0で初期化してから ILC_DatLoad に渡すこと。
+ * point の file / func は chunk 内を指す。連続する行で同じファイル名、
+ * 関数名は同じ領域を共有するため、通常は比較がポインタの比較で済む。
+ */
+typedef struct _ilc_dat_table {
+	ILC_DAT_POINT*	point;		/**< 計測ポイント */
+	long			num;		/**< 計測ポイントの数 */
+	long			capacity;	/**< pointの確保済みの数 */
+	ILC_DAT_CHUNK*	chunk;		/**< 文字列の格納領域 */
+	long			invalid;	/**< 形式が正しくないため読み飛ばした行数 */
+}
+ILC_DAT_TABLE;
+
+/**
+ * ILCカバレッジデータファイルをすべて読み込み、メモリに展開する
+ * 形式が正しくない行は読み飛ばし、invalid に数える。
+ * @param const char*    ファイル名("-"の場合は標準入力)
+ * @param ILC_DAT_TABLE* 展開先(読み込んだ計測ポイントを末尾に追加する)
+ * @return  0:正常終了
+ *         -1:ファイルオープンエラー、読み込みエラー、またはメモリ確保エラー
+ */
+int ILC_DatLoad ( const char*, ILC_DAT_TABLE* );
+
+/**
+ * 計測ポイントを「ファイル名:関数名:行数」の順に並べ替える
+ * 同じ計測ポイントが複数ある場合は ILC_DatCombine で1つにまとめる。
+ * @param ILC_DAT_TABLE* メモリに展開したILCカバレッジデータファイル
+ */
+void ILC_DatSort ( ILC_DAT_TABLE* );
+
+/**
+ * 計測ポイントを「ファイル名:関数名:行数」で比較する
+ * ファイル名、関数名は文字列として、行数は数値として比較する。
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return 負:前 0:同じ計測ポイント 正:後
+ */
+int ILC_DatCompare ( const ILC_DAT_POINT*, const ILC_DAT_POINT* );
+
+/**
+ * 同じ計測ポイントの結果をまとめる
+ * 通過フラグは論理和、通過回数は合計とする。
+ * どちらかに通過回数があれば、まとめた結果も通過回数を持つ。
+ * @param ILC_DAT_POINT*       まとめ先
+ * @param const ILC_DAT_POINT* まとめる計測ポイント
+ */
+void ILC_DatCombine ( ILC_DAT_POINT*, const ILC_DAT_POINT* );
+
+/**
+ * 計測ポイントをILCカバレッジデータファイルの形式で1行書き出す
+ * @param FILE*                出力先
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return  0:正常終了
+ *         -1:書き込みエラー
+ */
+int ILC_DatWrite ( FILE*, const ILC_DAT_POINT* );
+
+/**
+ * 計測ポイントをILCカバレッジデータファイルに書き込む
+ * 計測ポイントの並びはそのまま書き込む。
+ * @param const char*          ファイル名("-"の場合は標準出力)
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param long                 計測ポイントの数
+ * @param int                  ファイル形式(ILC_DAT_TEXT / ILC_DAT_BINARY)
+ * @return  0:正常終了
+ *         -1:ファイルオープンエラー、書き込みエラー、メモリ確保エラー、
+ *            またはバイナリ形式で表せない行数
+ */
+int ILC_DatSave ( const char*, const ILC_DAT_POINT*, long, int );
+
+/**
+ * ILC_DatLoad で展開したメモリを解放する
+ * 解放後は0で初期化した状態になる。
+ * @param ILC_DAT_TABLE* メモリに展開したILCカバレッジデータファイル
+ */
+void ILC_DatFree ( ILC_DAT_TABLE* );
+
+
+#endif /* _ILC_DAT_H_ */
@@ -0,0 +1,145 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	ilc_inline.h
+ * @brief	計測ポイントのインライン展開(ilc -n / -r で変換したソースがインクルードする)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#ifndef _ILC_INLINE_H_
+#define _ILC_INLINE_H_
+
+/*-
+ * 計測ポイントごとに静的な ILC_SITE を1つ持ち、通過時は
+ *
+ *   seen が __ilc_epoch と一致する : 記録済み。何もしない
+ *                                    (local が1なら site の通過回数だけ加算)
+ *   一致しない                     : __ilc_site_hit で libilc に記録する
+ *
+ * とする。初回通過以降は関数呼び出しがなく、予測の当たる分岐1つで済むため、
+ * 計測ポイントを含むループのインライン展開やベクトル化を妨げない。
+ *
+ * __ilc_epoch は ILC_Initialize、ILC_Reset( ILC_RESET_FLAG )、ILC_Finalize、
+ * fork した子プロセスで進むため、その後の初回通過は再び libilc に記録される。
+ * site の通過回数は ILC_Snapshot / ILC_Finalize で集計する。
+ * ILC_MODE_THREAD・ILC_MODE_MMAP・ILC_MODE_SHM の回数モードと標本化の場合は
+ * 記録済みにせず、通過のたびに libilc に記録する。
+ *
+ * libilc をリンクすること(__ilc_check を自前で用意する場合は使用できない)。
+ */
+
+/**
+ * 計測ポイントごとの記録状態
+ * 0 で初期化しておけば、初回通過時に libilc が設定する。
+ */
+typedef struct _ilc_site {
+	unsigned long		seen;		/**< 記録済みとした __ilc_epoch(0:未記録) */
+	int					local;		/**< 通過回数を count に数えるか */
+	unsigned long long	count;		/**< 集計前の通過回数(__atomic_xxxで読み書きする) */
+	long				id;			/**< 計測ポイントのID(key がある場合は初回通過時に検索する) */
+	const char*			key;		/**< ファイル名:関数名:行数(ID指定版はNULL) */
+	struct _ilc_site*	next;		/**< 通過回数を集計する site のリスト */
+	int					listed;		/**< リストに登録済みか */
+}
+ILC_SITE;
+
+/**
+ * 実行ファイルに埋め込む計測ポイント(ilc -r)
+ * ilc_points セクションに並べ、ILC_Initialize がリンカの作成する
+ * __start_ilc_points 〜 __stop_ilc_points を順に登録する。
+ */
+typedef struct _ilc_point {
+	const char*			file;		/**< ファイル名 */
+	const char*			func;		/**< 関数名 */
+	int					line;		/**< 行数 */
+	ILC_SITE*			site;		/**< 記録状態(登録時にIDを設定する。NULL:登録のみ) */
+}
+ILC_POINT;
+
+/** 記録済みの判定に使う世代(libilc が更新する) */
+extern unsigned long __ilc_epoch;
+
+/**
+ * 計測ポイントを libilc に記録し、可能なら記録済みにする
+ * @param ILC_SITE* 計測ポイントの記録状態
+ */
+void __ilc_site_hit ( ILC_SITE* );
+
+/** 計測ポイントの通過(site は計測ポイントごとの静的変数) */
+#define __ilc_site_check( site )											\
+	do {																	\
+		if ( __builtin_expect( (site).seen != __ilc_epoch, 0 ) ) {			\
+			__ilc_site_hit( &(site) );										\
+		}																	\
+		else if ( (site).local != 0 ) {										\
+			__atomic_fetch_add( &(site).count, 1, __ATOMIC_RELAXED );		\
+		}																	\
+	} while ( 0 )
+
+/**
+ * カバレッジ検出ポイント通過のフラグを立てる(__ilc_check のインライン版)
+ * @param const char* ファイル名:関数名:行数(文字列リテラル)
+ */
+#define __ilc_check_inline( str )											\
+	do {																	\
+		static ILC_SITE __ilc_site = { 0, 0, 0, -1, str, 0, 0 };			\
+		__ilc_site_check( __ilc_site );										\
+	} while ( 0 )
+
+/**
+ * カバレッジ検出ポイント通過のフラグを立てる(__ilc_check_id のインライン版)
+ * @param long 計測ポイントのID
+ */
+#define __ilc_check_id_inline( n )											\
+	do {																	\
+		static ILC_SITE __ilc_site = { 0, 0, 0, n, 0, 0, 0 };				\
+		__ilc_site_check( __ilc_site );										\
+	} while ( 0 )
+
+/**
+ * カバレッジ検出ポイント通過のフラグを立てる(ilc_points セクション登録版)
+ * 計測ポイントを ILC_Initialize で登録するため、ILCカバレッジデータファイルに
+ * なくてもよい。IDは登録時に設定し、通過時は検索しない。
+ * 配列として並ぶよう、ポインタ境界に揃えて配置する。
+ * @param const char* ファイル名(文字列リテラル)
+ * @param const char* 関数名(文字列リテラル)
+ * @param int         行数
+ */
+#define __ilc_check_point( file, func, line )								\
+	do {																	\
+		static ILC_SITE __ilc_site = { 0, 0, 0, -1, 0, 0, 0 };				\
+		static ILC_POINT __ilc_point										\
+			__attribute__((section("ilc_points"), used, aligned(sizeof(void*)))) \
+			= { file, func, line, &__ilc_site };							\
+		__ilc_site_check( __ilc_site );										\
+	} while ( 0 )
+
+#endif /* _ILC_INLINE_H_ */
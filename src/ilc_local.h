@@ -39,4 +39,146 @@
 
 #define ILC_FILE_DEFAULT "ilc.dat"
 
+/** スレッド別の記録領域の境界(キャッシュラインサイズ) */
+#define ILC_CACHE_LINE (64)
+
+/**
+ * スレッド別の記録領域(ILC_MODE_THREAD)
+ * スレッドごとに1つ作成し、__ilc_check はこの領域にのみ書き込む。
+ * 他のスレッドと同じキャッシュラインを共有しないよう、
+ * ILC_CACHE_LINE 境界に配置する。
+ * flag・count は __atomic_xxx(relaxed)で読み書きする。count に書き込むのは
+ * 作成したスレッドだけで、集計・クリアする側は base を進めて
+ * count - base を未集計の通過回数として扱う。
+ * 領域はスレッド終了時(pthread_key のデストラクタ)に集計して解放する。
+ */
+typedef struct _ilc_shard {
+	struct _ilc_shard*	next;		/**< 次の記録領域 */
+	unsigned long		generation;	/**< 作成時の ILC_Initialize の世代 */
+	long				num;		/**< 計測ポイントの数 */
+	char*				flag;		/**< 通過フラグ */
+	unsigned long long*	count;		/**< 通過回数(ILC_MODE_COUNT以外はNULL) */
+	unsigned long long*	base;		/**< 集計済み・クリア済みの通過回数(__ilc_shard_lock で排他する) */
+}
+ILC_SHARD;
+
+/**
+ * 「ファイル名:関数名:行数」を分解したもの
+ * ファイル名・関数名は元の文字列内を指し、NULL終端していない。
+ */
+typedef struct _ilc_key {
+	const char*			file;		/**< ファイル名の先頭 */
+	size_t				file_len;	/**< ファイル名の長さ */
+	const char*			func;		/**< 関数名の先頭 */
+	size_t				func_len;	/**< 関数名の長さ */
+	int					line;		/**< 行数 */
+	const char*			rest;		/**< 行数の後ろ(通過回数があれば ":回数") */
+}
+ILC_KEY;
+
+/** ILC_MODE_SIGNAL: スナップショットを要求するシグナル */
+#define ILC_SNAPSHOT_SIGNAL SIGUSR1
+
+/** 書き出し途中の一時ファイルの拡張子(ファイル名 + "." + プロセスID の後ろにつける) */
+#define ILC_TMP_SUFFIX ".tmp"
+
+/** 自動初期化: ILCカバレッジデータファイル名を指定する環境変数 */
+#define ILC_ENV_FILE "ILC_FILE"
+
+/** 自動初期化: 動作モードを指定する環境変数(数値、または "count,thread" など) */
+#define ILC_ENV_MODE "ILC_MODE"
+
+/** 自動初期化: 通過回数の標本化の間隔を指定する環境変数(ILC_SetSampling) */
+#define ILC_ENV_SAMPLE "ILC_SAMPLE"
+
+/** 異常終了時の書き出しバッファのサイズ */
+#define ILC_CRASH_BUFSIZ (64 * 1024)
+
+/** 通過回数ファイル(ILC_MODE_MMAP)の拡張子 */
+#define ILC_COUNT_SUFFIX ".cnt"
+
+/** 通過回数ファイルの識別子 */
+#define ILC_COUNT_MAGIC "ILCCNT01"
+
+/**
+ * 通過回数ファイル(ILC_MODE_MMAP)のヘッダ
+ * ヘッダの直後に unsigned long long の通過回数が num 個並ぶ。
+ * 通過回数は ILCカバレッジデータファイルの値を含めた累計で持つ。
+ */
+typedef struct _ilc_count_header {
+	char				magic[8];	/**< ILC_COUNT_MAGIC */
+	long long			num;		/**< 計測ポイントの数 */
+}
+ILC_COUNT_HEADER;
+
+/** バイナリ形式のILCカバレッジデータファイルの識別子 */
+#define ILC_DAT_MAGIC "ILCDAT01"
+
+/** バイトオーダーの確認用(書き込んだ環境と同じ値で読めること) */
+#define ILC_DAT_ENDIAN (0x01020304U)
+
+/** ILC_DAT_HEADER.flags: 通過回数の列あり */
+#define ILC_DAT_HAS_COUNT (0x01U)
+
+/** 計測ポイントのフラグ列: 通過フラグ */
+#define ILC_DAT_FLAG_COVERED (0x01U)
+/** 計測ポイントのフラグ列: 通過回数の項目あり(テキスト形式の5番目の項目) */
+#define ILC_DAT_FLAG_COUNT (0x02U)
+
+/**
+ * バイナリ形式のILCカバレッジデータファイルのヘッダ
+ * ヘッダの後に次の順で並ぶ。各部分は8バイト境界から始まる。
+ *
+ *   文字列表 : ファイル名・関数名をNULL終端で str_num 個(str_size バイト、
+ *              8の倍数になるよう'\0'で埋める)。先頭から 0, 1, ... がIDとなる。
+ *   通過回数 : unsigned long long[num] (ILC_DAT_HAS_COUNT の場合のみ)
+ *   ファイル : unsigned int[num]   ファイル名のID
+ *   関数     : unsigned int[num]   関数名のID
+ *   行数     : int[num]
+ *   フラグ   : unsigned char[num]  ILC_DAT_FLAG_xxx の論理和
+ *
+ * 計測ポイントの並びはテキスト形式の行の並びと同じ
+ * (ilc -i のIDがそのまま使える)。
+ */
+typedef struct _ilc_dat_header {
+	char				magic[8];	/**< ILC_DAT_MAGIC */
+	unsigned int		endian;		/**< ILC_DAT_ENDIAN */
+	unsigned int		flags;		/**< ILC_DAT_HAS_COUNT */
+	long long			num;		/**< 計測ポイントの数 */
+	long long			str_num;	/**< 文字列の数 */
+	long long			str_size;	/**< 文字列表のバイト数(8の倍数) */
+}
+ILC_DAT_HEADER;
+
+/** ILC_MODE_SHM: 共有メモリ名を指定する環境変数(なければ "/ilc.プロセスID") */
+#define ILC_ENV_SHM "ILC_SHM"
+
+/** ILC_MODE_SHM: 共有メモリ名の接頭辞 */
+#define ILC_SHM_PREFIX "/ilc."
+
+/** 共有メモリ(ILC_MODE_SHM)の識別子 */
+#define ILC_SHM_MAGIC "ILCSHM01"
+
+/**
+ * 共有メモリ(ILC_MODE_SHM)のヘッダ
+ * ヘッダの後はバイナリ形式のILCカバレッジデータファイル(ILC_DAT_HEADER)と
+ * 同じ順で、文字列表・通過回数・ファイル・関数・行数・フラグが並ぶ。
+ * 計測ポイントは ILC_Initialize 時点のもの(flag_num個)で、以後は増えない。
+ * 通過回数とフラグの列は計測中のプロセスが更新し続ける。
+ * 他の項目をすべて書き込んでから magic を書き込むため、magic が一致すれば
+ * 内容は揃っている。
+ */
+typedef struct _ilc_shm_header {
+	char				magic[8];	/**< ILC_SHM_MAGIC */
+	unsigned int		endian;		/**< ILC_DAT_ENDIAN */
+	unsigned int		flags;		/**< ILC_DAT_HAS_COUNT */
+	long long			num;		/**< 計測ポイントの数 */
+	long long			str_num;	/**< 文字列の数 */
+	long long			str_size;	/**< 文字列表のバイト数(8の倍数) */
+	long long			pid;		/**< 計測中のプロセスID */
+	long long			size;		/**< 共有メモリ全体のバイト数 */
+	long long			sampling;	/**< 通過回数の標本化の間隔(1以下:すべて数える) */
+}
+ILC_SHM_HEADER;
+
 #endif /* _ILC_LOCAL_H_ */
@@ -36,6 +36,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 #include "ilc.h"
 #include "ilc_util.h"
 #include "ilc_util_local.h"
@@ -44,6 +45,9 @@
 /** RCSID */
 static const char rcsid[] = "@(#) $Id: ilc_util.c,v 1.2 2008/05/25 13:22:49 shingo Exp $";
 
+/* ILCカバレッジデータへの登録の排他(複数スレッドで変換する場合) */
+static pthread_mutex_t ilc_data_lock = PTHREAD_MUTEX_INITIALIZER;
+
 
 /**
  * ILCデータの初期化
@@ -62,6 +66,7 @@ void ilc_init (
 	ilc->fpin     = stdin;
 	ilc->fpout    = stdout;
 	ilc->ilc_func = NULL;
+	ilc->ilc_data = NULL;
 
 	/* ILC: ilc_init終了 */
 }
@@ -494,6 +499,173 @@ void ilc_put_coverage (
 }
 
 
+/**
+ * カバレッジ検出コードの出力(ID指定版)
+ * @param FILE*       出力先
+ * @param long        計測ポイントのID
+ */
+void ilc_put_coverage_id (
+	FILE* fout,
+	long id
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_put_coverage_id開始 */
+
+	if ( fout != NULL ) {
+		/* ILC: 念のためにNULLポインタをガード */
+		fprintf( fout, COVERAGECODE_ID, id );
+	}
+
+	/* ILC: ilc_put_coverage_id終了 */
+}
+
+
+/**
+ * カバレッジ検出コードの出力(インライン版)
+ * @param FILE*       出力先
+ * @param const char* ソースファイル名
+ * @param const char* 関数名
+ * @param const int   検出行
+ */
+void ilc_put_coverage_inline (
+	FILE* fout,
+	const char* src_name,
+	const char* func_name,
+	const int line
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_put_coverage_inline開始 */
+
+	if ( fout != NULL && src_name != NULL && func_name != NULL ) {
+		/* ILC: 念のためにNULLポインタをガード */
+		fprintf( fout, COVERAGECODE_INLINE, src_name, func_name, line );
+	}
+
+	/* ILC: ilc_put_coverage_inline終了 */
+}
+
+
+/**
+ * カバレッジ検出コードの出力(ID指定・インライン版)
+ * @param FILE*       出力先
+ * @param long        計測ポイントのID
+ */
+void ilc_put_coverage_id_inline (
+	FILE* fout,
+	long id
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_put_coverage_id_inline開始 */
+
+	if ( fout != NULL ) {
+		/* ILC: 念のためにNULLポインタをガード */
+		fprintf( fout, COVERAGECODE_ID_INLINE, id );
+	}
+
+	/* ILC: ilc_put_coverage_id_inline終了 */
+}
+
+
+/**
+ * カバレッジ検出コードの出力(ilc_points セクション登録版)
+ * @param FILE*       出力先
+ * @param const char* ソースファイル名
+ * @param const char* 関数名
+ * @param const int   検出行
+ */
+void ilc_put_coverage_point (
+	FILE* fout,
+	const char* src_name,
+	const char* func_name,
+	const int line
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_put_coverage_point開始 */
+
+	if ( fout != NULL && src_name != NULL && func_name != NULL ) {
+		/* ILC: 念のためにNULLポインタをガード */
+		fprintf( fout, COVERAGECODE_POINT, src_name, func_name, line );
+	}
+
+	/* ILC: ilc_put_coverage_point終了 */
+}
+
+
+/**
+ * インライン版の変換後ファイルの先頭に、ilc_inline.h のインクルードを出力する
+ * 直後に #line 1 を出力し、以降の行番号を変換元のファイルと揃える。
+ * @param FILE*       出力先
+ */
+void ilc_put_inline_header (
+	FILE* fout
+)
+{
+	/**/
+	/**/
+	/* ILC: ilc_put_inline_header開始 */
+
+	if ( fout != NULL ) {
+		/* ILC: 念のためにNULLポインタをガード */
+		fputs( COVERAGECODE_INLINE_HEADER, fout );
+	}
+
+	/* ILC: ilc_put_inline_header終了 */
+}
+
+
+/**
+ * 計測ポイントのIDを取得する
+ * ILCカバレッジデータに未登録の場合は、登録してからIDを返す。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* ソースファイル名
+ * @param const char* 関数名
+ * @param int         検出行
+ * @return 計測ポイントのID
+ *         -1:異常終了（メモリ確保エラー）
+ */
+long ilc_coverage_id (
+	ILC_DATA* ilc_data,
+	const char* src_name,
+	const char* func_name,
+	int line
+)
+{
+	/**/
+	char *buf;		/* ILCカバレッジデータに登録するためのバッファ */
+	long id = -1;
+	/**/
+	/* ILC: ilc_coverage_id開始 */
+
+	/* フラグ(1) + ':' x 3 + 行数(10) + '\0' */
+	buf = (char*)xmalloc( strlen( src_name ) + strlen( func_name ) + 1 + 3 + 10 + 1 );
+	if ( buf != NULL ) {
+		/* ILC: 登録用文字列の作成 */
+		sprintf( buf, "0:%s:%s:%d", src_name, func_name, line );
+		pthread_mutex_lock( &ilc_data_lock );
+		id = ILC_SearchId( ilc_data, buf + 2 );
+		if ( id < 0 && ILC_AppendCopy( ilc_data, buf ) == ILC_SUCCESS ) {
+			/* ILC: 未登録なので末尾に追加し、そのIDを使用する */
+			id = ilc_data->num - 1;
+		}
+		pthread_mutex_unlock( &ilc_data_lock );
+
+		/* 登録内容は ILC_AppendCopy 内で展開されるため、登録用文字列は不要 */
+		xfree( buf );
+	}
+
+	/* ILC: ilc_coverage_id終了 */
+	return id;
+}
+
+
 /**
  * ILCデータをILCカバレッジデータに変換する
  * @param ILC*      変換元のILCデータ
@@ -519,6 +691,8 @@ int ilc2ilcdata (
 
 	fname_len = strlen(ilc->file_in);
 
+	pthread_mutex_lock( &ilc_data_lock );
+
 	for ( func = ilc->ilc_func, breakflg = 0; func != NULL && breakflg == 0 ; func = func->next ) {
 		/**/
 		size_t func_len;	/* 関数名の長さ */
@@ -547,7 +721,7 @@ int ilc2ilcdata (
 				if ( ILC_Search( ilc_data, buf + 2 ) == NULL ) {
 					/* ILC: `0:' を飛ばしたものを渡す必要がある */
 					/* 未登録なので、ILCカバレッジデータに登録する */
-					if ( ILC_Append( ilc_data, buf ) == ILC_FAILURE ) {
+					if ( ILC_AppendCopy( ilc_data, buf ) == ILC_FAILURE ) {
 						/* ILC: 登録に失敗したため、トップレベルのループを終了 */
 						xfree( buf );
 						breakflg = 1;
@@ -555,10 +729,8 @@ int ilc2ilcdata (
 						break;
 					}
 				}
-				else {
-					/* ILC:登録済みの場合は、使用しないため解放する */
-					xfree( buf );
-				}
+				/* 登録内容は ILC_AppendCopy 内で展開されるため、登録用文字列は解放する */
+				xfree( buf );
 			}
 			else {
 				/* ILC: 登録に失敗したため、トップレベルのループを終了 */
@@ -569,6 +741,8 @@ int ilc2ilcdata (
 		}
 	}
 
+	pthread_mutex_unlock( &ilc_data_lock );
+
 	/* ILC: ilc2ilcdata終了 */
 	return ret;
 }
@@ -576,3 +750,94 @@ int ilc2ilcdata (
 
 
 
+
+
+/**
+ * ILCデータの計測ポイントをマニフェスト(ilc -m)として書き出す
+ * ILCカバレッジデータファイルと同じテキスト形式で、出現順に1行ずつ書き出す。
+ * ILCカバレッジデータは参照しないため、排他は不要。
+ * @param ILC*  書き出すILCデータ
+ * @param FILE* 出力先
+ * @return  0:正常終了
+ *         -1:書き込みエラー
+ */
+int ilc2manifest (
+	ILC* ilc,
+	FILE* fout
+)
+{
+	/**/
+	SLIST* func;
+	SLIST* comment;
+	int ret = 0;
+	/**/
+	/* ILC: ilc2manifest開始 */
+
+	for ( func = ilc->ilc_func; func != NULL && ret == 0; func = func->next ) {
+		/* ILC: 関数名でループ */
+		for ( comment = FUNC(func)->ilc_comment; comment != NULL; comment = comment->next ) {
+			/* ILC: ILCコメントごとに1行 */
+			if ( fprintf( fout, MANIFESTCODE, ilc->file_in, FUNC(func)->func_name, COMMENT(comment)->line ) < 0 ) {
+				/* ILC: 書き込みエラー */
+				ret = -1;
+				break;
+			}
+		}
+	}
+
+	/* ILC: ilc2manifest終了 */
+	return ret;
+}
+
+
+/**
+ * マニフェスト(ilc -m)の計測ポイントをILCカバレッジデータに登録する
+ * ILCカバレッジデータに未登録の計測ポイントのみ登録する。空行は読み飛ばす。
+ * ILCカバレッジデータへの登録は排他するため、複数スレッドから呼び出せる。
+ * @param FILE*     マニフェスト
+ * @param ILC_DATA* 登録先のILCカバレッジデータ
+ * @return  0:正常終了
+ *         -1:異常終了（メモリ確保エラー、形式エラー）
+ */
+int manifest2ilcdata (
+	FILE* fin,
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	char* line = NULL;
+	size_t size = 0;
+	ssize_t len;
+	int ret = 0;
+	/**/
+	/* ILC: manifest2ilcdata開始 */
+
+	pthread_mutex_lock( &ilc_data_lock );
+
+	while ( ret == 0 && (len = getline( &line, &size, fin )) > 0 ) {
+		/* ILC: 1行ずつ登録する */
+		while ( len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r') ) {
+			/* ILC: 行末の改行を取り除く */
+			line[--len] = '\0';
+		}
+		if ( len == 0 ) {
+			/* ILC: 空行 */
+			continue;
+		}
+		if ( len < 2 || line[1] != ':' ) {
+			/* ILC: フラグ:ファイル名:関数名:行数 の形式でない */
+			ret = -1;
+		}
+		else if ( ILC_Search( ilc_data, line + 2 ) == NULL && ILC_AppendCopy( ilc_data, line ) == ILC_FAILURE ) {
+			/* ILC: 未登録なので登録したが、失敗 */
+			ret = -1;
+		}
+	}
+
+	pthread_mutex_unlock( &ilc_data_lock );
+
+	free( line );
+
+	/* ILC: manifest2ilcdata終了 */
+	return ret;
+}
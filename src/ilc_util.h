@@ -43,6 +43,27 @@
 /** カバレッジ検出ポイントに埋め込む文字列 */
 #define COVERAGECODE "*/ __ilc_check( \"%s:%s:%d\" ); /*"
 
+/** カバレッジ検出ポイントに埋め込む文字列(ID指定版) */
+#define COVERAGECODE_ID "*/ __ilc_check_id( %ld ); /*"
+
+/** カバレッジ検出ポイントに埋め込む文字列(インライン版) */
+#define COVERAGECODE_INLINE "*/ __ilc_check_inline( \"%s:%s:%d\" ); /*"
+
+/** カバレッジ検出ポイントに埋め込む文字列(ID指定・インライン版) */
+#define COVERAGECODE_ID_INLINE "*/ __ilc_check_id_inline( %ld ); /*"
+
+/** カバレッジ検出ポイントに埋め込む文字列(ilc_points セクション登録版) */
+#define COVERAGECODE_POINT "*/ __ilc_check_point( \"%s\", \"%s\", %d ); /*"
+
+/** マニフェスト(ilc -m)の拡張子 */
+#define MANIFEST_SUFFIX ".ilcm"
+
+/** マニフェストの1行(ILCカバレッジデータファイルと同じ形式: フラグ:ファイル名:関数名:行数) */
+#define MANIFESTCODE "0:%s:%s:%lu\n"
+
+/** インライン版の変換後ファイルの先頭に埋め込む文字列(以降の行番号は変換元と揃える) */
+#define COVERAGECODE_INLINE_HEADER "#include \"ilc_inline.h\"\n#line 1\n"
+
 /*-
  * データ構造
  * ILC         : 処理対象ファイルのすべての情報を束ねる。
@@ -94,6 +115,8 @@ typedef struct _ilc {
 	FILE*			fpin;			/**< 入力元 */
 	FILE*			fpout;			/**< 出力先 */
 	SLIST*   	    ilc_func;		/**< ILC情報 */
+	ILC_DATA*		ilc_data;		/**< ID指定で出力する場合の登録先(NULL:文字列で出力) */
+	int				inline_mode;	/**< 0以外:インライン展開するマクロで出力(2:ilc_points セクションに登録) */
 }
 ILC;
 
@@ -192,9 +215,61 @@ int ilc_append_coverage( SLIST**, const char*, int );
  */
 void ilc_put_coverage ( FILE*, const char*, const char*, int );
 
+/**
+ * カバレッジ検出コードの出力(ID指定版)
+ * @param FILE*       出力先
+ * @param long        計測ポイントのID
+ */
+void ilc_put_coverage_id ( FILE*, long );
+
+/**
+ * カバレッジ検出コードの出力(インライン版)
+ * @param FILE*       出力先
+ * @param const char* ソースファイル名
+ * @param const char* 関数名
+ * @param const int   検出行
+ */
+void ilc_put_coverage_inline ( FILE*, const char*, const char*, int );
+
+/**
+ * カバレッジ検出コードの出力(ID指定・インライン版)
+ * @param FILE*       出力先
+ * @param long        計測ポイントのID
+ */
+void ilc_put_coverage_id_inline ( FILE*, long );
+
+/**
+ * カバレッジ検出コードの出力(ilc_points セクション登録版)
+ * @param FILE*       出力先
+ * @param const char* ソースファイル名
+ * @param const char* 関数名
+ * @param const int   検出行
+ */
+void ilc_put_coverage_point ( FILE*, const char*, const char*, int );
+
+/**
+ * インライン版の変換後ファイルの先頭に、ilc_inline.h のインクルードを出力する
+ * @param FILE*       出力先
+ */
+void ilc_put_inline_header ( FILE* );
+
+/**
+ * 計測ポイントのIDを取得する
+ * ILCカバレッジデータに未登録の場合は、登録してからIDを返す。
+ * ILCカバレッジデータへの登録は排他するため、複数スレッドから呼び出せる。
+ * @param ILC_DATA*   ILCカバレッジデータ
+ * @param const char* ソースファイル名
+ * @param const char* 関数名
+ * @param int         検出行
+ * @return 計測ポイントのID
+ *         -1:異常終了（メモリ確保エラー）
+ */
+long ilc_coverage_id ( ILC_DATA*, const char*, const char*, int );
+
 
 /**
  * ILCデータをILCカバレッジデータに変換する
+ * ILCカバレッジデータへの登録は排他するため、複数スレッドから呼び出せる。
  * @param ILC*      変換元のILCデータ
  * @param ILC_DATA* 変換後のILCカバレッジデータ
  * @return  0:正常終了
@@ -202,6 +277,26 @@ void ilc_put_coverage ( FILE*, const char*, const char*, int );
  */
 int ilc2ilcdata ( ILC*, ILC_DATA* );
 
+/**
+ * ILCデータの計測ポイントをマニフェスト(ilc -m)として書き出す
+ * ILCカバレッジデータファイルと同じテキスト形式で、出現順に1行ずつ書き出す。
+ * @param ILC*  書き出すILCデータ
+ * @param FILE* 出力先
+ * @return  0:正常終了
+ *         -1:書き込みエラー
+ */
+int ilc2manifest ( ILC*, FILE* );
+
+/**
+ * マニフェスト(ilc -m)の計測ポイントをILCカバレッジデータに登録する
+ * ILCカバレッジデータへの登録は排他するため、複数スレッドから呼び出せる。
+ * @param FILE*     マニフェスト
+ * @param ILC_DATA* 登録先のILCカバレッジデータ
+ * @return  0:正常終了
+ *         -1:異常終了（メモリ確保エラー、形式エラー）
+ */
+int manifest2ilcdata ( FILE*, ILC_DATA* );
+
 
 #endif /* _ILC_UTIL_H_ */
 
@@ -0,0 +1,511 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	link.c
+ * @brief	ilc -m で変換時に作成したマニフェストを、1つのILCカバレッジデータファイルにまとめる(ilc-link)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ilc_dat.h"
+
+/*-
+ * ilc -m は変換したファイルごとに、計測ポイントの一覧(マニフェスト、
+ * ILCカバレッジデータファイルと同じテキスト形式)を「変換後のファイル名.ilcm」に
+ * 書き出す。変換時は共有するファイルを読み書きしないため、make -j で
+ * 並列に変換しても計測ポイントが失われない。
+ *
+ * ilc-link はすべてのマニフェストを1回ずつ読み込み、同じ計測ポイントを
+ * 1つにまとめて書き出す。-f で指定したILCカバレッジデータファイルの
+ * 計測ポイントは並びと結果をそのまま残し、新しい計測ポイントを末尾に追加する。
+ * -c を指定すると、計測ポイントを ilc_points セクションに登録するCのソースを
+ * 書き出す(実行ファイルにリンクすると、ILC_Initialize がファイルなしで登録する)。
+ */
+
+/**
+ * 計測ポイントの検索用ハッシュ表(オープンアドレス法)
+ */
+typedef struct _link_index {
+	long*			slot;		/**< 出力する計測ポイントの添字+1(0:空き) */
+	unsigned long	mask;		/**< slotの数-1(slotの数は2のべき乗) */
+}
+LINK_INDEX;
+
+/**
+ * 入力ファイル名の一覧
+ */
+typedef struct _link_files {
+	char**			name;		/**< ファイル名 */
+	int				num;		/**< ファイル名の数 */
+	int				capacity;	/**< nameの確保済みの数 */
+}
+LINK_FILES;
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-link [options] manifest ...\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -b           write the binary format\n", stdout);
+  fputs("  -c cfile     write a C source registering the points in the ilc_points section\n", stdout);
+  fputs("  -f datafile  keep the points and results in datafile, appending new points\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  -o outfile   output file (default: standard output, none with -c)\n", stdout);
+  fputs("  manifest     .ilcm file written by ilc -m\n", stdout);
+  fputs("  @listfile    read manifest names from listfile, one per line\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+/**
+ * 計測ポイントのハッシュ値を求める(FNV-1a)
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return ハッシュ値
+ */
+unsigned long link_hash (
+	const ILC_DAT_POINT* point
+)
+{
+	/**/
+	unsigned long hash = 2166136261UL;
+	const unsigned char* ptr;
+	/**/
+	/* ILC: link_hash開始 */
+
+	for ( ptr = (const unsigned char*)point->file; *ptr != '\0'; ptr++ ) {
+		/* ILC: ファイル名 */
+		hash = ( hash ^ *ptr ) * 16777619UL;
+	}
+	hash = ( hash ^ ':' ) * 16777619UL;
+	for ( ptr = (const unsigned char*)point->func; *ptr != '\0'; ptr++ ) {
+		/* ILC: 関数名 */
+		hash = ( hash ^ *ptr ) * 16777619UL;
+	}
+	hash = ( hash ^ (unsigned long)point->line ) * 16777619UL;
+
+	/* ILC: link_hash終了 */
+	return hash;
+}
+
+
+/**
+ * 読み込んだ計測ポイントを、同じ計測ポイントをまとめながら先頭から順に並べる
+ * 最初に出現した位置に、後から出現したものの結果をまとめる。
+ * @param const ILC_DAT_TABLE* 読み込んだ計測ポイント
+ * @param ILC_DAT_POINT*       出力する計測ポイントの格納先(table->num個以上)
+ * @return 出力する計測ポイントの数
+ *         -1:メモリ確保エラー
+ */
+long link_points (
+	const ILC_DAT_TABLE* table,
+	ILC_DAT_POINT* out
+)
+{
+	/**/
+	LINK_INDEX index;
+	unsigned long size = 64;
+	unsigned long pos;
+	long num = 0;
+	long ix;
+	/**/
+	/* ILC: link_points開始 */
+
+	while ( size < (unsigned long)table->num * 2 ) {
+		/* ILC: 負荷率が1/2以下になる大きさ */
+		size *= 2;
+	}
+	index.slot = (long*)calloc( size, sizeof(long) );
+	index.mask = size - 1;
+	if ( index.slot == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+
+	for ( ix = 0; ix < table->num; ix++ ) {
+		/* ILC: 読み込んだ順に登録 */
+		for ( pos = link_hash( &(table->point)[ix] ) & index.mask;
+			  index.slot[pos] != 0;
+			  pos = ( pos + 1 ) & index.mask ) {
+			/* ILC: 空きを検出するまで線形探査 */
+			if ( ILC_DatCompare( &out[ index.slot[pos] - 1 ], &(table->point)[ix] ) == 0 ) {
+				/* ILC: 同じ計測ポイント */
+				break;
+			}
+		}
+		if ( index.slot[pos] != 0 ) {
+			/* ILC: 登録済みの計測ポイントに結果をまとめる */
+			ILC_DatCombine( &out[ index.slot[pos] - 1 ], &(table->point)[ix] );
+		}
+		else {
+			/* ILC: 新しい計測ポイントは末尾に追加 */
+			out[num] = (table->point)[ix];
+			index.slot[pos] = ++num;
+		}
+	}
+
+	free( index.slot );
+
+	/* ILC: link_points終了 */
+	return num;
+}
+
+
+/**
+ * 入力ファイル名を一覧に追加する
+ * 一覧の領域は倍々で拡張する。
+ * @param LINK_FILES* 入力ファイル名の一覧
+ * @param const char* 追加するファイル名(複製して追加する)
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー
+ */
+int link_add_file (
+	LINK_FILES* files,
+	const char* name
+)
+{
+	/**/
+	char** names;
+	char* str;
+	int capacity;
+	/**/
+	/* ILC: link_add_file開始 */
+
+	if ( files->num >= files->capacity ) {
+		/* ILC: 一覧を拡張する */
+		capacity = ( files->capacity < 16 ) ? 16 : files->capacity * 2;
+		names = (char**)realloc( files->name, sizeof(char*) * (size_t)capacity );
+		if ( names == NULL ) {
+			/* ILC: メモリ確保エラー */
+			return -1;
+		}
+		files->name = names;
+		files->capacity = capacity;
+	}
+	str = strdup( name );
+	if ( str == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+	(files->name)[ files->num++ ] = str;
+
+	/* ILC: link_add_file終了 */
+	return 0;
+}
+
+
+/**
+ * @ファイル名 に1行1ファイルで書かれたファイル名を一覧に追加する
+ * 空行は読み飛ばす。
+ * @param LINK_FILES* 入力ファイル名の一覧
+ * @param const char* ファイル名の一覧のファイル
+ * @return  0:正常終了
+ *         -1:ファイルが読み込めない、またはメモリ確保エラー
+ */
+int link_add_list (
+	LINK_FILES* files,
+	const char* list
+)
+{
+	/**/
+	FILE* fp;
+	char* line = NULL;
+	size_t size = 0;
+	ssize_t len;
+	int ret = 0;
+	/**/
+	/* ILC: link_add_list開始 */
+
+	fp = fopen( list, "r" );
+	if ( fp == NULL ) {
+		/* ILC: ファイルオープンエラー */
+		return -1;
+	}
+
+	while ( ret == 0 && (len = getline( &line, &size, fp )) > 0 ) {
+		/* ILC: 1行ずつ読み込む */
+		while ( len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r') ) {
+			/* ILC: 改行を取り除く */
+			line[--len] = '\0';
+		}
+		if ( len == 0 ) {
+			/* ILC: 空行 */
+			continue;
+		}
+		if ( link_add_file( files, line ) != 0 ) {
+			/* ILC: メモリ確保エラー */
+			ret = -1;
+		}
+	}
+	if ( ferror( fp ) ) {
+		/* ILC: 読み込みエラー */
+		ret = -1;
+	}
+
+	free( line );
+	fclose( fp );
+
+	/* ILC: link_add_list終了 */
+	return ret;
+}
+
+
+/**
+ * 文字列をCの文字列リテラルとして書き出す
+ * @param FILE*       出力先
+ * @param const char* 文字列
+ */
+void link_cstr (
+	FILE* fp,
+	const char* str
+)
+{
+	/**/
+	const unsigned char* ptr;
+	/**/
+	/* ILC: link_cstr開始 */
+
+	putc( '"', fp );
+	for ( ptr = (const unsigned char*)str; *ptr != '\0'; ptr++ ) {
+		/* ILC: 1文字ずつ */
+		if ( *ptr == '"' || *ptr == '\\' ) {
+			/* ILC: エスケープが必要な文字 */
+			putc( '\\', fp );
+			putc( *ptr, fp );
+		}
+		else if ( *ptr < 0x20 || *ptr == 0x7f ) {
+			/* ILC: 制御文字は8進数で書く */
+			fprintf( fp, "\\%03o", *ptr );
+		}
+		else {
+			/* ILC: そのまま */
+			putc( *ptr, fp );
+		}
+	}
+	putc( '"', fp );
+
+	/* ILC: link_cstr終了 */
+}
+
+
+/**
+ * 計測ポイントを ilc_points セクションに登録するCのソースを書き出す
+ * @param const char*          ファイル名
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @param long                 計測ポイントの数
+ * @return  0:正常終了
+ *         -1:ファイルオープンエラー、または書き込みエラー
+ */
+int link_ctable (
+	const char* path,
+	const ILC_DAT_POINT* point,
+	long num
+)
+{
+	/**/
+	FILE* fp;
+	long ix;
+	int ret = 0;
+	/**/
+	/* ILC: link_ctable開始 */
+
+	fp = fopen( path, "w" );
+	if ( fp == NULL ) {
+		/* ILC: ファイルオープンエラー */
+		return -1;
+	}
+
+	fputs( "/* ilc-link で作成したファイル。編集しないこと */\n", fp );
+	fputs( "#include \"ilc_inline.h\"\n\n", fp );
+	if ( num > 0 ) {
+		/* ILC: 計測ポイントの配列(ILC_Initialize が __start_ilc_points から登録する) */
+		fputs( "static ILC_POINT __ilc_link_points[]\n", fp );
+		fputs( "\t__attribute__((section(\"ilc_points\"), used, aligned(sizeof(void*)))) = {\n", fp );
+		for ( ix = 0; ix < num; ix++ ) {
+			/* ILC: 計測ポイントごとに1行 */
+			fputs( "\t{ ", fp );
+			link_cstr( fp, point[ix].file );
+			fputs( ", ", fp );
+			link_cstr( fp, point[ix].func );
+			fprintf( fp, ", %ld, 0 },\n", point[ix].line );
+		}
+		fputs( "};\n", fp );
+	}
+
+	if ( ferror( fp ) ) {
+		/* ILC: 書き込みエラー */
+		ret = -1;
+	}
+	if ( fclose( fp ) != 0 ) {
+		/* ILC: 書き出しに失敗 */
+		ret = -1;
+	}
+
+	/* ILC: link_ctable終了 */
+	return ret;
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	ILC_DAT_TABLE table;
+	ILC_DAT_POINT* out = NULL;
+	LINK_FILES files;
+	const char* out_file = NULL;
+	const char* dat_file = NULL;
+	const char* c_file = NULL;
+	int format = ILC_DAT_TEXT;
+	long num = 0;
+	int ret = 0;
+	int ch;
+	int ix;
+	/**/
+	/* ILC: main開始 */
+
+	while ( (ch = getopt( argc, argv, "bc:f:ho:" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'b':
+			/* ILC: バイナリ形式で出力 */
+			format = ILC_DAT_BINARY;
+			break;
+		case 'c':
+			/* ILC: Cのソースを出力 */
+			c_file = optarg;
+			break;
+		case 'f':
+			/* ILC: 結果を残すILCカバレッジデータファイル */
+			dat_file = optarg;
+			break;
+		case 'o':
+			/* ILC: 出力ファイル */
+			out_file = optarg;
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 1;
+		}
+	}
+	if ( optind >= argc ) {
+		/* ILC: マニフェストの指定なし */
+		usage();
+		return 1;
+	}
+	if ( out_file == NULL && c_file == NULL ) {
+		/* ILC: 出力先の指定がなければ標準出力 */
+		out_file = "-";
+	}
+
+	memset( &table, 0, sizeof(ILC_DAT_TABLE) );
+	memset( &files, 0, sizeof(LINK_FILES) );
+
+	for ( ix = optind; ret == 0 && ix < argc; ix++ ) {
+		/* ILC: マニフェストの一覧を作成 */
+		if ( argv[ix][0] == '@' ) {
+			/* ILC: ファイル名の一覧から追加 */
+			if ( link_add_list( &files, argv[ix] + 1 ) != 0 ) {
+				/* ILC: 一覧が読み込めない */
+				fprintf( stderr, "%s: ファイルを読み込めません。\n", argv[ix] + 1 );
+				ret = -1;
+			}
+		}
+		else if ( link_add_file( &files, argv[ix] ) != 0 ) {
+			/* ILC: メモリ確保エラー */
+			fprintf( stderr, "メモリが確保できません。\n" );
+			ret = -1;
+		}
+	}
+
+	if ( ret == 0 && dat_file != NULL && access( dat_file, F_OK ) == 0 ) {
+		/* ILC: 既存の計測ポイントと結果を先頭に読み込む(初回はファイルがなくてよい) */
+		if ( ILC_DatLoad( dat_file, &table ) != 0 ) {
+			/* ILC: 読み込みエラー */
+			fprintf( stderr, "%s: ファイルを読み込めません。\n", dat_file );
+			ret = -1;
+		}
+	}
+
+	for ( ix = 0; ret == 0 && ix < files.num; ix++ ) {
+		/* ILC: マニフェストを順に読み込み、末尾に追加する */
+		if ( ILC_DatLoad( (files.name)[ix], &table ) != 0 ) {
+			/* ILC: 読み込みエラー */
+			fprintf( stderr, "%s: ファイルを読み込めません。\n", (files.name)[ix] );
+			ret = -1;
+		}
+	}
+	if ( ret == 0 && table.invalid > 0 ) {
+		/* ILC: 形式が正しくない行があった */
+		fprintf( stderr, "形式が正しくない%ld行を読み飛ばしました。\n", table.invalid );
+	}
+
+	if ( ret == 0 ) {
+		/* ILC: 同じ計測ポイントをまとめる */
+		out = (ILC_DAT_POINT*)malloc( sizeof(ILC_DAT_POINT) * (size_t)( table.num + 1 ) );
+		num = ( out != NULL ) ? link_points( &table, out ) : -1;
+		if ( num < 0 ) {
+			/* ILC: メモリ確保エラー */
+			fprintf( stderr, "メモリが確保できません。\n" );
+			ret = -1;
+		}
+	}
+
+	if ( ret == 0 && out_file != NULL && ILC_DatSave( out_file, out, num, format ) != 0 ) {
+		/* ILC: 書き込みエラー */
+		fprintf( stderr, "%s: 書き込みに失敗しました。\n", out_file );
+		ret = -1;
+	}
+	if ( ret == 0 && c_file != NULL && link_ctable( c_file, out, num ) != 0 ) {
+		/* ILC: 書き込みエラー */
+		fprintf( stderr, "%s: 書き込みに失敗しました。\n", c_file );
+		ret = -1;
+	}
+
+	free( out );
+	ILC_DatFree( &table );
+	for ( ix = 0; ix < files.num; ix++ ) {
+		/* ILC: ファイル名の一覧を解放 */
+		free( (files.name)[ix] );
+	}
+	free( files.name );
+
+	/* ILC: main終了 */
+	return ( ret == 0 ) ? 0 : 1;
+}
@@ -35,23 +35,57 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "ilc.h"
 #include "ilc_util.h"
 #include "parser.h"
 #include "options.h"
+#include "conv.h"
+#include "server.h"
 #include "version.h"
 
+/** 変換後出力ファイルのバッファサイズ(字句解析器の出力をまとめて書き出す) */
+#define CONV_BUFSIZ (256 * 1024)
+
+/** ILCコメントの目印(含まないファイルは解析せずに複写する) */
+#define ILC_MARK "ILC:"
+
+/** キャッシュした変換後出力ファイルの拡張子(計測ポイントの一覧は MANIFEST_SUFFIX) */
+#define CACHE_OUT_SUFFIX ".out"
+
+/**
+ * libilc の自動初期化を無効にする
+ * 変換ツール自身は計測対象ではないため、環境変数 ILC_FILE による
+ * 自動初期化・終了時の書き出しを行わず、-f のファイルだけを扱う。
+ */
+const int __ilc_no_auto = 1;
+
 
 void usage ()
 {
   /* ILC: begin usage() */
-  fputs("usage: ilc [options] file\n", stdout);
+  fputs("usage: ilc [options] file ...\n", stdout);
+  fputs("       ilc [options] --server socket\n", stdout);
   fputs("  Options are as follows:\n", stdout);
   fputs("  -h           display this help\n", stdout);
+  fputs("  -C cachedir  reuse conversions of unchanged files (keyed by content; not with -i)\n", stdout);
   fputs("  -v           display version info\n", stdout);
   fputs("  -f datafile  coverage data file\n", stdout);
-  fputs("  -o outfile   output file\n", stdout);
+  fputs("  -i           emit __ilc_check_id(id) using the line in datafile as id\n", stdout);
+  fputs("  -j jobs      convert up to jobs files in parallel\n", stdout);
+  fputs("  -m           write a manifest (outfile.ilcm) per file instead of updating datafile\n", stdout);
+  fputs("  -n           emit inline checks from ilc_inline.h (call libilc on first hit only)\n", stdout);
+  fputs("  -r           like -n, and register points in the ilc_points section (no -i ids)\n", stdout);
+  fputs("  -o outfile   output file (only with a single input file)\n", stdout);
+  fputs("  -S, --server socket\n", stdout);
+  fputs("               keep datafile loaded and convert requests from ilc-client on socket\n", stdout);
+  fputs("  @listfile    read input file names from listfile, one per line\n", stdout);
 
   /* ILC: end usage() */
 }        
@@ -68,6 +102,29 @@ void version()
 
 
 
+/**
+ * 変換の進行状況
+ * 複数スレッドで変換する場合は、すべてのスレッドで共有する。
+ */
+struct conv_state {
+	struct opt*		opt;		/**< 引数の解析結果 */
+	int				next;		/**< 次に変換するファイルの添字 */
+	int				done;		/**< 変換に成功したファイルの数 */
+	int				error;		/**< 0以外:エラー発生(以降のファイルは変換しない) */
+	pthread_mutex_t	lock;		/**< next/done/errorの排他 */
+};
+
+
+/**
+ * 変換結果のキャッシュ(-C)
+ * 入力ファイルの内容から求めたキーごとに、変換後出力ファイルと計測ポイントの一覧を保存する。
+ */
+struct cache_entry {
+	char*	out;		/**< 変換後出力ファイルのキャッシュ(キー.out) */
+	char*	points;		/**< 計測ポイントの一覧のキャッシュ(キー.ilcm、マニフェストと同じ形式) */
+};
+
+
 /**
  * 変換元入力ファイル名をもとに、変換後出力ファイル名を自動決定する。
  * ex) test.c => test_ilc.c
@@ -107,6 +164,7 @@ char* set_outfile (
 			}
 			
 			/* _ilc を付与 */
+			*dst = '\0';
 			strcat( dst, "_ilc" );
 			dst += 4;
 			
@@ -125,15 +183,552 @@ char* set_outfile (
 }
 
 
+/**
+ * 出力ファイルを作成する
+ * 一時ファイル名の格納先を指定した場合は、同じディレクトリに一時ファイルを作成する。
+ * 一時ファイルは close_output で出力ファイルに置き換える。
+ * @param const char* 出力ファイル名
+ * @param char**      一時ファイル名の格納先(NULL:出力ファイルを直接作成する)
+ * @return FILE* 作成したファイル
+ *               NULL:作成できない
+ */
+FILE* open_output (
+	const char* path,
+	char** tmp
+)
+{
+	/**/
+	static unsigned long seq = 0;	/* 一時ファイル名の連番(スレッド間で重複させない) */
+	FILE* fp = NULL;
+	int fd;
+	/**/
+	/* ILC: open_output開始 */
+
+	if ( tmp == NULL ) {
+		/* ILC: 出力ファイルを直接作成する */
+		fp = fopen( path, "w" );
+	}
+	else {
+		/* ILC: 出力ファイル名.プロセスID.連番.tmp を作成する */
+		/* '.' x 3 + プロセスID(20) + 連番(20) + "tmp" + '\0' */
+		*tmp = (char*)xmalloc( strlen( path ) + 3 + 20 + 20 + 3 + 1 );
+		if ( *tmp != NULL ) {
+			/* ILC: 一時ファイル名を確保できた */
+			sprintf( *tmp, "%s.%ld.%lu.tmp", path, (long)getpid(), __atomic_fetch_add( &seq, 1, __ATOMIC_RELAXED ) );
+			fd = open( *tmp, O_WRONLY | O_CREAT | O_EXCL, 0666 );
+			if ( fd >= 0 && (fp = fdopen( fd, "w" )) == NULL ) {
+				/* ILC: ストリームを作成できない */
+				close( fd );
+				unlink( *tmp );
+			}
+			if ( fp == NULL ) {
+				/* ILC: 一時ファイルを作成できない */
+				xfree( *tmp );
+				*tmp = NULL;
+			}
+		}
+	}
+
+	/* ILC: open_output終了 */
+	return fp;
+}
+
+
+/**
+ * open_output で作成した出力ファイルを閉じる
+ * 一時ファイルの場合、正常時は内容が変わったときだけ出力ファイルを置き換え(更新時刻を変えない)、
+ * 異常時は一時ファイルを削除する。
+ * @param FILE*       open_output で作成したファイル
+ * @param char*       一時ファイル名(NULL:一時ファイルでない)。解放する
+ * @param const char* 出力ファイル名
+ * @param int         それまでの処理結果(0:正常)
+ * @return 0:正常
+ *         4:ファイルの書き込みエラー
+ *         それ以外:それまでの処理結果
+ */
+int close_output (
+	FILE* fp,
+	char* tmp,
+	const char* path,
+	int ret
+)
+{
+	/**/
+	/**/
+	/* ILC: close_output開始 */
+
+	if ( fclose( fp ) != 0 && ret == 0 ) {
+		/* ILC: バッファの書き出しに失敗 */
+		ret = 4;
+	}
+
+	if ( tmp != NULL ) {
+		/* ILC: 一時ファイルの場合 */
+		if ( ret != 0 ) {
+			/* ILC: 異常時は削除する */
+			unlink( tmp );
+		}
+		else if ( file_update( tmp, path ) < 0 ) {
+			/* ILC: 出力ファイルを置き換えられない */
+			ret = 4;
+		}
+		xfree( tmp );
+	}
+
+	/* ILC: close_output終了 */
+	return ret;
+}
+
+
+/**
+ * ファイルの内容を出力ファイルに複写する
+ * 一時ファイルに複写し、内容が変わったときだけ出力ファイルを置き換える。
+ * @param const char* 複写元ファイル名
+ * @param const char* 出力ファイル名
+ * @return 0:正常
+ *         3:ファイルのオープンエラー
+ *         4:ファイルの書き込みエラー
+ */
+int copy_output (
+	const char* src,
+	const char* path
+)
+{
+	/**/
+	FILE* fp;
+	char* tmp;
+	int fd;
+	int ret = 3;
+	/**/
+	/* ILC: copy_output開始 */
+
+	fd = open( src, O_RDONLY );
+	if ( fd >= 0 ) {
+		/* ILC: 複写元を開けた */
+		fp = open_output( path, &tmp );
+		if ( fp != NULL ) {
+			/* ILC: 一時ファイルに複写する */
+			ret = ( fd_copy( fd, fileno( fp ) ) == 0 ) ? 0 : 4;
+			ret = close_output( fp, tmp, path, ret );
+		}
+		close( fd );
+	}
+
+	/* ILC: copy_output終了 */
+	return ret;
+}
+
+
+/**
+ * マニフェスト(ilc -m)のファイル名を求める
+ * 変換後出力ファイル名の拡張子を .ilcm にしたもの。
+ * @param const char* 変換後出力ファイル名
+ * @return マニフェストのファイル名
+ *         NULL:メモリ確保エラー
+ */
+char* manifest_path (
+	const char* out_file
+)
+{
+	/**/
+	char* path;
+	char* suf;
+	/**/
+	/* ILC: manifest_path開始 */
+
+	path = (char*)xmalloc( strlen( out_file ) + strlen( MANIFEST_SUFFIX ) + 1 );
+	if ( path != NULL ) {
+		/* ILC: ファイル名のバッファを確保できた場合 */
+		strcpy( path, out_file );
+		suf = strrchr( path, '.' );
+		if ( suf != NULL && strchr( suf, '/' ) == NULL ) {
+			/* ILC: 拡張子を置き換える */
+			*suf = '\0';
+		}
+		strcat( path, MANIFEST_SUFFIX );
+	}
+
+	/* ILC: manifest_path終了 */
+	return path;
+}
+
+
+/**
+ * マニフェスト(ilc -m)を書き出す
+ * @param ILC*        書き出すILCデータ
+ * @param const char* 変換後出力ファイル名
+ * @param int         1:内容が変わったときだけ置き換える
+ *                    0:常に書き出す
+ * @return 0:正常
+ *         2:メモリエラー
+ *         3:ファイルのオープンエラー
+ *         4:ファイルの書き込みエラー
+ */
+int put_manifest (
+	ILC* ilc,
+	const char* out_file,
+	int update
+)
+{
+	/**/
+	char* path;
+	char* tmp = NULL;
+	FILE* fp;
+	int ret;
+	/**/
+	/* ILC: put_manifest開始 */
+
+	path = manifest_path( out_file );
+	if ( path == NULL ) {
+		/* ILC: メモリエラー */
+		return 2;
+	}
+
+	fp = open_output( path, ( update == 1 ) ? &tmp : NULL );
+	if ( fp == NULL ) {
+		/* ILC: オープンエラー */
+		ret = 3;
+	}
+	else {
+		/* ILC: 計測ポイントを書き出す */
+		ret = ( ilc2manifest( ilc, fp ) == 0 ) ? 0 : 4;
+		ret = close_output( fp, tmp, path, ret );
+	}
+	xfree( path );
+
+	/* ILC: put_manifest終了 */
+	return ret;
+}
+
+
+/**
+ * cache_open で設定したキャッシュのファイル名を解放する
+ * @param struct cache_entry* キャッシュ
+ */
+void cache_close (
+	struct cache_entry* cache
+)
+{
+	/**/
+	/**/
+	/* ILC: cache_close開始 */
+
+	xfree( cache->out );
+	xfree( cache->points );
+	cache->out = NULL;
+	cache->points = NULL;
+
+	/* ILC: cache_close終了 */
+}
+
+
+/**
+ * 変換結果のキャッシュを探す
+ * キーは変換ツールのバージョン、出力形式(-n/-r)、入力ファイル名(計測ポイントに埋め込むため)、
+ * 入力ファイルの内容から求めたハッシュ値。
+ * 見つからなかった場合も、cache_store で保存するファイル名を設定する。
+ * @param const struct opt*   引数の解析結果
+ * @param const char*         変換元入力ファイル名
+ * @param int                 変換元入力ファイルのディスクリプタ
+ * @param struct cache_entry* キャッシュのファイル名の格納先(cache_closeで解放する)
+ * @return  1:キャッシュあり
+ *          0:キャッシュなし
+ *         -1:キャッシュを使用できない(通常のファイルでない、メモリ確保エラー)
+ */
+int cache_open (
+	const struct opt* opt,
+	const char* in_file,
+	int fd,
+	struct cache_entry* cache
+)
+{
+	/**/
+	char buf[64];
+	unsigned long long hash;
+	size_t len;
+	int ret = -1;
+	/**/
+	/* ILC: cache_open開始 */
+
+	cache->out = NULL;
+	cache->points = NULL;
+
+	sprintf( buf, "ilc %d.%d %d", MAJOR_VERSION, MINOR_VERSION, opt->inline_mode );
+	hash = mem_hash( buf, strlen( buf ) + 1, HASH_INIT );
+	hash = mem_hash( in_file, strlen( in_file ) + 1, hash );
+
+	if ( fd_hash( fd, &hash ) == 0 ) {
+		/* ILC: ディレクトリ/キー(16進16桁)拡張子 */
+		len = strlen( opt->cache_dir ) + 1 + 16 + 1;
+		cache->out = (char*)xmalloc( len + strlen( CACHE_OUT_SUFFIX ) );
+		cache->points = (char*)xmalloc( len + strlen( MANIFEST_SUFFIX ) );
+		if ( cache->out != NULL && cache->points != NULL ) {
+			/* ILC: キャッシュのファイル名を作成して探す */
+			sprintf( cache->out, "%s/%016llx%s", opt->cache_dir, hash, CACHE_OUT_SUFFIX );
+			sprintf( cache->points, "%s/%016llx%s", opt->cache_dir, hash, MANIFEST_SUFFIX );
+			/* 変換後出力ファイルは計測ポイントの一覧より後に保存するので、あれば両方そろっている */
+			ret = ( access( cache->out, R_OK ) == 0 && access( cache->points, R_OK ) == 0 ) ? 1 : 0;
+		}
+		else {
+			/* ILC: メモリ確保エラー */
+			cache_close( cache );
+		}
+	}
+
+	/* ILC: cache_open終了 */
+	return ret;
+}
+
+
+/**
+ * キャッシュから変換結果を復元する
+ * 字句解析・構文解析は行わず、キャッシュした変換後出力ファイルを複写し、
+ * 計測ポイントの一覧をカバレッジデータに登録する(-m の場合はマニフェストに複写する)。
+ * @param const struct opt*   引数の解析結果
+ * @param struct cache_entry* キャッシュ
+ * @param const char*         変換後出力ファイル名
+ * @return 0:正常
+ *         2:メモリエラー
+ *         3:ファイルのオープンエラー
+ *         4:ファイルの書き込みエラー
+ */
+int cache_restore (
+	const struct opt* opt,
+	struct cache_entry* cache,
+	const char* out_file
+)
+{
+	/**/
+	char* path;
+	FILE* fp;
+	int ret;
+	/**/
+	/* ILC: cache_restore開始 */
+
+	ret = copy_output( cache->out, out_file );
+
+	if ( ret == 0 && opt->manifest == 1 ) {
+		/* ILC: 計測ポイントの一覧をマニフェストに複写する */
+		path = manifest_path( out_file );
+		ret = ( path != NULL ) ? copy_output( cache->points, path ) : 2;
+		xfree( path );
+	}
+	else if ( ret == 0 ) {
+		/* ILC: 計測ポイントの一覧をカバレッジデータに登録する */
+		fp = fopen( cache->points, "r" );
+		if ( fp == NULL ) {
+			/* ILC: オープンエラー */
+			ret = 3;
+		}
+		else {
+			/* ILC: 未登録の計測ポイントを登録する */
+			ret = ( manifest2ilcdata( fp, ILC_GetILCData() ) == 0 ) ? 0 : 2;
+			fclose( fp );
+		}
+	}
+
+	/* ILC: cache_restore終了 */
+	return ret;
+}
+
+
+/**
+ * 変換結果をキャッシュに保存する
+ * 計測ポイントの一覧、変換後出力ファイルの順に保存する。
+ * 保存に失敗しても次回キャッシュが使われないだけなので、エラーにはしない。
+ * @param struct cache_entry* キャッシュ
+ * @param ILC*                変換したILCデータ
+ * @param const char*         変換後出力ファイル名
+ */
+void cache_store (
+	struct cache_entry* cache,
+	ILC* ilc,
+	const char* out_file
+)
+{
+	/**/
+	char* tmp;
+	FILE* fp;
+	int ret = 3;
+	/**/
+	/* ILC: cache_store開始 */
+
+	fp = open_output( cache->points, &tmp );
+	if ( fp != NULL ) {
+		/* ILC: 計測ポイントの一覧を保存する */
+		ret = ( ilc2manifest( ilc, fp ) == 0 ) ? 0 : 4;
+		ret = close_output( fp, tmp, cache->points, ret );
+	}
+
+	if ( ret == 0 ) {
+		/* ILC: 変換後出力ファイルを保存する */
+		copy_output( out_file, cache->out );
+	}
+
+	/* ILC: cache_store終了 */
+}
+
+
+/**
+ * ファイル名の一覧にファイル名を追加する
+ * 一覧の領域は倍々で拡張する。
+ * @param struct opt* 追加先(in_files/in_num)
+ * @param int*        一覧の確保済みの数
+ * @param const char* 追加するファイル名(複製して追加する)
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー
+ */
+int add_infile (
+	struct opt* opt,
+	int* capacity,
+	const char* name
+)
+{
+	/**/
+	char** files;
+	char* str;
+	int ret = -1;
+	/**/
+	/* ILC: add_infile開始 */
+
+	if ( opt->in_num == *capacity ) {
+		/* ILC: 一覧の領域を拡張する */
+		*capacity = ( *capacity == 0 ) ? 16 : *capacity * 2;
+		files = (char**)realloc( opt->in_files, sizeof(char*) * (size_t)*capacity );
+		if ( files != NULL ) {
+			/* ILC: 拡張成功 */
+			opt->in_files = files;
+		}
+		else {
+			/* ILC: 拡張失敗 */
+			*capacity = opt->in_num;
+		}
+	}
+
+	if ( opt->in_num < *capacity ) {
+		/* ILC: 一覧に空きがある */
+		str = (char*)xmalloc( strlen( name ) + 1 );
+		if ( str != NULL ) {
+			/* ILC: ファイル名を複製して追加 */
+			strcpy( str, name );
+			(opt->in_files)[opt->in_num++] = str;
+			ret = 0;
+		}
+	}
+
+	/* ILC: add_infile終了 */
+	return ret;
+}
+
+
+/**
+ * 入力ファイル名の一覧を作成する
+ * '@'で始まる引数はファイル一覧(1行1ファイル)として読み込み、展開する。
+ * 空行は読み飛ばす。
+ * 作成した一覧は free_infiles で解放すること。
+ * @param struct opt* 作成した一覧の格納先(in_files/in_num、空であること)
+ * @param char**      引数で指定された入力ファイル名
+ * @param int         引数で指定された入力ファイルの数
+ * @return  0:正常終了
+ *         -1:ファイル一覧が読み込めない、またはメモリ確保エラー
+ */
+int load_infiles (
+	struct opt* opt,
+	char** args,
+	int num
+)
+{
+	/**/
+	int capacity = 0;
+	int ix;
+	int ret = 0;
+	/**/
+	/* ILC: load_infiles開始 */
+
+	for ( ix = 0; ix < num && ret == 0; ix++ ) {
+		/* ILC: 引数ごとに追加 */
+		if ( args[ix][0] == '@' ) {
+			/**/
+			FILE* fp;
+			char line[FILENAME_MAX + 2];
+			/**/
+			/* ILC: ファイル一覧を読み込む */
+			fp = fopen( args[ix] + 1, "r" );
+			if ( fp == NULL ) {
+				/* ILC: ファイル一覧のオープンに失敗 */
+				fprintf( stderr, "%s: ファイル一覧を開けません。\n", args[ix] + 1 );
+				ret = -1;
+				break;
+			}
+			while ( ret == 0 && fgets( line, sizeof(line), fp ) != NULL ) {
+				/**/
+				size_t len = strlen( line );
+				/**/
+				/* ILC: 1行1ファイル。行末の空白と改行を取り除く */
+				while ( len > 0 && strchr( " \t\r\n", line[len - 1] ) != NULL ) {
+					/* ILC: 末尾から取り除く */
+					line[--len] = '\0';
+				}
+				if ( len > 0 ) {
+					/* ILC: 空行以外を追加 */
+					ret = add_infile( opt, &capacity, line );
+				}
+			}
+			fclose( fp );
+		}
+		else {
+			/* ILC: 通常のファイル名 */
+			ret = add_infile( opt, &capacity, args[ix] );
+		}
+	}
+
+	if ( ret == 0 && opt->in_num == 0 ) {
+		/* ILC: ファイル一覧が空 */
+		fprintf( stderr, "入力ファイルがありません。\n" );
+		ret = -1;
+	}
+	opt->in_file = ( opt->in_num > 0 ) ? (opt->in_files)[0] : NULL;
+
+	/* ILC: load_infiles終了 */
+	return ret;
+}
+
+
+/**
+ * load_infiles で作成した入力ファイル名の一覧を解放する
+ * @param struct opt* 引数の解析結果
+ */
+void free_infiles (
+	struct opt* opt
+)
+{
+	/**/
+	int ix;
+	/**/
+	/* ILC: free_infiles開始 */
+
+	for ( ix = 0; ix < opt->in_num; ix++ ) {
+		/* ILC: ファイル名の解放 */
+		xfree( (opt->in_files)[ix] );
+	}
+	free( opt->in_files );
+	opt->in_files = NULL;
+	opt->in_file = NULL;
+	opt->in_num = 0;
+
+	/* ILC: free_infiles終了 */
+}
+
+
 /**
  * 初期処理
  * 以下の処理を実施する
  * ・引数の解析
- * ・ILCデータへの入出力ファイルの設定
+ * ・入力ファイル名の一覧の作成
  * ・カバレッジデータの読み込み
- * @param int    引数の数
- * @param char** 引数のアドレス
- * @param ILC*   ILCデータ
+ * @param int         引数の数
+ * @param char**      引数のアドレス
+ * @param struct opt* 引数の解析結果
  * @return ILC_SUCCESS:継続可（カバレッジデータファイルの指定有り）
  *         ILC_WARN   :継続可（カバレッジデータファイルの指定無し）
  *         ILC_FAILURE:継続不可
@@ -141,69 +736,317 @@ char* set_outfile (
 ILC_ERROR init (
 	int argc,
 	char** argv,
-	ILC* ilc
+	struct opt* opt
 )
 {
 	/**/
-	struct opt opt;
+	char** args;		/* 引数で指定された入力ファイル名 */
+	int num;
 	ILC_ERROR ret;
 	/**/
 	/* ILC: init開始 */
 
 	/* 引数の解析 */
-	memset( &opt, 0, sizeof(opt) );
-	parse_option( argc, argv, &opt );
+	memset( opt, 0, sizeof(*opt) );
+	parse_option( argc, argv, opt );
+
+	/* 引数の一覧は load_infiles で作成しなおすため、退避しておく */
+	args = opt->in_files;
+	num = opt->in_num;
+	opt->in_files = NULL;
+	opt->in_num = 0;
 
-	if ( opt.version == 1 ) {
+	if ( opt->version == 1 ) {
 		/* ILC: -vオプションが指定されたため、バージョン情報を表示 */
 		version();
 		ret = ILC_FAILURE;
 	}
-	else if ( opt.in_file == NULL || opt.help == 1 ) {
+	else if ( ( opt->in_file == NULL && opt->server == NULL ) || opt->help == 1 ) {
 		/* ILC: 入力ファイルの指定がない、または-hオプションが指定されたため、使い方を表示 */
 		usage();
 		ret = ILC_FAILURE;
 	}
+	else if ( opt->server != NULL && ( num > 0 || opt->out_file != NULL || opt->manifest == 1 ) ) {
+		/* ILC: 変換するファイルは ilc-client で指定する。カバレッジデータは共有する */
+		fprintf( stderr, "--server と入力ファイル、-o、-m は同時に指定できません。\n" );
+		ret = ILC_FAILURE;
+	}
+	else if ( opt->server == NULL && load_infiles( opt, args, num ) != 0 ) {
+		/* ILC: 入力ファイル名の一覧が作成できない */
+		ret = ILC_FAILURE;
+	}
+	else if ( opt->in_num > 1 && opt->out_file != NULL ) {
+		/* ILC: 複数ファイルの出力先を1つには指定できない */
+		fprintf( stderr, "-o は入力ファイルが1つの場合のみ指定できます。\n" );
+		ret = ILC_FAILURE;
+	}
+	else if ( opt->manifest == 1 && opt->id_mode == 1 && opt->inline_mode != 2 ) {
+		/* ILC: IDの採番には共有するカバレッジデータが必要 */
+		fprintf( stderr, "-m と -i は同時に指定できません。\n" );
+		ret = ILC_FAILURE;
+	}
+	else if ( opt->cache_dir != NULL && mkdir( opt->cache_dir, 0777 ) != 0 && errno != EEXIST ) {
+		/* ILC: キャッシュディレクトリが作成できない */
+		fprintf( stderr, "%s: キャッシュディレクトリを作成できません。\n", opt->cache_dir );
+		ret = ILC_FAILURE;
+	}
+	else if ( opt->manifest == 1 ) {
+		/* ILC: ファイルごとにマニフェストを書き出すので、カバレッジデータは読み書きしない */
+		ret = ILC_SUCCESS;
+	}
 	else {
 		/* ILC: 通常の変換処理はこちら */
+		/* カバレッジデータはすべてのファイルで共有し、最後に1回だけ書き出す */
+		ret = ILC_Initialize( opt->ilc_file );
+	}
 
-		if ( opt.out_file == NULL ) {
-			/* ILC: 変換後出力ファイル名を自動設定する */
-			opt.out_file = set_outfile( opt.in_file );
-		}
+	/* ILC: init終了 */
+	return ret;
+}
 
-		ilc->file_in  = opt.in_file;
-		ilc->file_out = opt.out_file;
-		ilc->ilc_func = NULL;
-		ilc->fpin     = fopen( ilc->file_in, "r" );
-		ilc->fpout    = fopen( ilc->file_out, "w" );
 
-		if ( ilc->fpin != NULL && ilc->fpout != NULL ) {
-			/* ILC: 正常系 ILCカバレッジデータの読み込み */
-			ret = ILC_Initialize( opt.ilc_file );
+/**
+ * 変換元を解析して変換後を出力し、カバレッジデータに登録する
+ * ILCコメントを含まないファイルは、解析せずにそのまま複写する。
+ * @param const struct opt* 引数の解析結果
+ * @param ILC*              ILCデータ(fpin/fpoutを設定済み)
+ * @return 0:正常
+ *         1:構文エラー
+ *         2:メモリエラー
+ *         4:ファイルの書き込みエラー
+ */
+int conv_parse (
+	const struct opt* opt,
+	ILC* ilc
+)
+{
+	/**/
+	int ret;
+	/**/
+	/* ILC: conv_parse開始 */
+
+	if ( fd_contains( fileno( ilc->fpin ), ILC_MARK ) == 0 ) {
+		/* ILC: ILCコメントがないので、解析せずにそのまま複写する(計測ポイントなし) */
+		ret = ( fd_copy( fileno( ilc->fpin ), fileno( ilc->fpout ) ) == 0 ) ? 0 : 4;
+	}
+	else {
+		/* ILC: 解析する(メモリ上の変換元など、調べられない場合も含む) */
+		if ( opt->inline_mode != 0 ) {
+			/* ILC: インライン版のマクロを使えるようにする */
+			ilc_put_inline_header( ilc->fpout );
 		}
-		else {
-			/* ILC: 変換元ファイル/変換後ファイルのオープンに失敗 */
-			/* オープン中のファイルはfinalizeでクローズするため、ここでは何もしない */
-			ret = ILC_FAILURE;
+		ret = parse( ilc );
+		if ( ret == 0 && opt->manifest == 0 && ilc2ilcdata( ilc, ILC_GetILCData() ) != 0 ) {
+			/* ILC: メモリエラー */
+			ret = 2;
 		}
 	}
 
-	/* ILC: init終了 */
+	/* ILC: conv_parse終了 */
+	return ret;
+}
+
+
+/**
+ * 1ファイルを変換し、カバレッジデータに登録する
+ * キャッシュ(-C)を使用する場合、入力ファイルの内容が同じ変換結果があれば解析せずに再利用し、
+ * 変換後出力ファイルは内容が変わったときだけ置き換える。
+ * @param const struct opt* 引数の解析結果
+ * @param char*             変換元入力ファイル名
+ * @return 0:正常
+ *         1:構文エラー
+ *         2:メモリエラー
+ *         3:ファイルのオープンエラー
+ *         4:ファイルの書き込みエラー
+ */
+int conv_file (
+	const struct opt* opt,
+	char* in_file
+)
+{
+	/**/
+	ILC ilc;
+	struct cache_entry cache;
+	char* out_file = opt->out_file;
+	char* tmp = NULL;	/* 変換後出力ファイルの一時ファイル名(キャッシュを使用する場合) */
+	int hit = -1;		/* 1:キャッシュあり 0:キャッシュなし -1:キャッシュを使用しない */
+	int ret;
+	/**/
+	/* ILC: conv_file開始 */
+
+	if ( out_file == NULL ) {
+		/* ILC: 変換後出力ファイル名を自動設定する */
+		out_file = set_outfile( in_file );
+	}
+
+	ilc.file_in  = in_file;
+	ilc.file_out = out_file;
+	ilc.ilc_func = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = opt->inline_mode;
+	ilc.fpin     = fopen( in_file, "r" );
+	ilc.fpout    = NULL;
+
+	if ( opt->cache_dir != NULL && ( opt->id_mode == 0 || opt->inline_mode == 2 ) && ilc.fpin != NULL ) {
+		/* ILC: 入力ファイルの内容でキャッシュを探す(-i のIDはカバレッジデータで決まるため、キャッシュしない) */
+		hit = cache_open( opt, in_file, fileno( ilc.fpin ), &cache );
+	}
+
+	if ( out_file != NULL && hit != 1 ) {
+		/* ILC: 変換後出力ファイルの作成(キャッシュを使用する場合は一時ファイルに出力する) */
+		ilc.fpout = open_output( out_file, ( hit == 0 ) ? &tmp : NULL );
+	}
+
+	if ( opt->id_mode == 1 && opt->inline_mode != 2 ) {
+		/* ILC: 解析中に計測ポイントを登録し、IDを採番する(-r の場合は実行時に採番する) */
+		ilc.ilc_data = ILC_GetILCData();
+	}
+
+	if ( ilc.fpout != NULL ) {
+		/* ILC: 出力は大きなバッファにためてまとめて書き出す */
+		setvbuf( ilc.fpout, NULL, _IOFBF, CONV_BUFSIZ );
+	}
+
+	if ( out_file == NULL ) {
+		/* ILC: 出力ファイル名のメモリ確保エラー */
+		ret = 2;
+	}
+	else if ( hit == 1 ) {
+		/* ILC: キャッシュした変換結果を使用する */
+		ret = cache_restore( opt, &cache, out_file );
+	}
+	else if ( ilc.fpin == NULL || ilc.fpout == NULL ) {
+		/* ILC: 変換元ファイル/変換後ファイルのオープンに失敗 */
+		ret = 3;
+	}
+	else {
+		/* ILC: 正常系 */
+		ret = conv_parse( opt, &ilc );
+	}
+
+	if ( ret == 0 && opt->manifest == 1 && hit != 1 ) {
+		/* ILC: 計測ポイントの一覧をマニフェストに書き出す(計測ポイントがなくても作成する) */
+		ret = put_manifest( &ilc, out_file, ( hit == 0 ) ? 1 : 0 );
+	}
+
+	if ( ilc.fpin != NULL ) {
+		/* ILC: 変換元入力ファイルのクローズ */
+		fclose( ilc.fpin );
+	}
+
+	if ( ilc.fpout != NULL ) {
+		/* ILC: 変換後出力ファイルのクローズ(一時ファイルの場合は出力ファイルを置き換える) */
+		ret = close_output( ilc.fpout, tmp, out_file, ret );
+	}
+
+	if ( ret == 0 && hit == 0 ) {
+		/* ILC: 次回のために変換結果をキャッシュする */
+		cache_store( &cache, &ilc, out_file );
+	}
+
+	/* メモリ解放 */
+	ilc_end( &ilc );
+
+	if ( hit >= 0 ) {
+		/* ILC: キャッシュのファイル名の解放 */
+		cache_close( &cache );
+	}
+
+	if ( out_file != opt->out_file ) {
+		/* ILC: 自動設定した出力ファイル名の解放 */
+		xfree( out_file );
+	}
+
+	/* ILC: conv_file終了 */
+	return ret;
+}
+
+
+/**
+ * メモリ上の変換元を変換し、カバレッジデータに登録する(ilc --server)
+ * 変換後はメモリに出力する。-m のマニフェスト、-C のキャッシュは使用しない。
+ * @param const struct opt* 引数の解析結果
+ * @param char*             変換元入力ファイル名(計測ポイントの名前に使用する)
+ * @param char*             変換元
+ * @param size_t            変換元のバイト数
+ * @param char**            変換後の格納先(正常時は呼び出し側で free する)
+ * @param size_t*           変換後のバイト数の格納先
+ * @return 0:正常
+ *         1:構文エラー
+ *         2:メモリエラー
+ *         4:書き込みエラー
+ */
+int conv_buffer (
+	const struct opt* opt,
+	char* in_file,
+	char* buf,
+	size_t len,
+	char** out,
+	size_t* out_len
+)
+{
+	/**/
+	ILC ilc;
+	int ret;
+	/**/
+	/* ILC: conv_buffer開始 */
+
+	*out = NULL;
+	*out_len = 0;
+
+	ilc.file_in  = in_file;
+	ilc.file_out = NULL;
+	ilc.ilc_func = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = opt->inline_mode;
+	ilc.fpin     = ( len > 0 ) ? fmemopen( buf, len, "r" ) : fopen( "/dev/null", "r" );
+	ilc.fpout    = open_memstream( out, out_len );
+
+	if ( opt->id_mode == 1 && opt->inline_mode != 2 ) {
+		/* ILC: 解析中に計測ポイントを登録し、IDを採番する(-r の場合は実行時に採番する) */
+		ilc.ilc_data = ILC_GetILCData();
+	}
+
+	ret = ( ilc.fpin != NULL && ilc.fpout != NULL ) ? conv_parse( opt, &ilc ) : 2;
+
+	/* メモリ解放 */
+	ilc_end( &ilc );
+
+	if ( ilc.fpin != NULL ) {
+		/* ILC: 変換元のクローズ */
+		fclose( ilc.fpin );
+	}
+
+	if ( ilc.fpout != NULL ) {
+		/* ILC: 変換後のクローズ(*out、*out_len が確定する) */
+		if ( fclose( ilc.fpout ) != 0 && ret == 0 ) {
+			/* ILC: 書き出しに失敗 */
+			ret = 4;
+		}
+	}
+
+	if ( ret != 0 ) {
+		/* ILC: 異常時は変換後を破棄する */
+		free( *out );
+		*out = NULL;
+		*out_len = 0;
+	}
+
+	/* ILC: conv_buffer終了 */
 	return ret;
 }
 
 
 /**
  * 終了処理
- * @param ILC* ILCデータ
- * @param int  1:ILC_Finalizeを呼ぶ
- *             0:ILC_Finalizeを呼ばない（initでエラーが発生したため）
+ * @param struct opt* 引数の解析結果
+ * @param int         1:ILC_Finalizeを呼ぶ
+ *                    0:ILC_Finalizeを呼ばない（initでエラーが発生したため）
  * @return  0:正常終了
  *         -1:カバレッジデータの書き込みに失敗
  */
 int finalize (
-	ILC* ilc,
+	struct opt* opt,
 	int outflag
 )
 {
@@ -213,17 +1056,7 @@ int finalize (
 	/* ILC: finalize開始 */
 
 	/* メモリ解放 */
-	ilc_end( ilc );
-
-	if ( ilc->fpin != NULL ) {
-		/* ILC: 変換元入力ファイルのクローズ */
-		fclose( ilc->fpin );
-	}
-
-	if ( ilc->fpout != NULL ) {
-		/* ILC: 変換後出力ファイルのクローズ */
-		fclose( ilc->fpout );
-	}
+	free_infiles( opt );
 
 	if ( outflag == 1 ) {
 		/* ILC: カバレッジデータを吐き出す */
@@ -238,6 +1071,102 @@ int finalize (
 }
 
 
+/**
+ * 変換結果を報告する
+ * @param const char* 変換元入力ファイル名
+ * @param int         conv_file の戻り値
+ * @return  0:正常
+ *         -1:異常
+ */
+int conv_report (
+	const char* in_file,
+	int code
+)
+{
+	/**/
+	int ret = -1;
+	/**/
+	/* ILC: conv_report開始 */
+
+	switch ( code ) {
+	case 0:
+		/* ILC: 正常系動作 */
+		ret = 0;
+		break;
+	case 1:
+		/* ILC: 構文エラー */
+		fprintf( stderr, "%s: 構文解析に失敗したので中断します。\n", in_file );
+		break;
+	case 2:
+		/* ILC: メモリエラー */
+		fprintf( stderr, "%s: メモリ確保に失敗したので中断します。\n", in_file );
+		break;
+	case 3:
+		/* ILC: ファイルのオープンエラー */
+		fprintf( stderr, "%s: ファイルを開けないので中断します。\n", in_file );
+		break;
+	case 4:
+		/* ILC: ファイルの書き込みエラー */
+		fprintf( stderr, "%s: ファイルの書き込みに失敗したので中断します。\n", in_file );
+		break;
+	default:
+		/* ILC: ここにはこない */
+		fprintf( stderr, "ありえないエラーが発生したので中断します。エラーコード=%d\n", code );
+		break;
+	}
+
+	/* ILC: conv_report終了 */
+	return ret;
+}
+
+
+/**
+ * 変換処理(ワーカー)
+ * 未変換のファイルがなくなるか、エラーが発生するまで1ファイルずつ変換する。
+ * 複数スレッドで同時に実行できる。
+ * @param void* 変換の進行状況(struct conv_state*)
+ * @return NULL
+ */
+void* conv_worker (
+	void* arg
+)
+{
+	/**/
+	struct conv_state* state = (struct conv_state*)arg;
+	int ix;
+	int ret;
+	/**/
+	/* ILC: conv_worker開始 */
+
+	for ( ;; ) {
+		/* ILC: 次のファイルを取り出す */
+		pthread_mutex_lock( &state->lock );
+		ix = ( state->error == 0 && state->next < state->opt->in_num ) ? state->next++ : -1;
+		pthread_mutex_unlock( &state->lock );
+		if ( ix < 0 ) {
+			/* ILC: 未変換のファイルなし、またはエラー発生 */
+			break;
+		}
+
+		ret = conv_report( (state->opt->in_files)[ix], conv_file( state->opt, (state->opt->in_files)[ix] ) );
+
+		pthread_mutex_lock( &state->lock );
+		if ( ret == 0 ) {
+			/* ILC: 変換成功 */
+			state->done++;
+		}
+		else {
+			/* ILC: 変換失敗。以降のファイルは変換しない */
+			state->error = 1;
+		}
+		pthread_mutex_unlock( &state->lock );
+	}
+
+	/* ILC: conv_worker終了 */
+	return NULL;
+}
+
+
 /**
  * メイン処理
  * @param int 引数の数
@@ -252,51 +1181,63 @@ int conv_main (
 {
 	/**/
 	int ret = -1;		/* 異常状態で初期化しておく。 */
-	ILC ilc;
+	struct opt opt;
+	struct conv_state state;
 	int outflag = 0;	/* 終了処理でカバレッジデータを出力しない */
 	/**/
 	/* ILC: conv_main開始 */
 
-	/* ILCデータの初期化 */
-	ilc.file_in  = NULL;
-	ilc.file_out = NULL;
-	ilc.fpin     = NULL;
-	ilc.fpout    = NULL;
-	ilc.ilc_func = NULL;
-
-	if ( init( argc, argv, &ilc ) != ILC_FAILURE ) {
+	if ( init( argc, argv, &opt ) == ILC_FAILURE ) {
+		/* ILC: 初期化に失敗したので変換しない */
+	}
+	else if ( opt.server != NULL ) {
+		/* ILC: 変換サーバーとして要求を処理し、終了時にカバレッジデータを出力する */
+		ret = server_main( &opt );
+		outflag = 1;
+	}
+	else {
+		/**/
+		pthread_t* threads = NULL;
+		int jobs = ( opt.jobs < opt.in_num ) ? opt.jobs : opt.in_num;	/* 自スレッドを含めた数 */
+		int started = 0;
+		int ix;
+		/**/
 		/* ILC: 初期化に成功したので変換処理を行います */
+		state.opt   = &opt;
+		state.next  = 0;
+		state.done  = 0;
+		state.error = 0;
+		pthread_mutex_init( &state.lock, NULL );
 
-		ret = parse( &ilc );
-		switch ( ret ) {
-		case 0:
-			/* ILC: 正常系動作 */
-			if ( ilc2ilcdata( &ilc, ILC_GetILCData() ) == 0 ) {
-				/* ILC: 正常終了。終了処理でカバレッジデータを出力する */
-				outflag = 1;
-				ret = 0;
-			}
-			else {
-				/* ILC: メモりエラー */
-				fprintf( stderr, "メモリ確保に失敗しました。\n" );
+		if ( jobs > 1 ) {
+			/* ILC: 複数スレッドで変換する */
+			threads = (pthread_t*)malloc( sizeof(pthread_t) * (size_t)(jobs - 1) );
+		}
+		for ( ix = 0; threads != NULL && ix < jobs - 1; ix++ ) {
+			/* ILC: ワーカースレッドの起動 */
+			if ( pthread_create( &threads[ix], NULL, conv_worker, &state ) == 0 ) {
+				/* ILC: 起動成功 */
+				started++;
 			}
-			break;
-		case 1:
-			/* ILC: 構文エラー */
-			fprintf( stderr, "構文解析に失敗したので中断します。\n" );
-			break;
-		case 2:
-			/* ILC: メモリエラー */
-			fprintf( stderr, "メモリ確保に失敗したので中断します。\n" );
-			break;
-		default:
-			/* ILC: ここにはこない */
-			fprintf( stderr, "ありえないエラーが発生したので中断します。エラーコード=%d\n", ret );
-			break;
 		}
+
+		/* 起動できなかった場合も含め、自スレッドでも変換する */
+		conv_worker( &state );
+
+		for ( ix = 0; ix < started; ix++ ) {
+			/* ILC: ワーカースレッドの終了待ち */
+			pthread_join( threads[ix], NULL );
+		}
+		free( threads );
+		pthread_mutex_destroy( &state.lock );
+
+		/* 中断した場合も、変換済みのファイルのカバレッジデータは書き出す */
+		/* (マニフェストを書き出す場合はカバレッジデータを使用しない) */
+		outflag = ( state.done > 0 && opt.manifest == 0 ) ? 1 : 0;
+		ret = ( state.error == 0 ) ? 0 : -1;
 	}
 
-	if ( finalize( &ilc, outflag ) != 0 ) {
+	if ( finalize( &opt, outflag ) != 0 ) {
 		/* ILC: カバレッジデータの出力に失敗 */
 		fprintf( stderr, "カバレッジデータの書き出しに失敗しました。\n" );
 		ret = -1;
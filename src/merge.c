@@ -0,0 +1,598 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	merge.c
+ * @brief	複数のILCカバレッジデータファイルを1つにまとめる(ilc-merge)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ilc_dat.h"
+
+/*-
+ * 同じ計測ポイント(ファイル名:関数名:行数)は1行にまとめ、
+ * 通過フラグは論理和、通過回数は合計とする。
+ * 出力は「ファイル名:関数名:行数」の順に並べる。
+ *
+ * 1. 読み込み・並べ替え: 入力ファイルごとに ILC_DatLoad + ILC_DatSort
+ * 2. マージ: 並べ替え済みの列を2つずつ併合する(log2(入力数) 回)
+ *
+ * 読み込みはファイルの単位で -j で指定した数のスレッドに分担する。
+ * 併合は組の数が少ない後半の回(最後は1組)でもすべてのスレッドを使うよう、
+ * 各組をキーの範囲で分割して分担する。長い方の列を等分した位置の計測ポイントを
+ * 境界とし、もう一方の列の境界は二分探索で求める(同じ計測ポイントは
+ * 同じ範囲に入るため、範囲ごとに独立してまとめられる)。
+ * 範囲ごとの併合先は、まとめた分だけ隙間ができるため、最後に前へ詰める。
+ */
+
+/** 1つの範囲の最小の計測ポイント数(これより短い組は分割しない) */
+#define MERGE_PART_MIN (64 * 1024)
+
+/**
+ * 並べ替え済みの計測ポイントの列
+ */
+typedef struct _merge_run {
+	ILC_DAT_POINT*	point;		/**< 計測ポイント */
+	long			num;		/**< 計測ポイントの数 */
+	int				owned;		/**< pointをこの列で確保したか(入力ファイルの領域でない) */
+}
+MERGE_RUN;
+
+/**
+ * 2つの列の併合を分割した範囲
+ * src[run*2] の [a_begin, a_end) と src[run*2+1] の [b_begin, b_end) を、
+ * dst[run] の out 以降に併合する。
+ */
+typedef struct _merge_part {
+	int				run;		/**< 併合先の列の添字 */
+	long			a_begin;	/**< 1つめの列の範囲の先頭 */
+	long			a_end;		/**< 1つめの列の範囲の終わり */
+	long			b_begin;	/**< 2つめの列の範囲の先頭 */
+	long			b_end;		/**< 2つめの列の範囲の終わり */
+	long			out;		/**< 併合先の書き込み位置(a_begin + b_begin) */
+	long			num;		/**< 併合した計測ポイントの数 */
+}
+MERGE_PART;
+
+/**
+ * スレッドに分担する処理
+ * 各スレッドは next の添字の作業を取り出して実行する。
+ */
+typedef struct _merge_task {
+	int				(*func)(struct _merge_task*, int);	/**< 作業(0:正常終了 -1:エラー) */
+	int				num;		/**< 作業の数 */
+	int				next;		/**< 次に実行する作業の添字 */
+	int				error;		/**< 0以外:エラー発生(以降の作業は実行しない) */
+	pthread_mutex_t	lock;		/**< next/errorの排他 */
+	char**			in_files;	/**< 入力ファイル名 */
+	ILC_DAT_TABLE*	table;		/**< 入力ファイルの内容 */
+	MERGE_RUN*		src;		/**< 併合元の列 */
+	MERGE_RUN*		dst;		/**< 併合先の列 */
+	int				src_num;	/**< 併合元の列の数 */
+	MERGE_PART*		part;		/**< 併合する範囲 */
+}
+MERGE_TASK;
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-merge [options] datafile ...\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -b           write the binary format\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  -j jobs      number of threads (default: number of CPUs)\n", stdout);
+  fputs("  -o outfile   output file (default: standard output)\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+/**
+ * 入力ファイルを読み込み、並べ替える(作業)
+ * @param MERGE_TASK* 作業の一覧
+ * @param int         入力ファイルの添字
+ * @return  0:正常終了
+ *         -1:ファイルが読み込めない、またはメモリ確保エラー
+ */
+int merge_load (
+	MERGE_TASK* task,
+	int ix
+)
+{
+	/**/
+	ILC_DAT_TABLE* table = &(task->table)[ix];
+	/**/
+	/* ILC: merge_load開始 */
+
+	if ( ILC_DatLoad( (task->in_files)[ix], table ) != 0 ) {
+		/* ILC: 読み込みエラー */
+		fprintf( stderr, "%s: ファイルを読み込めません。\n", (task->in_files)[ix] );
+		return -1;
+	}
+	if ( table->invalid > 0 ) {
+		/* ILC: 形式が正しくない行があった */
+		fprintf( stderr, "%s: 形式が正しくない%ld行を読み飛ばしました。\n", (task->in_files)[ix], table->invalid );
+	}
+	ILC_DatSort( table );
+
+	(task->dst)[ix].point = table->point;
+	(task->dst)[ix].num = table->num;
+	(task->dst)[ix].owned = 0;
+
+	/* ILC: merge_load終了 */
+	return 0;
+}
+
+
+/**
+ * 並べ替え済みの列から、指定した計測ポイント以上の最初の位置を探す
+ * @param const MERGE_RUN*     並べ替え済みの列
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return 位置(すべて小さい場合は列の長さ)
+ */
+long merge_lower_bound (
+	const MERGE_RUN* run,
+	const ILC_DAT_POINT* key
+)
+{
+	/**/
+	long low = 0;
+	long high = run->num;
+	long mid;
+	/**/
+	/* ILC: merge_lower_bound開始 */
+
+	while ( low < high ) {
+		/* ILC: 二分探索 */
+		mid = low + ( high - low ) / 2;
+		if ( ILC_DatCompare( &(run->point)[mid], key ) < 0 ) {
+			/* ILC: 後半にある */
+			low = mid + 1;
+		}
+		else {
+			/* ILC: 前半にある */
+			high = mid;
+		}
+	}
+
+	/* ILC: merge_lower_bound終了 */
+	return low;
+}
+
+
+/**
+ * 1回分の併合を範囲に分割する
+ * 併合先の列を確保し、相手のいない最後の列はそのまま移す。
+ * 各組はスレッド数を組の数で割った数(短い組は MERGE_PART_MIN ごと)の範囲に分ける。
+ * @param MERGE_TASK* 作業の一覧(src/src_num/dstを設定しておくこと)
+ * @param int         スレッド数
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー
+ */
+int merge_plan (
+	MERGE_TASK* task,
+	int jobs
+)
+{
+	/**/
+	int pairs = task->src_num / 2;
+	int pieces = ( jobs + pairs - 1 ) / pairs;	/* 1組あたりの範囲の数 */
+	int run;
+	/**/
+	/* ILC: merge_plan開始 */
+
+	task->num = 0;
+	if ( task->src_num % 2 != 0 ) {
+		/* ILC: 相手のいない列はそのまま移す */
+		(task->dst)[pairs] = (task->src)[task->src_num - 1];
+		(task->src)[task->src_num - 1].owned = 0;
+	}
+
+	task->part = (MERGE_PART*)malloc( sizeof(MERGE_PART) * (size_t)pairs * (size_t)pieces );
+	if ( task->part == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+
+	for ( run = 0; run < pairs; run++ ) {
+		/**/
+		MERGE_RUN* a = &(task->src)[run * 2];
+		MERGE_RUN* b = &(task->src)[run * 2 + 1];
+		MERGE_RUN* dst = &(task->dst)[run];
+		MERGE_RUN* x = ( a->num >= b->num ) ? a : b;	/* 等分する長い方の列 */
+		MERGE_RUN* y = ( x == a ) ? b : a;
+		long n = ( a->num + b->num ) / MERGE_PART_MIN;
+		long k;
+		/**/
+		/* ILC: 組ごとに併合先を確保して分割する */
+		dst->point = (ILC_DAT_POINT*)malloc( sizeof(ILC_DAT_POINT) * (size_t)( a->num + b->num + 1 ) );
+		if ( dst->point == NULL ) {
+			/* ILC: メモリ確保エラー */
+			return -1;
+		}
+		dst->num = 0;
+		dst->owned = 1;
+
+		n = ( n < pieces ) ? n : pieces;
+		n = ( n > 1 ) ? n : 1;
+		for ( k = 0; k < n; k++ ) {
+			/**/
+			MERGE_PART* part = &(task->part)[task->num++];
+			long x_begin = 0;
+			long y_begin = 0;
+			long x_end = x->num;
+			long y_end = y->num;
+			/**/
+			/* ILC: 長い方を等分した位置の計測ポイントを境界にする */
+			if ( k > 0 ) {
+				/* ILC: 先頭の範囲以外 */
+				x_begin = x->num * k / n;
+				y_begin = merge_lower_bound( y, &(x->point)[x_begin] );
+			}
+			if ( k < n - 1 ) {
+				/* ILC: 最後の範囲以外 */
+				x_end = x->num * ( k + 1 ) / n;
+				y_end = merge_lower_bound( y, &(x->point)[x_end] );
+			}
+			part->run = run;
+			part->a_begin = ( x == a ) ? x_begin : y_begin;
+			part->a_end = ( x == a ) ? x_end : y_end;
+			part->b_begin = ( x == a ) ? y_begin : x_begin;
+			part->b_end = ( x == a ) ? y_end : x_end;
+			part->out = x_begin + y_begin;
+			part->num = 0;
+		}
+	}
+
+	/* ILC: merge_plan終了 */
+	return 0;
+}
+
+
+/**
+ * 並べ替え済みの2つの列の範囲を併合する(作業)
+ * part[ix] の範囲を、併合先の範囲の書き込み位置から書き込む。
+ * @param MERGE_TASK* 作業の一覧
+ * @param int         範囲の添字
+ * @return  0:正常終了
+ */
+int merge_part (
+	MERGE_TASK* task,
+	int ix
+)
+{
+	/**/
+	MERGE_PART* part = &(task->part)[ix];
+	const MERGE_RUN* a = &(task->src)[part->run * 2];
+	const MERGE_RUN* b = &(task->src)[part->run * 2 + 1];
+	ILC_DAT_POINT* dst = (task->dst)[part->run].point + part->out;
+	long ia = part->a_begin;
+	long ib = part->b_begin;
+	long num = 0;
+	int cmp;
+	/**/
+	/* ILC: merge_part開始 */
+
+	while ( ia < part->a_end && ib < part->b_end ) {
+		/* ILC: 小さい方から取り出す */
+		cmp = ILC_DatCompare( &(a->point)[ia], &(b->point)[ib] );
+		if ( cmp < 0 ) {
+			/* ILC: aが前 */
+			dst[num++] = (a->point)[ia++];
+		}
+		else if ( cmp > 0 ) {
+			/* ILC: bが前 */
+			dst[num++] = (b->point)[ib++];
+		}
+		else {
+			/* ILC: 同じ計測ポイントはまとめる */
+			dst[num] = (a->point)[ia++];
+			ILC_DatCombine( &dst[num++], &(b->point)[ib++] );
+		}
+	}
+	memcpy( dst + num, a->point + ia, sizeof(ILC_DAT_POINT) * (size_t)( part->a_end - ia ) );
+	num += part->a_end - ia;
+	memcpy( dst + num, b->point + ib, sizeof(ILC_DAT_POINT) * (size_t)( part->b_end - ib ) );
+	num += part->b_end - ib;
+	part->num = num;
+
+	/* ILC: merge_part終了 */
+	return 0;
+}
+
+
+/**
+ * 範囲ごとに併合した結果を、併合先の列の前へ詰める
+ * 同じ計測ポイントをまとめた範囲の後ろには隙間ができるため、次の範囲を移す。
+ * @param MERGE_TASK* 作業の一覧
+ */
+void merge_pack (
+	MERGE_TASK* task
+)
+{
+	/**/
+	MERGE_PART* part;
+	MERGE_RUN* dst;
+	int ix;
+	/**/
+	/* ILC: merge_pack開始 */
+
+	for ( ix = 0; ix < task->num; ix++ ) {
+		/* ILC: 範囲の順(組の中では先頭から)に詰める */
+		part = &(task->part)[ix];
+		dst = &(task->dst)[part->run];
+		if ( part->out != dst->num ) {
+			/* ILC: 前の範囲に隙間がある */
+			memmove( dst->point + dst->num, dst->point + part->out, sizeof(ILC_DAT_POINT) * (size_t)part->num );
+		}
+		dst->num += part->num;
+	}
+
+	/* ILC: merge_pack終了 */
+}
+
+
+/**
+ * 作業を取り出して実行する(スレッドの処理)
+ * @param void* MERGE_TASK*
+ * @return NULL
+ */
+void* merge_worker (
+	void* arg
+)
+{
+	/**/
+	MERGE_TASK* task = (MERGE_TASK*)arg;
+	int ix;
+	/**/
+	/* ILC: merge_worker開始 */
+
+	for ( ;; ) {
+		/* ILC: 作業がなくなるまで */
+		pthread_mutex_lock( &task->lock );
+		ix = ( task->error == 0 && task->next < task->num ) ? task->next++ : -1;
+		pthread_mutex_unlock( &task->lock );
+		if ( ix < 0 ) {
+			/* ILC: 作業なし、またはエラー発生済み */
+			break;
+		}
+
+		if ( task->func( task, ix ) != 0 ) {
+			/* ILC: エラー */
+			pthread_mutex_lock( &task->lock );
+			task->error = 1;
+			pthread_mutex_unlock( &task->lock );
+		}
+	}
+
+	/* ILC: merge_worker終了 */
+	return NULL;
+}
+
+
+/**
+ * 作業をスレッドに分担して、すべて終わるまで待つ
+ * 呼び出したスレッドも作業を行う。
+ * @param MERGE_TASK* 作業の一覧(func/numを設定しておくこと)
+ * @param int         スレッド数
+ * @return  0:正常終了
+ *         -1:作業でエラーが発生
+ */
+int merge_run (
+	MERGE_TASK* task,
+	int jobs
+)
+{
+	/**/
+	pthread_t* threads;
+	int started = 0;
+	int ix;
+	/**/
+	/* ILC: merge_run開始 */
+
+	task->next = 0;
+	if ( jobs > task->num ) {
+		/* ILC: 作業の数より多くのスレッドは不要 */
+		jobs = task->num;
+	}
+
+	threads = ( jobs > 1 ) ? (pthread_t*)malloc( sizeof(pthread_t) * (size_t)( jobs - 1 ) ) : NULL;
+	for ( ix = 0; threads != NULL && ix < jobs - 1; ix++ ) {
+		/* ILC: スレッドを作成 */
+		if ( pthread_create( &threads[ix], NULL, merge_worker, task ) != 0 ) {
+			/* ILC: 作成できなかった分は作成済みのスレッドで行う */
+			break;
+		}
+		started++;
+	}
+
+	merge_worker( task );
+
+	for ( ix = 0; ix < started; ix++ ) {
+		/* ILC: 終了を待つ */
+		pthread_join( threads[ix], NULL );
+	}
+	free( threads );
+
+	/* ILC: merge_run終了 */
+	return ( task->error == 0 ) ? 0 : -1;
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	MERGE_TASK task;
+	MERGE_RUN* runs;
+	const char* out_file = "-";
+	int format = ILC_DAT_TEXT;
+	long cpus;
+	int jobs = 0;
+	int num;
+	int ret;
+	int ch;
+	int ix;
+	/**/
+	/* ILC: main開始 */
+
+	while ( (ch = getopt( argc, argv, "bhj:o:" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'b':
+			/* ILC: バイナリ形式で出力 */
+			format = ILC_DAT_BINARY;
+			break;
+		case 'j':
+			/* ILC: スレッド数 */
+			jobs = atoi( optarg );
+			if ( jobs < 1 ) {
+				/* ILC: 不正な値 */
+				usage();
+				return 1;
+			}
+			break;
+		case 'o':
+			/* ILC: 出力ファイル */
+			out_file = optarg;
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 1;
+		}
+	}
+	num = argc - optind;
+	if ( num < 1 ) {
+		/* ILC: データファイルの指定なし */
+		usage();
+		return 1;
+	}
+	if ( jobs == 0 ) {
+		/* ILC: 指定がなければCPUの数 */
+		cpus = sysconf( _SC_NPROCESSORS_ONLN );
+		jobs = ( cpus > 0 ) ? (int)cpus : 1;
+	}
+
+	memset( &task, 0, sizeof(MERGE_TASK) );
+	pthread_mutex_init( &task.lock, NULL );
+	task.in_files = argv + optind;
+	task.table = (ILC_DAT_TABLE*)calloc( (size_t)num, sizeof(ILC_DAT_TABLE) );
+	runs = (MERGE_RUN*)calloc( (size_t)num, sizeof(MERGE_RUN) );
+	if ( task.table == NULL || runs == NULL ) {
+		/* ILC: メモリ確保エラー */
+		fprintf( stderr, "メモリが確保できません。\n" );
+		return 1;
+	}
+
+	/* 1. 入力ファイルごとに読み込み、並べ替える */
+	task.func = merge_load;
+	task.num = num;
+	task.dst = runs;
+	ret = merge_run( &task, jobs );
+
+	/* 2. 2つずつ併合する(各組をキーの範囲で分割してスレッドに分担する) */
+	while ( ret == 0 && num > 1 ) {
+		/**/
+		MERGE_RUN* dst;
+		/**/
+		/* ILC: 列が1つになるまで */
+		dst = (MERGE_RUN*)calloc( (size_t)( num + 1 ) / 2, sizeof(MERGE_RUN) );
+		if ( dst == NULL ) {
+			/* ILC: メモリ確保エラー */
+			fprintf( stderr, "メモリが確保できません。\n" );
+			ret = -1;
+			break;
+		}
+		task.src = runs;
+		task.src_num = num;
+		task.dst = dst;
+		ret = merge_plan( &task, jobs );
+		if ( ret == 0 ) {
+			/* ILC: 範囲ごとに併合して、前へ詰める */
+			task.func = merge_part;
+			ret = merge_run( &task, jobs );
+			merge_pack( &task );
+		}
+		else {
+			/* ILC: メモリ確保エラー */
+			fprintf( stderr, "メモリが確保できません。\n" );
+		}
+		free( task.part );
+		task.part = NULL;
+
+		for ( ix = 0; ix < num; ix++ ) {
+			/* ILC: 併合元の列を解放 */
+			if ( runs[ix].owned ) {
+				/* ILC: 併合で確保した列 */
+				free( runs[ix].point );
+			}
+		}
+		free( runs );
+		runs = dst;
+		num = ( num + 1 ) / 2;
+	}
+
+	if ( ret == 0 ) {
+		/* ILC: 併合した結果を出力 */
+		ret = ILC_DatSave( out_file, runs[0].point, runs[0].num, format );
+		if ( ret != 0 ) {
+			/* ILC: 書き込みエラー */
+			fprintf( stderr, "%s: 書き込みに失敗しました。\n", out_file );
+		}
+	}
+
+	for ( ix = 0; ix < num; ix++ ) {
+		/* ILC: 残った列を解放 */
+		if ( runs[ix].owned ) {
+			/* ILC: 併合で確保した列 */
+			free( runs[ix].point );
+		}
+	}
+	free( runs );
+	for ( ix = 0; ix < argc - optind; ix++ ) {
+		/* ILC: 入力ファイルの内容を解放 */
+		ILC_DatFree( &task.table[ix] );
+	}
+	free( task.table );
+	pthread_mutex_destroy( &task.lock );
+
+	/* ILC: main終了 */
+	return ( ret == 0 ) ? 0 : 1;
+}
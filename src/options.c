@@ -34,10 +34,18 @@
  *
  */
 
+#include <stdlib.h>
 #include <unistd.h>
+#include <getopt.h>
 #include "options.h"
 
-static const char* options_str = "f:o:hv";
+static const char* options_str = "C:S:f:o:hij:mnrv";
+
+/** 長い名前のオプション(短い名前のオプションに対応させる) */
+static const struct option long_options[] = {
+	{ "server", required_argument, NULL, 'S' },
+	{ NULL,     0,                 NULL, 0   }
+};
 
 
 /**
@@ -65,9 +73,17 @@ void parse_option (
 	optreset = 1;
 	optind   = 1;
 
-	while ( (ch = getopt(argc, argv, options_str)) != -1 ) {
+	while ( (ch = getopt_long(argc, argv, options_str, long_options, NULL)) != -1 ) {
 		/* ILC: オプション解析 */
 		switch ( ch ) {
+		case 'C':
+			/* ILC: 変換結果のキャッシュディレクトリの指定 */
+			opt->cache_dir = optarg;
+			break;
+		case 'S':
+			/* ILC: 変換サーバーとして起動(ソケットのパス) */
+			opt->server = optarg;
+			break;
 		case 'f':
 			/* ILC: ILCデータファイルの指定 */
 			opt->ilc_file = optarg;
@@ -76,6 +92,33 @@ void parse_option (
 			/* ILC: 変換後ファイルの指定 */
 			opt->out_file = optarg;
 			break;
+		case 'i':
+			/* ILC: 計測ポイントをIDで出力 */
+			opt->id_mode = 1;
+			break;
+		case 'j':
+			/* ILC: 同時に変換するファイルの数 */
+			opt->jobs = atoi( optarg );
+			if ( opt->jobs < 1 ) {
+				/* ILC: 1以上の数でなければエラー */
+				opt->help = 1;
+			}
+			break;
+		case 'm':
+			/* ILC: ファイルごとのマニフェストを出力 */
+			opt->manifest = 1;
+			break;
+		case 'n':
+			/* ILC: 計測ポイントをインライン展開するマクロで出力 */
+			if ( opt->inline_mode == 0 ) {
+				/* ILC: -r の指定を優先する */
+				opt->inline_mode = 1;
+			}
+			break;
+		case 'r':
+			/* ILC: 計測ポイントを実行ファイルの ilc_points セクションに登録する */
+			opt->inline_mode = 2;
+			break;
 		case 'v':
 			/* ILC: バージョン情報出力 */
 			opt->version = 1;
@@ -93,7 +136,9 @@ void parse_option (
 
 	if ( argc > 0 ) {
 		/* ILC: 入力ファイル名の設定 */
-		opt->in_file = argv[0];
+		opt->in_file  = argv[0];
+		opt->in_files = argv;
+		opt->in_num   = argc;
 	}
 
 	/* ILC: parse_option終了 */
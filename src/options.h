@@ -39,10 +39,19 @@
 
 struct opt {
 	char*	ilc_file;		/**< ILCデータファイル名 */
-	char*	in_file;		/**< 変換元入力ファイル名 */
+	char*	in_file;		/**< 変換元入力ファイル名(先頭のファイル) */
+	char**	in_files;		/**< 変換元入力ファイル名の一覧(@ファイル名はファイル一覧の指定) */
+	int		in_num;			/**< 変換元入力ファイルの数 */
 	char*	out_file;		/**< 変換後出力ファイル名 */
 	int		version;		/**< バージョン情報出力 */
 	int		help;			/**< ヘルプ出力 */
+	int		id_mode;		/**< 計測ポイントをIDで出力 */
+	int		jobs;			/**< 同時に変換するファイルの数(0:指定なし) */
+	int		manifest;		/**< ILCデータファイルの代わりにファイルごとのマニフェストを出力 */
+	int		inline_mode;	/**< 計測ポイントをインライン展開するマクロで出力(ilc_inline.h)
+							     0:関数呼び出し 1:インライン 2:インライン + ilc_points セクションに登録 */
+	char*	cache_dir;		/**< 変換結果のキャッシュディレクトリ(NULL:キャッシュしない) */
+	char*	server;			/**< 変換サーバーのソケットのパス(NULL:サーバーとして起動しない) */
 };
 
 
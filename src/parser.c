@@ -72,20 +72,10 @@
 /** RCSID */
 static const char rcsid[] = "$Id: parser.c,v 1.2 2008/05/25 13:22:49 shingo Exp $";
 
-
-/*
- * 外部定義
- */
-extern int yylex();
-extern int yylineno;
-extern char* yytext;
-extern int yyleng;
-
-
-/*
- * 内部定義
+/*-
+ * 解析中の状態(字句解析器、longjmpの戻り先)はすべて PARSE_DATA に持つ。
+ * 静的な状態を持たないため、ファイルごとに別スレッドで parse を呼び出せる。
  */
-static jmp_buf jbuf;
 
 
 /**
@@ -113,18 +103,23 @@ int parse (
 	pdata.addflag = 0;
 	pdata.ilc_func  = ilc->ilc_func;
 	pdata.fpout = ilc->fpout;
+	pdata.ilc_data = ilc->ilc_data;
+	pdata.inline_mode = ilc->inline_mode;
 
 	/* parse準備 */
-	set_lex_input( ilc->fpin );
-	set_lex_output( ilc->fpout );
-	yylineno = 1;
+	pdata.scanner = lex_create( ilc->fpin, ilc->fpout );
+	if ( pdata.scanner == NULL ) {
+		/* ILC: 字句解析器が作成できない */
+		breakflag = -1;
+		exception = EXP_ALLOC;
+	}
 
 
 	/* ILC: parse開始 */
 
-	while ( breakflag == 0 && (token = get_token()) != 0 ) {
+	while ( breakflag == 0 && (token = get_token( &pdata )) != 0 ) {
 		/* ILC: C++でいう try */
-		exception = setjmp( jbuf );
+		exception = setjmp( pdata.jbuf );
 		switch ( exception ) {
 		case EXP_START:
 			/* ILC: 構文解析の開始 */
@@ -154,6 +149,11 @@ int parse (
 
 	ilc->ilc_func = pdata.ilc_func;
 
+	if ( pdata.scanner != NULL ) {
+		/* ILC: 字句解析器の破棄 */
+		lex_destroy( pdata.scanner );
+	}
+
 	/* ILC: parse終了 */
 	return exception;
 }
@@ -303,14 +303,14 @@ static int function_definition (
 		/* ILC: 左かっこ検出 */
 		/* LL_PARENTHIS_R が出現するまで読み込み続ける */
 		/* いろいろと面倒なため、LL_IDであるかのチェックは行わない */
-		while ( (token = get_token()) != LL_PARENTHIS_R ) {
+		while ( (token = get_token( pdata )) != LL_PARENTHIS_R ) {
 			/* ILC: 右かっこ検出中 */
 			if ( token == 0 ) {
 				/* ILC: EOFが検出されたので解析エラー */
 				parse_error( token, pdata );
 			}
 		}
-		token = get_token();
+		token = get_token( pdata );
 		break;
 	default:
 		/* ILC: 関数定義なのに左かっこがないので解析エラー */
@@ -347,12 +347,12 @@ static int function_imple (
 			/* ILC: EOFは解析エラー */
 			parse_error( token, pdata );
 		}
-		token = get_token();
+		token = get_token( pdata );
 	}
 
 
 	/* 先ほど検出した LL_BRACE_L に対応した LL_BRACE_R を検出するまでループ */
-	while ( (token = get_token()) != LL_BRACE_R ) {
+	while ( (token = get_token( pdata )) != LL_BRACE_R ) {
 		switch ( token ) {
 		case 0:
 			/* ILC: EOFは解析エラー */
@@ -369,19 +369,49 @@ static int function_imple (
 				int ret;
 				/**/
 				/* カバレッジ検出ポイントをリストに追加 */
-				ret = ilc_append_coverage( &(pdata->ilc_func), pdata->func_name, yylineno );
+				ret = ilc_append_coverage( &(pdata->ilc_func), pdata->func_name, lex_lineno( pdata->scanner ) );
 				if ( ret == 0 ) {
 					/* ILC: リストへの追加に成功 */
 					pdata->addflag = 1;
 				}
 				else {
 					/* ILC: リストへの追加に失敗 */
-					longjmp( jbuf, EXP_ALLOC );
+					longjmp( pdata->jbuf, EXP_ALLOC );
 				}
 			}
 
 			/* カバレッジ検出ポイントをコードに付与 */
-			ilc_put_coverage( pdata->fpout, pdata->file_name, pdata->func_name, yylineno );
+			if ( pdata->inline_mode == 2 ) {
+				/* ILC: 実行ファイルに登録する(IDは実行時に決まる) */
+				ilc_put_coverage_point( pdata->fpout, pdata->file_name, pdata->func_name, lex_lineno( pdata->scanner ) );
+			}
+			else if ( pdata->ilc_data != NULL ) {
+				/**/
+				long id;
+				/**/
+				/* ILC: ID指定で出力 */
+				id = ilc_coverage_id( pdata->ilc_data, pdata->file_name, pdata->func_name, lex_lineno( pdata->scanner ) );
+				if ( id < 0 ) {
+					/* ILC: ILCカバレッジデータへの登録に失敗 */
+					longjmp( pdata->jbuf, EXP_ALLOC );
+				}
+				if ( pdata->inline_mode != 0 ) {
+					/* ILC: インライン版 */
+					ilc_put_coverage_id_inline( pdata->fpout, id );
+				}
+				else {
+					/* ILC: 関数呼び出し */
+					ilc_put_coverage_id( pdata->fpout, id );
+				}
+			}
+			else if ( pdata->inline_mode != 0 ) {
+				/* ILC: 文字列で出力(インライン版) */
+				ilc_put_coverage_inline( pdata->fpout, pdata->file_name, pdata->func_name, lex_lineno( pdata->scanner ) );
+			}
+			else {
+				/* ILC: 文字列で出力 */
+				ilc_put_coverage( pdata->fpout, pdata->file_name, pdata->func_name, lex_lineno( pdata->scanner ) );
+			}
 			break;
 		default:
 			/* ILC: その他の token を検出 */
@@ -415,14 +445,14 @@ static int ids (
 		/* ILC: IDを検出中 */
 		if ( token == LL_ID ) {
 			/* ILC: 関数名の定義 */
-			ret = set_func_name( yytext, yyleng, pdata );
+			ret = set_func_name( lex_text( pdata->scanner ), lex_leng( pdata->scanner ), pdata );
 			if ( ret != 0 ) {
 				/* ILC: メモリ不足 */
-				longjmp( jbuf, EXP_ALLOC );
+				longjmp( pdata->jbuf, EXP_ALLOC );
 			}
 		}
 
-		token = get_token();
+		token = get_token( pdata );
 	}
 
 	token = struct_or_union( token, pdata );
@@ -458,7 +488,7 @@ static int struct_or_union (
 		while ( stack != 0 ) {
 			/* ILC: スタックが空になるまでループです */
 
-			token = get_token();
+			token = get_token( pdata );
 			switch ( token ) {
 			case LL_BRACE_L:
 				/* ILC: LL_BRACE_Lを検出したのでスタックに積みます */
@@ -477,11 +507,11 @@ static int struct_or_union (
 		/* ILC: LL_IDを検出したら、飲み込む。それ以外の字句であれば上位へ返す */
 		/* typedef struct _st { ... } ST; という宣言を想定しての動作*/
 
-		token = get_token();
+		token = get_token( pdata );
 		token = skip_ilc_comment( token, pdata );
 		if ( token == LL_ID ) {
 			/* ILC: LL_IDだったので次の字句を上位へ返す */
-			token = get_token();
+			token = get_token( pdata );
 		}
 	}
 
@@ -502,19 +532,20 @@ static void parse_error (
 )
 {
 	/**/
+	char* text = lex_text( pdata->scanner );	/* 異常を検出した token の文字列 */
 	struct tokens {
 		int token;
 		char* type;
 		char* text;
 	}
 	tokens[] = {
-		{ LL_ID,			"関数名 or 変数名",		yytext },
-		{ LL_BRACE_L,		"カッコ",				yytext },
-		{ LL_BRACE_R,		"カッコ閉じ",			yytext },
-		{ LL_PARENTHIS_L,	"カッコ", 				yytext },
-		{ LL_PARENTHIS_R,	"カッコ閉じ", 			yytext },
-		{ LL_EXP_END,		"セミコロン",			yytext },
-		{ LL_ILC_COMMENT,	"コメント中のILCタグ",	yytext },
+		{ LL_ID,			"関数名 or 変数名",		text   },
+		{ LL_BRACE_L,		"カッコ",				text   },
+		{ LL_BRACE_R,		"カッコ閉じ",			text   },
+		{ LL_PARENTHIS_L,	"カッコ", 				text   },
+		{ LL_PARENTHIS_R,	"カッコ閉じ", 			text   },
+		{ LL_EXP_END,		"セミコロン",			text   },
+		{ LL_ILC_COMMENT,	"コメント中のILCタグ",	text   },
 		{ 0,				"EOF",					"NULL" },
 		{ -1,				NULL,					NULL   }
 	};
@@ -530,10 +561,10 @@ static void parse_error (
 	}
 
 	fprintf( stderr, "予期しないトークンが出現しました。(%s:%s) in %s(%d)\n"
-			 , ptoken->type, ptoken->text, pdata->file_name, yylineno );
+			 , ptoken->type, ptoken->text, pdata->file_name, lex_lineno( pdata->scanner ) );
 
 	/* ILC: parse_error終了 */
-	longjmp( jbuf, EXP_FAILURE );
+	longjmp( pdata->jbuf, EXP_FAILURE );
 }
 
 /**
@@ -554,7 +585,7 @@ static int skip_ilc_comment (
 
 	while ( token == LL_ILC_COMMENT ) {
 		/* ILC: コメント読み飛ばし中 */
-		token = get_token();
+		token = get_token( pdata );
 	}
 
 	/* ILC: skip_ilc_comment終了 */
@@ -564,9 +595,11 @@ static int skip_ilc_comment (
 
 /**
  * lex から token を取得するラッパー
+ * @param PARSE_DATA*
  * @return lex から取得した token
  */
 static int get_token (
+	PARSE_DATA* pdata
 )
 {
 	/**/
@@ -575,7 +608,7 @@ static int get_token (
 
 	/* ILC: get_token開始 */
 
-	retcode = yylex();
+	retcode = lex_token( pdata->scanner );
 
 	/* ILC: get_token終了 */
 	return retcode;
@@ -37,6 +37,9 @@
 #ifndef _PARSER_LOCAL_H_
 #define _PARSER_LOCAL_H_
 
+#include <setjmp.h>
+#include "ilc.h"
+#include "scan.h"
 #include "util.h"
 
 /** 構文解析の未実施 (setjmpの戻り値) */
@@ -53,6 +56,10 @@ typedef struct _parse_data {
 	int         addflag;	/* ILC_FUNCにfunc_nameを格納したかどうか */
 	SLIST*		ilc_func;
 	FILE*		fpout;
+	ILC_DATA*	ilc_data;	/* ID指定で出力する場合の登録先(NULL:文字列で出力) */
+	int			inline_mode;	/* 0以外:インライン展開するマクロで出力(2:ilc_points セクションに登録) */
+	LEX_SCANNER	scanner;	/* 字句解析器 */
+	jmp_buf		jbuf;		/* 異常時の戻り先 */
 }
 PARSE_DATA;
 
@@ -134,9 +141,10 @@ static int skip_ilc_comment( int, PARSE_DATA* );
 
 /**
  * lex から token を取得するラッパー
+ * @param PARSE_DATA*
  * @return lex から取得した token
  */
-static int get_token( );
+static int get_token( PARSE_DATA* );
 
 /**
  * 関数名をバッファに設定する
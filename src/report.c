@@ -0,0 +1,960 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	report.c
+ * @brief	ILCカバレッジデータからHTMLのレポートを作成する(ilc-report)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ilc_dat.h"
+
+/*-
+ * tool/dat2xml.awk + tool/report.xsl と同じレイアウトのHTMLを出力する。
+ *
+ * report.xsl はファイル・関数ごとのグルーピングを preceding-sibling と
+ * count() で行うため、計測ポイント数の2乗の時間がかかる。
+ * ここでは全データファイルを1回だけ読み込み、ファイル名と
+ * (ファイル, 関数名)をキーとしたハッシュ表で集計する。
+ * ファイル・関数の並びは report.xsl と同じく最初に現れた順とし、
+ * 詳細の行は関数ごとに行数順に並べる(同じ行数は現れた順)。
+ * 通過回数(ILC_MODE_COUNT)のあるデータファイルでは、詳細に Hits の列を加える。
+ * 通過回数が標本化(ILC_SetSampling)による推定値の場合は、-s で間隔を指定すると
+ * 列の見出しに推定値であることを表示する(データファイルには間隔が残らないため)。
+ */
+
+/**
+ * 計測ポイント(詳細表示用)
+ */
+typedef struct _report_line {
+	long	line;		/**< 行数 */
+	long	seq;		/**< 現れた順番(同じ行数の並び順) */
+	int		covered;	/**< 通過済みか */
+	int		has_count;	/**< 通過回数の項目があるか */
+	unsigned long long	count;	/**< 通過回数 */
+}
+REPORT_LINE;
+
+/**
+ * 関数ごとの集計
+ */
+typedef struct _report_func {
+	struct _report_func*	next;		/**< 同じファイルの次の関数(現れた順) */
+	struct _report_file*	file;		/**< 関数のあるファイル */
+	char*					name;		/**< 関数名 */
+	unsigned long			hash;		/**< ハッシュ値 */
+	long					covered;	/**< 通過済みの計測ポイント数 */
+	long					total;		/**< 計測ポイント数 */
+	REPORT_LINE*			lines;		/**< 計測ポイント */
+	long					capacity;	/**< linesの確保済みの数 */
+}
+REPORT_FUNC;
+
+/**
+ * ファイルごとの集計
+ */
+typedef struct _report_file {
+	struct _report_file*	next;		/**< 次のファイル(現れた順) */
+	char*					name;		/**< ファイル名 */
+	unsigned long			hash;		/**< ハッシュ値 */
+	long					covered;	/**< 通過済みの計測ポイント数 */
+	long					total;		/**< 計測ポイント数 */
+	REPORT_FUNC*			func;		/**< 関数の一覧の先頭 */
+	REPORT_FUNC*			func_last;	/**< 関数の一覧の末尾 */
+}
+REPORT_FILE;
+
+/**
+ * レポート全体の集計
+ */
+typedef struct _report {
+	REPORT_FILE*	file;			/**< ファイルの一覧の先頭 */
+	REPORT_FILE*	file_last;		/**< ファイルの一覧の末尾 */
+	long			file_num;		/**< ファイルの数 */
+	REPORT_FILE**	file_index;		/**< ファイル名のハッシュ表 */
+	long			file_index_size;/**< file_indexのサイズ(2のべき乗) */
+	long			func_num;		/**< 関数の数 */
+	REPORT_FUNC**	func_index;		/**< (ファイル, 関数名)のハッシュ表 */
+	long			func_index_size;/**< func_indexのサイズ(2のべき乗) */
+	long			covered;		/**< 通過済みの計測ポイント数 */
+	long			total;			/**< 計測ポイント数 */
+	int				has_count;		/**< 通過回数のある計測ポイントがあるか */
+	long			sampling;		/**< 通過回数の標本化の間隔(-s、1以下:推定値でない) */
+}
+REPORT;
+
+/* ハッシュ表の初期サイズ(2のべき乗であること) */
+#define REPORT_INDEX_MIN (256)
+
+/* HTMLのスタイルシート(report.xslと同じ) */
+static const char* report_style =
+	"      .graph {\n"
+	"        position: relative;\n"
+	"        width: 200px;\n"
+	"        border: 1px solid #000000;\n"
+	"        background: #d60000;\n"
+	"        padding: 0px;\n"
+	"      }\n"
+	"      .graph .bar {\n"
+	"        display: block;\n"
+	"        position: relative;\n"
+	"        background: #00D600;\n"
+	"        text-align: center;\n"
+	"        color: #FFFFFF;\n"
+	"        height: 2em;\n"
+	"        line-height: 2em;\n"
+	"      }\n"
+	"      .graph .bar span { position: absolute; left: 1em; }\n"
+	"\n"
+	"      body {\n"
+	"        font:normal 68% verdana,arial,helvetica;\n"
+	"        color:#000000;\n"
+	"      }\n"
+	"      table {\n"
+	"        width:100%;\n"
+	"        border:0;\n"
+	"      }\n"
+	"      table tr td {\n"
+	"        font-size: 100%;\n"
+	"        background:#eeeee0;\n"
+	"      }\n"
+	"      table tr th {\n"
+	"        font-size: 100%;\n"
+	"        text-align:center;\n"
+	"        background:#a6caf0;\n"
+	"      }\n"
+	"      h1 {\n"
+	"        margin: 0px 0px 5px; font: 165% verdana,arial,helvetica;\n"
+	"      }\n"
+	"      h2 {\n"
+	"        margin-top: 1em; margin-bottom: 0.5em; font: bold 125% verdana,arial,helvetica;\n"
+	"      }\n"
+	"      h3 {\n"
+	"        margin-bottom: 0.5em; font: bold 115% verdana,arial,helvetica;\n"
+	"      }\n"
+	"      h4 {\n"
+	"        margin-top: 0px;\n"
+	"        margin-bottom: 0.5em; font: bold 100% verdana,arial,helvetica;\n"
+	"        color: blue;\n"
+	"      }\n"
+	"      h5 {\n"
+	"        margin-bottom: 0.5em; font: bold 100% verdana,arial,helvetica;\n"
+	"        font-size: 95%;\n"
+	"      }\n"
+	"      h6 {\n"
+	"        margin-bottom: 0px; font: bold 100% verdana,arial,helvetica;\n"
+	"      }\n"
+	"\n"
+	"      .Passed {\n"
+	"        background:green;\n"
+	"        color:white;\n"
+	"        text-align:center;\n"
+	"      }\n"
+	"      .NotYet {\n"
+	"        background:red;\n"
+	"        font-weight:bold;\n"
+	"        color:white;\n"
+	"        text-align:center;\n"
+	"      }\n";
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-report [options] datafile ...\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  -o outfile   output file (default: standard output)\n", stdout);
+  fputs("  -s N         hit counts were sampled 1-in-N (ILC_SAMPLE); mark them as estimates\n", stdout);
+  fputs("  datafile     coverage data file (\"-\" for standard input)\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+/**
+ * 文字列のハッシュ値を求める(FNV-1a)
+ * @param unsigned long 初期値(0の場合はFNVの初期値を使う)
+ * @param const char*   文字列
+ * @return ハッシュ値
+ */
+unsigned long report_hash (
+	unsigned long hash,
+	const char* str
+)
+{
+	/**/
+	/**/
+	/* ILC: report_hash開始 */
+
+	if ( hash == 0 ) {
+		/* ILC: FNVの初期値 */
+		hash = 2166136261UL;
+	}
+	for ( ; *str != '\0'; str++ ) {
+		/* ILC: 1文字ずつ */
+		hash ^= (unsigned char)*str;
+		hash *= 16777619UL;
+	}
+
+	/* ILC: report_hash終了 */
+	return hash;
+}
+
+
+/**
+ * 文字列を複製する
+ * @param const char* 複製する文字列
+ * @return 複製した文字列
+ *         NULL:メモリ確保エラー
+ */
+char* report_strdup (
+	const char* str
+)
+{
+	/**/
+	char* dst;
+	/**/
+	/* ILC: report_strdup開始 */
+
+	dst = (char*)malloc( strlen( str ) + 1 );
+	if ( dst != NULL ) {
+		/* ILC: 複製 */
+		strcpy( dst, str );
+	}
+
+	/* ILC: report_strdup終了 */
+	return dst;
+}
+
+
+/**
+ * ハッシュ表を倍の大きさで作り直す
+ * 登録されている要素は hash の値で入れ直す。
+ * @param void***      ハッシュ表(REPORT_FILE** または REPORT_FUNC**)
+ * @param long*        ハッシュ表のサイズ
+ * @param unsigned long (*)(const void*) 要素のハッシュ値を得る関数
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー(ハッシュ表は変更しない)
+ */
+int report_rehash (
+	void*** index,
+	long* size,
+	unsigned long (*hash_of)(const void*)
+)
+{
+	/**/
+	void** new_index;
+	long new_size;
+	long ix;
+	/**/
+	/* ILC: report_rehash開始 */
+
+	new_size = ( *size == 0 ) ? REPORT_INDEX_MIN : *size * 2;
+	new_index = (void**)calloc( (size_t)new_size, sizeof(void*) );
+	if ( new_index == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+
+	for ( ix = 0; ix < *size; ix++ ) {
+		/* ILC: 登録済みの要素を入れ直す */
+		if ( (*index)[ix] != NULL ) {
+			/**/
+			long pos = (long)(hash_of( (*index)[ix] ) & (unsigned long)(new_size - 1));
+			/**/
+			/* ILC: 空いている位置を線形探索 */
+			while ( new_index[pos] != NULL ) {
+				/* ILC: 次の位置 */
+				pos = ( pos + 1 ) & ( new_size - 1 );
+			}
+			new_index[pos] = (*index)[ix];
+		}
+	}
+
+	free( *index );
+	*index = new_index;
+	*size = new_size;
+
+	/* ILC: report_rehash終了 */
+	return 0;
+}
+
+
+/**
+ * REPORT_FILEのハッシュ値を得る(report_rehash用)
+ * @param const void* REPORT_FILE*
+ * @return ハッシュ値
+ */
+unsigned long report_file_hash (
+	const void* file
+)
+{
+	/**/
+	/**/
+	/* ILC: report_file_hash */
+	return ((const REPORT_FILE*)file)->hash;
+}
+
+
+/**
+ * REPORT_FUNCのハッシュ値を得る(report_rehash用)
+ * @param const void* REPORT_FUNC*
+ * @return ハッシュ値
+ */
+unsigned long report_func_hash (
+	const void* func
+)
+{
+	/**/
+	/**/
+	/* ILC: report_func_hash */
+	return ((const REPORT_FUNC*)func)->hash;
+}
+
+
+/**
+ * ファイルの集計を検索する。なければ作成して一覧の末尾に追加する。
+ * @param REPORT*     レポート全体の集計
+ * @param const char* ファイル名
+ * @return REPORT_FILE* ファイルの集計
+ *                      NULL:メモリ確保エラー
+ */
+REPORT_FILE* report_file (
+	REPORT* report,
+	const char* name
+)
+{
+	/**/
+	REPORT_FILE* file;
+	unsigned long hash;
+	long pos;
+	/**/
+	/* ILC: report_file開始 */
+
+	if ( ( report->file_num + 1 ) * 2 > report->file_index_size ) {
+		/* ILC: 負荷率が1/2を超えるのでハッシュ表を拡大する */
+		if ( report_rehash( (void***)&report->file_index, &report->file_index_size, report_file_hash ) != 0 ) {
+			/* ILC: 拡大失敗 */
+			return NULL;
+		}
+	}
+
+	hash = report_hash( 0, name );
+	pos = (long)(hash & (unsigned long)(report->file_index_size - 1));
+	while ( (file = (report->file_index)[pos]) != NULL ) {
+		/* ILC: 登録済みの位置 */
+		if ( file->hash == hash && strcmp( file->name, name ) == 0 ) {
+			/* ILC: 見つかった */
+			return file;
+		}
+		pos = ( pos + 1 ) & ( report->file_index_size - 1 );
+	}
+
+	file = (REPORT_FILE*)calloc( 1, sizeof(REPORT_FILE) );
+	if ( file == NULL || (file->name = report_strdup( name )) == NULL ) {
+		/* ILC: メモリ確保エラー */
+		free( file );
+		return NULL;
+	}
+	file->hash = hash;
+	(report->file_index)[pos] = file;
+	report->file_num++;
+
+	if ( report->file_last != NULL ) {
+		/* ILC: 一覧の末尾に追加 */
+		report->file_last->next = file;
+	}
+	else {
+		/* ILC: 最初のファイル */
+		report->file = file;
+	}
+	report->file_last = file;
+
+	/* ILC: report_file終了 */
+	return file;
+}
+
+
+/**
+ * 関数の集計を検索する。なければ作成してファイルの関数一覧の末尾に追加する。
+ * @param REPORT*      レポート全体の集計
+ * @param REPORT_FILE* 関数のあるファイル
+ * @param const char*  関数名
+ * @return REPORT_FUNC* 関数の集計
+ *                      NULL:メモリ確保エラー
+ */
+REPORT_FUNC* report_func (
+	REPORT* report,
+	REPORT_FILE* file,
+	const char* name
+)
+{
+	/**/
+	REPORT_FUNC* func;
+	unsigned long hash;
+	long pos;
+	/**/
+	/* ILC: report_func開始 */
+
+	if ( ( report->func_num + 1 ) * 2 > report->func_index_size ) {
+		/* ILC: 負荷率が1/2を超えるのでハッシュ表を拡大する */
+		if ( report_rehash( (void***)&report->func_index, &report->func_index_size, report_func_hash ) != 0 ) {
+			/* ILC: 拡大失敗 */
+			return NULL;
+		}
+	}
+
+	/* ファイル名のハッシュ値に続けて関数名を加える */
+	hash = report_hash( file->hash, name );
+	pos = (long)(hash & (unsigned long)(report->func_index_size - 1));
+	while ( (func = (report->func_index)[pos]) != NULL ) {
+		/* ILC: 登録済みの位置 */
+		if ( func->hash == hash && func->file == file && strcmp( func->name, name ) == 0 ) {
+			/* ILC: 見つかった */
+			return func;
+		}
+		pos = ( pos + 1 ) & ( report->func_index_size - 1 );
+	}
+
+	func = (REPORT_FUNC*)calloc( 1, sizeof(REPORT_FUNC) );
+	if ( func == NULL || (func->name = report_strdup( name )) == NULL ) {
+		/* ILC: メモリ確保エラー */
+		free( func );
+		return NULL;
+	}
+	func->hash = hash;
+	func->file = file;
+	(report->func_index)[pos] = func;
+	report->func_num++;
+
+	if ( file->func_last != NULL ) {
+		/* ILC: 一覧の末尾に追加 */
+		file->func_last->next = func;
+	}
+	else {
+		/* ILC: ファイルの最初の関数 */
+		file->func = func;
+	}
+	file->func_last = func;
+
+	/* ILC: report_func終了 */
+	return func;
+}
+
+
+/**
+ * 計測ポイントを集計に加える
+ * @param REPORT*              レポート全体の集計
+ * @param const ILC_DAT_POINT* 計測ポイント
+ * @return  0:正常終了
+ *         -1:メモリ確保エラー
+ */
+int report_add (
+	REPORT* report,
+	const ILC_DAT_POINT* point
+)
+{
+	/**/
+	REPORT_FILE* file;
+	REPORT_FUNC* func;
+	int covered;
+	/**/
+	/* ILC: report_add開始 */
+
+	file = report_file( report, point->file );
+	if ( file == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+	func = report_func( report, file, point->func );
+	if ( func == NULL ) {
+		/* ILC: メモリ確保エラー */
+		return -1;
+	}
+
+	if ( func->total == func->capacity ) {
+		/**/
+		REPORT_LINE* lines;
+		long capacity = ( func->capacity == 0 ) ? 16 : func->capacity * 2;
+		/**/
+		/* ILC: 計測ポイントの領域を倍々で拡張する */
+		lines = (REPORT_LINE*)realloc( func->lines, sizeof(REPORT_LINE) * (size_t)capacity );
+		if ( lines == NULL ) {
+			/* ILC: 拡張失敗 */
+			return -1;
+		}
+		func->lines = lines;
+		func->capacity = capacity;
+	}
+
+	covered = ILC_DAT_COVERED( point );
+	(func->lines)[func->total].line = point->line;
+	(func->lines)[func->total].seq = func->total;
+	(func->lines)[func->total].covered = covered;
+	(func->lines)[func->total].has_count = point->has_count;
+	(func->lines)[func->total].count = point->count;
+	if ( point->has_count ) {
+		/* ILC: 詳細に通過回数の列を加える */
+		report->has_count = 1;
+	}
+
+	func->total++;
+	file->total++;
+	report->total++;
+	if ( covered ) {
+		/* ILC: 通過済み */
+		func->covered++;
+		file->covered++;
+		report->covered++;
+	}
+
+	/* ILC: report_add終了 */
+	return 0;
+}
+
+
+/**
+ * データファイルを読み込み、集計に加える
+ * 形式が正しくない行は警告を表示して読み飛ばす。
+ * @param REPORT*     レポート全体の集計
+ * @param const char* データファイル名
+ * @return  0:正常終了
+ *         -1:ファイルが開けない、またはメモリ確保エラー
+ */
+int report_load (
+	REPORT* report,
+	const char* filename
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT point;
+	int ret = 0;
+	int rc;
+	/**/
+	/* ILC: report_load開始 */
+
+	reader = ILC_DatOpen( filename );
+	if ( reader == NULL ) {
+		/* ILC: ファイルオープンエラー */
+		fprintf( stderr, "%s: ファイルを開けません。\n", filename );
+		return -1;
+	}
+
+	while ( ret == 0 && (rc = ILC_DatRead( reader, &point )) != 0 ) {
+		/* ILC: 1行ずつ集計 */
+		if ( rc > 0 ) {
+			/* ILC: 計測ポイント */
+			ret = report_add( report, &point );
+		}
+		else {
+			/* ILC: 形式が正しくない行 */
+			fprintf( stderr, "%s:%ld: 形式が正しくないため読み飛ばします。\n", filename, reader->lineno );
+		}
+	}
+	if ( ret != 0 ) {
+		/* ILC: メモリ確保エラー */
+		fprintf( stderr, "%s: メモリが確保できません。\n", filename );
+	}
+
+	ILC_DatClose( reader );
+
+	/* ILC: report_load終了 */
+	return ret;
+}
+
+
+/**
+ * 集計を解放する
+ * @param REPORT* レポート全体の集計
+ */
+void report_free (
+	REPORT* report
+)
+{
+	/**/
+	REPORT_FILE* file;
+	REPORT_FUNC* func;
+	/**/
+	/* ILC: report_free開始 */
+
+	while ( (file = report->file) != NULL ) {
+		/* ILC: ファイルごとに解放 */
+		report->file = file->next;
+		while ( (func = file->func) != NULL ) {
+			/* ILC: 関数ごとに解放 */
+			file->func = func->next;
+			free( func->lines );
+			free( func->name );
+			free( func );
+		}
+		free( file->name );
+		free( file );
+	}
+	free( report->file_index );
+	free( report->func_index );
+	memset( report, 0, sizeof(REPORT) );
+
+	/* ILC: report_free終了 */
+}
+
+
+/**
+ * 計測ポイントを行数順に並べるための比較関数
+ * 同じ行数の場合は現れた順とする。
+ * @param const void* REPORT_LINE*
+ * @param const void* REPORT_LINE*
+ * @return 比較結果
+ */
+int report_line_cmp (
+	const void* a,
+	const void* b
+)
+{
+	/**/
+	const REPORT_LINE* la = (const REPORT_LINE*)a;
+	const REPORT_LINE* lb = (const REPORT_LINE*)b;
+	/**/
+	/* ILC: report_line_cmp開始 */
+
+	if ( la->line != lb->line ) {
+		/* ILC: 行数が異なる */
+		return ( la->line < lb->line ) ? -1 : 1;
+	}
+
+	/* ILC: report_line_cmp終了 */
+	return ( la->seq < lb->seq ) ? -1 : ( la->seq > lb->seq );
+}
+
+
+/**
+ * HTMLの特殊文字をエスケープして出力する
+ * @param FILE*       出力先
+ * @param const char* 出力する文字列
+ */
+void html_puts (
+	FILE* fp,
+	const char* str
+)
+{
+	/**/
+	/**/
+	/* ILC: html_puts開始 */
+
+	for ( ; *str != '\0'; str++ ) {
+		/* ILC: 1文字ずつ */
+		switch ( *str ) {
+		case '&':
+			/* ILC: & */
+			fputs( "&amp;", fp );
+			break;
+		case '<':
+			/* ILC: < */
+			fputs( "&lt;", fp );
+			break;
+		case '>':
+			/* ILC: > */
+			fputs( "&gt;", fp );
+			break;
+		case '"':
+			/* ILC: " */
+			fputs( "&quot;", fp );
+			break;
+		default:
+			/* ILC: そのまま */
+			putc( *str, fp );
+			break;
+		}
+	}
+
+	/* ILC: html_puts終了 */
+}
+
+
+/**
+ * 網羅率のグラフを出力する
+ * @param FILE*       出力先
+ * @param const char* 行頭の字下げ
+ * @param long        通過済みの計測ポイント数
+ * @param long        計測ポイント数
+ */
+void html_graph (
+	FILE* fp,
+	const char* indent,
+	long covered,
+	long total
+)
+{
+	/**/
+	long rate;
+	/**/
+	/* ILC: html_graph開始 */
+
+	/* report.xsl と同じく切り捨て */
+	rate = ( total > 0 ) ? ( covered * 100 / total ) : 0;
+
+	fprintf( fp, "%s<td>\n", indent );
+	fprintf( fp, "%s  <div class=\"graph\">\n", indent );
+	fprintf( fp, "%s    <div class=\"bar\" style=\"width:%ld%%;\">%ld%%</div>\n", indent, rate, rate );
+	fprintf( fp, "%s  </div>\n", indent );
+	fprintf( fp, "%s</td>\n", indent );
+
+	/* ILC: html_graph終了 */
+}
+
+
+/**
+ * 集計結果をHTMLで出力する
+ * @param FILE*   出力先
+ * @param REPORT* レポート全体の集計(詳細の行は行数順に並べ替える)
+ */
+void report_html (
+	FILE* fp,
+	REPORT* report
+)
+{
+	/**/
+	REPORT_FILE* file;
+	REPORT_FUNC* func;
+	long ix;
+	/**/
+	/* ILC: report_html開始 */
+
+	fputs( "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\" "
+	       "\"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">\n", fp );
+	fputs( "<html>\n", fp );
+	fputs( "  <head>\n", fp );
+	fputs( "    <meta http-equiv=\"Content-Type\" content=\"text/html; charset=UTF-8\">\n", fp );
+	fputs( "    <title>Coverage Report</title>\n", fp );
+	fputs( "    <style types=\"text/css\">\n", fp );
+	fputs( report_style, fp );
+	fputs( "    </style>\n", fp );
+	fputs( "  </head>\n", fp );
+	fputs( "  <body>\n", fp );
+	fputs( "    <h1>\n      Coverage Report\n    </h1>\n\n    <hr>\n\n", fp );
+
+	/* 全体の集計 */
+	fputs( "    <h2>\n      Summary\n    </h2>\n", fp );
+	fputs( "    <table>\n", fp );
+	fputs( "      <tr><th></th><th>Covered</th><th>Total</th><th>% Covered</th></tr>\n", fp );
+	fputs( "      <tr>\n", fp );
+	fputs( "        <td>All Files</td>\n", fp );
+	fprintf( fp, "        <td>%ld</td>\n", report->covered );
+	fprintf( fp, "        <td>%ld</td>\n", report->total );
+	html_graph( fp, "        ", report->covered, report->total );
+	fputs( "      </tr>\n", fp );
+	fputs( "    </table>\n\n    <br>\n    <hr>\n    <br>\n\n", fp );
+
+	/* ファイルごとの集計 */
+	fputs( "    <h2>\n      Files\n    </h2>\n", fp );
+	fputs( "    <table>\n", fp );
+	fputs( "      <tr>\n        <th>File</th>\n        <th>Covered</th>\n"
+	       "        <th>Total</th>\n        <th>% Covered</th>\n      </tr>\n", fp );
+	for ( file = report->file; file != NULL; file = file->next ) {
+		/* ILC: ファイルごと */
+		fputs( "      <tr>\n", fp );
+		fputs( "        <td><a href=\"#", fp );
+		html_puts( fp, file->name );
+		fputs( "\">", fp );
+		html_puts( fp, file->name );
+		fputs( "</a></td>\n", fp );
+		fprintf( fp, "        <td>%ld</td>\n", file->covered );
+		fprintf( fp, "        <td>%ld</td>\n", file->total );
+		html_graph( fp, "        ", file->covered, file->total );
+		fputs( "      </tr>\n", fp );
+	}
+	fputs( "    </table>\n\n    <br>\n    <hr>\n    <br>\n\n", fp );
+
+	/* 関数ごとの集計 */
+	fputs( "    <h2>\n      Functions By File\n    </h2>\n\n", fp );
+	for ( file = report->file; file != NULL; file = file->next ) {
+		/* ILC: ファイルごと */
+		fputs( "    <h3><a name=\"", fp );
+		html_puts( fp, file->name );
+		fputs( "\">", fp );
+		html_puts( fp, file->name );
+		fputs( "</a></h3>\n", fp );
+		fputs( "    <table>\n", fp );
+		fputs( "      <tr><th>Function</th><th>Covered</th><th>Total</th><th>% Covered</th></tr>\n", fp );
+		for ( func = file->func; func != NULL; func = func->next ) {
+			/* ILC: 関数ごと */
+			fputs( "      <tr>\n", fp );
+			fputs( "        <td><a href=\"#", fp );
+			html_puts( fp, func->name );
+			fputs( "\">", fp );
+			html_puts( fp, func->name );
+			fputs( "</a></td>\n", fp );
+			fprintf( fp, "        <td>%ld</td>\n", func->covered );
+			fprintf( fp, "        <td>%ld</td>\n", func->total );
+			html_graph( fp, "        ", func->covered, func->total );
+			fputs( "      </tr>\n", fp );
+		}
+		fputs( "    </table>\n    <br>\n\n", fp );
+	}
+	fputs( "    <br>\n    <hr>\n    <br>\n\n", fp );
+
+	/* 計測ポイントごとの詳細 */
+	fputs( "    <h2>\n      Function Details\n    </h2>\n\n", fp );
+	for ( file = report->file; file != NULL; file = file->next ) {
+		/* ILC: ファイルごと */
+		fputs( "    <h3>", fp );
+		html_puts( fp, file->name );
+		fputs( "</h3>\n", fp );
+		fputs( "    <table>\n", fp );
+		fputs( "      <tr><th>Function</th><th>Line</th><th>Result</th>", fp );
+		if ( report->has_count && report->sampling > 1 ) {
+			/* ILC: 通過回数は標本化による推定値 */
+			fprintf( fp, "<th>Hits (sampled 1/%ld, estimated)</th>", report->sampling );
+		}
+		else if ( report->has_count ) {
+			/* ILC: 通過回数 */
+			fputs( "<th>Hits</th>", fp );
+		}
+		fputs( "</tr>\n", fp );
+		for ( func = file->func; func != NULL; func = func->next ) {
+			/* ILC: 関数ごとに行数順で出力 */
+			qsort( func->lines, (size_t)func->total, sizeof(REPORT_LINE), report_line_cmp );
+			for ( ix = 0; ix < func->total; ix++ ) {
+				/* ILC: 計測ポイントごと */
+				fputs( "      <tr>\n", fp );
+				fputs( "        <td><a name=\"", fp );
+				html_puts( fp, func->name );
+				fputs( "\">", fp );
+				html_puts( fp, func->name );
+				fputs( "</a></td>\n", fp );
+				fprintf( fp, "        <td>%ld</td>\n", (func->lines)[ix].line );
+				if ( (func->lines)[ix].covered ) {
+					/* ILC: 通過済み */
+					fputs( "        <td class=\"Passed\">passed</td>\n", fp );
+				}
+				else {
+					/* ILC: 未通過 */
+					fputs( "        <td class=\"NotYet\">not</td>\n", fp );
+				}
+				if ( report->has_count && (func->lines)[ix].has_count ) {
+					/* ILC: 通過回数 */
+					fprintf( fp, "        <td>%llu</td>\n", (func->lines)[ix].count );
+				}
+				else if ( report->has_count ) {
+					/* ILC: 通過回数のない計測ポイント */
+					fputs( "        <td>-</td>\n", fp );
+				}
+				fputs( "      </tr>\n", fp );
+			}
+		}
+		fputs( "    </table>\n    <br>\n\n", fp );
+	}
+
+	fputs( "    <br>\n    <br>\n    <hr>\n", fp );
+	fputs( "    Copyright &copy; 2007-2008, 2017 tamura shingo\n", fp );
+	fputs( "    <br>\n  </body>\n</html>\n", fp );
+
+	/* ILC: report_html終了 */
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	REPORT report;
+	const char* out_file = NULL;
+	FILE* out;
+	int ret = 0;
+	int ch;
+	int ix;
+	/**/
+	/* ILC: main開始 */
+
+	memset( &report, 0, sizeof(REPORT) );
+	while ( (ch = getopt( argc, argv, "ho:s:" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'o':
+			/* ILC: 出力ファイル */
+			out_file = optarg;
+			break;
+		case 's':
+			/* ILC: 通過回数の標本化の間隔 */
+			report.sampling = atol( optarg );
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 1;
+		}
+	}
+	if ( optind >= argc ) {
+		/* ILC: データファイルの指定なし */
+		usage();
+		return 1;
+	}
+
+	for ( ix = optind; ix < argc && ret == 0; ix++ ) {
+		/* ILC: データファイルごとに集計 */
+		ret = report_load( &report, argv[ix] );
+	}
+
+	if ( ret == 0 ) {
+		/* ILC: 集計できたので出力する */
+		out = ( out_file != NULL ) ? fopen( out_file, "w" ) : stdout;
+		if ( out == NULL ) {
+			/* ILC: 出力ファイルのオープンに失敗 */
+			fprintf( stderr, "%s: ファイルを開けません。\n", out_file );
+			ret = -1;
+		}
+		else {
+			/* ILC: HTMLを出力 */
+			report_html( out, &report );
+			if ( fflush( out ) != 0 || ferror( out ) ) {
+				/* ILC: 書き込みエラー */
+				fprintf( stderr, "%s: 書き込みに失敗しました。\n", ( out_file != NULL ) ? out_file : "stdout" );
+				ret = -1;
+			}
+			if ( out != stdout ) {
+				/* ILC: 出力ファイルを閉じる */
+				fclose( out );
+			}
+		}
+	}
+
+	report_free( &report );
+
+	/* ILC: main終了 */
+	return ( ret == 0 ) ? 0 : 1;
+}
@@ -60,14 +60,54 @@
 
 
 /**
- * lexの入力元を設定する
+ * 字句解析器
+ * 解析中の状態をすべて保持するため、ファイルごとに作成すれば
+ * 複数のスレッドで同時に解析できる。
  */
-void set_lex_input ( FILE* );
+typedef void* LEX_SCANNER;
 
 /**
- * lexの出力先を設定する
+ * 字句解析器を作成する
+ * @param FILE* 入力元
+ * @param FILE* 出力先(NULLの場合は標準出力)
+ * @return LEX_SCANNER 作成した字句解析器
+ *                     NULL:メモリ確保エラー
  */
-void set_lex_output ( FILE* );
+LEX_SCANNER lex_create ( FILE*, FILE* );
+
+/**
+ * 字句解析器を破棄する
+ * @param LEX_SCANNER 字句解析器
+ */
+void lex_destroy ( LEX_SCANNER );
+
+/**
+ * 次の token を取得する
+ * @param LEX_SCANNER 字句解析器
+ * @return token(0:EOF)
+ */
+int lex_token ( LEX_SCANNER );
+
+/**
+ * 最後に取得した token の文字列を得る
+ * @param LEX_SCANNER 字句解析器
+ * @return token の文字列
+ */
+char* lex_text ( LEX_SCANNER );
+
+/**
+ * 最後に取得した token の文字列の長さを得る
+ * @param LEX_SCANNER 字句解析器
+ * @return token の文字列の長さ
+ */
+int lex_leng ( LEX_SCANNER );
+
+/**
+ * 現在の行番号を得る
+ * @param LEX_SCANNER 字句解析器
+ * @return 行番号
+ */
+int lex_lineno ( LEX_SCANNER );
 
 #endif	/* _SCAN_H_ */
 
@@ -0,0 +1,773 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	server.c
+ * @brief	変換サーバー(ilc --server)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#define _GNU_SOURCE		/* struct ucred */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "ilc.h"
+#include "util.h"
+#include "conv.h"
+#include "server.h"
+
+/*-
+ * ilc は1ファイル(または1回の起動)ごとに、プロセスの起動、カバレッジデータファイルの
+ * 読み込みと書き出しを行う。ilc --server はカバレッジデータ(計測ポイントの一覧)を
+ * メモリに置いたまま、Unixドメインソケットで受けた要求を順に変換するため、
+ * 1ファイルあたりの処理は解析だけになる。
+ * カバレッジデータファイルは、計測ポイントが追加されていれば SERVER_FLUSH_INTERVAL 秒ごとと
+ * FLUSH 要求時に ILC_Snapshot で書き出し、終了時に ILC_Finalize で書き出す。
+ *
+ * 要求は1つずつ処理する(CONV は作業ディレクトリに移動して変換し、元に戻る)。
+ * 接続には送受信のタイムアウト(SERVER_TIMEOUT 秒)を設定し、要求を送らずに
+ * 接続を保持しているクライアントが他の接続を待たせ続けないようにする。
+ * 1つの接続で多数の要求を受けている間も、定期的な書き出しは要求の合間に行う。
+ */
+
+/** 1要求の項目の最大数 */
+#define SERVER_FIELD_MAX 4
+
+/* 終了要求(シグナルハンドラ、QUIT 要求で設定する) */
+static volatile sig_atomic_t server_stop = 0;
+
+
+/**
+ * 終了要求のシグナルハンドラ
+ * @param int シグナル番号
+ */
+static void server_signal( int );
+
+/**
+ * ソケットを作成して待ち受ける
+ * 前回異常終了したサーバーのソケットが残っていれば、削除して作り直す。
+ * ソケットはサーバーのユーザーだけが接続できるモード(0600)で作成する。
+ * @param const char* ソケットのパス
+ * @return ソケットのディスクリプタ
+ *         -1:作成できない(すでにサーバーが動作している場合も含む)
+ */
+static int server_listen( const char* );
+
+/**
+ * 接続を受け付ける
+ * サーバーと異なるユーザーの接続は切断し、送受信のタイムアウトを設定する。
+ * @param int 待ち受けのディスクリプタ
+ * @return 接続のディスクリプタ
+ *         -1:受け付けなかった
+ */
+static int server_accept( int );
+
+/**
+ * 1つの接続の要求を処理する
+ * @param struct opt* 引数の解析結果
+ * @param int         接続のディスクリプタ(クローズする)
+ * @param int         サーバーの作業ディレクトリのディスクリプタ
+ * @param long*       前回書き出した時点の計測ポイントの数
+ * @param time_t*     次に書き出す時刻
+ * @return 0:接続の終了
+ *         1:サーバーの終了要求を受けた
+ */
+static int server_session( struct opt*, int, int, long*, time_t* );
+
+/**
+ * 変換の指定がサーバーの起動時の指定と同じか確認する(MODE 要求)
+ * @param struct opt* 引数の解析結果
+ * @param char*       作業ディレクトリ
+ * @param char*       カバレッジデータファイル名(空:確認しない)
+ * @param char*       変換の指定(i、n、r を並べた文字列)
+ * @return 0:同じ
+ *         SERVER_EMODE:異なる
+ */
+static int server_mode( struct opt*, char*, char*, char* );
+
+/**
+ * ファイルを変換する(CONV 要求)
+ * @param struct opt* 引数の解析結果
+ * @param int         サーバーの作業ディレクトリのディスクリプタ
+ * @param char*       作業ディレクトリ
+ * @param char*       変換元入力ファイル名
+ * @param char*       変換後出力ファイル名(空:自動設定)
+ * @return conv_file の戻り値
+ */
+static int server_conv( struct opt*, int, char*, char*, char* );
+
+/**
+ * メモリ上の内容を変換する(BUF 要求)
+ * @param struct opt* 引数の解析結果
+ * @param FILE*       接続(変換元の読み込み)
+ * @param char*       変換元入力ファイル名
+ * @param char*       変換元のバイト数
+ * @param char**      変換後の格納先
+ * @param size_t*     変換後のバイト数の格納先
+ * @return conv_buffer の戻り値
+ *         SERVER_EREQUEST:変換元を受け取れない
+ */
+static int server_buf( struct opt*, FILE*, char*, char*, char**, size_t* );
+
+/**
+ * 計測ポイントが追加されていれば、カバレッジデータファイルを書き出す
+ * @param long* 前回書き出した時点の計測ポイントの数
+ * @return 0:正常
+ *         SERVER_EFLUSH:書き出しに失敗
+ */
+static int server_flush( long* );
+
+/**
+ * 書き出す時刻になっていれば、カバレッジデータファイルを書き出す
+ * @param long*   前回書き出した時点の計測ポイントの数
+ * @param time_t* 次に書き出す時刻(書き出した場合は更新する)
+ */
+static void server_timer( long*, time_t* );
+
+
+/**
+ * 変換サーバーを実行する(ilc --server)
+ * 終了要求(QUIT)、または SIGINT/SIGTERM を受けるまで要求を処理する。
+ * @param struct opt* 引数の解析結果(server:ソケットのパス)
+ * @return  0:正常終了
+ *         -1:ソケットを作成できない
+ */
+int server_main (
+	struct opt* opt
+)
+{
+	/**/
+	struct sigaction sa;
+	char* cache_dir = opt->cache_dir;	/* 作業ディレクトリを移動しても使えるよう、絶対パスにする */
+	char* abs_dir = NULL;
+	long flushed;						/* 前回書き出した時点の計測ポイントの数 */
+	time_t next;						/* 次に書き出す時刻 */
+	int fd;
+	int home;
+	/**/
+	/* ILC: server_main開始 */
+
+	fd = server_listen( opt->server );
+	home = open( ".", O_RDONLY | O_DIRECTORY );
+	if ( fd < 0 || home < 0 ) {
+		/* ILC: 待ち受けできない */
+		fprintf( stderr, "%s: ソケットを作成できません。\n", opt->server );
+		if ( fd >= 0 ) {
+			/* ILC: 作成したソケットの削除 */
+			close( fd );
+			unlink( opt->server );
+		}
+		return -1;
+	}
+
+	if ( cache_dir != NULL && cache_dir[0] != '/' ) {
+		/**/
+		char cwd[FILENAME_MAX];
+		/**/
+		/* ILC: キャッシュディレクトリを絶対パスにする */
+		if ( getcwd( cwd, sizeof(cwd) ) != NULL
+			 && (abs_dir = (char*)xmalloc( strlen( cwd ) + 1 + strlen( cache_dir ) + 1 )) != NULL ) {
+			/* ILC: 作業ディレクトリからのパス */
+			sprintf( abs_dir, "%s/%s", cwd, cache_dir );
+			opt->cache_dir = abs_dir;
+		}
+	}
+
+	/* 終了要求のシグナル(システムコールを中断させる)、切断した接続への書き込みは無視する */
+	memset( &sa, 0, sizeof(sa) );
+	sigemptyset( &sa.sa_mask );
+	sa.sa_handler = server_signal;
+	sigaction( SIGINT, &sa, NULL );
+	sigaction( SIGTERM, &sa, NULL );
+	sa.sa_handler = SIG_IGN;
+	sigaction( SIGPIPE, &sa, NULL );
+
+	flushed = ILC_GetILCData()->num;
+	next = time( NULL ) + SERVER_FLUSH_INTERVAL;
+
+	while ( server_stop == 0 ) {
+		/**/
+		struct pollfd pfd;
+		time_t now = time( NULL );
+		int client;
+		/**/
+		/* ILC: 次の書き出し時刻まで接続を待つ */
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if ( poll( &pfd, 1, ( next > now ) ? (int)(next - now) * 1000 : 0 ) > 0
+			 && (client = server_accept( fd )) >= 0 ) {
+			/* ILC: 接続を受けた */
+			if ( server_session( opt, client, home, &flushed, &next ) != 0 ) {
+				/* ILC: 終了要求 */
+				server_stop = 1;
+			}
+		}
+
+		server_timer( &flushed, &next );
+	}
+
+	close( fd );
+	unlink( opt->server );
+	close( home );
+
+	opt->cache_dir = cache_dir;
+	xfree( abs_dir );
+
+	/* ILC: server_main終了 */
+	return 0;
+}
+
+
+/**
+ * 終了要求のシグナルハンドラ
+ * @param int シグナル番号
+ */
+static void server_signal (
+	int sig
+)
+{
+	/**/
+	/**/
+	/* ILC: server_signal開始 */
+
+	server_stop = 1;
+
+	/* ILC: server_signal終了 */
+}
+
+
+/**
+ * ソケットを作成して待ち受ける
+ * 前回異常終了したサーバーのソケットが残っていれば、削除して作り直す。
+ * @param const char* ソケットのパス
+ * @return ソケットのディスクリプタ
+ *         -1:作成できない(すでにサーバーが動作している場合も含む)
+ */
+static int server_listen (
+	const char* path
+)
+{
+	/**/
+	struct sockaddr_un addr;
+	mode_t mask;
+	int fd;
+	int ret;
+	/**/
+	/* ILC: server_listen開始 */
+
+	if ( strlen( path ) >= sizeof(addr.sun_path) ) {
+		/* ILC: パスが長すぎる */
+		return -1;
+	}
+
+	memset( &addr, 0, sizeof(addr) );
+	addr.sun_family = AF_UNIX;
+	strcpy( addr.sun_path, path );
+
+	fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if ( fd < 0 ) {
+		/* ILC: ソケットを作成できない */
+		return -1;
+	}
+
+	/* ソケットのファイルは bind で umask に従って作成されるため、その間だけ 0600 にする */
+	mask = umask( 0177 );
+	ret = bind( fd, (struct sockaddr*)&addr, sizeof(addr) );
+	if ( ret != 0 && errno == EADDRINUSE ) {
+		/**/
+		int test = socket( AF_UNIX, SOCK_STREAM, 0 );
+		/**/
+		/* ILC: 接続できなければ、前回のサーバーが残したソケットなので作り直す */
+		if ( test >= 0 && connect( test, (struct sockaddr*)&addr, sizeof(addr) ) != 0 && errno == ECONNREFUSED ) {
+			/* ILC: 動作しているサーバーはない */
+			unlink( path );
+			ret = bind( fd, (struct sockaddr*)&addr, sizeof(addr) );
+		}
+		if ( test >= 0 ) {
+			/* ILC: 確認用のソケットのクローズ */
+			close( test );
+		}
+	}
+	umask( mask );
+
+	if ( ret != 0 || listen( fd, SOMAXCONN ) != 0 ) {
+		/* ILC: 待ち受けできない */
+		if ( ret == 0 ) {
+			/* ILC: 作成したソケットの削除 */
+			unlink( path );
+		}
+		close( fd );
+		fd = -1;
+	}
+
+	/* ILC: server_listen終了 */
+	return fd;
+}
+
+
+/**
+ * 接続を受け付ける
+ * サーバーと異なるユーザーの接続は切断し、送受信のタイムアウトを設定する。
+ * タイムアウトした読み込み・書き込みはエラーになるため、接続の処理を終了する。
+ * @param int 待ち受けのディスクリプタ
+ * @return 接続のディスクリプタ
+ *         -1:受け付けなかった
+ */
+static int server_accept (
+	int listen_fd
+)
+{
+	/**/
+	struct timeval tv;
+	int fd;
+	/**/
+	/* ILC: server_accept開始 */
+
+	fd = accept( listen_fd, NULL, NULL );
+	if ( fd < 0 ) {
+		/* ILC: 受け付けられない */
+		return -1;
+	}
+
+#ifdef SO_PEERCRED
+	{
+		/**/
+		struct ucred cred;
+		socklen_t len = sizeof(cred);
+		/**/
+		/* ILC: 接続したプロセスのユーザーを確認する */
+		if ( getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &len ) != 0 || cred.uid != geteuid() ) {
+			/* ILC: サーバーと異なるユーザー */
+			fprintf( stderr, "他のユーザーからの接続を切断しました。\n" );
+			close( fd );
+			return -1;
+		}
+	}
+#endif
+
+	tv.tv_sec = SERVER_TIMEOUT;
+	tv.tv_usec = 0;
+	if ( setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) ) != 0
+		 || setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv) ) != 0 ) {
+		/* ILC: タイムアウトを設定できない接続は、他の接続を待たせるおそれがあるので切断する */
+		close( fd );
+		fd = -1;
+	}
+
+	/* ILC: server_accept終了 */
+	return fd;
+}
+
+
+/**
+ * 1つの接続の要求を処理する
+ * 要求はタブ区切りの1行。不正な要求を受けた場合は接続を終了する。
+ * @param struct opt* 引数の解析結果
+ * @param int         接続のディスクリプタ(クローズする)
+ * @param int         サーバーの作業ディレクトリのディスクリプタ
+ * @param long*       前回書き出した時点の計測ポイントの数
+ * @param time_t*     次に書き出す時刻
+ * @return 0:接続の終了
+ *         1:サーバーの終了要求を受けた
+ */
+static int server_session (
+	struct opt* opt,
+	int fd,
+	int home,
+	long* flushed,
+	time_t* next
+)
+{
+	/**/
+	FILE* in;
+	FILE* out;
+	char* line = NULL;
+	size_t size = 0;
+	ssize_t len;
+	int quit = 0;
+	int dup_fd;
+	/**/
+	/* ILC: server_session開始 */
+
+	dup_fd = dup( fd );
+	in  = ( dup_fd >= 0 ) ? fdopen( dup_fd, "r" ) : NULL;
+	out = fdopen( fd, "w" );
+	if ( in == NULL || out == NULL ) {
+		/* ILC: ストリームを作成できない */
+		if ( in != NULL ) {
+			/* ILC: 作成できたストリームのクローズ */
+			fclose( in );
+		}
+		else if ( dup_fd >= 0 ) {
+			/* ILC: 複製したディスクリプタのクローズ */
+			close( dup_fd );
+		}
+		if ( out != NULL ) {
+			/* ILC: 作成できたストリームのクローズ */
+			fclose( out );
+		}
+		else {
+			/* ILC: 接続のクローズ */
+			close( fd );
+		}
+		return 0;
+	}
+
+	while ( quit == 0 && server_stop == 0 && (len = getline( &line, &size, in )) > 0 ) {
+		/**/
+		char* field[SERVER_FIELD_MAX];
+		char* rest = line;
+		char* buf = NULL;
+		size_t buf_len = 0;
+		int num = 0;
+		int code;
+		/**/
+		/* ILC: 1要求ずつ処理する */
+		while ( len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r') ) {
+			/* ILC: 行末の改行を取り除く */
+			line[--len] = '\0';
+		}
+		while ( rest != NULL && num < SERVER_FIELD_MAX ) {
+			/* ILC: タブで区切る(空の項目も残す) */
+			field[num++] = strsep( &rest, "\t" );
+		}
+		if ( rest != NULL ) {
+			/* ILC: 項目が多すぎる */
+			num = 0;
+		}
+
+		if ( num == 4 && strcmp( field[0], SERVER_CONV ) == 0 ) {
+			/* ILC: ファイルの変換 */
+			code = server_conv( opt, home, field[1], field[2], field[3] );
+		}
+		else if ( num == 4 && strcmp( field[0], SERVER_MODE ) == 0 ) {
+			/* ILC: 変換の指定の確認 */
+			code = server_mode( opt, field[1], field[2], field[3] );
+		}
+		else if ( num == 3 && strcmp( field[0], SERVER_BUF ) == 0 ) {
+			/* ILC: メモリ上の内容の変換 */
+			code = server_buf( opt, in, field[1], field[2], &buf, &buf_len );
+		}
+		else if ( num == 1 && strcmp( field[0], SERVER_FLUSH ) == 0 ) {
+			/* ILC: カバレッジデータファイルの書き出し */
+			code = server_flush( flushed );
+		}
+		else if ( num == 1 && strcmp( field[0], SERVER_QUIT ) == 0 ) {
+			/* ILC: サーバーの終了(書き出しは終了時に行う) */
+			code = 0;
+			quit = 1;
+		}
+		else {
+			/* ILC: 不正な要求 */
+			code = SERVER_EREQUEST;
+		}
+
+		if ( code != 0 ) {
+			/* ILC: 失敗 */
+			fprintf( out, "%s\t%d\n", SERVER_NG, code );
+		}
+		else if ( strcmp( field[0], SERVER_BUF ) == 0 ) {
+			/* ILC: 変換後の内容を返す */
+			fprintf( out, "%s\t%lu\n", SERVER_OK, (unsigned long)buf_len );
+			fwrite( buf, 1, buf_len, out );
+		}
+		else {
+			/* ILC: 成功 */
+			fprintf( out, "%s\n", SERVER_OK );
+		}
+		free( buf );
+
+		if ( fflush( out ) != 0 || code == SERVER_EREQUEST ) {
+			/* ILC: 切断された、または不正な要求を受けたので接続を終了する */
+			break;
+		}
+
+		/* 要求が続く間も、定期的な書き出しを行う */
+		server_timer( flushed, next );
+	}
+
+	free( line );
+	fclose( in );
+	fclose( out );
+
+	/* ILC: server_session終了 */
+	return quit;
+}
+
+
+/**
+ * ファイルを変換する(CONV 要求)
+ * 要求元の作業ディレクトリに移動して変換し、サーバーの作業ディレクトリに戻る。
+ * @param struct opt* 引数の解析結果
+ * @param int         サーバーの作業ディレクトリのディスクリプタ
+ * @param char*       作業ディレクトリ
+ * @param char*       変換元入力ファイル名
+ * @param char*       変換後出力ファイル名(空:自動設定)
+ * @return conv_file の戻り値
+ */
+static int server_conv (
+	struct opt* opt,
+	int home,
+	char* dir,
+	char* in_file,
+	char* out_file
+)
+{
+	/**/
+	struct opt req = *opt;
+	int ret;
+	/**/
+	/* ILC: server_conv開始 */
+
+	req.out_file = ( out_file[0] != '\0' ) ? out_file : NULL;
+
+	if ( chdir( dir ) != 0 ) {
+		/* ILC: 作業ディレクトリに移動できない */
+		ret = 3;
+	}
+	else {
+		/* ILC: 変換する(エラーはサーバー側にも出力する) */
+		ret = conv_file( &req, in_file );
+		conv_report( in_file, ret );
+	}
+
+	if ( fchdir( home ) != 0 ) {
+		/* ILC: カバレッジデータファイルを書き出せなくなるため、サーバーを終了する */
+		fprintf( stderr, "作業ディレクトリに戻れないので終了します。\n" );
+		server_stop = 1;
+	}
+
+	/* ILC: server_conv終了 */
+	return ret;
+}
+
+
+/**
+ * 変換の指定がサーバーの起動時の指定と同じか確認する(MODE 要求)
+ * カバレッジデータファイルは、どちらも存在すれば同じファイルか(デバイスとiノード)、
+ * 存在しなければ絶対パスが同じかで判定する。
+ * @param struct opt* 引数の解析結果
+ * @param char*       作業ディレクトリ
+ * @param char*       カバレッジデータファイル名(空:確認しない)
+ * @param char*       変換の指定(i、n、r を並べた文字列)
+ * @return 0:同じ
+ *         SERVER_EMODE:異なる
+ */
+static int server_mode (
+	struct opt* opt,
+	char* dir,
+	char* file,
+	char* flags
+)
+{
+	/**/
+	struct stat req_st;
+	struct stat own_st;
+	const char* own = ILC_GetILCData()->filename;
+	char cwd[FILENAME_MAX];
+	char* req_path = NULL;
+	char* own_path = NULL;
+	int inline_mode = ( strchr( flags, 'r' ) != NULL ) ? 2 : ( strchr( flags, 'n' ) != NULL ) ? 1 : 0;
+	int ret = SERVER_EMODE;
+	/**/
+	/* ILC: server_mode開始 */
+
+	if ( ( strchr( flags, 'i' ) != NULL ) != ( opt->id_mode != 0 ) || inline_mode != opt->inline_mode ) {
+		/* ILC: -i、-n、-r の指定が異なる */
+		return ret;
+	}
+	if ( file[0] == '\0' ) {
+		/* ILC: カバレッジデータファイルは確認しない */
+		return 0;
+	}
+	if ( own == NULL || getcwd( cwd, sizeof(cwd) ) == NULL ) {
+		/* ILC: サーバーのカバレッジデータファイルがわからない */
+		return ret;
+	}
+
+	/* どちらも絶対パスにする(サーバーの作業ディレクトリは起動時のまま) */
+	req_path = (char*)xmalloc( strlen( dir ) + 1 + strlen( file ) + 1 );
+	own_path = (char*)xmalloc( strlen( cwd ) + 1 + strlen( own ) + 1 );
+	if ( req_path != NULL && own_path != NULL ) {
+		/* ILC: 相対パスは作業ディレクトリからのパス */
+		if ( file[0] == '/' ) {
+			/* ILC: 絶対パス */
+			strcpy( req_path, file );
+		}
+		else {
+			/* ILC: 要求元の作業ディレクトリからの相対パス */
+			sprintf( req_path, "%s/%s", dir, file );
+		}
+		if ( own[0] == '/' ) {
+			/* ILC: 絶対パス */
+			strcpy( own_path, own );
+		}
+		else {
+			/* ILC: サーバーの作業ディレクトリからの相対パス */
+			sprintf( own_path, "%s/%s", cwd, own );
+		}
+
+		if ( stat( req_path, &req_st ) == 0 && stat( own_path, &own_st ) == 0 ) {
+			/* ILC: どちらも存在するので、同じファイルか確認する */
+			ret = ( req_st.st_dev == own_st.st_dev && req_st.st_ino == own_st.st_ino ) ? 0 : SERVER_EMODE;
+		}
+		else {
+			/* ILC: まだ書き出していないので、パスで確認する */
+			ret = ( strcmp( req_path, own_path ) == 0 ) ? 0 : SERVER_EMODE;
+		}
+	}
+	xfree( req_path );
+	xfree( own_path );
+
+	/* ILC: server_mode終了 */
+	return ret;
+}
+
+
+/**
+ * メモリ上の内容を変換する(BUF 要求)
+ * @param struct opt* 引数の解析結果
+ * @param FILE*       接続(変換元の読み込み)
+ * @param char*       変換元入力ファイル名
+ * @param char*       変換元のバイト数
+ * @param char**      変換後の格納先
+ * @param size_t*     変換後のバイト数の格納先
+ * @return conv_buffer の戻り値
+ *         SERVER_EREQUEST:変換元を受け取れない
+ */
+static int server_buf (
+	struct opt* opt,
+	FILE* in,
+	char* in_file,
+	char* size,
+	char** out,
+	size_t* out_len
+)
+{
+	/**/
+	char* buf;
+	char* end;
+	unsigned long len;
+	int ret = SERVER_EREQUEST;
+	/**/
+	/* ILC: server_buf開始 */
+
+	errno = 0;
+	len = strtoul( size, &end, 10 );
+	if ( size[0] == '\0' || *end != '\0' || errno != 0 ) {
+		/* ILC: バイト数が数字でない */
+		return ret;
+	}
+
+	buf = (char*)xmalloc( (size_t)len + 1 );
+	if ( buf != NULL ) {
+		/* ILC: 変換元を受け取る */
+		if ( fread( buf, 1, (size_t)len, in ) == (size_t)len ) {
+			/* ILC: 受け取れたので変換する(エラーはサーバー側にも出力する) */
+			ret = conv_buffer( opt, in_file, buf, (size_t)len, out, out_len );
+			conv_report( in_file, ret );
+		}
+		xfree( buf );
+	}
+
+	/* ILC: server_buf終了 */
+	return ret;
+}
+
+
+/**
+ * 計測ポイントが追加されていれば、カバレッジデータファイルを書き出す
+ * 計測は行わないため、計測ポイントの数が変わらなければ内容も変わらない。
+ * @param long* 前回書き出した時点の計測ポイントの数
+ * @return 0:正常
+ *         SERVER_EFLUSH:書き出しに失敗
+ */
+static int server_flush (
+	long* flushed
+)
+{
+	/**/
+	long num = ILC_GetILCData()->num;
+	int ret = 0;
+	/**/
+	/* ILC: server_flush開始 */
+
+	if ( num != *flushed ) {
+		/* ILC: 計測ポイントが追加されている */
+		if ( ILC_Snapshot( NULL ) == ILC_SUCCESS ) {
+			/* ILC: 書き出した */
+			*flushed = num;
+		}
+		else {
+			/* ILC: 書き出しに失敗 */
+			fprintf( stderr, "カバレッジデータの書き出しに失敗しました。\n" );
+			ret = SERVER_EFLUSH;
+		}
+	}
+
+	/* ILC: server_flush終了 */
+	return ret;
+}
+
+
+/**
+ * 書き出す時刻になっていれば、カバレッジデータファイルを書き出す
+ * @param long*   前回書き出した時点の計測ポイントの数
+ * @param time_t* 次に書き出す時刻(書き出した場合は更新する)
+ */
+static void server_timer (
+	long* flushed,
+	time_t* next
+)
+{
+	/**/
+	/**/
+	/* ILC: server_timer開始 */
+
+	if ( time( NULL ) >= *next ) {
+		/* ILC: 定期的な書き出し */
+		server_flush( flushed );
+		*next = time( NULL ) + SERVER_FLUSH_INTERVAL;
+	}
+
+	/* ILC: server_timer終了 */
+}
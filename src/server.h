@@ -0,0 +1,124 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	server.h
+ * @brief	変換サーバー(ilc --server)と ilc-client の間のプロトコル
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include "options.h"
+
+/*-
+ * プロトコル
+ * Unixドメインソケットで接続し、1行1要求(項目はタブ区切り)を送る。
+ * 1回の接続で複数の要求を送ることができ、サーバーは要求ごとに順に応答する。
+ *
+ * CONV <作業ディレクトリ> <入力ファイル名> <出力ファイル名(空:自動設定)>
+ *      入力ファイルを変換する。ファイル名は作業ディレクトリからの相対パスでもよい
+ *      (計測ポイントの名前には、入力ファイル名をそのまま使用する)。
+ *      => OK
+ * BUF <入力ファイル名> <バイト数>
+ *      要求に続けて送ったバイト数分の内容を変換する。
+ *      => OK <バイト数>  (続けて変換後の内容)
+ * MODE <作業ディレクトリ> <カバレッジデータファイル名(空:確認しない)> <変換の指定>
+ *      ilc-client の指定がサーバーの起動時の指定と同じか確認する。
+ *      変換の指定は i(-i)、n(-n)、r(-r) を並べた文字列(いずれもなければ空)。
+ *      カバレッジデータファイル名は作業ディレクトリからの相対パスでもよい。
+ *      => OK  (異なる場合は NG SERVER_EMODE)
+ * FLUSH
+ *      カバレッジデータファイルを書き出す。
+ *      => OK
+ * QUIT
+ *      カバレッジデータファイルを書き出して、サーバーを終了する。
+ *      => OK
+ *
+ * 失敗した場合は NG <エラーコード> を返す。エラーコードは conv_file の戻り値、
+ * または SERVER_EREQUEST(不正な要求。接続を切断する)。
+ *
+ * ソケットはサーバーのユーザーだけが読み書きできるモード(0600)で作成し、
+ * 他のユーザーからの接続は受け付けない。
+ * 要求の受信中と、応答後に次の要求を待つ間、SERVER_TIMEOUT 秒以上
+ * 送受信のない接続は切断する(他の接続と定期的な書き出しを待たせないため)。
+ */
+
+/** ソケットのパスを指定する環境変数(ilc-client) */
+#define SERVER_ENV "ILC_SERVER"
+
+/** 要求:ファイルの変換 */
+#define SERVER_CONV "CONV"
+
+/** 要求:メモリ上の内容の変換 */
+#define SERVER_BUF "BUF"
+
+/** 要求:変換の指定の確認 */
+#define SERVER_MODE "MODE"
+
+/** 要求:カバレッジデータファイルの書き出し */
+#define SERVER_FLUSH "FLUSH"
+
+/** 要求:サーバーの終了 */
+#define SERVER_QUIT "QUIT"
+
+/** 応答:成功 */
+#define SERVER_OK "OK"
+
+/** 応答:失敗 */
+#define SERVER_NG "NG"
+
+/** エラーコード:不正な要求 */
+#define SERVER_EREQUEST 9
+
+/** エラーコード:カバレッジデータファイルの書き出しエラー */
+#define SERVER_EFLUSH 8
+
+/** エラーコード:変換の指定がサーバーの起動時の指定と異なる */
+#define SERVER_EMODE 7
+
+/** 計測ポイントが追加された場合に、カバレッジデータファイルを書き出す間隔(秒) */
+#define SERVER_FLUSH_INTERVAL 30
+
+/** 送受信のない接続を切断するまでの時間(秒) */
+#define SERVER_TIMEOUT 10
+
+/**
+ * 変換サーバーを実行する(ilc --server)
+ * 終了要求(QUIT)、または SIGINT/SIGTERM を受けるまで要求を処理する。
+ * カバレッジデータは ILC_Initialize 済みであること。終了時の書き出しは呼び出し側で行う。
+ * @param struct opt* 引数の解析結果(server:ソケットのパス)
+ * @return  0:正常終了
+ *         -1:ソケットを作成できない
+ */
+int server_main ( struct opt* );
+
+#endif /* _SERVER_H_ */
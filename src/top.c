@@ -0,0 +1,443 @@
+/*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file	top.c
+ * @brief	ILC_MODE_SHM で計測中のプロセスのカバレッジを、ファイルごとに表示し続ける(ilc-top)
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ilc_local.h"
+
+/*-
+ * 計測中のプロセスが作成した共有メモリ(ILC_SHM_HEADER)を読み取り専用で
+ * マップし、一定間隔で通過フラグと通過回数の列を読むだけで集計する。
+ * 計測中のプロセスへの通知やロックは行わないため、計測への影響はない。
+ *
+ * ファイルごとに、計測ポイント数・通過済みの数・前回の表示からの通過回数
+ * (1秒あたり)を表示する。計測中のプロセスが終了したら、最後の結果を
+ * 表示して終了する。
+ */
+
+/**
+ * マップした共有メモリの各列
+ */
+typedef struct _top_shm {
+	const ILC_SHM_HEADER*		header;		/**< ヘッダ */
+	size_t						size;		/**< マップしたサイズ */
+	long						num;		/**< 計測ポイントの数 */
+	const char**				strings;	/**< 文字列表(IDの順) */
+	long						str_num;	/**< 文字列の数 */
+	const unsigned long long*	count;		/**< 通過回数の列(NULL:なし) */
+	const unsigned int*			file_id;	/**< ファイル名のIDの列 */
+	const unsigned char*		flag;		/**< フラグの列 */
+}
+TOP_SHM;
+
+/**
+ * ファイルごとの集計
+ */
+typedef struct _top_file {
+	long				total;		/**< 計測ポイント数 */
+	long				covered;	/**< 通過済みの計測ポイント数 */
+	unsigned long long	hits;		/**< 通過回数の合計 */
+	unsigned long long	prev;		/**< 前回の表示時の通過回数の合計 */
+}
+TOP_FILE;
+
+/** 端末に表示する場合の画面のクリア */
+#define TOP_CLEAR "\033[H\033[J"
+
+
+void usage ()
+{
+  /* ILC: begin usage() */
+  fputs("usage: ilc-top [options] name|pid\n", stdout);
+  fputs("  Options are as follows:\n", stdout);
+  fputs("  -d seconds   refresh interval (default: 1)\n", stdout);
+  fputs("  -h           display this help\n", stdout);
+  fputs("  -n count     exit after count refreshes (default: until the process exits)\n", stdout);
+  fputs("  name|pid     shared memory name (ILC_SHM), or the pid of a process run with ILC_MODE_SHM\n", stdout);
+
+  /* ILC: end usage() */
+}
+
+
+/**
+ * 共有メモリを読み取り専用でマップし、各列の位置を求める
+ * @param const char* 共有メモリ名
+ * @param TOP_SHM*    マップした共有メモリ
+ * @return  0:正常終了
+ *         -1:共有メモリがない、または形式が正しくない
+ */
+int top_open (
+	const char* name,
+	TOP_SHM* shm		/* OUT */
+)
+{
+	/**/
+	struct stat st;
+	const ILC_SHM_HEADER* header;
+	const char* ptr;
+	const char* end;
+	void* map = MAP_FAILED;
+	long ix;
+	int fd;
+	/**/
+	/* ILC: top_open開始 */
+
+	memset( shm, 0, sizeof(TOP_SHM) );
+
+	fd = shm_open( name, O_RDONLY, 0 );
+	if ( fd >= 0 ) {
+		/* ILC: 共有メモリ全体を読み取り専用でマップする */
+		if ( fstat( fd, &st ) == 0 && (size_t)st.st_size >= sizeof(ILC_SHM_HEADER) ) {
+			/* ILC: ヘッダ以上のサイズがある */
+			map = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+		}
+		close( fd );
+	}
+	if ( map == MAP_FAILED ) {
+		/* ILC: 共有メモリがない */
+		return -1;
+	}
+
+	header = (const ILC_SHM_HEADER*)map;
+	shm->header = header;
+	shm->size = (size_t)st.st_size;
+	if ( memcmp( header->magic, ILC_SHM_MAGIC, sizeof(header->magic) ) != 0 ||
+		 header->endian != ILC_DAT_ENDIAN || header->size != (long long)st.st_size ||
+		 header->num < 0 || header->str_num < 0 || header->str_size < 0 ||
+		 header->size != (long long)sizeof(ILC_SHM_HEADER) + header->str_size
+		 + ( (header->flags & ILC_DAT_HAS_COUNT) != 0 ? (long long)sizeof(unsigned long long) * header->num : 0 )
+		 + (long long)(sizeof(unsigned int) * 2 + sizeof(int) + 1) * header->num ) {
+		/* ILC: 作成途中、または形式が正しくない */
+		munmap( map, shm->size );
+		return -1;
+	}
+	__atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+	shm->num = (long)header->num;
+	shm->str_num = (long)header->str_num;
+	shm->strings = (const char**)malloc( sizeof(char*) * ((size_t)shm->str_num + 1) );
+	if ( shm->strings == NULL ) {
+		/* ILC: メモリ確保エラー */
+		munmap( map, shm->size );
+		return -1;
+	}
+
+	ptr = (const char*)(header + 1);
+	end = ptr + header->str_size;
+	for ( ix = 0; ix < shm->str_num; ix++ ) {
+		/* ILC: 文字列表を分割する */
+		(shm->strings)[ix] = ( ptr < end ) ? ptr : "";
+		ptr += strnlen( ptr, (size_t)(end - ptr) ) + 1;
+	}
+
+	ptr = end;
+	if ( (header->flags & ILC_DAT_HAS_COUNT) != 0 ) {
+		/* ILC: 通過回数の列あり */
+		shm->count = (const unsigned long long*)ptr;
+		ptr += sizeof(unsigned long long) * (size_t)shm->num;
+	}
+	shm->file_id = (const unsigned int*)ptr;
+	ptr += (sizeof(unsigned int) * 2 + sizeof(int)) * (size_t)shm->num;
+	shm->flag = (const unsigned char*)ptr;
+
+	/* ILC: top_open終了 */
+	return 0;
+}
+
+
+/**
+ * 共有メモリのマップを解除する
+ * @param TOP_SHM* マップした共有メモリ
+ */
+void top_close (
+	TOP_SHM* shm
+)
+{
+	/**/
+	/**/
+	/* ILC: top_close開始 */
+
+	free( (void*)shm->strings );
+	munmap( (void*)shm->header, shm->size );
+	memset( shm, 0, sizeof(TOP_SHM) );
+
+	/* ILC: top_close終了 */
+}
+
+
+/**
+ * 通過フラグと通過回数の列を読み、ファイルごとに集計する
+ * 計測中のプロセスが書き込んでいる最中の値を読むため、通過回数は
+ * 1つずつ不可分に読み込む。
+ * @param const TOP_SHM* マップした共有メモリ
+ * @param TOP_FILE*      ファイルごとの集計(文字列のIDが添字、str_num個)
+ */
+void top_collect (
+	const TOP_SHM* shm,
+	TOP_FILE* file
+)
+{
+	/**/
+	long ix;
+	/**/
+	/* ILC: top_collect開始 */
+
+	for ( ix = 0; ix < shm->str_num; ix++ ) {
+		/* ILC: 前回の通過回数を残してクリアする */
+		file[ix].prev = file[ix].hits;
+		file[ix].total = 0;
+		file[ix].covered = 0;
+		file[ix].hits = 0;
+	}
+
+	for ( ix = 0; ix < shm->num; ix++ ) {
+		/**/
+		TOP_FILE* ptr;
+		unsigned long long count = 0;
+		/**/
+		/* ILC: 計測ポイントごとに集計 */
+		if ( (shm->file_id)[ix] >= (unsigned int)shm->str_num ) {
+			/* ILC: 形式が正しくない */
+			continue;
+		}
+		ptr = &file[ (shm->file_id)[ix] ];
+		if ( shm->count != NULL ) {
+			/* ILC: 通過回数 */
+			count = __atomic_load_n( &(shm->count)[ix], __ATOMIC_RELAXED );
+		}
+		ptr->total++;
+		if ( __atomic_load_n( &(shm->flag)[ix], __ATOMIC_RELAXED ) != 0 || count != 0 ) {
+			/* ILC: 通過済み */
+			ptr->covered++;
+		}
+		ptr->hits += count;
+	}
+
+	/* ILC: top_collect終了 */
+}
+
+
+/**
+ * ファイルごとの集計を表示する
+ * @param const char*     共有メモリ名
+ * @param const TOP_SHM*  マップした共有メモリ
+ * @param const TOP_FILE* ファイルごとの集計
+ * @param double          前回の表示からの秒数(0の場合は通過回数/秒を表示しない)
+ * @param int             0以外:計測中のプロセスは終了している
+ */
+void top_print (
+	const char* name,
+	const TOP_SHM* shm,
+	const TOP_FILE* file,
+	double elapsed,
+	int ended
+)
+{
+	/**/
+	TOP_FILE total;
+	char stamp[32];
+	time_t now = time( NULL );
+	long ix;
+	/**/
+	/* ILC: top_print開始 */
+
+	memset( &total, 0, sizeof(total) );
+	strftime( stamp, sizeof(stamp), "%H:%M:%S", localtime( &now ) );
+
+	if ( isatty( fileno( stdout ) ) ) {
+		/* ILC: 端末は画面を書き換える */
+		fputs( TOP_CLEAR, stdout );
+	}
+	printf( "ilc-top: %s (pid %lld%s)  %s", name, shm->header->pid, ended ? ", exited" : "", stamp );
+	if ( shm->count != NULL && shm->header->sampling > 1 ) {
+		/* ILC: 通過回数は標本化による推定値 */
+		printf( "  hits sampled 1/%lld", shm->header->sampling );
+	}
+	printf( "\n\n" );
+	printf( "%8s %12s %17s  %s\n", "coverage", "hits/s", "points", "file" );
+
+	for ( ix = 0; ix < shm->str_num; ix++ ) {
+		/* ILC: 計測ポイントのあるファイルのみ */
+		if ( file[ix].total == 0 ) {
+			/* ILC: 関数名、または計測ポイントのないファイル */
+			continue;
+		}
+		total.total += file[ix].total;
+		total.covered += file[ix].covered;
+		total.hits += file[ix].hits;
+		total.prev += file[ix].prev;
+
+		printf( "%7.1f%% ", 100.0 * (double)file[ix].covered / (double)file[ix].total );
+		if ( shm->count != NULL && elapsed > 0 ) {
+			/* ILC: 通過回数/秒 */
+			printf( "%12.0f ", (double)(file[ix].hits - file[ix].prev) / elapsed );
+		}
+		else {
+			/* ILC: 通過回数なし、または初回 */
+			printf( "%12s ", "-" );
+		}
+		printf( "%8ld/%-8ld  %s\n", file[ix].covered, file[ix].total, (shm->strings)[ix] );
+	}
+
+	printf( "%7.1f%% ", ( total.total > 0 ) ? 100.0 * (double)total.covered / (double)total.total : 0.0 );
+	if ( shm->count != NULL && elapsed > 0 ) {
+		/* ILC: 通過回数/秒 */
+		printf( "%12.0f ", (double)(total.hits - total.prev) / elapsed );
+	}
+	else {
+		/* ILC: 通過回数なし、または初回 */
+		printf( "%12s ", "-" );
+	}
+	printf( "%8ld/%-8ld  %s\n", total.covered, total.total, "total" );
+	fflush( stdout );
+
+	/* ILC: top_print終了 */
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	TOP_SHM shm;
+	TOP_FILE* file;
+	char* name;
+	const char* arg;
+	double interval = 1.0;
+	double elapsed = 0.0;
+	struct timespec ts;
+	long count = 0;
+	long ix;
+	int ended = 0;
+	int ch;
+	/**/
+	/* ILC: main開始 */
+
+	while ( (ch = getopt( argc, argv, "d:hn:" )) != -1 ) {
+		/* ILC: オプションの解析 */
+		switch ( ch ) {
+		case 'd':
+			/* ILC: 表示間隔 */
+			interval = atof( optarg );
+			if ( interval <= 0 ) {
+				/* ILC: 正の数のみ */
+				fprintf( stderr, "-d には正の数を指定してください。\n" );
+				return 1;
+			}
+			break;
+		case 'n':
+			/* ILC: 表示回数 */
+			count = atol( optarg );
+			break;
+		case 'h':
+		default:
+			/* ILC: ヘルプ */
+			usage();
+			return ( ch == 'h' ) ? 0 : 1;
+		}
+	}
+	if ( argc - optind != 1 ) {
+		/* ILC: 共有メモリ名は1つ */
+		usage();
+		return 1;
+	}
+
+	/* 数字のみの場合はプロセスIDとして、"/ilc.プロセスID" を参照する */
+	arg = argv[optind];
+	name = (char*)malloc( strlen( arg ) + sizeof(ILC_SHM_PREFIX) + 1 );
+	if ( name == NULL ) {
+		/* ILC: メモリ確保エラー */
+		fprintf( stderr, "メモリが確保できません。\n" );
+		return 1;
+	}
+	if ( strspn( arg, "0123456789" ) == strlen( arg ) ) {
+		/* ILC: プロセスID */
+		sprintf( name, ILC_SHM_PREFIX "%s", arg );
+	}
+	else {
+		/* ILC: 共有メモリ名(先頭の '/' は省略できる) */
+		sprintf( name, "%s%s", ( arg[0] == '/' ) ? "" : "/", arg );
+	}
+
+	if ( top_open( name, &shm ) != 0 ) {
+		/* ILC: 共有メモリがない */
+		fprintf( stderr, "%s: 共有メモリを参照できません(ILC_MODE_SHM で計測中か確認してください)。\n", name );
+		free( name );
+		return 1;
+	}
+
+	file = (TOP_FILE*)calloc( (size_t)shm.str_num + 1, sizeof(TOP_FILE) );
+	if ( file == NULL ) {
+		/* ILC: メモリ確保エラー */
+		fprintf( stderr, "メモリが確保できません。\n" );
+		top_close( &shm );
+		free( name );
+		return 1;
+	}
+
+	for ( ix = 1; ; ix++ ) {
+		/* ILC: 計測中のプロセスが終了するか、指定回数表示するまで繰り返す */
+		ended = ( kill( (pid_t)shm.header->pid, 0 ) != 0 && errno == ESRCH );
+		top_collect( &shm, file );
+		top_print( name, &shm, file, elapsed, ended );
+		if ( ended || ix == count ) {
+			/* ILC: 終了 */
+			break;
+		}
+
+		ts.tv_sec = (time_t)interval;
+		ts.tv_nsec = (long)((interval - (double)ts.tv_sec) * 1e9);
+		nanosleep( &ts, NULL );
+		elapsed = interval;
+	}
+
+	free( file );
+	top_close( &shm );
+	free( name );
+
+	/* ILC: main終了 */
+	return 0;
+}
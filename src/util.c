@@ -34,13 +34,47 @@
  *
  */
 
+#define _GNU_SOURCE		/* memmem, copy_file_range */
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 #include "util.h"
 
 /** RCSID */
 static const char rcsid[] ="$Id: util.c,v 1.2 2008/05/25 13:22:49 shingo Exp $";
 
+/** fd_copy で read/write する場合のバッファサイズ */
+#define COPY_BUFSIZ (64 * 1024)
+
+/**
+ * カーネル内でファイルの内容を複写する
+ * @param int 複写元ファイルディスクリプタ(現在の位置から)
+ * @param int 複写先ファイルディスクリプタ(現在の位置へ)
+ * @param off_t 複写するバイト数
+ * @return  0:正常終了
+ *         -1:この方法では複写できない(何も複写していない)
+ *         -2:書き込みエラー
+ */
+static int fd_copy_kernel( int, int, off_t );
+
+/**
+ * 2つのファイルの内容が同じかを調べる
+ * @param int ファイルディスクリプタ
+ * @param int ファイルディスクリプタ
+ * @return  1:同じ
+ *          0:異なる、または調べられない
+ */
+static int fd_same( int, int );
+
 /**
  * SLISTを作成する
  * @return SLIST* 作成したSLIST
@@ -202,3 +236,347 @@ void xfree (
 	/* ILC: xfree終了 */
 }
 
+
+
+/**
+ * ファイルに指定した文字列が含まれるかを調べる
+ * ファイルをマップして一括で検索する。ファイルの位置は変更しない。
+ * @param int         ファイルディスクリプタ
+ * @param const char* 検索する文字列
+ * @return  1:含まれる
+ *          0:含まれない
+ *         -1:調べられない(通常のファイルでない、マップできない)
+ */
+int fd_contains (
+	int fd,
+	const char* str
+)
+{
+	/**/
+	struct stat st;
+	void* ptr;
+	int ret = -1;
+	/**/
+	/* ILC: fd_contains開始 */
+
+	if ( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) ) {
+		/* ILC: 通常のファイル */
+		if ( st.st_size == 0 ) {
+			/* ILC: 空のファイル(マップできない) */
+			ret = 0;
+		}
+		else if ( (ptr = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 )) != MAP_FAILED ) {
+			/* ILC: マップしたファイル全体を検索する */
+			ret = ( memmem( ptr, (size_t)st.st_size, str, strlen( str ) ) != NULL ) ? 1 : 0;
+			munmap( ptr, (size_t)st.st_size );
+		}
+	}
+
+	/* ILC: fd_contains終了 */
+	return ret;
+}
+
+
+/**
+ * ファイルの内容を複写する
+ * 可能であればカーネル内で複写し(copy_file_range、sendfile)、
+ * できない場合は read/write で複写する。
+ * @param int 複写元ファイルディスクリプタ(現在の位置から)
+ * @param int 複写先ファイルディスクリプタ(現在の位置へ)
+ * @return  0:正常終了
+ *         -1:読み込みエラー、または書き込みエラー
+ */
+int fd_copy (
+	int in,
+	int out
+)
+{
+	/**/
+	struct stat st;
+	char* buf;
+	ssize_t len;
+	int ret;
+	/**/
+	/* ILC: fd_copy開始 */
+
+	ret = ( fstat( in, &st ) == 0 && S_ISREG( st.st_mode ) ) ? fd_copy_kernel( in, out, st.st_size ) : -1;
+
+	if ( ret == -1 ) {
+		/* ILC: カーネル内で複写できないので read/write で複写する */
+		ret = 0;
+		buf = (char*)malloc( COPY_BUFSIZ );
+		if ( buf == NULL ) {
+			/* ILC: メモリ確保エラー */
+			ret = -1;
+		}
+		while ( ret == 0 && (len = read( in, buf, COPY_BUFSIZ )) != 0 ) {
+			/* ILC: EOFまで複写する */
+			if ( len < 0 ) {
+				/* ILC: 読み込みエラー */
+				if ( errno != EINTR ) {
+					ret = -1;
+				}
+			}
+			else if ( write( out, buf, (size_t)len ) != len ) {
+				/* ILC: 書き込みエラー */
+				ret = -1;
+			}
+		}
+		free( buf );
+	}
+	else if ( ret == -2 ) {
+		/* ILC: 途中までカーネル内で複写したが失敗 */
+		ret = -1;
+	}
+
+	/* ILC: fd_copy終了 */
+	return ret;
+}
+
+
+/**
+ * メモリの内容のハッシュ値を求める(FNV-1a 64bit)
+ * 前回の結果を初期値に渡すと、続けてハッシュ値を求められる。
+ * @param const void*         対象のメモリ
+ * @param size_t              バイト数
+ * @param unsigned long long  初期値(HASH_INIT、または前回の結果)
+ * @return unsigned long long ハッシュ値
+ */
+unsigned long long mem_hash (
+	const void* ptr,
+	size_t size,
+	unsigned long long hash
+)
+{
+	/**/
+	const unsigned char* p = (const unsigned char*)ptr;
+	const unsigned char* end = p + size;
+	/**/
+	/* ILC: mem_hash開始 */
+
+	for ( ; p < end; p++ ) {
+		/* ILC: 1バイトずつ混ぜる */
+		hash = ( hash ^ *p ) * 0x100000001b3ULL;
+	}
+
+	/* ILC: mem_hash終了 */
+	return hash;
+}
+
+
+/**
+ * ファイルの内容のハッシュ値を求める(FNV-1a 64bit)
+ * ファイルをマップして一括で求める。ファイルの位置は変更しない。
+ * @param int                 ファイルディスクリプタ
+ * @param unsigned long long* ハッシュ値(入力:初期値 出力:ハッシュ値)
+ * @return  0:正常終了
+ *         -1:求められない(通常のファイルでない、マップできない)
+ */
+int fd_hash (
+	int fd,
+	unsigned long long* hash
+)
+{
+	/**/
+	struct stat st;
+	void* ptr;
+	int ret = -1;
+	/**/
+	/* ILC: fd_hash開始 */
+
+	if ( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) ) {
+		/* ILC: 通常のファイル */
+		if ( st.st_size == 0 ) {
+			/* ILC: 空のファイル(マップできない) */
+			ret = 0;
+		}
+		else if ( (ptr = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 )) != MAP_FAILED ) {
+			/* ILC: マップしたファイル全体から求める */
+			*hash = mem_hash( ptr, (size_t)st.st_size, *hash );
+			munmap( ptr, (size_t)st.st_size );
+			ret = 0;
+		}
+	}
+
+	/* ILC: fd_hash終了 */
+	return ret;
+}
+
+
+/**
+ * 一時ファイルでファイルを置き換える
+ * 内容が同じ場合は置き換えずに一時ファイルを削除するため、ファイルの更新時刻は変わらない。
+ * @param const char* 一時ファイル名(同じディレクトリにあること)
+ * @param const char* 置き換えるファイル名
+ * @return  0:置き換えた
+ *          1:内容が同じなので置き換えなかった
+ *         -1:置き換えられない(一時ファイルは削除する)
+ */
+int file_update (
+	const char* tmp,
+	const char* path
+)
+{
+	/**/
+	int fd_tmp;
+	int fd_path;
+	int ret = 0;
+	/**/
+	/* ILC: file_update開始 */
+
+	fd_tmp  = open( tmp, O_RDONLY );
+	fd_path = open( path, O_RDONLY );
+	if ( fd_tmp >= 0 && fd_path >= 0 ) {
+		/* ILC: 置き換えるファイルがあれば内容を比べる */
+		ret = fd_same( fd_tmp, fd_path );
+	}
+	if ( fd_tmp >= 0 ) {
+		/* ILC: 一時ファイルのクローズ */
+		close( fd_tmp );
+	}
+	if ( fd_path >= 0 ) {
+		/* ILC: 置き換えるファイルのクローズ */
+		close( fd_path );
+	}
+
+	if ( ret == 1 ) {
+		/* ILC: 内容が同じなので一時ファイルを削除する */
+		unlink( tmp );
+	}
+	else if ( rename( tmp, path ) != 0 ) {
+		/* ILC: 置き換えに失敗 */
+		unlink( tmp );
+		ret = -1;
+	}
+
+	/* ILC: file_update終了 */
+	return ret;
+}
+
+
+/**
+ * 2つのファイルの内容が同じかを調べる
+ * 大きさが同じ場合のみ、両方のファイルをマップして比べる。
+ * @param int ファイルディスクリプタ
+ * @param int ファイルディスクリプタ
+ * @return  1:同じ
+ *          0:異なる、または調べられない
+ */
+static int fd_same (
+	int fd1,
+	int fd2
+)
+{
+	/**/
+	struct stat st1;
+	struct stat st2;
+	void* ptr1;
+	void* ptr2;
+	int ret = 0;
+	/**/
+	/* ILC: fd_same開始 */
+
+	if ( fstat( fd1, &st1 ) == 0 && fstat( fd2, &st2 ) == 0
+		 && S_ISREG( st1.st_mode ) && S_ISREG( st2.st_mode ) && st1.st_size == st2.st_size ) {
+		/* ILC: 通常のファイルで大きさが同じ */
+		if ( st1.st_size == 0 ) {
+			/* ILC: 空のファイル(マップできない) */
+			ret = 1;
+		}
+		else if ( (ptr1 = mmap( NULL, (size_t)st1.st_size, PROT_READ, MAP_PRIVATE, fd1, 0 )) != MAP_FAILED ) {
+			/* ILC: 一方をマップできた */
+			if ( (ptr2 = mmap( NULL, (size_t)st2.st_size, PROT_READ, MAP_PRIVATE, fd2, 0 )) != MAP_FAILED ) {
+				/* ILC: 両方をマップできたので比べる */
+				ret = ( memcmp( ptr1, ptr2, (size_t)st1.st_size ) == 0 ) ? 1 : 0;
+				munmap( ptr2, (size_t)st2.st_size );
+			}
+			munmap( ptr1, (size_t)st1.st_size );
+		}
+	}
+
+	/* ILC: fd_same終了 */
+	return ret;
+}
+
+
+#if defined(__linux__)
+/**
+ * カーネル内でファイルの内容を複写する(Linux)
+ * copy_file_range を使用し(対応するファイルシステムではreflinkになる)、
+ * 使用できない場合は sendfile を使用する。
+ * @param int 複写元ファイルディスクリプタ(現在の位置から)
+ * @param int 複写先ファイルディスクリプタ(現在の位置へ)
+ * @param off_t 複写するバイト数
+ * @return  0:正常終了
+ *         -1:この方法では複写できない(何も複写していない)
+ *         -2:書き込みエラー
+ */
+static int fd_copy_kernel (
+	int in,
+	int out,
+	off_t size
+)
+{
+	/**/
+	off_t done = 0;			/* 複写済みのバイト数 */
+	ssize_t len = 0;
+	int use_sendfile = 0;	/* 0:copy_file_range 1:sendfile */
+	/**/
+	/* ILC: fd_copy_kernel開始 */
+
+	while ( done < size ) {
+		/* ILC: 複写が終わるまで繰り返す */
+		if ( use_sendfile == 0 ) {
+			/* ILC: copy_file_range */
+			len = copy_file_range( in, NULL, out, NULL, (size_t)(size - done), 0 );
+		}
+		else {
+			/* ILC: sendfile */
+			len = sendfile( out, in, NULL, (size_t)(size - done) );
+		}
+
+		if ( len > 0 ) {
+			/* ILC: 複写できた */
+			done += len;
+		}
+		else if ( len == 0 ) {
+			/* ILC: ファイルが途中で短くなった */
+			break;
+		}
+		else if ( errno == EINTR ) {
+			/* ILC: 再試行 */
+		}
+		else if ( done == 0 && use_sendfile == 0 ) {
+			/* ILC: copy_file_range が使えない(古いカーネル、異なるファイルシステムなど) */
+			use_sendfile = 1;
+		}
+		else {
+			/* ILC: sendfile も使えない、または途中で失敗 */
+			break;
+		}
+	}
+
+	/* ILC: fd_copy_kernel終了 */
+	return ( len >= 0 ) ? 0 : ( done == 0 ) ? -1 : -2;
+}
+#else
+/**
+ * カーネル内でファイルの内容を複写する(未対応の環境)
+ * @param int 複写元ファイルディスクリプタ(現在の位置から)
+ * @param int 複写先ファイルディスクリプタ(現在の位置へ)
+ * @param off_t 複写するバイト数
+ * @return -1:この方法では複写できない
+ */
+static int fd_copy_kernel (
+	int in,
+	int out,
+	off_t size
+)
+{
+	/**/
+	/**/
+	/* ILC: fd_copy_kernel開始 */
+	/* ILC: fd_copy_kernel終了 */
+	return -1;
+}
+#endif
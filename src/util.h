@@ -95,6 +95,57 @@ void* xmalloc( size_t );
  */
 void xfree( void * );
 
+/**
+ * ファイルに指定した文字列が含まれるかを調べる
+ * @param int         ファイルディスクリプタ
+ * @param const char* 検索する文字列
+ * @return  1:含まれる
+ *          0:含まれない
+ *         -1:調べられない(通常のファイルでない、マップできない)
+ */
+int fd_contains( int, const char* );
+
+/**
+ * ファイルの内容を複写する
+ * @param int 複写元ファイルディスクリプタ(現在の位置から)
+ * @param int 複写先ファイルディスクリプタ(現在の位置へ)
+ * @return  0:正常終了
+ *         -1:読み込みエラー、または書き込みエラー
+ */
+int fd_copy( int, int );
+
+/** mem_hash、fd_hash の初期値 */
+#define HASH_INIT 0xcbf29ce484222325ULL
+
+/**
+ * メモリの内容のハッシュ値を求める(FNV-1a 64bit)
+ * @param const void*         対象のメモリ
+ * @param size_t              バイト数
+ * @param unsigned long long  初期値(HASH_INIT、または前回の結果)
+ * @return unsigned long long ハッシュ値
+ */
+unsigned long long mem_hash( const void*, size_t, unsigned long long );
+
+/**
+ * ファイルの内容のハッシュ値を求める(FNV-1a 64bit)
+ * @param int                 ファイルディスクリプタ
+ * @param unsigned long long* ハッシュ値(入力:初期値 出力:ハッシュ値)
+ * @return  0:正常終了
+ *         -1:求められない(通常のファイルでない、マップできない)
+ */
+int fd_hash( int, unsigned long long* );
+
+/**
+ * 一時ファイルでファイルを置き換える
+ * 内容が同じ場合は置き換えずに一時ファイルを削除する。
+ * @param const char* 一時ファイル名(同じディレクトリにあること)
+ * @param const char* 置き換えるファイル名
+ * @return  0:置き換えた
+ *          1:内容が同じなので置き換えなかった
+ *         -1:置き換えられない(一時ファイルは削除する)
+ */
+int file_update( const char*, const char* );
+
 
 #endif /* _UTIL_H_ */
 
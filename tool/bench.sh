@@ -0,0 +1,79 @@
+#!/bin/sh
+##############################################################################
+# ilcの変換速度(MB/s)を計測する。
+#
+# 指定したサイズのCソースを生成し、ilcで繰り返し変換して
+# 最も速かった回の速度を表示する。
+#
+# usage :
+#   bench.sh [ilc] [サイズ(MB)] [繰り返し回数]
+#
+#
+#   Copyright (c) 2007-2008, 2017 tamura shingo
+##############################################################################
+
+ILC=${1:-./ilc}
+SIZE=${2:-5}
+REPEAT=${3:-5}
+WORK=${TMPDIR:-/tmp}/ilc_bench.$$
+
+# 現在時刻(秒)。小数点以下が取れない環境では秒単位になる
+now () {
+	t=`date +%s.%N`
+	case "$t" in
+	*N) date +%s ;;
+	*)  echo "$t" ;;
+	esac
+}
+
+mkdir -p "$WORK" || exit 1
+trap 'rm -rf "$WORK"' 0 1 2 15
+
+# ベンチマーク用のソースを生成する
+awk -v size="$SIZE" 'BEGIN {
+	limit = size * 1024 * 1024
+	for ( n = 0; bytes < limit; n++ ) {
+		s = sprintf( "/*\n * func%d\n * generated for benchmark\n */\n", n )
+		s = s sprintf( "static int func%d ( int x, const char* str )\n{\n", n )
+		s = s sprintf( "\t/* ILC: func%d開始 */\n", n )
+		s = s sprintf( "\tint i, sum = 0;\n\n" )
+		s = s sprintf( "\tfor ( i = 0; i < x; i++ ) {\n" )
+		s = s sprintf( "\t\t/* ILC: ループ中 */\n" )
+		for ( j = 0; j < 100; j++ ) {
+			s = s sprintf( "\t\tsum += i * %d + (int)str[i %% 8];\t/* 計算 %d */\n", j, j )
+		}
+		s = s sprintf( "\t}\n" )
+		s = s sprintf( "\tif ( sum > %d ) {\n\t\t/* ILC: 大きい */\n", n * 3 )
+		s = s sprintf( "\t\tprintf( \"func%d: sum=%%d (\\\"large\\\")\\n\", sum );\n\t}\n", n )
+		s = s sprintf( "\telse {\n\t\t/* ILC: 小さい */\n\t\tsum = -sum;\n\t}\n\n" )
+		s = s sprintf( "\t/* ILC: func%d終了 */\n\treturn sum;\n}\n\n", n )
+		printf "%s", s
+		bytes += length( s )
+	}
+}' > "$WORK/bench.c" || exit 1
+
+BYTES=`wc -c < "$WORK/bench.c"`
+
+i=0
+while [ $i -lt "$REPEAT" ]; do
+	rm -f "$WORK/bench.dat"
+	start=`now`
+	"$ILC" -f "$WORK/bench.dat" -o "$WORK/bench_ilc.c" "$WORK/bench.c" || exit 1
+	end=`now`
+	echo "$start $end" >> "$WORK/time.txt"
+	i=`expr $i + 1`
+done
+
+awk -v bytes="$BYTES" '{
+	t = $2 - $1
+	if ( NR == 1 || t < best ) {
+		best = t
+	}
+}
+END {
+	printf "input : %.1f MB\n", bytes / 1048576
+	printf "time  : %.3f sec (best of %d)\n", best, NR
+	if ( best > 0 ) {
+		printf "speed : %.1f MB/s\n", bytes / 1048576 / best
+	}
+}' "$WORK/time.txt"
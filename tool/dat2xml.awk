@@ -19,13 +19,19 @@ BEGIN {
 }
 
 {
-	if ( $1 == "0" ) {
+	# 5番目の項目は通過回数(回数モードで出力した場合のみ)
+	if ( $1 == "0" && ( NF < 5 || $5 + 0 == 0 ) ) {
 		flag = "false"
 	}
 	else {
 		flag = "true"
 	}
-	printf "  <coverage source=\"%s\" function=\"%s\" line=\"%d\" result=\"%s\" />\n", $2, $3, $4, flag
+	if ( NF >= 5 ) {
+		printf "  <coverage source=\"%s\" function=\"%s\" line=\"%d\" result=\"%s\" count=\"%s\" />\n", $2, $3, $4, flag, $5
+	}
+	else {
+		printf "  <coverage source=\"%s\" function=\"%s\" line=\"%d\" result=\"%s\" />\n", $2, $3, $4, flag
+	}
 }
 
 
@@ -0,0 +1,609 @@
+/**
+ * @file	test_ilc.c
+ * @brief	ilc.c(libilc)のユニットテスト
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <glob.h>
+#include <pthread.h>
+#include "ilc.h"
+#include "ilc_inline.h"
+#include "ILUT.h"
+
+/* テスト対象の libilc 自身で計測するため、自動初期化しない */
+const int __ilc_no_auto = 1;
+
+/* テストで使用するデータファイル */
+#define TEST_DAT "test_ilc.dat"
+
+/* スナップショットの書き出し先 */
+#define TEST_COPY "test_ilc_copy.dat"
+
+/* テストで使用するデータファイルの初期内容 */
+#define TEST_INIT "0:a.c:f:1\n0:a.c:f:2\n"
+
+
+/**
+ * テスト用のデータファイルを作成する
+ * @param const char* ファイル名
+ * @param const char* ファイルの内容
+ * @return 0:正常終了 -1:作成に失敗
+ */
+int make_dat (
+	const char* path,
+	const char* str
+)
+{
+	/**/
+	FILE* fp;
+	/**/
+
+	fp = fopen( path, "w" );
+	if ( fp == NULL ) {
+		return -1;
+	}
+	fputs( str, fp );
+	fclose( fp );
+
+	return 0;
+}
+
+
+/**
+ * データファイルの内容が期待した内容と一致するか
+ * @param const char* ファイル名
+ * @param const char* 期待する内容
+ * @return 1:一致 0:不一致、または読み込めない
+ */
+int same_dat (
+	const char* path,
+	const char* str
+)
+{
+	/**/
+	FILE* fp;
+	char buf[1024];
+	size_t len;
+	/**/
+
+	fp = fopen( path, "r" );
+	if ( fp == NULL ) {
+		return 0;
+	}
+	len = fread( buf, 1, sizeof(buf) - 1, fp );
+	buf[len] = '\0';
+	fclose( fp );
+
+	return strcmp( buf, str ) == 0;
+}
+
+
+/**
+ * ILC_Snapshotのテスト
+ * 計測を続けたまま書き出せること
+ */
+ILUT_Test test_ilc_snapshot (
+)
+{
+	/**/
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	remove( TEST_COPY );
+
+	ILUT_ASSERT( "初期化前はILC_FAILUREを返すこと", ILC_Snapshot( NULL ) == ILC_FAILURE );
+
+	ILC_SetMode( ILC_MODE_FLAG );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	__ilc_check( "a.c:f:1" );
+	ILUT_ASSERT( "読み込んだファイルに書き出せること", ILC_Snapshot( NULL ) == ILC_SUCCESS );
+	ILUT_ASSERT( "通過済みの計測ポイントが書き出されること", same_dat( TEST_DAT, "1:a.c:f:1\n0:a.c:f:2\n" ) );
+
+	__ilc_check( "a.c:f:2" );
+	ILUT_ASSERT( "別のファイルに書き出せること", ILC_Snapshot( TEST_COPY ) == ILC_SUCCESS );
+	ILUT_ASSERT( "スナップショット後の通過も書き出されること", same_dat( TEST_COPY, "1:a.c:f:1\n1:a.c:f:2\n" ) );
+
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "終了時にすべての通過が書き出されること", same_dat( TEST_DAT, "1:a.c:f:1\n1:a.c:f:2\n" ) );
+
+	remove( TEST_DAT );
+	remove( TEST_COPY );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_Resetのテスト
+ * ファイルから読み込んだ結果も含めてクリアすること
+ */
+ILUT_Test test_ilc_reset (
+)
+{
+	/**/
+	/**/
+
+	if ( make_dat( TEST_DAT, "1:a.c:f:1:5\n0:a.c:f:2:0\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILUT_ASSERT( "初期化前はILC_FAILUREを返すこと", ILC_Reset( ILC_RESET_FLAG ) == ILC_FAILURE );
+
+	ILC_SetMode( ILC_MODE_COUNT | ILC_MODE_THREAD );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	__ilc_check( "a.c:f:1" );
+	__ilc_check( "a.c:f:1" );
+	ILUT_ASSERT( "クリアできること", ILC_Reset( ILC_RESET_FLAG | ILC_RESET_COUNT ) == ILC_SUCCESS );
+	__ilc_check( "a.c:f:2" );
+	ILUT_ASSERT( "書き出せること", ILC_Snapshot( NULL ) == ILC_SUCCESS );
+	ILUT_ASSERT( "クリア後の通過だけが書き出されること", same_dat( TEST_DAT, "0:a.c:f:1:0\n1:a.c:f:2:1\n" ) );
+
+	__ilc_check( "a.c:f:2" );
+	ILUT_ASSERT( "通過回数だけをクリアできること", ILC_Reset( ILC_RESET_COUNT ) == ILC_SUCCESS );
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "通過フラグは残ること", same_dat( TEST_DAT, "0:a.c:f:1:0\n1:a.c:f:2:0\n" ) );
+
+	ILC_SetMode( ILC_MODE_FLAG );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_Append / ILC_AppendCopy / ILC_Searchのテスト
+ * ILC_Append は渡した文字列を引き取り、ILC_AppendCopy は複製して登録すること
+ */
+ILUT_Test test_ilc_append (
+)
+{
+	/**/
+	ILC_DATA* data;
+	char* flag;
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILC_SetMode( ILC_MODE_FLAG );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	data = ILC_GetILCData();
+
+	/* 成功すると文字列は ILC_Append が解放する */
+	ILUT_ASSERT( "ILC_Appendで追加できること", ILC_Append( data, strdup( "0:b.c:g:3" ) ) == ILC_SUCCESS );
+	ILUT_ASSERT( "ILC_AppendCopyで追加できること", ILC_AppendCopy( data, "0:b.c:g:4" ) == ILC_SUCCESS );
+	ILUT_ASSERT( "追加した順にIDが振られること", ILC_SearchId( data, "b.c:g:3" ) == 2 && ILC_SearchId( data, "b.c:g:4" ) == 3 );
+
+	__ilc_check( "a.c:f:1" );
+	flag = ILC_Search( data, "a.c:f:1" );
+	ILUT_ASSERT( "ILC_Searchは通過フラグ(数値の0/1)を返すこと", flag != NULL && *flag == 1 );
+	ILUT_ASSERT( "未登録の場合はNULLを返すこと", ILC_Search( data, "b.c:g:5" ) == NULL );
+
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "追加した計測ポイントが書き出されること",
+				 same_dat( TEST_DAT, "1:a.c:f:1\n0:a.c:f:2\n0:b.c:g:3\n0:b.c:g:4\n" ) );
+
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * インライン版(ilc -n)の計測ポイントを通過させる
+ * @param long 通過回数
+ */
+void hit_inline (
+	long num
+)
+{
+	/**/
+	long ix;
+	/**/
+
+	for ( ix = 0; ix < num; ix++ ) {
+		__ilc_check_inline( "a.c:f:1" );
+	}
+}
+
+
+/**
+ * ilc_points セクション登録版(ilc -r)の計測ポイントを通過させる
+ * 他のテストのデータファイルにもある a.c:f:2 を登録する(他のテストでは追加されない)。
+ * @param long 通過回数
+ */
+void hit_point (
+	long num
+)
+{
+	/**/
+	long ix;
+	/**/
+
+	for ( ix = 0; ix < num; ix++ ) {
+		__ilc_check_point( "a.c", "f", 2 );
+	}
+}
+
+
+/**
+ * __ilc_site_hit / ILC_SITEのテスト
+ * 初回通過で libilc に記録し、以後は ILC_SITE に数えて集計されること
+ * ILC_Reset で記録済みの状態が戻り、再び libilc に記録されること
+ */
+ILUT_Test test_ilc_site (
+)
+{
+	/**/
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILC_SetMode( ILC_MODE_COUNT );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+
+	hit_inline( 3 );
+	ILUT_ASSERT( "書き出せること", ILC_Snapshot( NULL ) == ILC_SUCCESS );
+	ILUT_ASSERT( "計測ポイントごとに数えた通過回数が集計されること", same_dat( TEST_DAT, "1:a.c:f:1:3\n0:a.c:f:2:0\n" ) );
+
+	/* 記録済みの状態をクリアすると、次の通過で再び libilc に記録する */
+	ILUT_ASSERT( "クリアできること", ILC_Reset( ILC_RESET_FLAG | ILC_RESET_COUNT ) == ILC_SUCCESS );
+	hit_inline( 2 );
+	ILUT_ASSERT( "クリア後の初回通過で通過フラグが立つこと", *ILC_Search( ILC_GetILCData(), "a.c:f:1" ) == 1 );
+	ILUT_ASSERT( "通過していない計測ポイントの通過フラグは立たないこと", *ILC_Search( ILC_GetILCData(), "a.c:f:2" ) == 0 );
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "クリア後の通過が記録されること", same_dat( TEST_DAT, "1:a.c:f:1:2\n0:a.c:f:2:0\n" ) );
+
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ilc_points セクションの登録(ilc_registry_add)のテスト
+ * データファイルにない計測ポイントを追加してIDを設定し、
+ * 前回の ILC_Initialize で記録済みの ILC_SITE も再び記録されること
+ */
+ILUT_Test test_ilc_registry (
+)
+{
+	/**/
+	ILC_DATA* data;
+	/**/
+
+	if ( make_dat( TEST_DAT, "0:a.c:f:1\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILC_SetMode( ILC_MODE_COUNT );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	data = ILC_GetILCData();
+	ILUT_ASSERT( "ファイルにない計測ポイントが末尾に追加されること",
+				 data->num == 2 && ILC_SearchId( data, "a.c:f:2" ) == 1 );
+	ILC_Finalize();
+
+	/* ファイルにある計測ポイントは追加せず、その行のIDを使う */
+	ILUT_ASSERT( "初期化しなおせること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	data = ILC_GetILCData();
+	ILUT_ASSERT( "ファイルにある計測ポイントは追加しないこと",
+				 data->num == 2 && ILC_SearchId( data, "a.c:f:2" ) == 1 );
+
+	hit_point( 2 );
+	ILUT_ASSERT( "書き出せること", ILC_Snapshot( NULL ) == ILC_SUCCESS );
+	ILUT_ASSERT( "登録した計測ポイントの通過回数が集計されること", same_dat( TEST_DAT, "0:a.c:f:1:0\n1:a.c:f:2:2\n" ) );
+	ILC_Finalize();
+
+	/* 前回の ILC_Initialize で記録済みにした ILC_SITE も、次の初期化後は再び記録する */
+	if ( make_dat( TEST_DAT, "0:a.c:f:1\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	ILUT_ASSERT( "もう一度初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	data = ILC_GetILCData();
+
+	hit_point( 4 );
+	ILUT_ASSERT( "前回の初期化で記録済みでも、通過フラグが立つこと", *ILC_Search( data, "a.c:f:2" ) == 1 );
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "追加した計測ポイントの通過が書き出されること", same_dat( TEST_DAT, "0:a.c:f:1:0\n1:a.c:f:2:4\n" ) );
+
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * スレッドから計測ポイントを通過させる
+ * @param void* 通過回数(long*)
+ * @return NULL
+ */
+void* hit_thread (
+	void* arg
+)
+{
+	/**/
+	long ix;
+	/**/
+
+	for ( ix = 0; ix < *(long*)arg; ix++ ) {
+		__ilc_check( "a.c:f:1" );
+	}
+
+	return NULL;
+}
+
+
+/**
+ * ILC_MODE_THREADのテスト
+ * 終了したスレッドの記録も集計されること
+ */
+ILUT_Test test_ilc_thread (
+)
+{
+	/**/
+	pthread_t th[4];
+	long num = 1000;
+	int ix;
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILC_SetMode( ILC_MODE_COUNT | ILC_MODE_THREAD );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	for ( ix = 0; ix < 4; ix++ ) {
+		if ( pthread_create( &th[ix], NULL, hit_thread, &num ) != 0 ) {
+			ILUT_FAIL( "スレッドの作成に失敗" );
+		}
+	}
+	for ( ix = 0; ix < 4; ix++ ) {
+		pthread_join( th[ix], NULL );
+	}
+	ILUT_ASSERT( "終了したスレッドの記録がスナップショットに含まれること",
+				 ILC_Snapshot( NULL ) == ILC_SUCCESS && same_dat( TEST_DAT, "1:a.c:f:1:4000\n0:a.c:f:2:0\n" ) );
+
+	pthread_create( &th[0], NULL, hit_thread, &num );
+	pthread_join( th[0], NULL );
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "すべてのスレッドの記録が集計されること", same_dat( TEST_DAT, "1:a.c:f:1:5000\n0:a.c:f:2:0\n" ) );
+
+	ILC_SetMode( ILC_MODE_FLAG );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * 通過回数の標本化(ILC_SetSampling)のテスト
+ * 初回通過は正確に数え、以後は平均 N 回に1回だけ N を加算すること
+ */
+ILUT_Test test_ilc_sampling (
+)
+{
+	/**/
+	pthread_t th;
+	long num;
+	ILC_DATA* data;
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILC_SetMode( ILC_MODE_COUNT );
+	ILC_SetSampling( 100 );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	data = ILC_GetILCData();
+
+	/* 標本化のカウントダウンはスレッドごとなので、新しいスレッドで通過させる */
+	num = 2;
+	pthread_create( &th, NULL, hit_thread, &num );
+	pthread_join( th, NULL );
+	ILUT_ASSERT( "2回の通過で N を加算しないこと", data->count[0] == 1 );
+
+	ILC_Reset( ILC_RESET_FLAG | ILC_RESET_COUNT );
+	num = 100000;
+	pthread_create( &th, NULL, hit_thread, &num );
+	pthread_join( th, NULL );
+	ILUT_ASSERT( "推定値が通過回数に近いこと", data->count[0] > 80000 && data->count[0] < 120000 );
+	ILUT_ASSERT( "推定値は N の倍数 + 初回の1であること", data->count[0] % 100 == 1 );
+
+	ILC_Finalize();
+	ILC_SetMode( ILC_MODE_FLAG );
+	ILC_SetSampling( 0 );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_MODE_MMAPのテスト
+ * ILC_Finalizeせずに終了しても、通過フラグと通過回数が残ること
+ */
+ILUT_Test test_ilc_mmap (
+)
+{
+	/**/
+	pid_t pid;
+	int status = -1;
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	remove( TEST_DAT ".cnt" );
+
+	pid = fork();
+	if ( pid == 0 ) {
+		/* 子プロセス: 通過した後、書き出さずに終了する */
+		ILC_SetMode( ILC_MODE_MMAP | ILC_MODE_COUNT );
+		ILC_Initialize( TEST_DAT );
+		__ilc_check( "a.c:f:1" );
+		__ilc_check( "a.c:f:1" );
+		_exit( 0 );
+	}
+	ILUT_ASSERT( "子プロセスが作成できること", pid > 0 );
+	waitpid( pid, &status, 0 );
+	ILUT_ASSERT( "子プロセスが正常に終了すること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+	ILUT_ASSERT( "通過フラグがファイルに残ること", same_dat( TEST_DAT, "1:a.c:f:1\n0:a.c:f:2\n" ) );
+	ILUT_ASSERT( "通過回数ファイルが残ること", access( TEST_DAT ".cnt", F_OK ) == 0 );
+
+	ILC_SetMode( ILC_MODE_COUNT );
+	ILUT_ASSERT( "次の実行で初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "通過回数ファイルの通過回数が反映されること", same_dat( TEST_DAT, "1:a.c:f:1:2\n0:a.c:f:2:0\n" ) );
+	ILUT_ASSERT( "反映後は通過回数ファイルを削除すること", access( TEST_DAT ".cnt", F_OK ) != 0 );
+
+	ILC_SetMode( ILC_MODE_FLAG );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_MODE_MMAPでのILC_Snapshotのテスト
+ * スナップショット後の通過も、ILC_Finalizeせずにファイルに残ること
+ */
+ILUT_Test test_ilc_mmap_snapshot (
+)
+{
+	/**/
+	pid_t pid;
+	int status = -1;
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	pid = fork();
+	if ( pid == 0 ) {
+		/* 子プロセス: スナップショットの後に通過し、書き出さずに終了する */
+		ILC_SetMode( ILC_MODE_MMAP );
+		ILC_Initialize( TEST_DAT );
+		__ilc_check( "a.c:f:1" );
+		ILC_Snapshot( NULL );
+		__ilc_check( "a.c:f:2" );
+		_exit( 0 );
+	}
+	ILUT_ASSERT( "子プロセスが作成できること", pid > 0 );
+	waitpid( pid, &status, 0 );
+	ILUT_ASSERT( "子プロセスが正常に終了すること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+	ILUT_ASSERT( "スナップショット後の通過もファイルに残ること", same_dat( TEST_DAT, "1:a.c:f:1\n1:a.c:f:2\n" ) );
+
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+
+/**
+ * fork した子プロセスの記録の集計のテスト
+ * 今回の実行の子プロセスのファイルだけを集計し、無関係なファイルは残すこと
+ */
+ILUT_Test test_ilc_fork_collect (
+)
+{
+	/**/
+	pid_t pid;
+	int status = -1;
+	glob_t gl;
+	/**/
+
+	if ( make_dat( TEST_DAT, TEST_INIT ) != 0 || make_dat( TEST_DAT ".99999", "1:zzz.c:stale:7\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	ILC_SetMode( ILC_MODE_FLAG );
+	ILUT_ASSERT( "初期化できること", ILC_Initialize( TEST_DAT ) == ILC_SUCCESS );
+
+	pid = fork();
+	if ( pid == 0 ) {
+		/* 子プロセス: fork 以降の通過を書き出して終了する */
+		__ilc_check( "a.c:f:2" );
+		_exit( ILC_Finalize() == ILC_SUCCESS ? 0 : 1 );
+	}
+	ILUT_ASSERT( "子プロセスが作成できること", pid > 0 );
+	waitpid( pid, &status, 0 );
+	ILUT_ASSERT( "子プロセスが書き出せること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+
+	__ilc_check( "a.c:f:1" );
+	ILUT_ASSERT( "終了できること", ILC_Finalize() == ILC_SUCCESS );
+	ILUT_ASSERT( "子プロセスの通過が集計され、無関係なファイルは集計されないこと",
+				 same_dat( TEST_DAT, "1:a.c:f:1\n1:a.c:f:2\n" ) );
+	ILUT_ASSERT( "無関係なファイルは削除しないこと", access( TEST_DAT ".99999", F_OK ) == 0 );
+	ILUT_ASSERT( "集計した子プロセスのファイルは削除すること",
+				 glob( TEST_DAT ".*-*", 0, NULL, &gl ) == GLOB_NOMATCH );
+
+	remove( TEST_DAT );
+	remove( TEST_DAT ".99999" );
+
+	return ILUT_SUCCESS;
+}
+
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	static ILUT_TestCase test[] = {
+		DEF_TEST(test_ilc_snapshot),
+		DEF_TEST(test_ilc_reset),
+		DEF_TEST(test_ilc_append),
+		DEF_TEST(test_ilc_site),
+		DEF_TEST(test_ilc_registry),
+		DEF_TEST(test_ilc_thread),
+		DEF_TEST(test_ilc_sampling),
+		DEF_TEST(test_ilc_mmap),
+		DEF_TEST(test_ilc_mmap_snapshot),
+		DEF_TEST(test_ilc_fork_collect),
+		TestCaseEnd
+	};
+	int ret;
+	FILE* out = NULL;
+	/**/
+
+	/* テスト対象が libilc 自身のため、カバレッジデータは読み込まない */
+
+	ILUT_SetShowMode( ILUT_MODE_DETAIL );
+	ret = ILUT_RunTest( test );
+
+	/*-
+	 * 第一引数でファイルが指定されてあれば、そちらにテスト結果を出力する。
+	 * 指定が無ければ標準出力にテスト結果を出力する。
+	 */
+	if ( argc > 1 ) {
+		out = fopen( argv[1], "w" );
+	}
+	if ( out == NULL ) {
+		out = stdout;
+	}
+	ILUT_ResultOut( out, "ilc", test );
+	fclose( out );
+
+	return ret;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file	test_ilc_auto.c
+ * @brief	ilc.c(libilc)の自動初期化のユニットテスト
+ *
+ * 自動初期化はプログラム開始時(main の前)に行われるため、
+ * テストごとに環境変数を設定して自分自身を子プロセスとして実行し、
+ * 子プロセスが書き出したファイルを親プロセスで確認する。
+ * test_ilc.c は __ilc_no_auto を定義しているため、こちらに分けている。
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "ilc.h"
+#include "ilc_local.h"
+#include "ILUT.h"
+
+/* 子プロセスで実行する処理を指定する環境変数 */
+#define TEST_ENV_CASE "TEST_ILC_AUTO_CASE"
+
+/* 自動初期化で読み込むデータファイル */
+#define TEST_AUTO "test_ilc_auto.dat"
+
+/* プログラムが ILC_Initialize で読み込むデータファイル */
+#define TEST_DAT "test_ilc_auto_q.dat"
+
+/* 自分自身の実行ファイル名 */
+static const char* test_self;
+
+
+/**
+ * テスト用のデータファイルを作成する
+ * @param const char* ファイル名
+ * @param const char* ファイルの内容
+ * @return 0:正常終了 -1:作成に失敗
+ */
+int make_dat (
+	const char* path,
+	const char* str
+)
+{
+	/**/
+	FILE* fp;
+	/**/
+
+	fp = fopen( path, "w" );
+	if ( fp == NULL ) {
+		return -1;
+	}
+	fputs( str, fp );
+	fclose( fp );
+
+	return 0;
+}
+
+
+/**
+ * データファイルの内容が期待した内容と一致するか
+ * @param const char* ファイル名
+ * @param const char* 期待する内容
+ * @return 1:一致 0:不一致、または読み込めない
+ */
+int same_dat (
+	const char* path,
+	const char* str
+)
+{
+	/**/
+	FILE* fp;
+	char buf[1024];
+	size_t len;
+	/**/
+
+	fp = fopen( path, "r" );
+	if ( fp == NULL ) {
+		return 0;
+	}
+	len = fread( buf, 1, sizeof(buf) - 1, fp );
+	buf[len] = '\0';
+	fclose( fp );
+
+	return strcmp( buf, str ) == 0;
+}
+
+
+/**
+ * 自分自身を子プロセスとして実行する
+ * @param const char* 子プロセスで実行する処理
+ * @param const char* 自動初期化で読み込むファイル(ILC_FILE)
+ * @return waitpid で取得した終了状態 -1:実行に失敗
+ */
+int run_child (
+	const char* name,
+	const char* file
+)
+{
+	/**/
+	pid_t pid;
+	int status;
+	/**/
+
+	pid = fork();
+	if ( pid == 0 ) {
+		setenv( TEST_ENV_CASE, name, 1 );
+		setenv( ILC_ENV_FILE, file, 1 );
+		unsetenv( ILC_ENV_MODE );
+		execl( test_self, test_self, (char*)NULL );
+		_exit( 127 );
+	}
+	if ( pid < 0 || waitpid( pid, &status, 0 ) != pid ) {
+		return -1;
+	}
+
+	return status;
+}
+
+
+/**
+ * 子プロセスの処理
+ * 自動初期化した後に、プログラムが別のファイルで ILC_Initialize する
+ * @param const char* 処理の名前
+ * @return 終了コード
+ */
+int child_main (
+	const char* name
+)
+{
+	/**/
+	ILC_DATA* data;
+	/**/
+
+	if ( strcmp( name, "same" ) == 0 ) {
+		/* 自動初期化と同じファイルを読み込みなおす */
+		if ( ILC_Initialize( TEST_AUTO ) != ILC_SUCCESS ) {
+			return 2;
+		}
+		data = ILC_GetILCData();
+		if ( data->num != 2 ) {
+			return 3;
+		}
+		return ILC_Finalize() == ILC_SUCCESS ? 0 : 4;
+	}
+	if ( strcmp( name, "other" ) == 0 ) {
+		/* 別のファイルを読み込み、ID 0 を通過する */
+		if ( ILC_Initialize( TEST_DAT ) != ILC_SUCCESS ) {
+			return 2;
+		}
+		__ilc_check_id( 0 );
+		return ILC_Finalize() == ILC_SUCCESS ? 0 : 4;
+	}
+	if ( strcmp( name, "crash" ) == 0 ) {
+		/* 計測ポイントがないまま異常終了する */
+		__ilc_check( "x.c:main:1" );
+		raise( SIGTERM );
+		return 5;
+	}
+	if ( strcmp( name, "exit" ) == 0 ) {
+		/* 計測ポイントがないまま正常終了する */
+		__ilc_check( "x.c:main:1" );
+		return 0;
+	}
+
+	return 1;
+}
+
+
+/**
+ * 自動初期化と同じファイルの ILC_Initialize のテスト
+ * 自動初期化で読み込んだ計測ポイントに重ねて読み込まないこと
+ */
+ILUT_Test test_ilc_auto_same (
+)
+{
+	/**/
+	int status;
+	/**/
+
+	if ( make_dat( TEST_AUTO, "0:a.c:f:1\n0:a.c:f:2\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	status = run_child( "same", TEST_AUTO );
+	ILUT_ASSERT( "計測ポイントが重複せず、正常に終了すること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+	ILUT_ASSERT( "ファイルの内容が増えないこと", same_dat( TEST_AUTO, "0:a.c:f:1\n0:a.c:f:2\n" ) );
+
+	status = run_child( "same", TEST_AUTO );
+	ILUT_ASSERT( "繰り返し実行しても正常に終了すること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+	ILUT_ASSERT( "繰り返し実行してもファイルの内容が増えないこと", same_dat( TEST_AUTO, "0:a.c:f:1\n0:a.c:f:2\n" ) );
+
+	remove( TEST_AUTO );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * 自動初期化と別のファイルの ILC_Initialize のテスト
+ * IDは指定したファイルの行の順になり、自動初期化したファイルの内容は混ざらないこと
+ */
+ILUT_Test test_ilc_auto_other (
+)
+{
+	/**/
+	int status;
+	/**/
+
+	if ( make_dat( TEST_AUTO, "0:z.c:z:1\n0:z.c:z:2\n" ) != 0 || make_dat( TEST_DAT, "0:a.c:x:1\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+
+	status = run_child( "other", TEST_AUTO );
+	ILUT_ASSERT( "正常に終了すること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+	ILUT_ASSERT( "指定したファイルの計測ポイントだけが書き出されること", same_dat( TEST_DAT, "1:a.c:x:1\n" ) );
+	ILUT_ASSERT( "自動初期化したファイルは変更しないこと", same_dat( TEST_AUTO, "0:z.c:z:1\n0:z.c:z:2\n" ) );
+
+	remove( TEST_AUTO );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * 計測ポイントがない場合の終了時の書き出しのテスト
+ * 正常終了・異常終了のどちらでもファイルを作らないこと
+ */
+ILUT_Test test_ilc_auto_empty (
+)
+{
+	/**/
+	int status;
+	/**/
+
+	remove( TEST_AUTO );
+
+	status = run_child( "exit", TEST_AUTO );
+	ILUT_ASSERT( "正常に終了すること", WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+	ILUT_ASSERT( "正常終了ではファイルを作らないこと", access( TEST_AUTO, F_OK ) != 0 );
+
+	status = run_child( "crash", TEST_AUTO );
+	ILUT_ASSERT( "シグナルで終了すること", WIFSIGNALED( status ) && WTERMSIG( status ) == SIGTERM );
+	ILUT_ASSERT( "異常終了でもファイルを作らないこと", access( TEST_AUTO, F_OK ) != 0 );
+
+	remove( TEST_AUTO );
+
+	return ILUT_SUCCESS;
+}
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	static ILUT_TestCase test[] = {
+		DEF_TEST(test_ilc_auto_same),
+		DEF_TEST(test_ilc_auto_other),
+		DEF_TEST(test_ilc_auto_empty),
+		TestCaseEnd
+	};
+	int ret;
+	FILE* out = NULL;
+	const char* name;
+	/**/
+
+	if ( (name = getenv( TEST_ENV_CASE )) != NULL ) {
+		/* 子プロセスとして実行された */
+		return child_main( name );
+	}
+	test_self = argv[0];
+
+	ILUT_SetShowMode( ILUT_MODE_DETAIL );
+	ret = ILUT_RunTest( test );
+
+	/*-
+	 * 第一引数でファイルが指定されてあれば、そちらにテスト結果を出力する。
+	 * 指定が無ければ標準出力にテスト結果を出力する。
+	 */
+	if ( argc > 1 ) {
+		out = fopen( argv[1], "w" );
+	}
+	if ( out == NULL ) {
+		out = stdout;
+	}
+	ILUT_ResultOut( out, "ilc_auto", test );
+	fclose( out );
+
+	return ret;
+}
@@ -0,0 +1,421 @@
+/**
+ * @file	test_ilc_dat.c
+ * @brief	ilc_dat.cのユニットテスト
+ *
+ * @author	tamura shingo (tamura.shingo@gmail.com)
+ * @date	2026-10-17
+ * @version	$Id$
+ *
+ * Copyright (c) 2007-2008, 2017 tamura shingo
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "ilc_dat.h"
+#include "ilc.h"
+#include "ILUT.h"
+
+/* テストで使用するデータファイル */
+#define TEST_DAT "test_ilc_dat.dat"
+
+
+/**
+ * テスト用のデータファイルを作成する
+ * @param const char* ファイルの内容
+ * @return 0:正常終了 -1:作成に失敗
+ */
+int make_dat (
+	const char* str
+)
+{
+	/**/
+	FILE* fp;
+	/**/
+
+	fp = fopen( TEST_DAT, "w" );
+	if ( fp == NULL ) {
+		return -1;
+	}
+	fputs( str, fp );
+	fclose( fp );
+
+	return 0;
+}
+
+
+/**
+ * ILC_DatOpenのテスト
+ */
+ILUT_Test test_ilc_dat_open (
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	/**/
+
+	remove( TEST_DAT );
+	ILUT_ASSERT( "存在しないファイルはNULLを返すこと", ILC_DatOpen( TEST_DAT ) == NULL );
+
+	if ( make_dat( "" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	reader = ILC_DatOpen( TEST_DAT );
+	ILUT_ASSERT( "ファイルが開けること", reader != NULL );
+	ILC_DatClose( reader );
+
+	ILC_DatClose( NULL );
+	ILUT_ASSERT( "NULLを渡してもSEGVしないこと", 1 );
+
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_DatReadのテスト
+ * 通過フラグのみの行、通過回数のある行、CRLF、空行、改行のない最終行
+ */
+ILUT_Test test_ilc_dat_read (
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT point;
+	/**/
+
+	if ( make_dat( "0:./src/a.c:func_a:10\n"
+	               "1:./src/a.c:func_a:20:5\r\n"
+	               "\n"
+	               "0:./src/b.c:func_b:30:0" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	reader = ILC_DatOpen( TEST_DAT );
+	if ( reader == NULL ) {
+		ILUT_FAIL( "ファイルのオープンに失敗" );
+	}
+
+	ILUT_ASSERT( "1行目が読み込めること", ILC_DatRead( reader, &point ) == 1 );
+	ILUT_ASSERT( "1行目:フラグ",     point.flag == 0 );
+	ILUT_ASSERT( "1行目:ファイル名", strcmp( point.file, "./src/a.c" ) == 0 );
+	ILUT_ASSERT( "1行目:関数名",     strcmp( point.func, "func_a" ) == 0 );
+	ILUT_ASSERT( "1行目:行数",       point.line == 10 );
+	ILUT_ASSERT( "1行目:回数なし",   point.has_count == 0 && point.count == 0 );
+	ILUT_ASSERT( "1行目:未通過",     !ILC_DAT_COVERED( &point ) );
+
+	ILUT_ASSERT( "2行目が読み込めること", ILC_DatRead( reader, &point ) == 1 );
+	ILUT_ASSERT( "2行目:フラグ",     point.flag == 1 );
+	ILUT_ASSERT( "2行目:行数",       point.line == 20 );
+	ILUT_ASSERT( "2行目:CRを含まないこと", point.has_count == 1 && point.count == 5 );
+	ILUT_ASSERT( "2行目:通過済み",   ILC_DAT_COVERED( &point ) );
+
+	ILUT_ASSERT( "空行を読み飛ばすこと", ILC_DatRead( reader, &point ) == 1 );
+	ILUT_ASSERT( "改行のない最終行:ファイル名", strcmp( point.file, "./src/b.c" ) == 0 );
+	ILUT_ASSERT( "改行のない最終行:回数",       point.has_count == 1 && point.count == 0 );
+	ILUT_ASSERT( "改行のない最終行:行番号",     reader->lineno == 4 );
+
+	ILUT_ASSERT( "ファイルの終わりで0を返すこと", ILC_DatRead( reader, &point ) == 0 );
+	ILUT_ASSERT( "続けて呼んでも0を返すこと",     ILC_DatRead( reader, &point ) == 0 );
+
+	ILC_DatClose( reader );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_DatReadのテスト
+ * 形式が正しくない行
+ */
+ILUT_Test test_ilc_dat_read_invalid (
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT point;
+	/**/
+
+	if ( make_dat( "0:./src/a.c:func_a\n"
+	               "x:./src/a.c:func_a:10\n"
+	               "0:./src/a.c:func_a:1O\n"
+	               "0:./src/a.c:func_a:10:\n"
+	               "1:./src/a.c:func_a:40\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	reader = ILC_DatOpen( TEST_DAT );
+	if ( reader == NULL ) {
+		ILUT_FAIL( "ファイルのオープンに失敗" );
+	}
+
+	ILUT_ASSERT( "項目が足りない",       ILC_DatRead( reader, &point ) == -1 && reader->lineno == 1 );
+	ILUT_ASSERT( "フラグが数値でない",   ILC_DatRead( reader, &point ) == -1 && reader->lineno == 2 );
+	ILUT_ASSERT( "行数が数値でない",     ILC_DatRead( reader, &point ) == -1 && reader->lineno == 3 );
+	ILUT_ASSERT( "回数が空",             ILC_DatRead( reader, &point ) == -1 && reader->lineno == 4 );
+	ILUT_ASSERT( "続きの行が読めること", ILC_DatRead( reader, &point ) == 1 && point.line == 40 );
+	ILUT_ASSERT( "ファイルの終わり",     ILC_DatRead( reader, &point ) == 0 );
+
+	ILC_DatClose( reader );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_DatReadのテスト
+ * バッファをまたぐ行、バッファより長い行
+ */
+ILUT_Test test_ilc_dat_read_large (
+)
+{
+	/**/
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT point;
+	FILE* fp;
+	static char func[1024 * 1024];
+	long ix;
+	long num = 0;
+	int ok = 1;
+	/**/
+
+	memset( func, 'f', sizeof(func) - 1 );
+	func[sizeof(func) - 1] = '\0';
+
+	fp = fopen( TEST_DAT, "w" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	for ( ix = 0; ix < 100000; ix++ ) {
+		fprintf( fp, "%ld:./src/large.c:func%ld:%ld\n", ix % 2, ix / 10, ix );
+	}
+	fprintf( fp, "1:./src/large.c:%s:1\n", func );
+	fclose( fp );
+
+	reader = ILC_DatOpen( TEST_DAT );
+	if ( reader == NULL ) {
+		ILUT_FAIL( "ファイルのオープンに失敗" );
+	}
+	for ( ix = 0; ix < 100000; ix++ ) {
+		if ( ILC_DatRead( reader, &point ) != 1 || point.line != ix || point.flag != ix % 2 ) {
+			ok = 0;
+			break;
+		}
+		num++;
+	}
+	ILUT_ASSERT( "すべての行が順に読み込めること", ok && num == 100000 );
+
+	ILUT_ASSERT( "バッファより長い行が読み込めること", ILC_DatRead( reader, &point ) == 1 );
+	ILUT_ASSERT( "長い関数名が欠けないこと", strcmp( point.func, func ) == 0 );
+	ILUT_ASSERT( "ファイルの終わり", ILC_DatRead( reader, &point ) == 0 );
+
+	ILC_DatClose( reader );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+
+/**
+ * ILC_DatLoad、ILC_DatSortのテスト
+ */
+ILUT_Test test_ilc_dat_load_sort (
+)
+{
+	/**/
+	ILC_DAT_TABLE table;
+	/**/
+
+	memset( &table, 0, sizeof(ILC_DAT_TABLE) );
+	remove( TEST_DAT );
+	ILUT_ASSERT( "存在しないファイルは-1を返すこと", ILC_DatLoad( TEST_DAT, &table ) == -1 );
+
+	if ( make_dat( "0:./src/b.c:func_b:10\n"
+	               "0:./src/a.c:func_a:20\n"
+	               "0:./src/a.c:func_a:3:2\n"
+	               "invalid\n"
+	               "1:./src/a.c:func_a:20\n"
+	               "0:./src/a.c:func_0:100\n" ) != 0 ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	ILUT_ASSERT( "読み込めること",           ILC_DatLoad( TEST_DAT, &table ) == 0 );
+	ILUT_ASSERT( "計測ポイントの数",         table.num == 5 );
+	ILUT_ASSERT( "読み飛ばした行数",         table.invalid == 1 );
+	ILUT_ASSERT( "同じ関数名は共有すること", table.point[1].func == table.point[2].func );
+
+	ILC_DatSort( &table );
+	ILUT_ASSERT( "同じ計測ポイントがまとまること", table.num == 4 );
+	ILUT_ASSERT( "1番目:関数名順",   strcmp( table.point[0].func, "func_0" ) == 0 );
+	ILUT_ASSERT( "2番目:行数は数値順", strcmp( table.point[1].func, "func_a" ) == 0 && table.point[1].line == 3 );
+	ILUT_ASSERT( "3番目:通過フラグの論理和", table.point[2].line == 20 && table.point[2].flag == 1 );
+	ILUT_ASSERT( "4番目:ファイル名順", strcmp( table.point[3].file, "./src/b.c" ) == 0 );
+
+	ILC_DatFree( &table );
+	ILUT_ASSERT( "解放後は初期状態であること", table.point == NULL && table.num == 0 && table.chunk == NULL );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ILC_DatCompare、ILC_DatCombine、ILC_DatWriteのテスト
+ */
+ILUT_Test test_ilc_dat_combine_write (
+)
+{
+	/**/
+	ILC_DAT_POINT a = { 0, "./src/a.c", "func", 9, 0, 0 };
+	ILC_DAT_POINT b = { 1, "./src/a.c", "func", 10, 3, 1 };
+	FILE* fp;
+	char buf[256];
+	/**/
+
+	ILUT_ASSERT( "行数は数値で比較すること", ILC_DatCompare( &a, &b ) < 0 && ILC_DatCompare( &b, &a ) > 0 );
+	b.line = 9;
+	ILUT_ASSERT( "同じ計測ポイント", ILC_DatCompare( &a, &b ) == 0 );
+
+	ILC_DatCombine( &a, &b );
+	ILUT_ASSERT( "通過フラグは論理和", a.flag == 1 );
+	ILUT_ASSERT( "通過回数を持つこと", a.has_count == 1 && a.count == 3 );
+	ILC_DatCombine( &a, &b );
+	ILUT_ASSERT( "通過回数は合計", a.count == 6 );
+
+	fp = fopen( TEST_DAT, "w+" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	b.has_count = 0;
+	ILUT_ASSERT( "書き出せること", ILC_DatWrite( fp, &a ) == 0 && ILC_DatWrite( fp, &b ) == 0 );
+	rewind( fp );
+	ILUT_ASSERT( "通過回数ありの形式", fgets( buf, sizeof(buf), fp ) != NULL && strcmp( buf, "1:./src/a.c:func:9:6\n" ) == 0 );
+	ILUT_ASSERT( "通過フラグのみの形式", fgets( buf, sizeof(buf), fp ) != NULL && strcmp( buf, "1:./src/a.c:func:9\n" ) == 0 );
+	fclose( fp );
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+
+/**
+ * ILC_DatSaveのテスト
+ * テキスト形式、バイナリ形式で書き込み、読み込んだ内容が同じであること
+ */
+ILUT_Test test_ilc_dat_save (
+)
+{
+	/**/
+	ILC_DAT_POINT point[] = {
+		{ 1, "./src/a.c", "func_a", 10, 5, 1 },
+		{ 0, "./src/a.c", "func_a", 20, 0, 0 },
+		{ 0, "./src/b.c", "func_a", 5, 0, 1 },
+		{ 1, "./src/a.c", "func_b", 7, 0, 0 },
+	};
+	ILC_DAT_READER* reader;
+	ILC_DAT_POINT read;
+	ILC_DAT_TABLE table;
+	FILE* fp;
+	char buf[256];
+	long ix;
+	int ok = 1;
+	/**/
+
+	ILUT_ASSERT( "テキスト形式で書き込めること", ILC_DatSave( TEST_DAT, point, 4, ILC_DAT_TEXT ) == 0 );
+	fp = fopen( TEST_DAT, "r" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "ファイルのオープンに失敗" );
+	}
+	ILUT_ASSERT( "1行目", fgets( buf, sizeof(buf), fp ) != NULL && strcmp( buf, "1:./src/a.c:func_a:10:5\n" ) == 0 );
+	ILUT_ASSERT( "2行目", fgets( buf, sizeof(buf), fp ) != NULL && strcmp( buf, "0:./src/a.c:func_a:20\n" ) == 0 );
+	fclose( fp );
+
+	ILUT_ASSERT( "バイナリ形式で書き込めること", ILC_DatSave( TEST_DAT, point, 4, ILC_DAT_BINARY ) == 0 );
+	reader = ILC_DatOpen( TEST_DAT );
+	if ( reader == NULL ) {
+		ILUT_FAIL( "バイナリ形式のファイルが開けない" );
+	}
+	ILUT_ASSERT( "バイナリ形式と判定すること", reader->format == ILC_DAT_BINARY );
+	ILUT_ASSERT( "文字列は重複せずに持つこと", reader->str_num == 4 );
+	for ( ix = 0; ix < 4; ix++ ) {
+		if ( ILC_DatRead( reader, &read ) != 1
+		     || read.flag != point[ix].flag || read.line != point[ix].line
+		     || read.count != point[ix].count || read.has_count != point[ix].has_count
+		     || strcmp( read.file, point[ix].file ) != 0 || strcmp( read.func, point[ix].func ) != 0 ) {
+			ok = 0;
+		}
+	}
+	ILUT_ASSERT( "書き込んだ順に同じ内容が読めること", ok );
+	ILUT_ASSERT( "ファイルの終わり", ILC_DatRead( reader, &read ) == 0 );
+	ILC_DatClose( reader );
+
+	memset( &table, 0, sizeof(ILC_DAT_TABLE) );
+	ILUT_ASSERT( "ILC_DatLoadで読み込めること", ILC_DatLoad( TEST_DAT, &table ) == 0 && table.num == 4 );
+	ILC_DatFree( &table );
+
+	/* 途中で切れたファイル */
+	truncate( TEST_DAT, 50 );
+	ILUT_ASSERT( "途中で切れたファイルは開けないこと", ILC_DatOpen( TEST_DAT ) == NULL );
+
+	point[0].line = 0x7fffffffL + 1L;
+	ILUT_ASSERT( "intで表せない行数はバイナリ形式で書き込めないこと",
+	             sizeof(long) == sizeof(int) || ILC_DatSave( TEST_DAT, point, 4, ILC_DAT_BINARY ) == -1 );
+
+	remove( TEST_DAT );
+
+	return ILUT_SUCCESS;
+}
+
+
+
+int main (
+	int argc,
+	char** argv
+)
+{
+	/**/
+	static ILUT_TestCase test[] = {
+		DEF_TEST(test_ilc_dat_open),
+		DEF_TEST(test_ilc_dat_read),
+		DEF_TEST(test_ilc_dat_read_invalid),
+		DEF_TEST(test_ilc_dat_read_large),
+		DEF_TEST(test_ilc_dat_load_sort),
+		DEF_TEST(test_ilc_dat_combine_write),
+		DEF_TEST(test_ilc_dat_save),
+		TestCaseEnd
+	};
+	int ret;
+	FILE* out = NULL;
+	/**/
+
+	/*-
+	 * 第一引数で指定されたファイルを読み込む。
+	 * 指定されていない場合は ilc.dat を読み込む。
+	 */
+	if ( ILC_Initialize( argv[1] ) != ILC_SUCCESS ) {
+		printf( "カバレッジデータの読み込みに失敗" );
+	}
+
+	ILUT_SetShowMode( ILUT_MODE_DETAIL );
+	ret = ILUT_RunTest( test );
+
+	/*-
+	 * 第二引数でファイルが指定されてあれば、そちらにテスト結果を出力する。
+	 * 指定が無ければ標準出力にテスト結果を出力する。
+	 */
+	if ( argv[2] != NULL ) {
+		out = fopen( argv[2], "w" );
+	}
+	if ( out == NULL ) {
+		out = stdout;
+	}
+	ILUT_ResultOut( out, "ilc_dat", test );
+	fclose( out );
+
+	ILC_Finalize();
+
+	return ret;
+}
@@ -14,17 +14,44 @@
 #include "ilc.h"
 #include "util.h"
 
-/** ILC_Appendが呼ばれた回数 */
+/** ILC_AppendCopyが呼ばれた回数 */
 static int AppendCount = 0;
 
+/** ILC_AppendCopyで登録された文字列の最大数 */
+#define APPEND_MAX (16)
+
+/** ILC_AppendCopyで登録された文字列(本家は展開して保持するため、スタブでは複製を保持する) */
+static char* AppendData[APPEND_MAX];
+
 
 int getAppendCount() { return AppendCount; }
 void initAppendCount() { AppendCount = 0; }
+const char* getAppendData( long ix ) { return AppendData[ix]; }
+
+
+/**
+ * ILC_AppendCopyで登録された文字列を解放する
+ * ILC_DATAの登録数も0に戻す。
+ */
+void freeAppendData (
+	ILC_DATA* ilc_data
+)
+{
+	/**/
+	long ix;
+	/**/
+
+	for ( ix = 0; ix < ilc_data->num; ix++ ) {
+		xfree( AppendData[ix] );
+		AppendData[ix] = NULL;
+	}
+	ilc_data->num = 0;
+}
 
 
 /**
  * ILC_Searchのスタブ
- * 本家と同じロジック
+ * 本家と同じ結果(見つからない場合はNULL)を返す
  */
 char* ILC_Search (
 	ILC_DATA* ilc_data,
@@ -33,14 +60,37 @@ char* ILC_Search (
 {
 	/**/
 	long ix;
-	char* ilc_id;
 	char* ret = NULL;
 	/**/
 
 	for ( ix = 0; ix < ilc_data->num; ix++ ) {
-		ilc_id = (ilc_data->coverage)[ix];
-		if ( strcmp( str, ilc_id + 2 ) == 0 ) {
-			ret = ilc_id;
+		if ( strcmp( str, AppendData[ix] + 2 ) == 0 ) {
+			ret = AppendData[ix];
+			break;
+		}
+	}
+
+	return ret;
+}
+
+
+/**
+ * ILC_SearchIdのスタブ
+ * 本家と同じ結果(見つからない場合は-1)を返す
+ */
+long ILC_SearchId (
+	ILC_DATA* ilc_data,
+	const char* str
+)
+{
+	/**/
+	long ix;
+	long ret = -1;
+	/**/
+
+	for ( ix = 0; ix < ilc_data->num; ix++ ) {
+		if ( strcmp( str, AppendData[ix] + 2 ) == 0 ) {
+			ret = ix;
 			break;
 		}
 	}
@@ -50,30 +100,26 @@ char* ILC_Search (
 
 
 /**
- * ILC_Appendのスタブ
- * ほぼ本家と一緒。
+ * ILC_AppendCopyのスタブ
+ * 登録する文字列を複製して保持する。
  */
-ILC_ERROR ILC_Append (
+ILC_ERROR ILC_AppendCopy (
 	ILC_DATA* ilc_data,
-	char* data
+	const char* data
 )
 {
 	/**/
-	char** ptr;
+	char* ptr;
 	ILC_ERROR ret;
 	/**/
 
 	AppendCount++;
 
-	ptr = (char**)xmalloc( sizeof(char*) * (ilc_data->num + 1) );
+	ptr = ( ilc_data->num < APPEND_MAX ) ? (char*)xmalloc( strlen( data ) + 1 ) : NULL;
 	if ( ptr != NULL ) {
-		if ( ilc_data->coverage != NULL ) {
-			memcpy( ptr, ilc_data->coverage, sizeof(char*) * ilc_data->num );
-			xfree( ilc_data->coverage );
-		}
-		ptr[ilc_data->num] = data;
+		strcpy( ptr, data );
+		AppendData[ilc_data->num] = ptr;
 		ilc_data->num++;
-		ilc_data->coverage = ptr;
 		ret = ILC_SUCCESS;
 	}
 	else {
@@ -84,3 +130,4 @@ ILC_ERROR ILC_Append (
 }
 
 
+
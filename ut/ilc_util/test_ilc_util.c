@@ -26,6 +26,8 @@ void setRemoveCount();
 /* ilc_stub.c */
 int  getAppendCount();
 void initAppendCount();
+const char* getAppendData( long );
+void freeAppendData( ILC_DATA* );
 
 
 /**
@@ -486,6 +488,7 @@ ILUT_Test test_ilc_init (
 	ILUT_ASSERT( "fpin     が stdin であること", ilc.fpin     == stdin );
 	ILUT_ASSERT( "fpout    が stdoutであること", ilc.fpout    == stdout );
 	ILUT_ASSERT( "ilc_func が NULL  であること", ilc.ilc_func == NULL );
+	ILUT_ASSERT( "ilc_data が NULL  であること", ilc.ilc_data == NULL );
 
 	return ILUT_SUCCESS;
 }
@@ -813,6 +816,158 @@ ILUT_Test test_ilc_put_coverage (
 }
 
 
+/**
+ * ilc_put_coverage_idのユニットテスト
+ */
+ILUT_Test test_ilc_put_coverage_id (
+)
+{
+	/**/
+	FILE* fout;
+	FILE* fin;
+	char buf[BUFSIZ + 1];
+	/**/
+
+	/* 正常系動作確認 */
+	{
+		fout = fopen( "test.dat", "w" );
+		if ( fout == NULL ) {
+			ILUT_FAIL( "書き込みファイルの作成に失敗" );
+		}
+		ilc_put_coverage_id( fout, 12 );
+		fclose( fout );
+
+		/* 確認 */
+		memset( buf, '\0', sizeof( buf ) );
+		fin = fopen( "test.dat", "r" );
+		fread( buf, sizeof( char ), BUFSIZ, fin );
+		fclose( fin );
+
+		ILUT_ASSERT( "文字列の確認", strcmp( "*/ __ilc_check_id( 12 ); /*", buf ) == 0 );
+	}
+
+	/* 準正常系確認 */
+	/* 第一引数がNULL */
+	{
+		ilc_put_coverage_id( NULL, 3 );
+		ILUT_ASSERT( "SEGVしないこと", 1 );
+	}
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ilc_put_coverage_inline、ilc_put_coverage_id_inline、ilc_put_coverage_point、
+ * ilc_put_inline_headerのユニットテスト
+ */
+ILUT_Test test_ilc_put_coverage_inline (
+)
+{
+	/**/
+	FILE* fout;
+	FILE* fin;
+	char buf[BUFSIZ + 1];
+	/**/
+
+	/* 正常系動作確認 */
+	{
+		fout = fopen( "test.dat", "w" );
+		if ( fout == NULL ) {
+			ILUT_FAIL( "書き込みファイルの作成に失敗" );
+		}
+		ilc_put_inline_header( fout );
+		ilc_put_coverage_inline( fout, "src001", "func001", 1 );
+		ilc_put_coverage_id_inline( fout, 12 );
+		ilc_put_coverage_point( fout, "src001", "func001", 2 );
+		fclose( fout );
+
+		/* 確認 */
+		memset( buf, '\0', sizeof( buf ) );
+		fin = fopen( "test.dat", "r" );
+		fread( buf, sizeof( char ), BUFSIZ, fin );
+		fclose( fin );
+
+		ILUT_ASSERT( "文字列の確認", strcmp( "#include \"ilc_inline.h\"\n#line 1\n"
+											 "*/ __ilc_check_inline( \"src001:func001:1\" ); /*"
+											 "*/ __ilc_check_id_inline( 12 ); /*"
+											 "*/ __ilc_check_point( \"src001\", \"func001\", 2 ); /*", buf ) == 0 );
+	}
+
+	/* 準正常系確認 */
+	/* 第一引数がNULL */
+	{
+		ilc_put_inline_header( NULL );
+		ilc_put_coverage_inline( NULL, "src002", "func002", 2 );
+		ilc_put_coverage_id_inline( NULL, 3 );
+		ilc_put_coverage_point( NULL, "src002", "func002", 2 );
+		ILUT_ASSERT( "SEGVしないこと", 1 );
+	}
+
+	/* 第二引数、第三引数がNULL */
+	{
+		fout = fopen( "test.dat", "w" );
+		if ( fout == NULL ) {
+			ILUT_FAIL( "書き込みファイルの作成に失敗" );
+		}
+		ilc_put_coverage_inline( fout, NULL, "func003", 3 );
+		ilc_put_coverage_inline( fout, "src003", NULL, 3 );
+		ilc_put_coverage_point( fout, NULL, "func003", 3 );
+		ilc_put_coverage_point( fout, "src003", NULL, 3 );
+		fclose( fout );
+
+		/* 確認 */
+		memset( buf, '\0', sizeof( buf ) );
+		fin = fopen( "test.dat", "r" );
+		fread( buf, sizeof( char ), BUFSIZ, fin );
+		fclose( fin );
+
+		ILUT_ASSERT( "何も出力されないこと", buf[0] == '\0' );
+	}
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ilc_coverage_idのユニットテスト
+ */
+ILUT_Test test_ilc_coverage_id (
+)
+{
+	/**/
+	ILC_DATA ilcdata;
+	long id;
+	/**/
+
+	memset( &ilcdata, 0, sizeof(ilcdata) );
+
+	/* 正常系動作確認 */
+	setCreateCount( -1 );		/* xmallocの制限無し */
+	initAppendCount();			/* ILC_Append呼び出し回数の初期化 */
+
+	id = ilc_coverage_id( &ilcdata, "src001.c", "func1", 11 );
+	ILUT_ASSERT( "未登録のポイントはID 0 で登録されること", id == 0 );
+	id = ilc_coverage_id( &ilcdata, "src001.c", "func1", 22 );
+	ILUT_ASSERT( "未登録のポイントはID 1 で登録されること", id == 1 );
+	id = ilc_coverage_id( &ilcdata, "src001.c", "func1", 11 );
+	ILUT_ASSERT( "登録済みのポイントは同じIDを返すこと", id == 0 );
+	ILUT_ASSERT( "ILC_Append呼び出し回数が2であること", getAppendCount() == 2 );
+	ILUT_ASSERT( "登録文字列の確認",
+				 strcmp( "0:src001.c:func1:22", getAppendData( 1 ) ) == 0 );
+
+	/* 異常系：登録用文字列が作成できない */
+	setCreateCount( 0 );
+	id = ilc_coverage_id( &ilcdata, "src001.c", "func1", 33 );
+	ILUT_ASSERT( "-1を返すこと", id == -1 );
+
+	setCreateCount( -1 );		/* xmallocの制限無し */
+	freeAppendData( &ilcdata );
+
+	return ILUT_SUCCESS;
+}
+
+
 /**
  * ilc2ilcdataのユニットテスト
  */
@@ -876,8 +1031,7 @@ ILUT_Test test_ilc2ilcdata (
 	ilc.file_in = "src001.c";
 	ilc.ilc_func = func1;
 
-	ilcdata.num = 0;
-	ilcdata.coverage = NULL;
+	memset( &ilcdata, 0, sizeof(ilcdata) );
 
 
 	/* 正常系動作確認 */
@@ -889,13 +1043,13 @@ ILUT_Test test_ilc2ilcdata (
 	ILUT_ASSERT( "ILC_Append呼び出し回数が4であること", getAppendCount() == 4 );
 	ILUT_ASSERT( "ILCカバレッジデータの登録数が4であること", ilcdata.num == 4 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 1/4",
-				 strcmp( "0:src001.c:func1:11", ilcdata.coverage[0] ) == 0 );
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 2/4",
-				 strcmp( "0:src001.c:func2:22", ilcdata.coverage[1] ) == 0 );
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 3/4",
-				 strcmp( "0:src001.c:func2:33", ilcdata.coverage[2] ) == 0 );
+				 strcmp( "0:src001.c:func2:33", getAppendData( 2 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 4/4",
-				 strcmp( "0:src001.c:func3:44", ilcdata.coverage[3] ) == 0 );
+				 strcmp( "0:src001.c:func3:44", getAppendData( 3 ) ) == 0 );
 
 	/* 登録済みのデータが登録されないこと */
 	initAppendCount();		/* ILC_Append呼び出し回数の初期化 */
@@ -905,22 +1059,16 @@ ILUT_Test test_ilc2ilcdata (
 	ILUT_ASSERT( "ILC_Append呼び出し回数が0であること", getAppendCount() == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータの登録数が4のままであること", ilcdata.num == 4 );
 	ILUT_ASSERT( "登録済みデータが変更されていないこと 1/4",
-				 strcmp( "0:src001.c:func1:11", ilcdata.coverage[0] ) == 0 );
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
 	ILUT_ASSERT( "登録済みデータが変更されていないこと 2/4",
-				 strcmp( "0:src001.c:func2:22", ilcdata.coverage[1] ) == 0 );
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
 	ILUT_ASSERT( "登録済みデータが変更されていないこと 3/4",
-				 strcmp( "0:src001.c:func2:33", ilcdata.coverage[2] ) == 0 );
+				 strcmp( "0:src001.c:func2:33", getAppendData( 2 ) ) == 0 );
 	ILUT_ASSERT( "登録済みデータが変更されていないこと 4/4",
-				 strcmp( "0:src001.c:func3:44", ilcdata.coverage[3] ) == 0 );
+				 strcmp( "0:src001.c:func3:44", getAppendData( 3 ) ) == 0 );
 
 	/* 後始末 */
-	xfree( ilcdata.coverage[0] );
-	xfree( ilcdata.coverage[1] );
-	xfree( ilcdata.coverage[2] );
-	xfree( ilcdata.coverage[3] );
-	xfree( ilcdata.coverage );
-	ilcdata.num = 0;
-	ilcdata.coverage = NULL;
+	freeAppendData( &ilcdata );
 	
 	/* コメントがない関数がある場合 (func3のilc_commentをNULLにする) */
 	((ILC_FUNC_BODY*)(func3->body))->ilc_comment = NULL;
@@ -932,11 +1080,11 @@ ILUT_Test test_ilc2ilcdata (
 	ILUT_ASSERT( "ILC_Append呼び出し回数が3であること", getAppendCount() == 3 );
 	ILUT_ASSERT( "ILCカバレッジデータの登録数が3であること", ilcdata.num == 3 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 1/3",
-				 strcmp( "0:src001.c:func1:11", ilcdata.coverage[0] ) == 0 );
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 2/3",
-				 strcmp( "0:src001.c:func2:22", ilcdata.coverage[1] ) == 0 );
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 3/3",
-				 strcmp( "0:src001.c:func2:33", ilcdata.coverage[2] ) == 0 );
+				 strcmp( "0:src001.c:func2:33", getAppendData( 2 ) ) == 0 );
 
 	/* 未登録のデータが登録されること (func3のilc_comment復活) */
 	((ILC_FUNC_BODY*)(func3->body))->ilc_comment = comm4;
@@ -948,22 +1096,16 @@ ILUT_Test test_ilc2ilcdata (
 	ILUT_ASSERT( "ILC_Append呼び出し回数が1であること", getAppendCount() == 1 );
 	ILUT_ASSERT( "ILCカバレッジデータの登録数が4であること", ilcdata.num == 4 );
 	ILUT_ASSERT( "登録済みのデータが変更されていないこと 1/3",
-				 strcmp( "0:src001.c:func1:11", ilcdata.coverage[0] ) == 0 );
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
 	ILUT_ASSERT( "登録済みのデータが変更されていないこと 2/3",
-				 strcmp( "0:src001.c:func2:22", ilcdata.coverage[1] ) == 0 );
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
 	ILUT_ASSERT( "登録済みのデータが変更されていないこと 3/3",
-				 strcmp( "0:src001.c:func2:33", ilcdata.coverage[2] ) == 0 );
+				 strcmp( "0:src001.c:func2:33", getAppendData( 2 ) ) == 0 );
 	ILUT_ASSERT( "未登録のデータが登録されていること 1/1",
-				 strcmp( "0:src001.c:func3:44", ilcdata.coverage[3] ) == 0 );
+				 strcmp( "0:src001.c:func3:44", getAppendData( 3 ) ) == 0 );
 
 	/* 後始末 */
-	xfree( ilcdata.coverage[0] );
-	xfree( ilcdata.coverage[1] );
-	xfree( ilcdata.coverage[2] );
-	xfree( ilcdata.coverage[3] );
-	xfree( ilcdata.coverage );
-	ilcdata.num = 0;
-	ilcdata.coverage = NULL;
+	freeAppendData( &ilcdata );
 
 
 	/* 準正常系：登録用文字列のメモリ確保に失敗 */
@@ -976,9 +1118,9 @@ ILUT_Test test_ilc2ilcdata (
 	ILUT_ASSERT( "ILC_Append呼び出し回数が2であること", getAppendCount() == 2 );
 	ILUT_ASSERT( "ILCカバレッジデータの登録数が2であること", ilcdata.num == 2 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 1/2",
-				 strcmp( "0:src001.c:func1:11", ilcdata.coverage[0] ) == 0 );
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 2/2",
-				 strcmp( "0:src001.c:func2:22", ilcdata.coverage[1] ) == 0 );
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
 
 
 
@@ -993,9 +1135,9 @@ ILUT_Test test_ilc2ilcdata (
 	ILUT_ASSERT( "ILC_Append呼び出し回数が1であること", getAppendCount() == 1 );
 	ILUT_ASSERT( "ILCカバレッジデータの登録数が2であること", ilcdata.num == 2 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 1/2",
-				 strcmp( "0:src001.c:func1:11", ilcdata.coverage[0] ) == 0 );
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
 	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 2/2",
-				 strcmp( "0:src001.c:func2:22", ilcdata.coverage[1] ) == 0 );
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
 
 
 	/* 終了処理 */
@@ -1013,9 +1155,224 @@ ILUT_Test test_ilc2ilcdata (
 	xfree( comm3 );
 	xfree( comm4->body );
 	xfree( comm4 );
-	xfree( ilcdata.coverage[0] );
-	xfree( ilcdata.coverage[1] );
-	xfree( ilcdata.coverage );
+	freeAppendData( &ilcdata );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * ilc2manifestのユニットテスト
+ */
+ILUT_Test test_ilc2manifest (
+	)
+{
+	/**/
+	ILC ilc;
+	FILE* fout;
+	FILE* fin;
+	char buf[BUFSIZ + 1];
+
+	SLIST* func1;
+	SLIST* func2;
+	SLIST* comm1;
+	SLIST* comm2;
+	SLIST* comm3;
+
+	int ret;
+	/**/
+
+	/* 初期化 */
+	/*-
+	 * リストについて
+	 * func1 ----> func2
+	 *  - comm1     - comm2
+	 *                comm3
+	 */
+
+	setCreateCount( -1 );		/* xmallocの制限無し */
+	func1 = ilcfunc_create();
+	func2 = ilcfunc_create();
+
+	comm1 = ilccomment_create();
+	comm2 = ilccomment_create();
+	comm3 = ilccomment_create();
+
+	((ILC_FUNC_BODY*)(func1->body))->func_name   = "func1";
+	((ILC_FUNC_BODY*)(func1->body))->count       = 1;
+	((ILC_FUNC_BODY*)(func1->body))->ilc_comment = comm1;
+	((ILC_FUNC_BODY*)(func2->body))->func_name   = "func2";
+	((ILC_FUNC_BODY*)(func2->body))->count       = 2;
+	((ILC_FUNC_BODY*)(func2->body))->ilc_comment = comm2;	/* ->next = comm3 */
+
+	((ILC_COMMENT_BODY*)(comm1->body))->line     = 11;
+	((ILC_COMMENT_BODY*)(comm2->body))->line     = 22;
+	((ILC_COMMENT_BODY*)(comm3->body))->line     = 33;
+
+	ilcfunc_append( &func1, func2 );
+
+	ilccomment_append( &comm2, comm3 );
+
+	ilc_init( &ilc );
+	ilc.file_in = "src001.c";
+	ilc.ilc_func = func1;
+
+
+	/* 正常系動作確認 */
+	{
+		fout = fopen( "test.dat", "w" );
+		if ( fout == NULL ) {
+			ILUT_FAIL( "書き込みファイルの作成に失敗" );
+		}
+		ret = ilc2manifest( &ilc, fout );
+		fclose( fout );
+
+		/* 確認 */
+		memset( buf, '\0', sizeof( buf ) );
+		fin = fopen( "test.dat", "r" );
+		fread( buf, sizeof( char ), BUFSIZ, fin );
+		fclose( fin );
+
+		ILUT_ASSERT( "ilc2manifestが正常終了すること", ret == 0 );
+		ILUT_ASSERT( "出現順に書き出されること", strcmp( "0:src001.c:func1:11\n"
+														 "0:src001.c:func2:22\n"
+														 "0:src001.c:func2:33\n", buf ) == 0 );
+	}
+
+	/* コメントがない関数がある場合 (func1のilc_commentをNULLにする) */
+	{
+		((ILC_FUNC_BODY*)(func1->body))->ilc_comment = NULL;
+
+		fout = fopen( "test.dat", "w" );
+		if ( fout == NULL ) {
+			ILUT_FAIL( "書き込みファイルの作成に失敗" );
+		}
+		ret = ilc2manifest( &ilc, fout );
+		fclose( fout );
+
+		/* 確認 */
+		memset( buf, '\0', sizeof( buf ) );
+		fin = fopen( "test.dat", "r" );
+		fread( buf, sizeof( char ), BUFSIZ, fin );
+		fclose( fin );
+
+		ILUT_ASSERT( "ilc2manifestが正常終了すること", ret == 0 );
+		ILUT_ASSERT( "コメントのない関数は書き出されないこと", strcmp( "0:src001.c:func2:22\n"
+																	   "0:src001.c:func2:33\n", buf ) == 0 );
+	}
+
+	/* 準正常系：書き込みに失敗 (読み込み専用で開いたファイル) */
+	{
+		fout = fopen( "test.dat", "r" );
+		if ( fout == NULL ) {
+			ILUT_FAIL( "ファイルのオープンに失敗" );
+		}
+		ret = ilc2manifest( &ilc, fout );
+		fclose( fout );
+
+		ILUT_ASSERT( "ilc2manifestが異常終了すること", ret == -1 );
+	}
+
+
+	/* 終了処理 */
+	xfree( func1->body );
+	xfree( func1 );
+	xfree( func2->body );
+	xfree( func2 );
+	xfree( comm1->body );
+	xfree( comm1 );
+	xfree( comm2->body );
+	xfree( comm2 );
+	xfree( comm3->body );
+	xfree( comm3 );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * manifest2ilcdataのユニットテスト
+ */
+ILUT_Test test_manifest2ilcdata (
+	)
+{
+	/**/
+	ILC_DATA ilcdata;
+	FILE* fp;
+	int ret;
+	/**/
+
+	memset( &ilcdata, 0, sizeof(ilcdata) );
+
+	fp = fopen( "test.dat", "w" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "書き込みファイルの作成に失敗" );
+	}
+	fputs( "0:src001.c:func1:11\n"
+		   "\n"
+		   "0:src001.c:func2:22\r\n"
+		   "0:src001.c:func1:11\n"
+		   "0:src001.c:func2:33", fp );
+	fclose( fp );
+
+	/* 正常系動作確認 */
+	setCreateCount( -1 );		/* xmallocの制限無し */
+	initAppendCount();			/* ILC_Append呼び出し回数の初期化 */
+	fp = fopen( "test.dat", "r" );
+	ret = manifest2ilcdata( fp, &ilcdata );
+	fclose( fp );
+
+	ILUT_ASSERT( "manifest2ilcdataが正常終了すること", ret == 0 );
+	ILUT_ASSERT( "ILC_Append呼び出し回数が3であること(空行・登録済みは除く)", getAppendCount() == 3 );
+	ILUT_ASSERT( "ILCカバレッジデータに登録されていること 1/3",
+				 strcmp( "0:src001.c:func1:11", getAppendData( 0 ) ) == 0 );
+	ILUT_ASSERT( "改行を取り除いて登録されていること 2/3",
+				 strcmp( "0:src001.c:func2:22", getAppendData( 1 ) ) == 0 );
+	ILUT_ASSERT( "末尾に改行がなくても登録されていること 3/3",
+				 strcmp( "0:src001.c:func2:33", getAppendData( 2 ) ) == 0 );
+
+	/* 登録済みのデータが登録されないこと */
+	initAppendCount();			/* ILC_Append呼び出し回数の初期化 */
+	fp = fopen( "test.dat", "r" );
+	ret = manifest2ilcdata( fp, &ilcdata );
+	fclose( fp );
+
+	ILUT_ASSERT( "manifest2ilcdataが正常終了すること", ret == 0 );
+	ILUT_ASSERT( "ILC_Append呼び出し回数が0であること", getAppendCount() == 0 );
+	ILUT_ASSERT( "ILCカバレッジデータの登録数が3のままであること", ilcdata.num == 3 );
+
+	freeAppendData( &ilcdata );
+
+	/* 準正常系：形式が異なる */
+	fp = fopen( "test.dat", "w" );
+	fputs( "src001.c:func1:11\n", fp );
+	fclose( fp );
+
+	initAppendCount();			/* ILC_Append呼び出し回数の初期化 */
+	fp = fopen( "test.dat", "r" );
+	ret = manifest2ilcdata( fp, &ilcdata );
+	fclose( fp );
+
+	ILUT_ASSERT( "manifest2ilcdataが異常終了すること", ret == -1 );
+	ILUT_ASSERT( "ILC_Append呼び出し回数が0であること", getAppendCount() == 0 );
+
+	/* 準正常系：ILC_Appendに失敗 */
+	fp = fopen( "test.dat", "w" );
+	fputs( "0:src001.c:func1:11\n0:src001.c:func1:22\n", fp );
+	fclose( fp );
+
+	setCreateCount( 1 );		/* xmallocが1回のみ成功(ILC_Append内) */
+	initAppendCount();			/* ILC_Append呼び出し回数の初期化 */
+	fp = fopen( "test.dat", "r" );
+	ret = manifest2ilcdata( fp, &ilcdata );
+	fclose( fp );
+
+	ILUT_ASSERT( "manifest2ilcdataが異常終了すること", ret == -1 );
+	ILUT_ASSERT( "ILC_Append呼び出し回数が2であること", getAppendCount() == 2 );
+	ILUT_ASSERT( "ILCカバレッジデータの登録数が1であること", ilcdata.num == 1 );
+
+	setCreateCount( -1 );		/* xmallocの制限無し */
+	freeAppendData( &ilcdata );
 
 	return ILUT_SUCCESS;
 }
@@ -1041,7 +1398,12 @@ int main (
 		DEF_TEST(test_ilc_end),
 		DEF_TEST(test_ilc_append_coverage),
 		DEF_TEST(test_ilc_put_coverage),
+		DEF_TEST(test_ilc_put_coverage_id),
+		DEF_TEST(test_ilc_put_coverage_inline),
+		DEF_TEST(test_ilc_coverage_id),
 		DEF_TEST(test_ilc2ilcdata),
+		DEF_TEST(test_ilc2manifest),
+		DEF_TEST(test_manifest2ilcdata),
 		TestCaseEnd
 	};
 	int ret;
@@ -183,6 +183,284 @@ ILUT_Test test_options_005 (
 	return ILUT_SUCCESS;
 }
 
+/**
+ * IDで出力するオプションの指定あり
+ */
+ILUT_Test test_options_006 (
+)
+{
+	/**/
+	int argc = 3;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-i",			/* 計測ポイントをIDで出力 */
+		"infile"		/* 入力ファイル名 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "ID出力が設定されていること", opt.id_mode == 1 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile", opt.in_file )  == 0 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * 入力ファイルを複数指定
+ */
+ILUT_Test test_options_007 (
+)
+{
+	/**/
+	int argc = 6;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-f",			/* ILCデータファイルの指定 */
+		"ilc.dat",		/* ILCデータファイル名 */
+		"infile1",		/* 入力ファイル名 */
+		"infile2",		/* 入力ファイル名 */
+		"@list"			/* 入力ファイル一覧 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "データファイル名が設定されていること",
+				 strcmp( "ilc.dat", opt.ilc_file ) == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile1", opt.in_file )  == 0 );
+	ILUT_ASSERT( "変換元入力ファイルの数が設定されていること", opt.in_num == 3 );
+	ILUT_ASSERT( "変換元入力ファイル名の一覧が設定されていること",
+				 strcmp( "infile1", opt.in_files[0] ) == 0 &&
+				 strcmp( "infile2", opt.in_files[1] ) == 0 &&
+				 strcmp( "@list",   opt.in_files[2] ) == 0 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * 同時に変換するファイルの数の指定
+ */
+ILUT_Test test_options_008 (
+)
+{
+	/**/
+	int argc = 4;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-j",			/* 同時に変換するファイルの数の指定 */
+		"8",			/* 同時に変換するファイルの数 */
+		"infile"		/* 入力ファイル名 */
+	};
+	int argc2 = 4;
+	char* argv2[] = {
+		"./test",		/* プログラム名 */
+		"-j",			/* 同時に変換するファイルの数の指定 */
+		"0",			/* 同時に変換するファイルの数(不正) */
+		"infile"		/* 入力ファイル名 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "同時に変換するファイルの数が設定されていること", opt.jobs == 8 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile", opt.in_file )  == 0 );
+
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc2, argv2, &opt );
+
+	ILUT_ASSERT( "不正な数の場合はヘルプ出力が設定されていること", opt.help == 1 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * インライン版の出力の指定
+ */
+ILUT_Test test_options_009 (
+)
+{
+	/**/
+	int argc = 4;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-n",			/* インライン版で出力 */
+		"-i",			/* 計測ポイントをIDで出力 */
+		"infile"		/* 入力ファイル名 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "インライン版の出力が設定されていること", opt.inline_mode == 1 );
+	ILUT_ASSERT( "ID出力が設定されていること", opt.id_mode == 1 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile", opt.in_file )  == 0 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * ilc_points セクションへの登録の指定
+ */
+ILUT_Test test_options_010 (
+)
+{
+	/**/
+	int argc = 4;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-r",			/* ilc_points セクションに登録 */
+		"-n",			/* インライン版で出力(-r が優先) */
+		"infile"		/* 入力ファイル名 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "セクションへの登録が設定されていること", opt.inline_mode == 2 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile", opt.in_file )  == 0 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * マニフェスト出力(-m)
+ */
+ILUT_Test test_options_011 (
+)
+{
+	/**/
+	int argc = 3;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-m",			/* マニフェストを出力 */
+		"infile"		/* 入力ファイル名 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "マニフェスト出力が設定されていること", opt.manifest == 1 );
+	ILUT_ASSERT( "インライン版が設定されていないこと", opt.inline_mode == 0 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile", opt.in_file )  == 0 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * キャッシュディレクトリの指定(-C)
+ */
+ILUT_Test test_options_012 (
+)
+{
+	/**/
+	int argc = 4;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-C",			/* キャッシュディレクトリの指定 */
+		".ilc-cache",	/* キャッシュディレクトリ */
+		"infile"		/* 入力ファイル名 */
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "キャッシュディレクトリが設定されていること",
+				 opt.cache_dir != NULL && strcmp( ".ilc-cache", opt.cache_dir ) == 0 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていること",
+				 strcmp( "infile", opt.in_file )  == 0 );
+
+	return ILUT_SUCCESS;
+}
+
+/**
+ * 変換サーバーとして起動(--server、-S)
+ */
+ILUT_Test test_options_013 (
+)
+{
+	/**/
+	int argc = 4;
+	char* argv[] = {
+		"./test",		/* プログラム名 */
+		"-f",			/* ILCデータファイルの指定 */
+		"ilc.dat",		/* ILCデータファイル */
+		"--server=ilc.sock"	/* 変換サーバーとして起動 */
+	};
+	char* argv2[] = {
+		"./test",		/* プログラム名 */
+		"-S",			/* 変換サーバーとして起動 */
+		"ilc2.sock",	/* ソケットのパス */
+		NULL
+	};
+	struct opt opt;
+	/**/
+
+	/* 初期化 */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( argc, argv, &opt );
+
+	ILUT_ASSERT( "ソケットのパスが設定されていること",
+				 opt.server != NULL && strcmp( "ilc.sock", opt.server ) == 0 );
+	ILUT_ASSERT( "ILCデータファイル名が設定されていること",
+				 strcmp( "ilc.dat", opt.ilc_file ) == 0 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+	ILUT_ASSERT( "変換元入力ファイル名が設定されていないこと", opt.in_file == NULL );
+
+	/* 短い名前のオプション */
+	memset( &opt, 0, sizeof(opt) );
+
+	parse_option( 3, argv2, &opt );
+
+	ILUT_ASSERT( "ソケットのパスが設定されていること",
+				 opt.server != NULL && strcmp( "ilc2.sock", opt.server ) == 0 );
+	ILUT_ASSERT( "ヘルプ出力が設定されていないこと", opt.help == 0 );
+
+	return ILUT_SUCCESS;
+}
+
 int main (
 	int argc,
 	char** argv
@@ -195,6 +473,14 @@ int main (
 		DEF_TEST(test_options_003),
 		DEF_TEST(test_options_004),
 		DEF_TEST(test_options_005),
+		DEF_TEST(test_options_006),
+		DEF_TEST(test_options_007),
+		DEF_TEST(test_options_008),
+		DEF_TEST(test_options_009),
+		DEF_TEST(test_options_010),
+		DEF_TEST(test_options_011),
+		DEF_TEST(test_options_012),
+		DEF_TEST(test_options_013),
 		TestCaseEnd
 	};
 	int ret;
@@ -27,11 +27,11 @@ char* ILC_Search (
 
 
 /**
- * ILC_Appendのスタブ
+ * ILC_AppendCopyのスタブ
  */
-ILC_ERROR ILC_Append (
+ILC_ERROR ILC_AppendCopy (
 	ILC_DATA* ilc_data,
-	char* data
+	const char* data
 )
 {
 	return ILC_SUCCESS;
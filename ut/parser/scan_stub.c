@@ -14,11 +14,11 @@
 #include "scan.h"
 
 /*
- * 外部公開変数の定義
+ * 字句解析器の状態
  */
-int   yylineno = 0;
-char* yytext = NULL;
-int   yyleng = 0;
+static int   yylineno = 0;
+static char* yytext = NULL;
+static int   yyleng = 0;
 
 
 /*
@@ -50,11 +50,30 @@ void setStubData (
 
 
 /**
- * yylexのスタブ
+ * lex_createのスタブ
+ * 行番号を初期化し、ダミーの字句解析器を返す
+ */
+LEX_SCANNER lex_create (
+	FILE* in,
+	FILE* out
+)
+{
+	/**/
+	/**/
+	yylineno = 1;
+
+	return &stub;
+}
+
+void lex_destroy( LEX_SCANNER scanner ) {}
+
+/**
+ * lex_tokenのスタブ
  * ドライバで設定した文字列を返していく
- * yylex()が呼ばれたタイミングで yytext、yyleng の設定を行う
+ * lex_token()が呼ばれたタイミングで yytext、yyleng の設定を行う
  */
-int yylex (
+int lex_token (
+	LEX_SCANNER scanner
 )
 {
 	/**/
@@ -70,6 +89,6 @@ int yylex (
 	return _yylex;
 }
 
-void set_lex_input( FILE* fp ) {}
-void set_lex_output( FILE* fp ) {}
-
+char* lex_text( LEX_SCANNER scanner ) { return yytext; }
+int lex_leng( LEX_SCANNER scanner ) { return yyleng; }
+int lex_lineno( LEX_SCANNER scanner ) { return yylineno; }
@@ -54,6 +54,8 @@ ILUT_Test test_parse_001 (
 	ilc.file_in  = "test_parse_001.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setCreateCount( -1 );		/* xmallocの制限無し */
 	setStubData( stub );
@@ -87,6 +89,8 @@ ILUT_Test test_parse_002 (
 	ilc.file_in  = "test_parse_002.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setStubData( stub );
 
@@ -124,6 +128,8 @@ ILUT_Test test_parse_003 (
 	ilc.file_in  = "test_parse_003.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -168,6 +174,8 @@ ILUT_Test test_parse_004 (
 	ilc.file_in  = "test_parse_004.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -216,6 +224,8 @@ ILUT_Test test_parse_005 (
 	ilc.file_in  = "test_parse_005.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -289,6 +299,8 @@ ILUT_Test test_parse_006 (
 	ilc.file_in  = "test_parse_006.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -348,6 +360,8 @@ ILUT_Test test_parse_007 (
 	ilc.file_in  = "test_parse_007.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -419,6 +433,8 @@ ILUT_Test test_parse_008 (
 	ilc.file_in  = "test_parse_008.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = fout;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -526,6 +542,8 @@ ILUT_Test test_parse_009 (
 	ilc.file_in  = "test_parse_009.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = fout;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 
@@ -624,6 +642,8 @@ ILUT_Test test_parse_010 (
 	ilc.file_in  = "test_parse_010.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
@@ -685,6 +705,8 @@ ILUT_Test test_parse_011 (
 	ilc.file_in  = "test_parse_011.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
@@ -745,6 +767,8 @@ ILUT_Test test_parse_012 (
 	ilc.file_in  = "test_parse_012.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
@@ -809,6 +833,8 @@ ILUT_Test test_parse_013 (
 	ilc.file_in  = "test_parse_013.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
@@ -870,6 +896,8 @@ ILUT_Test test_parse_014 (
 	ilc.file_in  = "test_parse_014.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
@@ -937,6 +965,8 @@ ILUT_Test test_parse_015 (
 	ilc.file_in  = "test_parse_015.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 	setCreateCount( 2 );		/* void/funcを読み込んだ2回しかxmallocできない。
@@ -982,6 +1012,8 @@ ILUT_Test test_parse_016 (
 	ilc.file_in  = "test_parse_016.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 	setCreateCount( 2 );		/* extern/intを読み込んだ2回しかxmallocできない。 */
@@ -1032,6 +1064,8 @@ ILUT_Test test_parse_017 (
 	ilc.file_in  = "test_parse_017.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
@@ -1125,6 +1159,8 @@ ILUT_Test test_parse_018 (
 	ilc.file_in  = "test_parse_018.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	setRemoveCount( 0 );		/* xfreeの回数を初期化 */
 	setCreateCount( -1 );		/* xmallocの制限無し */
@@ -1168,6 +1204,8 @@ ILUT_Test test_parse_019 (
 	ilc.file_in  = "test_parse_019.c";
 	ilc.ilc_func = NULL;
 	ilc.fpout    = NULL;
+	ilc.ilc_data = NULL;
+	ilc.inline_mode = 0;
 
 	fout = freopen( "test.dat", "w", stderr );
 	if ( fout == NULL ) {
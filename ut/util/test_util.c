@@ -11,6 +11,8 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 #include "util.h"
 #include "ilc.h"
 #include "ILUT.h"
@@ -285,6 +287,183 @@ ILUT_Test test_xmalloc_xfree (
 	return ILUT_SUCCESS;
 }
 
+/**
+ * fd_containsのテスト
+ */
+ILUT_Test test_fd_contains (
+	)
+{
+	/**/
+	FILE* fp;
+	/**/
+
+	fp = fopen( "test_fd.dat", "w+" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	fflush( fp );
+	ILUT_ASSERT( "空のファイルは含まれないこと", fd_contains( fileno( fp ), "ILC:" ) == 0 );
+
+	fputs( "int main() {\n\t/* ILC; */\n}\n", fp );
+	fflush( fp );
+	ILUT_ASSERT( "文字列が含まれないこと", fd_contains( fileno( fp ), "ILC:" ) == 0 );
+
+	fputs( "/* ILC: 末尾 */", fp );
+	fflush( fp );
+	ILUT_ASSERT( "文字列が含まれること", fd_contains( fileno( fp ), "ILC:" ) == 1 );
+	fclose( fp );
+	remove( "test_fd.dat" );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * fd_copyのテスト
+ */
+ILUT_Test test_fd_copy (
+	)
+{
+	/**/
+	FILE* in;
+	FILE* out;
+	char buf[256];
+	size_t len;
+	long ix;
+	/**/
+
+	in  = fopen( "test_fd_in.dat", "w+" );
+	out = fopen( "test_fd_out.dat", "w+" );
+	if ( in == NULL || out == NULL ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	for ( ix = 0; ix < 10000; ix++ ) {
+		fprintf( in, "line %ld\n", ix );
+	}
+	fflush( in );
+	rewind( in );
+
+	ILUT_ASSERT( "複写できること", fd_copy( fileno( in ), fileno( out ) ) == 0 );
+
+	fseek( in, 0L, SEEK_END );
+	fseek( out, 0L, SEEK_END );
+	ILUT_ASSERT( "同じサイズであること", ftell( in ) == ftell( out ) );
+
+	rewind( out );
+	len = fread( buf, 1, 14, out );
+	buf[len] = '\0';
+	ILUT_ASSERT( "先頭から複写されていること", strcmp( "line 0\nline 1\n", buf ) == 0 );
+
+	fclose( in );
+	fclose( out );
+	remove( "test_fd_in.dat" );
+	remove( "test_fd_out.dat" );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * mem_hash、fd_hashのテスト
+ */
+ILUT_Test test_fd_hash (
+	)
+{
+	/**/
+	FILE* fp;
+	unsigned long long hash;
+	unsigned long long hash2;
+	/**/
+
+	ILUT_ASSERT( "空のメモリは初期値のままであること", mem_hash( "", 0, HASH_INIT ) == HASH_INIT );
+	ILUT_ASSERT( "FNV-1aのハッシュ値であること", mem_hash( "a", 1, HASH_INIT ) == 0xaf63dc4c8601ec8cULL );
+	ILUT_ASSERT( "続けて求められること",
+				 mem_hash( "b", 1, mem_hash( "a", 1, HASH_INIT ) ) == mem_hash( "ab", 2, HASH_INIT ) );
+
+	fp = fopen( "test_fd.dat", "w+" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	fflush( fp );
+	hash = HASH_INIT;
+	ILUT_ASSERT( "空のファイルも求められること", fd_hash( fileno( fp ), &hash ) == 0 );
+	ILUT_ASSERT( "空のファイルは初期値のままであること", hash == HASH_INIT );
+
+	fputs( "int main() {\n\t/* ILC: */\n}\n", fp );
+	fflush( fp );
+	hash = HASH_INIT;
+	ILUT_ASSERT( "求められること", fd_hash( fileno( fp ), &hash ) == 0 );
+	ILUT_ASSERT( "ファイルの内容のハッシュ値であること",
+				 hash == mem_hash( "int main() {\n\t/* ILC: */\n}\n", 27, HASH_INIT ) );
+
+	hash2 = 1;
+	fd_hash( fileno( fp ), &hash2 );
+	ILUT_ASSERT( "初期値が異なればハッシュ値も異なること", hash != hash2 );
+	fclose( fp );
+	remove( "test_fd.dat" );
+
+	hash = HASH_INIT;
+	ILUT_ASSERT( "通常のファイルでなければ求められないこと", fd_hash( -1, &hash ) == -1 );
+
+	return ILUT_SUCCESS;
+}
+
+
+/**
+ * file_updateのテスト
+ */
+ILUT_Test test_file_update (
+	)
+{
+	/**/
+	FILE* fp;
+	struct stat st1;
+	struct stat st2;
+	char buf[256];
+	size_t len;
+	/**/
+
+	remove( "test_fd_out.dat" );
+
+	/* 置き換えるファイルがない */
+	fp = fopen( "test_fd_tmp.dat", "w" );
+	if ( fp == NULL ) {
+		ILUT_FAIL( "ファイルの作成に失敗" );
+	}
+	fputs( "line 1\n", fp );
+	fclose( fp );
+	ILUT_ASSERT( "置き換えること", file_update( "test_fd_tmp.dat", "test_fd_out.dat" ) == 0 );
+	ILUT_ASSERT( "一時ファイルがないこと", stat( "test_fd_tmp.dat", &st1 ) != 0 );
+	stat( "test_fd_out.dat", &st1 );
+
+	/* 内容が同じ */
+	fp = fopen( "test_fd_tmp.dat", "w" );
+	fputs( "line 1\n", fp );
+	fclose( fp );
+	ILUT_ASSERT( "置き換えないこと", file_update( "test_fd_tmp.dat", "test_fd_out.dat" ) == 1 );
+	ILUT_ASSERT( "一時ファイルがないこと", stat( "test_fd_tmp.dat", &st2 ) != 0 );
+	stat( "test_fd_out.dat", &st2 );
+	ILUT_ASSERT( "ファイルが変わっていないこと", st1.st_ino == st2.st_ino );
+
+	/* 内容が異なる(大きさが同じ) */
+	fp = fopen( "test_fd_tmp.dat", "w" );
+	fputs( "line 2\n", fp );
+	fclose( fp );
+	ILUT_ASSERT( "置き換えること", file_update( "test_fd_tmp.dat", "test_fd_out.dat" ) == 0 );
+	fp = fopen( "test_fd_out.dat", "r" );
+	len = fread( buf, 1, sizeof(buf) - 1, fp );
+	buf[len] = '\0';
+	fclose( fp );
+	ILUT_ASSERT( "内容が置き換わっていること", strcmp( "line 2\n", buf ) == 0 );
+
+	/* 一時ファイルがない */
+	ILUT_ASSERT( "置き換えられないこと", file_update( "test_fd_tmp.dat", "test_fd_out.dat" ) == -1 );
+
+	remove( "test_fd_out.dat" );
+
+	return ILUT_SUCCESS;
+}
+
 
 
 int main (
@@ -299,6 +478,10 @@ int main (
 		DEF_TEST(test_slist_append),
 		DEF_TEST(test_slist_search),
 		DEF_TEST(test_xmalloc_xfree),
+		DEF_TEST(test_fd_contains),
+		DEF_TEST(test_fd_copy),
+		DEF_TEST(test_fd_hash),
+		DEF_TEST(test_file_update),
 		TestCaseEnd
 	};
 	int ret;